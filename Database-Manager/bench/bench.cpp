@@ -0,0 +1,481 @@
+// Database-Manager-bench: mide las rutas críticas con datos sintéticos y escribe JSON.
+//
+//   Database-Manager-bench [--out resultados.json] [--repeat 5] [--only regex] [--dsn DSN]
+//                          [--backend nombre=cadena ...] [--fetch-sql SQL]
+//
+// Sin servidor se usa SQLite en memoria para los resultados. El DDL General y el árbol
+// necesitan MariaDB (--dsn o DM_BENCH_DSN, la misma cadena que el diálogo de conexión):
+// se crea la base dm_bench con 5.000 objetos la primera vez. Con el servidor simulado
+// (--dsn "QFAKE:tables=4500;views=400;functions=50;procedures=50;latency=1") corren sin
+// MariaDB y con latencia fija. Sin DSN esos casos se escriben como "skipped". bench/compare.py compara el JSON con bench/baseline.json.
+//
+// Cada --backend añade fetch_<nombre>: lee --fetch-sql (por defecto 1M filas de la tabla
+// seq_1_to_1000000 del motor Sequence de MariaDB) igual que QueryWorker y anota filas/s.
+// Para comparar ODBC con el cliente nativo contra el mismo servidor:
+//   --backend odbc="DRIVER={MariaDB ODBC 3.2 Driver};SERVER=127.0.0.1;UID=root;PWD=x;"
+//   --backend nativo="QMARIADB:host=127.0.0.1;port=3306;user=root;password=x;"
+
+#include "SqlHighlighter.h"
+#include "SqlText.h"
+#include "ResultBuffer.h"
+#include "ResultModel.h"
+#include "ResultView.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include "DdlExporter.h"
+#include "ObjectTreeModel.h"
+#include "SchemaDiff.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QScrollBar>
+#include <QTableView>
+#include <QTextDocument>
+#include <QThread>
+#include <QDateTime>
+#include <QDir>
+#include <QSysInfo>
+#include <QFile>
+#include <QTextStream>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+const int kRows = 1000000;
+const int kRowBlock = 500;            // igual que QueryWorker
+const int kScrollSteps = 200;
+const char* kBenchDb = "dm_bench";
+const int kTables = 4500, kViews = 400, kFunctions = 50, kProcedures = 50;
+const char* kFetchSql = "SELECT seq, CONCAT('fila ', seq), seq * 1.5, NOW() - INTERVAL seq SECOND "
+                        "FROM seq_1_to_1000000";
+
+class Bench {
+public:
+    Bench(int repeat, const QString& only) : repeat(repeat), only(only) {}
+
+    bool wanted(const QString& name) const
+    {
+        return only.isEmpty() || QRegularExpression(only).match(name).hasMatch();
+    }
+
+    // Repite body; before (sin medir) prepara cada repetición.
+    void run(const QString& name, const std::function<void()>& body,
+             const std::function<void()>& before = {})
+    {
+        if (!wanted(name)) return;
+        QVector<double> ms;
+        for (int i = 0; i < repeat; ++i) {
+            if (before) before();
+            QElapsedTimer t;
+            t.start();
+            body();
+            ms << t.nsecsElapsed() / 1e6;
+        }
+        QVector<double> sorted = ms;
+        std::sort(sorted.begin(), sorted.end());
+
+        QJsonArray runs;
+        for (double v : ms) runs << qRound(v * 100) / 100.0;
+        QJsonObject o;
+        o["median_ms"] = qRound(sorted[sorted.size() / 2] * 100) / 100.0;
+        o["min_ms"] = qRound(sorted.first() * 100) / 100.0;
+        o["runs"] = runs;
+        results[name] = o;
+        QTextStream(stdout) << QString("%1 %2 ms\n").arg(name, -28).arg(sorted[sorted.size() / 2], 0, 'f', 2);
+    }
+
+    // Añade al caso ya medido el número de filas y el ritmo según la mediana.
+    void throughput(const QString& name, qint64 rows)
+    {
+        if (!results.contains(name)) return;
+        QJsonObject o = results[name].toObject();
+        const double median = o["median_ms"].toDouble();
+        o["rows"] = double(rows);
+        o["rows_per_s"] = median > 0 ? qRound64(rows * 1000.0 / median) : 0;
+        results[name] = o;
+    }
+
+    void skip(const QString& name, const QString& why)
+    {
+        if (!wanted(name)) return;
+        results[name] = QJsonObject{{"skipped", why}};
+        QTextStream(stdout) << QString("%1 omitido: %2\n").arg(name, -28).arg(why);
+    }
+
+    QJsonObject results;
+
+private:
+    int repeat;
+    QString only;
+};
+
+// ~10 MB de SQL variado: comentarios de línea y de bloque (multilínea), cadenas con
+// escapes, identificadores entre comillas invertidas y rutinas con DELIMITER.
+QString syntheticScript()
+{
+    QString s;
+    s.reserve(10 * 1024 * 1024 + 4096);
+    for (int i = 0; s.size() < 10 * 1024 * 1024; ++i) {
+        switch (i % 6) {
+        case 0:
+            s += QString("-- consulta %1\nSELECT c.id, c.nombre, SUM(v.total) AS total FROM clientes c "
+                         "JOIN ventas v ON v.cliente_id = c.id WHERE c.nombre LIKE 'a%\\'%1' "
+                         "GROUP BY c.id ORDER BY total DESC LIMIT 50;\n").arg(i);
+            break;
+        case 1:
+            s += QString("/* bloque %1\n   de varias líneas; con ; dentro */\n"
+                         "UPDATE `tabla %1` SET `valor` = `valor` + 1, nota = \"x;y\" WHERE id IN (1, 2, 3);\n").arg(i);
+            break;
+        case 2:
+            s += QString("CREATE TABLE IF NOT EXISTS t%1 (id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT, "
+                         "nombre VARCHAR(100) DEFAULT NULL, creado DATETIME DEFAULT CURRENT_TIMESTAMP, "
+                         "PRIMARY KEY (id), KEY ix_nombre (nombre)) ENGINE=InnoDB;\n").arg(i);
+            break;
+        case 3:
+            s += QString("INSERT INTO registro (id, texto, monto) VALUES (%1, 'línea %1', %1.25), "
+                         "(%2, NULL, -3.5e2);\n").arg(i).arg(i + 1);
+            break;
+        case 4:
+            s += QString("DELIMITER $$\nCREATE PROCEDURE p%1(IN x INT)\nBEGIN\n  DECLARE y INT DEFAULT 0;\n"
+                         "  SET y = x * 2; # comentario\n  SELECT y;\nEND$$\nDELIMITER ;\n").arg(i);
+            break;
+        default:
+            s += QString("ALTER TABLE t%1 ADD COLUMN extra%1 TEXT; DROP VIEW IF EXISTS v%1; USE ventas;\n").arg(i);
+            break;
+        }
+    }
+    return s;
+}
+
+bool exec(QSqlQuery& q, const QString& sql)
+{
+    if (q.exec(sql)) return true;
+    QTextStream(stderr) << "Error: " << q.lastError().text() << "\n  " << sql.left(200) << "\n";
+    return false;
+}
+
+// 1M filas con enteros, reales, fechas, textos repetidos y NULLs.
+bool fillSqlite(QSqlDatabase& db)
+{
+    QSqlQuery q(db);
+    return exec(q, "CREATE TABLE r (id INTEGER, nombre TEXT, monto REAL, fecha DATE, nota TEXT)")
+        && exec(q, "INSERT INTO r WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq "
+                   "WHERE n < " + QString::number(kRows) + ") "
+                   "SELECT n, 'cliente ' || (n * 7919 % 50000), (n * 37 % 100000) / 100.0, "
+                   "date('2020-01-01', '+' || (n % 1500) || ' days'), "
+                   "CASE WHEN n % 7 = 0 THEN NULL ELSE printf('%08x', n * 2654435761 % 4294967296) END FROM seq");
+}
+
+// Base dm_bench con 5.000 objetos; se reutiliza si ya está completa.
+bool prepareServerSchema(DbSession& session)
+{
+    QSqlQuery q(session.db());
+    const QString db = DbSession::q(kBenchDb);
+    if (!exec(q, "CREATE DATABASE IF NOT EXISTS " + db)) return false;
+
+    if (exec(q, QString("SELECT COUNT(*) FROM information_schema.TABLES WHERE TABLE_SCHEMA = '%1'").arg(kBenchDb))
+        && q.next() && q.value(0).toInt() == kTables + kViews) {
+        return true;
+    }
+
+    QTextStream(stdout) << "Creando " << kBenchDb << " (" << kTables + kViews + kFunctions + kProcedures << " objetos)...\n";
+    if (!exec(q, QString("DROP DATABASE %1").arg(db)) || !exec(q, "CREATE DATABASE " + db)) return false;
+    for (int i = 0; i < kTables; ++i) {
+        if (!exec(q, QString("CREATE TABLE %1.t%2 (id BIGINT UNSIGNED NOT NULL AUTO_INCREMENT, "
+                             "nombre VARCHAR(100), monto DECIMAL(12,2), creado DATETIME, "
+                             "PRIMARY KEY (id), KEY ix_nombre (nombre)) ENGINE=InnoDB").arg(db).arg(i)))
+            return false;
+    }
+    for (int i = 0; i < kViews; ++i) {
+        if (!exec(q, QString("CREATE VIEW %1.v%2 AS SELECT id, nombre FROM %1.t%2 WHERE monto > %2").arg(db).arg(i)))
+            return false;
+    }
+    for (int i = 0; i < kFunctions; ++i) {
+        if (!exec(q, QString("CREATE FUNCTION %1.f%2(x INT) RETURNS INT DETERMINISTIC RETURN x + %2").arg(db).arg(i)))
+            return false;
+    }
+    for (int i = 0; i < kProcedures; ++i) {
+        if (!exec(q, QString("CREATE PROCEDURE %1.p%2(IN x INT) BEGIN SELECT x + %2; END").arg(db).arg(i)))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    // Sin pantalla: la vista se pinta igual en el backend offscreen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Mide las rutas críticas de Database-Manager.");
+    parser.addHelpOption();
+    parser.addOption({"out", "Archivo JSON de resultados.", "archivo"});
+    parser.addOption({"repeat", "Repeticiones por caso (se informa la mediana).", "n", "5"});
+    parser.addOption({"only", "Solo los casos cuyo nombre coincide.", "regex"});
+    parser.addOption({"dsn", "DSN o cadena ODBC de un MariaDB local (o DM_BENCH_DSN).", "dsn"});
+    parser.addOption({"backend", "Cliente a comparar en fetch_<nombre> (repetible).", "nombre=cadena"});
+    parser.addOption({"fetch-sql", "Consulta de los casos fetch_<nombre>.", "sql", kFetchSql});
+    parser.process(app);
+
+    Bench bench(qMax(1, parser.value("repeat").toInt()), parser.value("only"));
+
+    // --- Texto SQL ---
+    const QString script = syntheticScript();
+    {
+        QTextDocument doc;
+        doc.setPlainText(script);
+        SqlHighlighter highlighter(&doc);
+        bench.run("highlight_10mb", [&](){ highlighter.rehighlight(); });
+    }
+
+    QVector<SqlStatement> statements;
+    bench.run("split_statements_10mb", [&](){ statements = SqlText::splitStatements(script); });
+    if (statements.isEmpty()) statements = SqlText::splitStatements(script);
+
+    bench.run("classify_statements", [&](){
+        int affecting = 0;
+        for (const auto& st : statements) {
+            const QString first = SqlText::firstTokenUpper(st.sql);
+            if (SqlText::isDbLevelDdl(st.sql) || SqlText::isTableLevelDdlOrDmlThatAffectsMetadata(st.sql))
+                affecting += first.size();
+        }
+        Q_UNUSED(affecting);
+    });
+    bench.run("fingerprint_statements", [&](){
+        for (const auto& st : statements) SqlText::fingerprint(st.sql);
+    });
+
+    // --- Resultados (SQLite en memoria) ---
+    {
+        QSqlDatabase lite = QSqlDatabase::addDatabase("QSQLITE", "bench_sqlite");
+        lite.setDatabaseName(":memory:");
+        if (!lite.open() || !fillSqlite(lite)) {
+            bench.skip("result_fetch_1m", "SQLite no disponible");
+        } else {
+            // Lectura + conversión a tramos, como QueryWorker
+            QStringList columns;
+            QVector<ResultChunk> chunks;
+            bench.run("result_fetch_1m", [&](){
+                chunks.clear();
+                QSqlQuery q(lite);
+                q.setForwardOnly(true);
+                exec(q, "SELECT * FROM r");
+                const QSqlRecord rec = q.record();
+                columns.clear();
+                for (int c = 0; c < rec.count(); ++c) columns << rec.fieldName(c);
+                const QVector<ColumnType> types = ResultBuffer::typesFor(rec);
+                ChunkBuilder block(types);
+                while (q.next()) {
+                    for (int c = 0; c < types.size(); ++c) block.addValue(c, q.value(c));
+                    block.endRow();
+                    if (block.rowCount() >= kRowBlock) chunks << block.take();
+                }
+                if (!block.isEmpty()) chunks << block.take();
+            });
+
+            ResultModel model;
+            bench.run("result_model_append_1m", [&](){
+                for (const auto& ch : chunks) model.appendRows(ch);
+            }, [&](){ model.reset(columns); });
+            if (model.rowCount() == 0) {
+                model.reset(columns);
+                for (const auto& ch : chunks) model.appendRows(ch);
+            }
+            model.setFetchDone(false);
+
+            QTableView view;
+            view.setModel(&model);
+            view.resize(1200, 800);
+            view.show();
+            QApplication::processEvents();
+            bench.run("result_scroll_1m", [&](){
+                QScrollBar* bar = view.verticalScrollBar();
+                for (int i = 0; i <= kScrollSteps; ++i) {
+                    bar->setValue(int(qint64(bar->maximum()) * i / kScrollSteps));
+                    view.viewport()->repaint();
+                }
+            });
+
+            QVector<int> rows;
+            ResultViewSpec sortText;
+            sortText.sortColumn = 1;
+            bench.run("result_sort_text_1m", [&](){ ResultViewBuilder::build(model.result(), sortText, &rows); });
+            ResultViewSpec sortNumber;
+            sortNumber.sortColumn = 2;
+            sortNumber.descending = true;
+            bench.run("result_sort_number_1m", [&](){ ResultViewBuilder::build(model.result(), sortNumber, &rows); });
+            ResultViewSpec filter;
+            filter.quickText = "cliente 42";
+            bench.run("result_filter_1m", [&](){ ResultViewBuilder::build(model.result(), filter, &rows); });
+
+            // Volcado a disco de todo el resultado y una pasada de filtro leyendo del mapeo
+            ResultBuffer spilled;
+            bench.run("result_spill_1m", [&](){
+                while (spilled.spillOldest(32 * 1024 * 1024, QString())) {}
+            }, [&](){ spilled = model.result(); });
+            if (spilled.diskUsage() > 0)
+                bench.run("result_filter_spilled_1m", [&](){ ResultViewBuilder::build(spilled, filter, &rows); });
+
+            // Instantánea: guardar todo y reabrir (solo mapea; el filtro lee del archivo)
+            const QString snapPath = QDir::temp().filePath("dm_bench.dmsnap");
+            bench.run("result_snapshot_save_1m", [&](){ model.result().save(snapPath, QJsonObject()); });
+            ResultBuffer reopened;
+            bench.run("result_snapshot_open_1m", [&](){ reopened.load(snapPath, nullptr); });
+            if (reopened.rowCount() > 0)
+                bench.run("result_filter_snapshot_1m", [&](){ ResultViewBuilder::build(reopened, filter, &rows); });
+            reopened = ResultBuffer();
+            QFile::remove(snapPath);
+
+            // 100 documentos de 1 MB: valor completo contra recorte + tamaño (TableDataBrowser)
+            QSqlQuery q(lite);
+            if (!exec(q, "CREATE TABLE docs AS WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL "
+                         "SELECT n + 1 FROM seq WHERE n < 100) SELECT n AS id, hex(randomblob(524288)) AS doc FROM seq")) {
+                bench.skip("result_lob_full_100x1mb", "no se pudo crear docs");
+            } else {
+                auto fetchDocs = [&](const QString& sql){
+                    QSqlQuery d(lite);
+                    d.setForwardOnly(true);
+                    exec(d, sql);
+                    const QSqlRecord rec = d.record();
+                    const int len = rec.indexOf("doc" + ResultBuffer::lengthSuffix());
+                    ChunkBuilder block({ColumnType::Int64, ColumnType::Text});
+                    while (d.next()) {
+                        block.addValue(0, d.value(0));
+                        block.addValue(1, d.value(1));
+                        if (len >= 0) block.setFullLength(1, d.value(len).toLongLong());
+                        block.endRow();
+                    }
+                    block.take();
+                };
+                bench.run("result_lob_full_100x1mb", [&](){ fetchDocs("SELECT id, doc FROM docs"); });
+                bench.run("result_lob_preview_100x1mb", [&](){
+                    fetchDocs("SELECT id, substr(doc, 1, 256) AS doc, length(doc) AS doc"
+                              + ResultBuffer::lengthSuffix() + " FROM docs");
+                });
+            }
+        }
+    }
+
+    // --- Metadatos (MariaDB) ---
+    QString dsn = parser.value("dsn");
+    if (dsn.isEmpty()) dsn = qEnvironmentVariable("DM_BENCH_DSN");
+    const bool fake = dsn.startsWith("QFAKE:", Qt::CaseInsensitive);
+    const QString benchDb = fake ? QString("fake_1") : QString(kBenchDb);   // QFAKE lista fake_1..N
+    DbSession session;
+    QString err;
+    QString why;
+    if (dsn.isEmpty()) why = "sin --dsn ni DM_BENCH_DSN";
+    else if (!session.openWithDsn(dsn, &err)) why = "no se pudo conectar: " + err;
+    else if (!fake && !prepareServerSchema(session)) why = "no se pudo crear " + benchDb;
+
+    if (!why.isEmpty()) {
+        bench.skip("ddl_general_5000", why);
+        bench.skip("tree_expand_5000", why);
+        bench.skip("schema_diff_5000", why);
+    } else {
+        // En frío: cada repetición vuelve a leer del servidor
+        MetadataService meta(&session);
+        bench.run("ddl_general_5000", [&](){ DdlExporter::databaseDdl(meta, benchDb); },
+                  [&](){ meta.invalidateAll(); });
+
+        ObjectTreeModel tree(&meta);
+        bench.run("tree_expand_5000", [&](){
+            tree.reload(false);
+            const QModelIndex db = tree.databaseIndex(benchDb);
+            tree.fetchMore(db);
+            for (int f = 0; f < tree.rowCount(db); ++f) {
+                const QModelIndex folder = tree.index(f, 0, db);
+                while (tree.canFetchMore(folder)) tree.fetchMore(folder);
+            }
+        }, [&](){ meta.invalidateAll(); });
+
+        // Los dos lados desde conexiones distintas al mismo servidor: todo igual, así se mide
+        // la lectura concurrente y el hash, que es lo que cuesta con miles de objetos
+        SchemaDiff diff(&session);
+        bench.run("schema_diff_5000", [&](){
+            QEventLoop loop;
+            QObject::connect(&diff, &SchemaDiff::finished, &loop, &QEventLoop::quit);
+            if (diff.start(benchDb, dsn, benchDb, 4, &err)) loop.exec();
+        });
+    }
+
+    // --- Lectura por cliente (ODBC / nativo) ---
+    const QString fetchSql = parser.value("fetch-sql");
+    for (const QString& spec : parser.values("backend")) {
+        const int eq = spec.indexOf('=');
+        const QString name = "fetch_" + spec.left(eq);
+        if (eq <= 0) {
+            bench.skip(spec, "se esperaba nombre=cadena");
+            continue;
+        }
+        if (!bench.wanted(name)) continue;
+
+        DbSession backend;
+        if (!backend.openWithDsn(spec.mid(eq + 1), &err)) {
+            bench.skip(name, "no se pudo conectar: " + err);
+            continue;
+        }
+        // Las mismas opciones y el mismo recorrido que QueryWorker
+        DbLease lease = backend.acquire("NO_CACHE=1;", &err);
+        if (!lease.isValid()) {
+            bench.skip(name, "no se pudo conectar: " + err);
+            continue;
+        }
+        qint64 rows = 0;
+        bool ok = true;
+        bench.run(name, [&](){
+            rows = 0;
+            QSqlQuery q(lease.db());
+            q.setForwardOnly(true);
+            if (!DbSession::execute(q, fetchSql)) {
+                QTextStream(stderr) << "Error: " << q.lastError().text() << "\n";
+                ok = false;
+                return;
+            }
+            const QVector<ColumnType> types = ResultBuffer::typesFor(q.record());
+            ChunkBuilder block(types);
+            while (q.next()) {
+                for (int c = 0; c < types.size(); ++c) block.addValue(c, q.value(c));
+                block.endRow();
+                if (block.rowCount() >= kRowBlock) block.take();
+                ++rows;
+            }
+        });
+        if (ok) bench.throughput(name, rows);
+        else bench.skip(name, "la consulta falló");
+    }
+
+    QJsonObject out;
+    out["format"] = 1;
+    out["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    out["host"] = QSysInfo::machineHostName();
+    out["cpu"] = QSysInfo::currentCpuArchitecture();
+    out["threads"] = QThread::idealThreadCount();
+    out["qt"] = QString(qVersion());
+    out["results"] = bench.results;
+
+    const QString path = parser.value("out");
+    if (!path.isEmpty()) {
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            QTextStream(stderr) << "No se pudo escribir " << path << "\n";
+            return 1;
+        }
+        f.write(QJsonDocument(out).toJson());
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Compara un resultado de Database-Manager-bench con la línea base.
+
+    python3 bench/compare.py bench/baseline.json actual.json [--threshold 0.10] [--min-ms 2]
+    python3 bench/compare.py bench/baseline.json actual.json --update
+    python3 bench/compare.py bench/baseline.json --check
+
+Un caso es regresión si su mediana supera la de la línea base en más de --threshold
+(fracción) y en más de --min-ms milisegundos (para no marcar ruido en casos cortos).
+Sale con código 1 si hay alguna regresión y con 2 si algún caso medido no tiene línea
+base (--allow-missing lo tolera, salvo que la línea base esté vacía: entonces sale con 2
+siempre). Los casos omitidos (sin servidor) se listan pero no cuentan.
+
+--check solo comprueba que la línea base tenga medianas (sale con 2 si está vacía); es la
+prueba bench_baseline de ctest.
+
+--update escribe en la línea base los casos medidos de actual.json (máquina, Qt y
+medianas), conservando los que no se midieron esta vez.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def measured(results):
+    return {k: v for k, v in results.items() if "median_ms" in v}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("baseline")
+    ap.add_argument("current", nargs="?")
+    ap.add_argument("--threshold", type=float, default=0.10)
+    ap.add_argument("--min-ms", type=float, default=2.0)
+    ap.add_argument("--allow-missing", action="store_true")
+    ap.add_argument("--update", action="store_true")
+    ap.add_argument("--check", action="store_true")
+    args = ap.parse_args()
+
+    base = load(args.baseline)
+    base_results = base.get("results", {})
+    empty = not measured(base_results)
+    if args.check:
+        if empty:
+            print(f"{args.baseline}: línea base vacía; registrarla con --update en la máquina de referencia")
+            return 2
+        print(f"{args.baseline}: {len(measured(base_results))} casos")
+        return 0
+    if args.current is None:
+        ap.error("falta el resultado actual (o --check)")
+
+    cur = load(args.current)
+    cur_results = cur.get("results", {})
+
+    if args.update:
+        out = {k: v for k, v in base.items() if k != "results"}
+        out.update({k: v for k, v in cur.items() if k != "results"})
+        merged = dict(base_results)
+        merged.update(measured(cur_results))
+        out["results"] = dict(sorted(merged.items()))
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            json.dump(out, f, indent=4, ensure_ascii=False)
+            f.write("\n")
+        print(f"{len(out['results'])} casos en {args.baseline}")
+        return 0
+
+    for field in ("host", "cpu", "threads", "qt"):
+        if field in base and base.get(field) != cur.get(field):
+            print(f"aviso: {field} distinto ({base.get(field)} -> {cur.get(field)}); "
+                  "la comparación solo vale en la misma máquina")
+
+    regressions = 0
+    missing = 0
+    print(f"{'caso':28} {'base ms':>10} {'actual ms':>10} {'cambio':>8}")
+    for name in sorted(set(base_results) | set(cur_results)):
+        b = base_results.get(name, {})
+        c = cur_results.get(name, {})
+        if "median_ms" not in c:
+            print(f"{name:28} {'':>10} {'':>10}  omitido: {c.get('skipped', 'sin dato')}")
+            continue
+        if "median_ms" not in b:
+            print(f"{name:28} {'':>10} {c['median_ms']:>10.2f}  SIN LÍNEA BASE")
+            missing += 1
+            continue
+
+        bm, cm = b["median_ms"], c["median_ms"]
+        change = (cm - bm) / bm if bm > 0 else 0.0
+        mark = ""
+        if cm > bm * (1 + args.threshold) and cm - bm > args.min_ms:
+            mark = "  REGRESIÓN"
+            regressions += 1
+        elif cm < bm * (1 - args.threshold) and bm - cm > args.min_ms:
+            mark = "  mejora"
+        print(f"{name:28} {bm:>10.2f} {cm:>10.2f} {change:>+7.1%}{mark}")
+
+    if regressions:
+        print(f"\n{regressions} regresión(es) por encima de {args.threshold:.0%}")
+        return 1
+    if empty:
+        print("\nLínea base vacía: nada que comparar; registrarla con --update en la máquina de referencia")
+        return 2
+    if missing and not args.allow_missing:
+        print(f"\n{missing} caso(s) sin línea base: registrarla con --update en la máquina de referencia")
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,218 @@
+#include "CellViewer.h"
+#include "DbSession.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QThread>
+#include <QCoreApplication>
+#include <QLabel>
+#include <QTabWidget>
+#include <QPlainTextEdit>
+#include <QScrollArea>
+#include <QPixmap>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QFontDatabase>
+#include <QLocale>
+
+// El volcado hex ocupa unas 4,5 veces el valor: de lo más grande solo se vuelca el principio.
+static const int kHexBytes = 256 * 1024;
+// Un QPlainTextEdit con decenas de MB congela la GUI al maquetar: texto y JSON se recortan.
+static const int kTextChars = 2 * 1024 * 1024;
+
+static QString sizeText(qint64 n)
+{
+    return QLocale().formattedDataSize(n, 1, QLocale::DataSizeTraditionalFormat);
+}
+
+static QByteArray bytesOf(const QVariant& v)
+{
+    return v.userType() == QMetaType::QByteArray ? v.toByteArray() : v.toString().toUtf8();
+}
+
+CellViewer::Rendered CellViewer::render(const QByteArray& bytes)
+{
+    Rendered r;
+    r.bytes = bytes.size();
+    r.textCut = bytes.size() > kTextChars;
+    r.text = QString::fromUtf8(r.textCut ? bytes.left(kTextChars) : bytes);
+
+    // Solo se intenta parsear lo que empieza como un objeto o un arreglo
+    const QByteArray head = bytes.left(64).trimmed();
+    if (head.startsWith('{') || head.startsWith('[')) {
+        QJsonParseError e;
+        const QJsonDocument doc = QJsonDocument::fromJson(bytes, &e);
+        if (e.error == QJsonParseError::NoError) {
+            r.json = QString::fromUtf8(doc.toJson(QJsonDocument::Indented));
+            r.jsonCut = r.json.size() > kTextChars;
+            if (r.jsonCut) r.json.truncate(kTextChars);
+        }
+    }
+
+    if (r.json.isEmpty()) r.image = QImage::fromData(bytes);
+
+    static const char digits[] = "0123456789abcdef";
+    const int n = int(qMin<qint64>(bytes.size(), kHexBytes));
+    r.hexCut = n < bytes.size();
+    r.hex.reserve((n / 16 + 1) * 78);
+    for (int off = 0; off < n; off += 16) {
+        QString line = QString("%1  ").arg(off, 8, 16, QChar('0'));
+        QString ascii;
+        for (int i = 0; i < 16; ++i) {
+            if (off + i < n) {
+                const uchar c = uchar(bytes.at(off + i));
+                line += QChar(digits[c >> 4]);
+                line += QChar(digits[c & 15]);
+                line += ' ';
+                ascii += (c >= 0x20 && c < 0x7f) ? QChar(c) : QChar('.');
+            } else {
+                line += "   ";
+            }
+            if (i == 7) line += ' ';
+        }
+        r.hex += line + ' ' + ascii + '\n';
+    }
+    return r;
+}
+
+CellViewer::CellViewer(const QString& column, const QVariant& value, qint64 fullLength,
+                       const DbSession* s, const QString& loadSql, QWidget* parent)
+    : QDialog(parent), full(fullLength), s(s)
+{
+    setWindowTitle(QString("Valor de \"%1\"").arg(column));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(760, 540);
+
+    status = new QLabel;
+    status->setWordWrap(true);
+
+    const QFont mono = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    auto makeEdit = [&](bool wrap){
+        auto* e = new QPlainTextEdit;
+        e->setReadOnly(true);
+        e->setFont(mono);
+        e->setLineWrapMode(wrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
+        return e;
+    };
+    text = makeEdit(true);
+    json = makeEdit(false);
+    hex = makeEdit(false);
+
+    image = new QLabel;
+    image->setAlignment(Qt::AlignCenter);
+    imageArea = new QScrollArea;
+    imageArea->setWidget(image);
+    imageArea->setWidgetResizable(true);
+
+    tabs = new QTabWidget;
+    tabs->addTab(text, "Texto");
+    tabs->addTab(json, "JSON");
+    tabs->addTab(hex, "Hex");
+    tabs->addTab(imageArea, "Imagen");
+    tabs->setEnabled(false);
+    connect(tabs, &QTabWidget::currentChanged, this, &CellViewer::fillTab);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto* l = new QVBoxLayout(this);
+    l->addWidget(status);
+    l->addWidget(tabs, 1);
+    l->addWidget(buttons);
+
+    if (value.isNull() && fullLength < 0) {
+        status->setText("NULL");
+        return;
+    }
+
+    const bool load = fullLength >= 0 && s && !loadSql.isEmpty();
+    status->setText(load ? QString("Cargando el valor completo (%1)...").arg(sizeText(fullLength))
+                         : QString("Preparando..."));
+
+    const QByteArray preview = bytesOf(value);
+    const std::shared_ptr<Run> r = run;
+    const QPointer<CellViewer> self(this);
+    auto job = [self, r, s, loadSql, load, preview](){
+        QByteArray bytes = preview;
+        QString err;
+        if (load) {
+            DbLease lease = s->acquire({}, &err);
+            if (lease.isValid()) {
+                QSqlQuery q(lease.db());
+                q.setForwardOnly(true);
+                if (q.exec("SELECT CONNECTION_ID()") && q.next())
+                    r->connId = q.value(0).toLongLong();
+                if (r->cancelled) return;
+                if (!DbSession::execute(q, loadSql)) err = q.lastError().text();
+                else if (!q.next()) err = "la fila ya no está en la tabla";
+                else bytes = bytesOf(q.value(0));
+                r->connId = -1;
+            }
+        }
+        if (r->cancelled) return;   // el visor se cerró: nadie va a mostrarlo
+        const Rendered rendered = render(bytes);
+        const bool complete = load && err.isEmpty();
+        // El visor puede cerrarse mientras tanto: self se comprueba ya en el hilo de la GUI
+        QMetaObject::invokeMethod(qApp, [self, rendered, complete, err](){
+            if (self) self->display(rendered, complete, err);
+        }, Qt::QueuedConnection);
+    };
+    if (load) {
+        s->spawn(job);   // la sesión lo espera al cerrarse; el visor no
+    } else {
+        QThread* t = QThread::create(job);
+        connect(t, &QThread::finished, t, &QObject::deleteLater);
+        t->start(QThread::LowPriority);
+    }
+}
+
+CellViewer::~CellViewer()
+{
+    // El hilo no se espera: se corta la lectura (KILL QUERY desde un hilo de trabajo de la
+    // sesión) y lo que devuelva se descarta
+    run->cancelled = true;
+    if (s) s->killQuery(run->connId);
+}
+
+void CellViewer::display(const Rendered& r, bool complete, const QString& error)
+{
+    QString msg;
+    if (complete || full < 0)
+        msg = sizeText(r.bytes);
+    else if (!error.isEmpty())
+        msg = QString("No se pudo cargar el valor completo (%1). Se muestra el principio: %2 de %3.")
+                  .arg(error, sizeText(r.bytes), sizeText(full));
+    else
+        msg = QString("Se muestra el principio: %1 de %2. El valor completo se carga desde los datos "
+                      "de una tabla con llave primaria.").arg(sizeText(r.bytes), sizeText(full));
+    if (r.textCut || r.jsonCut)
+        msg += QString(" El texto y el JSON se muestran hasta %1 caracteres.").arg(QLocale().toString(kTextChars));
+    if (r.hexCut) msg += QString(" El volcado hex solo cubre los primeros %1.").arg(sizeText(kHexBytes));
+    status->setText(msg);
+
+    shown = r;
+    if (!r.image.isNull()) image->setPixmap(QPixmap::fromImage(r.image));
+
+    tabs->setEnabled(true);
+    tabs->setTabEnabled(tabs->indexOf(json), !r.json.isEmpty());
+    tabs->setTabEnabled(tabs->indexOf(imageArea), !r.image.isNull());
+    if (!r.image.isNull()) tabs->setCurrentWidget(imageArea);
+    else if (!r.json.isEmpty()) tabs->setCurrentWidget(json);
+    else tabs->setCurrentWidget(text);
+    fillTab(tabs->currentIndex());
+}
+
+// Solo la pestaña que se abre pasa al QPlainTextEdit; el resto queda en shown hasta entonces.
+void CellViewer::fillTab(int index)
+{
+    QWidget* w = tabs->widget(index);
+    auto fill = [](QPlainTextEdit* e, QString& value){
+        if (value.isEmpty()) return;
+        e->setPlainText(value);
+        value.clear();
+    };
+    if (w == text) fill(text, shown.text);
+    else if (w == json) fill(json, shown.json);
+    else if (w == hex) fill(hex, shown.hex);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QDialog>
+#include <QVariant>
+#include <QImage>
+#include <QPointer>
+#include <atomic>
+#include <memory>
+
+class DbSession;
+class QThread;
+class QLabel;
+class QTabWidget;
+class QPlainTextEdit;
+class QScrollArea;
+
+// Visor de una celda de resultados. Si la grilla solo tiene un recorte (fullLength >= 0)
+// y se conoce cómo pedir la fila (loadSql), el valor completo se lee en otro hilo con una
+// conexión del pool; cerrar el visor antes de que llegue lo corta con KILL QUERY sin esperar
+// al hilo. Texto, JSON con sangría, volcado hex e imagen también se preparan fuera del hilo
+// de la GUI, recortados, y cada pestaña de texto se llena al abrirla.
+class CellViewer : public QDialog {
+    Q_OBJECT
+public:
+    CellViewer(const QString& column, const QVariant& value, qint64 fullLength,
+               const DbSession* s, const QString& loadSql, QWidget* parent = nullptr);
+    ~CellViewer() override;
+
+    struct Rendered {
+        QString text;
+        QString json;     // vacío si no es JSON válido
+        QString hex;
+        QImage image;     // nula si no es una imagen
+        qint64 bytes = 0;
+        bool textCut = false;
+        bool jsonCut = false;
+        bool hexCut = false;
+    };
+    static Rendered render(const QByteArray& bytes);
+
+private:
+    void display(const Rendered& r, bool complete, const QString& error);
+    void fillTab(int index);
+
+    qint64 full;
+    // Compartido con el hilo, que puede seguir vivo después de cerrar el visor
+    struct Run {
+        std::atomic<qint64> connId{-1};      // de la conexión que lee el valor, para KILL QUERY
+        std::atomic<bool> cancelled{false};
+    };
+
+    std::shared_ptr<Run> run = std::make_shared<Run>();
+    const DbSession* s;
+    Rendered shown;
+
+    QLabel* status;
+    QTabWidget* tabs;
+    QPlainTextEdit* text;
+    QPlainTextEdit* json;
+    QPlainTextEdit* hex;
+    QScrollArea* imageArea;
+    QLabel* image;
+};
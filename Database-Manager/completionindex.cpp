@@ -0,0 +1,60 @@
+#include "CompletionIndex.h"
+#include <algorithm>
+
+static const QChar kSep(0x1F);
+
+QString CompletionIndex::objectsBucket(const QString& db)
+{
+    return "obj" + QString(kSep) + db;
+}
+
+QString CompletionIndex::columnsBucket(const QString& db, const QString& table)
+{
+    return "col" + QString(kSep) + db + kSep + table;
+}
+
+void CompletionIndex::setBucket(const QString& id, QVector<Item> items)
+{
+    for (auto& it : items) it.key = it.text.toLower();
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b){ return a.key < b.key; });
+    buckets.insert(id, std::move(items));
+}
+
+void CompletionIndex::removeBuckets(const QString& prefix)
+{
+    for (auto it = buckets.begin(); it != buckets.end(); ) {
+        if (it.key().startsWith(prefix)) it = buckets.erase(it);
+        else ++it;
+    }
+}
+
+QVector<CompletionIndex::Item> CompletionIndex::complete(const QStringList& bucketIds, const QString& prefix,
+                                                         int limit, const QVector<Kind>& kinds) const
+{
+    const QString p = prefix.toLower();
+    QVector<Item> out;
+
+    for (const auto& id : bucketIds) {
+        const auto b = buckets.constFind(id);
+        if (b == buckets.constEnd()) continue;
+
+        auto it = std::lower_bound(b->cbegin(), b->cend(), p,
+                                   [](const Item& i, const QString& k){ return i.key < k; });
+        int taken = 0;
+        for (; it != b->cend() && it->key.startsWith(p) && taken < limit; ++it) {
+            if (!kinds.isEmpty() && !kinds.contains(it->kind)) continue;
+            out << *it;
+            ++taken;
+        }
+    }
+
+    std::sort(out.begin(), out.end(), [](const Item& a, const Item& b){
+        return a.kind != b.kind ? a.kind < b.kind : a.key < b.key;
+    });
+    // El mismo nombre desde dos tramos (p. ej. columna id en dos tablas): una vez
+    out.erase(std::unique(out.begin(), out.end(), [](const Item& a, const Item& b){
+        return a.kind == b.kind && a.text == b.text;
+    }), out.end());
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// Nombres para autocompletar, en tramos independientes ordenados por nombre en minúsculas:
+// las bases, los objetos de cada base, las columnas de cada tabla y las palabras clave.
+// Cuando cambian los metadatos de algo se reemplaza solo su tramo; la búsqueda por
+// prefijo es una bisección en cada tramo consultado.
+class CompletionIndex {
+public:
+    enum Kind { Column, Table, View, Database, Function, Procedure, Keyword };
+
+    struct Item {
+        QString key;      // text en minúsculas
+        QString text;
+        Kind kind = Keyword;
+        QString detail;   // p. ej. "columna de ventas.cliente"
+    };
+
+    static QString databasesBucket() { return "dbs"; }
+    static QString keywordsBucket() { return "kw"; }
+    static QString objectsBucket(const QString& db);
+    static QString columnsBucket(const QString& db, const QString& table);
+
+    void setBucket(const QString& id, QVector<Item> items);
+    bool hasBucket(const QString& id) const { return buckets.contains(id); }
+    void removeBucket(const QString& id) { buckets.remove(id); }
+    void removeBuckets(const QString& prefix);
+    void clear() { buckets.clear(); }
+
+    // Hasta limit elementos de esos tramos que empiezan por prefix (sin distinguir
+    // mayúsculas), ordenados por tipo (columnas primero) y nombre. kinds vacío = todos.
+    QVector<Item> complete(const QStringList& bucketIds, const QString& prefix, int limit,
+                           const QVector<Kind>& kinds = {}) const;
+
+private:
+    QHash<QString, QVector<Item>> buckets;
+};
@@ -0,0 +1,106 @@
+#include "DataComparePanel.h"
+#include "DbSession.h"
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSettings>
+#include <QLocale>
+
+DataComparePanel::DataComparePanel(const DbSession* source, QWidget* parent)
+    : QWidget(parent)
+{
+    comparer = new DataComparer(source, this);
+
+    title = new QLabel;
+    status = new QLabel;
+    status->setWordWrap(true);
+    btnCancel = new QPushButton("Cancelar");
+    btnCancel->setEnabled(false);
+
+    diffs = new QTableWidget(0, 0);
+    diffs->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    diffs->setSelectionBehavior(QAbstractItemView::SelectRows);
+    diffs->verticalHeader()->setVisible(false);
+
+    auto* top = new QHBoxLayout;
+    top->addWidget(title, 1);
+    top->addWidget(btnCancel);
+
+    auto* l = new QVBoxLayout(this);
+    l->addLayout(top);
+    l->addWidget(status);
+    l->addWidget(diffs, 1);
+
+    connect(btnCancel, &QPushButton::clicked, comparer, &DataComparer::cancel);
+    connect(comparer, &DataComparer::progress, this, &DataComparePanel::showProgress);
+    connect(comparer, &DataComparer::differencesFound, this, &DataComparePanel::addDiffs);
+    connect(comparer, &DataComparer::finished, this, [this](bool ok, const QString& message){
+        btnCancel->setEnabled(false);
+        status->setText(status->text() + "\n" + message);
+        emit finished(ok, message);
+    });
+}
+
+DataComparePanel::~DataComparePanel()
+{
+    // Al cerrar la pestaña el comparador se cancela; su finished ya no llega aquí
+    comparer->disconnect(this);
+    delete comparer;
+}
+
+bool DataComparePanel::start(const QString& targetConnStr, const QString& targetName,
+                             const QString& sourceDb, const QString& targetDb, const QString& table,
+                             const QStringList& keyColumns, const QStringList& columns, QString* err)
+{
+    db = sourceDb;
+    tbl = table;
+    title->setText(QString("%1.%2  ↔  %3: %4.%2").arg(sourceDb, table, targetName, targetDb));
+
+    QStringList headers = keyColumns;
+    headers << "Diferencia";
+    diffs->setColumnCount(headers.size());
+    diffs->setHorizontalHeaderLabels(headers);
+    diffs->setRowCount(0);
+    diffs->horizontalHeader()->setStretchLastSection(true);
+
+    QSettings st("UNITEC", "Database-Manager");
+    DataComparer::Options o;
+    o.chunkRows = st.value("compare/chunkRows", o.chunkRows).toInt();
+    o.fanout = st.value("compare/fanout", o.fanout).toInt();
+    o.leafRows = st.value("compare/leafRows", o.leafRows).toInt();
+    o.workers = st.value("compare/workers", o.workers).toInt();
+
+    if (!comparer->start(targetConnStr, sourceDb, targetDb, table, keyColumns, columns, o, err))
+        return false;
+    btnCancel->setEnabled(true);
+    return true;
+}
+
+void DataComparePanel::showProgress(const DataComparer::Progress& p)
+{
+    status->setText(QString("Rangos: %1%2 · filas iguales: %3 · subdivisiones: %4 · diferencias: %5 · "
+                            "consultas: %6 · recibido: %7")
+                        .arg(p.chunks).arg(p.walkDone ? "" : "…")
+                        .arg(p.rowsEqual).arg(p.rangesSplit).arg(p.diffs).arg(p.queries)
+                        .arg(QLocale().formattedDataSize(p.bytes, 1, QLocale::DataSizeTraditionalFormat)));
+}
+
+void DataComparePanel::addDiffs(const QVector<DataComparer::RowDiff>& rows)
+{
+    static const char* const kinds[] = { "Solo en origen", "Solo en destino", "Contenido distinto" };
+    const int keyCount = diffs->columnCount() - 1;
+
+    diffs->setUpdatesEnabled(false);
+    int r = diffs->rowCount();
+    diffs->setRowCount(r + rows.size());
+    for (const auto& d : rows) {
+        for (int c = 0; c < keyCount && c < d.key.size(); ++c)
+            diffs->setItem(r, c, new QTableWidgetItem(d.key[c].toString()));
+        diffs->setItem(r, keyCount, new QTableWidgetItem(kinds[d.kind]));
+        ++r;
+    }
+    diffs->setUpdatesEnabled(true);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QWidget>
+#include "DataComparer.h"
+
+class DbSession;
+class QTableWidget;
+class QLabel;
+class QPushButton;
+
+// Pestaña "Comparar datos": lanza un DataComparer y va listando las llaves de las filas
+// distintas (solo en origen, solo en destino o con otro contenido) a medida que aparecen.
+class DataComparePanel : public QWidget {
+    Q_OBJECT
+public:
+    DataComparePanel(const DbSession* source, QWidget* parent = nullptr);
+    ~DataComparePanel() override;
+
+    bool start(const QString& targetConnStr, const QString& targetName,
+               const QString& db, const QString& targetDb, const QString& table,
+               const QStringList& keyColumns, const QStringList& columns, QString* err);
+
+    QString database() const { return db; }
+    QString table() const { return tbl; }
+
+signals:
+    void finished(bool ok, const QString& message);
+
+private:
+    void showProgress(const DataComparer::Progress& p);
+    void addDiffs(const QVector<DataComparer::RowDiff>& rows);
+
+    DataComparer* comparer;
+    QString db;
+    QString tbl;
+
+    QLabel* title;
+    QLabel* status;
+    QTableWidget* diffs;
+    QPushButton* btnCancel;
+};
@@ -0,0 +1,443 @@
+#include "DataComparer.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSet>
+
+DataComparer::DataComparer(const DbSession* source, QObject* parent)
+    : QObject(parent), source(source)
+{
+}
+
+DataComparer::~DataComparer()
+{
+    if (running) stop(false, "Comparación cancelada.");
+}
+
+bool DataComparer::start(const QString& targetConnStr, const QString& db, const QString& targetDb,
+                         const QString& table, const QStringList& keyColumns, const QStringList& columns,
+                         const Options& options, QString* err)
+{
+    if (running) {
+        if (err) *err = "Ya hay una comparación en curso.";
+        return false;
+    }
+    if (keyColumns.isEmpty()) {
+        if (err) *err = "La tabla no tiene llave primaria ni índice único: no se puede partir por rangos.";
+        return false;
+    }
+    if (columns.isEmpty()) {
+        if (err) *err = "No se pudieron leer las columnas de " + table + ".";
+        return false;
+    }
+
+    target.reset(new DbSession);
+    QString openErr;
+    if (!target->openWithDsn(targetConnStr, &openErr)) {
+        target.reset();
+        if (err) *err = "No se pudo conectar al destino:\n" + openErr;
+        return false;
+    }
+
+    // Mismo conjunto de columnas en los dos lados; el orden puede variar (se usa el del origen)
+    MetadataService targetMeta(target->db().connectionName());
+    const QStringList targetCols = targetMeta.listColumns(targetDb, table);
+    if (QSet<QString>(targetCols.begin(), targetCols.end()) != QSet<QString>(columns.begin(), columns.end())) {
+        target.reset();
+        if (err) {
+            *err = targetCols.isEmpty()
+                ? QString("No existe %1.%2 en el destino.").arg(targetDb, table)
+                : QString("Las columnas de %1.%2 no coinciden en los dos servidores.").arg(targetDb, table);
+        }
+        return false;
+    }
+
+    dbs[Source] = db;
+    dbs[Target] = targetDb;
+    tbl = table;
+    keys = keyColumns;
+    cols = columns;
+    opt = options;
+    opt.chunkRows = qMax(opt.chunkRows, 2);
+    opt.fanout = qMax(opt.fanout, 2);
+    opt.leafRows = qMax(opt.leafRows, opt.fanout);
+
+    tasks.clear();
+    nextTask = 0;
+    walking = false;
+    walkFrom.clear();
+    stats = Progress();
+    cancelled = false;
+    running = true;
+
+    for (int side = 0; side < 2; ++side) {
+        QMutexLocker lock(&queues[side].mutex);
+        queues[side].queries.clear();
+        queues[side].closed = false;
+    }
+
+    // Más hilos que conexiones en el pool solo añadirían esperas
+    const int perSide[2] = { qBound(1, opt.workers, source->poolStats().maxSize),
+                             qBound(1, opt.workers, target->poolStats().maxSize) };
+    for (int side = 0; side < 2; ++side) {
+        aliveWorkers[side] = perSide[side];
+        for (int k = 0; k < perSide[side]; ++k) {
+            const Side s = Side(side);
+            QThread* t = QThread::create([this, s](){ workerLoop(s); });
+            threads << t;
+            t->start();
+        }
+    }
+
+    emit progress(stats);
+    walkNext();
+    return true;
+}
+
+void DataComparer::cancel()
+{
+    if (running) stop(false, "Comparación cancelada.");
+}
+
+// --- Hilos ---
+
+bool DataComparer::takeQuery(Side side, Query* q)
+{
+    Queue& queue = queues[side];
+    QMutexLocker lock(&queue.mutex);
+    while (queue.queries.isEmpty() && !queue.closed && !cancelled) queue.wake.wait(&queue.mutex);
+    if (cancelled || queue.queries.isEmpty()) return false;
+    *q = queue.queries.dequeue();
+    return true;
+}
+
+void DataComparer::workerLoop(Side side)
+{
+    QString err;
+    DbLease lease = (side == Source ? source : target.get())->acquire({}, &err);
+    if (!lease.isValid()) {
+        QMetaObject::invokeMethod(this, [this, side, err](){ onWorkerFailed(side, err); }, Qt::QueuedConnection);
+        return;
+    }
+
+    Query job;
+    while (takeQuery(side, &job)) {
+        QSqlQuery q(lease.db());
+        q.setForwardOnly(true);
+        QVector<QVector<QVariant>> rows;
+        const bool ok = DbSession::execute(q, job.sql);
+        if (ok) {
+            const int n = q.record().count();
+            while (q.next()) {
+                QVector<QVariant> row(n);
+                for (int c = 0; c < n; ++c) row[c] = q.value(c);
+                rows << row;
+            }
+        }
+        const QString error = ok ? QString() : q.lastError().text();
+        const int task = job.task;
+        QMetaObject::invokeMethod(this, [this, task, side, ok, rows, error](){
+            onResult(task, side, ok, rows, error);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void DataComparer::send(Side side, int task, const QString& sql)
+{
+    Queue& queue = queues[side];
+    {
+        QMutexLocker lock(&queue.mutex);
+        queue.queries.enqueue({task, sql});
+    }
+    queue.wake.wakeOne();
+    ++stats.queries;
+}
+
+void DataComparer::onWorkerFailed(Side side, const QString& error)
+{
+    if (!running) return;
+    // Con al menos una conexión viva en cada lado se sigue, más lento
+    if (--aliveWorkers[side] <= 0) stop(false, error);
+}
+
+// --- SQL ---
+
+QString DataComparer::tableRef(Side side) const
+{
+    return DbSession::q(dbs[side]) + "." + DbSession::q(tbl);
+}
+
+QString DataComparer::keyList() const
+{
+    QStringList l;
+    for (const auto& k : keys) l << DbSession::q(k);
+    return l.join(", ");
+}
+
+QString DataComparer::rowHash() const
+{
+    // CONCAT_WS omite los NULL: el mapa de ISNULL distingue ('a', NULL) de (NULL, 'a')
+    QStringList values, nulls;
+    for (const auto& c : cols) {
+        values << DbSession::q(c);
+        nulls << "ISNULL(" + DbSession::q(c) + ")";
+    }
+    return QString("CRC32(CONCAT_WS('#', %1, CONCAT(%2)))").arg(values.join(", "), nulls.join(", "));
+}
+
+QString DataComparer::rangeWhere(const Range& r) const
+{
+    // (a,b) > (x,y) se expande a a > x OR (a = x AND b > y), como en TableDataBrowser
+    auto bound = [this](const Key& k, bool lower){
+        QStringList ors;
+        for (int i = 0; i < k.size() && i < keys.size(); ++i) {
+            QStringList ands;
+            for (int j = 0; j < i; ++j)
+                ands << QString("%1 = %2").arg(DbSession::q(keys[j]), DbSession::literal(k[j]));
+            const bool last = (i == k.size() - 1);
+            const QString op = lower ? ">" : (last ? "<=" : "<");
+            ands << QString("%1 %2 %3").arg(DbSession::q(keys[i]), op, DbSession::literal(k[i]));
+            ors << "(" + ands.join(" AND ") + ")";
+        }
+        return "(" + ors.join(" OR ") + ")";
+    };
+
+    QStringList parts;
+    if (!r.lo.isEmpty()) parts << bound(r.lo, true);
+    if (!r.hi.isEmpty()) parts << bound(r.hi, false);
+    return parts.isEmpty() ? QString() : " WHERE " + parts.join(" AND ");
+}
+
+QString DataComparer::keyLiteral(const Key& k) const
+{
+    QStringList l;
+    for (const auto& v : k) l << DbSession::literal(v);
+    return l.join(", ");
+}
+
+// --- Coordinación (hilo GUI) ---
+
+void DataComparer::walkNext()
+{
+    // Se avanza por el índice del origen sin adelantarse demasiado a las sumas pendientes
+    if (!running || walking || stats.walkDone || tasks.size() >= opt.workers * 4) return;
+    walking = true;
+
+    Task t;
+    t.kind = Walk;
+    t.waiting = 1;
+    const int id = ++nextTask;
+    tasks.insert(id, t);
+
+    Range from;
+    from.lo = walkFrom;
+    // Un solo arg(): los literales de las llaves pueden contener "%1"
+    send(Source, id, QString("SELECT %1 FROM %2%3 ORDER BY %1 LIMIT 1 OFFSET %4")
+                         .arg(keyList(), tableRef(Source), rangeWhere(from),
+                              QString::number(opt.chunkRows - 1)));
+}
+
+void DataComparer::addRange(TaskKind kind, const Range& range)
+{
+    Task t;
+    t.kind = kind;
+    t.range = range;
+    t.waiting = 2;
+    const int id = ++nextTask;
+    tasks.insert(id, t);
+
+    for (int side = 0; side < 2; ++side) {
+        const Side s = Side(side);
+        if (kind == Checksum) {
+            send(s, id, QString("SELECT COUNT(*), COALESCE(BIT_XOR(%1), 0) FROM %2%3")
+                            .arg(rowHash(), tableRef(s), rangeWhere(range)));
+        } else {
+            send(s, id, QString("SELECT %1, %2 FROM %3%4 ORDER BY %1")
+                            .arg(keyList(), rowHash(), tableRef(s), rangeWhere(range)));
+        }
+    }
+}
+
+void DataComparer::onResult(int id, Side side, bool ok, const QVector<QVector<QVariant>>& rows,
+                            const QString& error)
+{
+    if (!running) return;
+    auto it = tasks.find(id);
+    if (it == tasks.end()) return;
+
+    if (!ok) {
+        stop(false, QString("Error en el %1: %2").arg(side == Source ? "origen" : "destino", error));
+        return;
+    }
+
+    for (const auto& row : rows) {
+        for (const auto& v : row) stats.bytes += v.toString().size() + 1;
+    }
+    Task& t = it.value();
+    t.rows[side] = rows;
+    if (--t.waiting > 0) return;
+
+    Task done = t;
+    tasks.erase(it);
+    finishTask(done);
+    if (!running) return;
+
+    emit progress(stats);
+    walkNext();
+    maybeDone();
+}
+
+void DataComparer::finishTask(Task& t)
+{
+    if (t.kind == Walk) {
+        walking = false;
+        Range r;
+        r.lo = walkFrom;
+        ++stats.chunks;
+        if (t.rows[Source].isEmpty()) {
+            // Último rango: sin límite superior, recoge lo que el destino tenga de más al final
+            stats.walkDone = true;
+            addRange(Checksum, r);
+        } else {
+            r.hi = t.rows[Source].first();
+            walkFrom = r.hi;
+            addRange(Checksum, r);
+        }
+        return;
+    }
+
+    if (t.kind == Checksum) {
+        for (int side = 0; side < 2; ++side) {
+            const auto& rows = t.rows[side];
+            t.count[side] = rows.isEmpty() ? 0 : rows.first().value(0).toLongLong();
+        }
+        const QString h0 = t.rows[Source].isEmpty() ? QString() : t.rows[Source].first().value(1).toString();
+        const QString h1 = t.rows[Target].isEmpty() ? QString() : t.rows[Target].first().value(1).toString();
+        if (t.count[Source] == t.count[Target] && h0 == h1) {
+            stats.rowsEqual += t.count[Source];
+            return;
+        }
+
+        const qint64 most = qMax(t.count[Source], t.count[Target]);
+        if (most <= opt.leafRows) {
+            addRange(Rows, t.range);
+            return;
+        }
+
+        // Límites de los subrangos desde el lado con más filas: ahí no falta ninguna
+        const Side side = t.count[Source] >= t.count[Target] ? Source : Target;
+        const qint64 step = (most + opt.fanout - 1) / opt.fanout;
+        Task split;
+        split.kind = Split;
+        split.range = t.range;
+        split.waiting = 1;
+        const int sid = ++nextTask;
+        tasks.insert(sid, split);
+        ++stats.rangesSplit;
+        send(side, sid, QString("SELECT %1 FROM (SELECT %1, ROW_NUMBER() OVER (ORDER BY %1) AS dm_rn "
+                                "FROM %2%3) AS dm_x WHERE dm_rn % %4 = 0 ORDER BY %1")
+                            .arg(keyList(), tableRef(side), rangeWhere(t.range), QString::number(step)));
+        return;
+    }
+
+    if (t.kind == Split) {
+        const auto& bounds = t.rows[Source].isEmpty() ? t.rows[Target] : t.rows[Source];
+        if (bounds.isEmpty()) {
+            // Los datos cambiaron entre medias: se comparan las filas tal cual
+            addRange(Rows, t.range);
+            return;
+        }
+        Key lo = t.range.lo;
+        for (const auto& b : bounds) {
+            addRange(Checksum, {lo, b});
+            lo = b;
+        }
+        addRange(Checksum, {lo, t.range.hi});
+        return;
+    }
+
+    compareRows(t);
+}
+
+void DataComparer::compareRows(const Task& t)
+{
+    const int nk = keys.size();
+    auto keyOf = [nk](const QVector<QVariant>& row){ return row.mid(0, nk); };
+
+    // Llave -> CRC32 de la fila en el destino; lo que quede al final solo está en el destino
+    QHash<QString, QString> targetHash;
+    QStringList targetOrder;
+    for (const auto& row : t.rows[Target]) {
+        const QString k = keyLiteral(keyOf(row));
+        targetHash.insert(k, row.value(nk).toString());
+        targetOrder << k;
+    }
+
+    QVector<RowDiff> diffs;
+    auto add = [&](const Key& k, DiffKind kind){
+        ++stats.diffs;
+        if (stats.diffs <= opt.maxDiffs) diffs.push_back({k, kind});
+    };
+
+    for (const auto& row : t.rows[Source]) {
+        const Key k = keyOf(row);
+        const QString lit = keyLiteral(k);
+        const auto it = targetHash.find(lit);
+        if (it == targetHash.end()) {
+            add(k, OnlySource);
+            continue;
+        }
+        if (it.value() != row.value(nk).toString()) add(k, Changed);
+        else ++stats.rowsEqual;
+        targetHash.erase(it);
+    }
+    for (int i = 0; i < t.rows[Target].size(); ++i) {
+        if (targetHash.contains(targetOrder[i])) add(keyOf(t.rows[Target][i]), OnlyTarget);
+    }
+
+    if (!diffs.isEmpty()) emit differencesFound(diffs);
+}
+
+void DataComparer::maybeDone()
+{
+    if (!running || !stats.walkDone || !tasks.isEmpty()) return;
+
+    QString message;
+    if (stats.diffs == 0) {
+        message = QString("%1.%2: sin diferencias (%3 filas, %4 KB recibidos).")
+                      .arg(dbs[Source], tbl).arg(stats.rowsEqual).arg((stats.bytes + 1023) / 1024);
+    } else {
+        message = QString("%1.%2: %3 filas distintas (%4 KB recibidos).")
+                      .arg(dbs[Source], tbl).arg(stats.diffs).arg((stats.bytes + 1023) / 1024);
+    }
+    stop(true, message);
+}
+
+void DataComparer::stop(bool ok, const QString& message)
+{
+    if (!ok) cancelled = true;
+    for (int side = 0; side < 2; ++side) {
+        {
+            QMutexLocker lock(&queues[side].mutex);
+            queues[side].closed = true;
+            queues[side].queries.clear();
+        }
+        queues[side].wake.wakeAll();
+    }
+
+    for (QThread* t : threads) {
+        t->wait();
+        delete t;
+    }
+    threads.clear();
+
+    tasks.clear();
+    target.reset();
+    running = false;
+    emit progress(stats);
+    emit finished(ok, message);
+}
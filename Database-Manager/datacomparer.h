@@ -0,0 +1,142 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+class DbSession;
+class QThread;
+
+// Compara los datos de una tabla entre dos conexiones sin traerlos al cliente.
+// La tabla se parte por rangos de la llave primaria (lo, hi] de chunkRows filas, recorriendo
+// el índice del origen. De cada rango se pide a los dos servidores a la vez
+// COUNT(*) y BIT_XOR(CRC32(CONCAT_WS(...))) de sus filas. Solo los rangos distintos se
+// subdividen (fanout partes, con límites tomados del lado con más filas) hasta tener
+// leafRows filas o menos. Entonces se piden llave y CRC32 de cada fila, también en los dos
+// lados. Cada lado tiene sus propios hilos y conexiones (una por hilo).
+class DataComparer : public QObject {
+    Q_OBJECT
+public:
+    using Key = QVector<QVariant>;
+
+    enum DiffKind { OnlySource, OnlyTarget, Changed };
+    struct RowDiff {
+        Key key;
+        DiffKind kind = Changed;
+    };
+
+    struct Options {
+        int chunkRows = 10000;
+        int fanout = 16;
+        int leafRows = 256;
+        int workers = 4;        // hilos por lado
+        int maxDiffs = 10000;   // a partir de aquí se cuentan pero no se listan
+    };
+
+    struct Progress {
+        qint64 chunks = 0;        // rangos de primer nivel
+        qint64 rowsEqual = 0;     // filas (del origen) en rangos iguales
+        qint64 rangesSplit = 0;
+        qint64 diffs = 0;
+        qint64 queries = 0;
+        qint64 bytes = 0;         // tamaño aproximado de lo recibido
+        bool walkDone = false;
+    };
+
+    // source es la sesión ya abierta de la ventana; target se abre aquí con otra cadena.
+    explicit DataComparer(const DbSession* source, QObject* parent = nullptr);
+    ~DataComparer() override;
+
+    // Abre el destino (bloquea hasta conectar), comprueba que las columnas coinciden y
+    // empieza. keyColumns y columns son los del origen (MetadataService).
+    bool start(const QString& targetConnStr, const QString& db, const QString& targetDb,
+               const QString& table, const QStringList& keyColumns, const QStringList& columns,
+               const Options& options, QString* err = nullptr);
+    void cancel();
+    bool isRunning() const { return running; }
+
+    QStringList keyColumns() const { return keys; }
+    Progress currentProgress() const { return stats; }
+
+signals:
+    void progress(const DataComparer::Progress& p);
+    void differencesFound(const QVector<DataComparer::RowDiff>& rows);
+    void finished(bool ok, const QString& message);
+
+private:
+    enum Side { Source = 0, Target = 1 };
+    enum TaskKind { Walk, Checksum, Split, Rows };
+
+    struct Range {
+        Key lo;   // exclusivo; vacío = sin límite
+        Key hi;   // inclusivo; vacío = sin límite
+    };
+
+    struct Task {
+        TaskKind kind = Checksum;
+        Range range;
+        int waiting = 0;                         // lados que faltan por responder
+        QVector<QVector<QVariant>> rows[2];
+        qint64 count[2] = {0, 0};
+    };
+
+    struct Query {
+        int task = 0;
+        QString sql;
+    };
+
+    struct Queue {
+        QMutex mutex;
+        QWaitCondition wake;
+        QQueue<Query> queries;
+        bool closed = false;
+    };
+
+    void workerLoop(Side side);
+    bool takeQuery(Side side, Query* q);
+    void send(Side side, int task, const QString& sql);
+
+    void onResult(int task, Side side, bool ok, const QVector<QVector<QVariant>>& rows,
+                  const QString& error);
+    void onWorkerFailed(Side side, const QString& error);
+    void walkNext();
+    void addRange(TaskKind kind, const Range& range);
+    void finishTask(Task& t);
+    void compareRows(const Task& t);
+    void maybeDone();
+    void stop(bool ok, const QString& message);
+
+    QString tableRef(Side side) const;
+    QString keyList() const;
+    QString rowHash() const;
+    QString rangeWhere(const Range& r) const;
+    QString keyLiteral(const Key& k) const;
+
+    const DbSession* source;
+    std::unique_ptr<DbSession> target;
+    bool running = false;
+
+    QString dbs[2];
+    QString tbl;
+    QStringList keys;
+    QStringList cols;
+    Options opt;
+
+    Queue queues[2];
+    std::atomic<bool> cancelled{false};
+    QVector<QThread*> threads;
+    int aliveWorkers[2] = {0, 0};
+
+    // Coordinación (hilo GUI)
+    QHash<int, Task> tasks;
+    int nextTask = 0;
+    bool walking = false;
+    Key walkFrom;
+    Progress stats;
+};
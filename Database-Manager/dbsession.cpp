@@ -1,6 +1,43 @@
 #include "DbSession.h"
+#ifdef DM_HAVE_FAKE
+#include "FakeSqlDriver.h"
+#endif
+#ifdef DM_HAVE_MARIADB
+#include "MariaDbDriver.h"
+#endif
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlDatabase>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <QThread>
+#include <QThreadPool>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlDriver>
+#include <QUrl>
+#include <cstring>
+#include <atomic>
+
+// Solo en el bench, las pruebas o con DM_WITH_FAKE: en la aplicación normal "QFAKE:..." no
+// es un servidor simulado sino un DSN más (y falla como tal).
+static bool isFake(const QString& s)
+{
+#ifdef DM_HAVE_FAKE
+    return s.startsWith(FakeSqlDriver::prefix, Qt::CaseInsensitive);
+#else
+    Q_UNUSED(s);
+    return false;
+#endif
+}
+
+static const char* const nativePrefix = "QMARIADB:";
+
+static bool isNative(const QString& s)
+{
+    return s.startsWith(nativePrefix, Qt::CaseInsensitive);
+}
 
 static bool looksLikeConnString(const QString& s)
 {
@@ -9,20 +46,175 @@ static bool looksLikeConnString(const QString& s)
            u.contains("PWD=") || u.contains("DATABASE=") || u.contains("PORT=");
 }
 
+static qint64 nowMs()
+{
+    static const QElapsedTimer clock = [](){ QElapsedTimer t; t.start(); return t; }();
+    return clock.elapsed();
+}
+
+DbLease& DbLease::operator=(DbLease&& o) noexcept
+{
+    if (this != &o) {
+        release();
+        pool = o.pool;
+        name = o.name;
+        o.pool = nullptr;
+        o.name.clear();
+    }
+    return *this;
+}
+
+QSqlDatabase DbLease::db() const
+{
+    return pool ? QSqlDatabase::database(name, false) : QSqlDatabase();
+}
+
+void DbLease::release()
+{
+    if (!pool) return;
+    pool->release(name);
+    pool = nullptr;
+    name.clear();
+}
+
+DbSession::DbSession()
+{
+    // Nombres de conexión únicos en QSqlDatabase aunque convivan varias sesiones
+    static std::atomic<int> instances{0};
+    const int n = instances++;
+    conn = n == 0 ? QString("odbc_conn") : QString("odbc_conn_%1").arg(n);
+    poolPrefix = n == 0 ? QString("pool_") : QString("pool%1_").arg(n);
+
+    QSettings st("UNITEC", "Database-Manager");
+    maxSize = qMax(1, st.value("pool/maxSize", 8).toInt());
+    idleTimeoutMs = qint64(st.value("pool/idleTimeoutSec", 300).toInt()) * 1000;
+    healthCheckIdleMs = qint64(st.value("pool/healthCheckSec", 30).toInt()) * 1000;
+
+    workers = new QThreadPool;
+    workers->setMaxThreadCount(qBound(2, st.value("pool/workers", 3).toInt(), 8));
+    workers->setExpiryTimeout(-1);
+}
+
+DbSession::~DbSession()
+{
+    // Al terminar, cada hilo de trabajo cierra sus conexiones (dropThread). Los KILL en cola
+    // salen antes de esperar a los trabajos largos.
+    delete workers;
+    for (const auto& t : spawned) {
+        if (!t) continue;
+        t->wait();
+        delete t.data();
+    }
+    // Para entonces los hilos que pidieron conexiones ya terminaron (dropThread las cerró)
+    closePool();
+    {
+        QMutexLocker lock(&mutex);
+        for (const auto& c : watched) QObject::disconnect(c);
+        watched.clear();
+    }
+    closeConnection(conn);
+}
+
+bool DbSession::nativeAvailable()
+{
+#ifdef DM_HAVE_MARIADB
+    return true;
+#else
+    return QSqlDatabase::isDriverAvailable("QMYSQL");
+#endif
+}
+
+QString DbSession::nativeConnString(const QString& host, int port, const QString& user,
+                                    const QString& password, const QString& database,
+                                    bool compress)
+{
+    // Los valores van codificados: una contraseña puede llevar ';' o '='
+    auto enc = [](const QString& v) { return QString::fromLatin1(QUrl::toPercentEncoding(v)); };
+    QString cs = QString(nativePrefix) + "host=" + enc(host) + ";port=" + QString::number(port) +
+                 ";user=" + enc(user) + ";password=" + enc(password) + ";";
+    if (!database.isEmpty()) cs += "database=" + enc(database) + ";";
+    if (compress) cs += "compress=1;";
+    return cs;
+}
+
+QHash<QString, QString> DbSession::nativeOptions(const QString& connStr)
+{
+    QHash<QString, QString> o;
+    if (!isNative(connStr)) return o;
+    const QStringList parts = connStr.mid(int(strlen(nativePrefix))).split(';', Qt::SkipEmptyParts);
+    for (const QString& p : parts) {
+        const int eq = p.indexOf('=');
+        if (eq <= 0) continue;
+        o.insert(p.left(eq).trimmed().toLower(),
+                 QUrl::fromPercentEncoding(p.mid(eq + 1).toLatin1()));
+    }
+    return o;
+}
+
+bool DbSession::execute(QSqlQuery& q, const QString& sql)
+{
+    // Protocolo de texto en todos los drivers: una sola ida y vuelta. Preparar (protocolo
+    // binario de MariaDbDriver) añade la del PREPARE y solo compensa con valores enlazados,
+    // que ya pasan por q.prepare() + addBindValue() + exec().
+    return q.exec(sql);
+}
+
 bool DbSession::openWithDsn(const QString& dsnOrConnStr, QString* err)
 {
-    if (QSqlDatabase::contains(conn)) {
-        QSqlDatabase old = QSqlDatabase::database(conn);
-        if (old.isValid()) old.close();
-        QSqlDatabase::removeDatabase(conn);
+    closePool();
+#ifdef DM_HAVE_FAKE
+    if (isFake(dsnOrConnStr)) FakeSqlDriver::registerDriver();
+#endif
+#ifdef DM_HAVE_MARIADB
+    if (isNative(dsnOrConnStr)) MariaDbDriver::registerDriver();
+#endif
+
+    {
+        QMutexLocker lock(&mutex);
+        connStr = isFake(dsnOrConnStr) || isNative(dsnOrConnStr) || looksLikeConnString(dsnOrConnStr)
+                      ? dsnOrConnStr
+                      : "DSN=" + dsnOrConnStr + ";";
     }
 
-    QSqlDatabase db = QSqlDatabase::addDatabase("QODBC", conn);
+    return openConnection(conn, err, {});
+}
+
+bool DbSession::openConnection(const QString& name, QString* err,
+                               const QString& extraOptions) const
+{
+    closeConnection(name);
 
-    if (looksLikeConnString(dsnOrConnStr)) {
-        db.setDatabaseName(dsnOrConnStr);
+    QString cs;
+    {
+        QMutexLocker lock(&mutex);
+        cs = connStr;
+    }
+    QSqlDatabase db;
+    if (isFake(cs)) {
+        // Servidor simulado: las opciones extra son del conector ODBC
+        db = QSqlDatabase::addDatabase("QFAKE", name);
+        db.setDatabaseName(cs);
+    } else if (isNative(cs)) {
+        // Cliente nativo: las opciones extra son del conector ODBC y no aplican
+#ifdef DM_HAVE_MARIADB
+        db = QSqlDatabase::addDatabase("QMARIADB", name);
+        db.setDatabaseName(cs);
+#else
+        const QHash<QString, QString> o = nativeOptions(cs);
+        db = QSqlDatabase::addDatabase("QMYSQL", name);
+        db.setHostName(o.value("host"));
+        db.setPort(o.value("port", "3306").toInt());
+        db.setUserName(o.value("user"));
+        db.setPassword(o.value("password"));
+        db.setDatabaseName(o.value("database"));
+        QString opts = "MYSQL_OPT_CONNECT_TIMEOUT=15";
+        if (o.value("compress") == "1") opts += ";CLIENT_COMPRESS";
+        db.setConnectOptions(opts);
+#endif
     } else {
-        db.setDatabaseName("DSN=" + dsnOrConnStr + ";");
+        db = QSqlDatabase::addDatabase("QODBC", name);
+        if (!extraOptions.isEmpty() && !cs.trimmed().endsWith(';')) cs += ';';
+        db.setDatabaseName(cs + extraOptions);
     }
 
     if (!db.open()) {
@@ -32,6 +224,329 @@ bool DbSession::openWithDsn(const QString& dsnOrConnStr, QString* err)
     return true;
 }
 
+void DbSession::closeConnection(const QString& name)
+{
+    // Solo desde el hilo dueño de la conexión (QSqlDatabase no se comparte entre hilos)
+    if (!QSqlDatabase::contains(name)) return;
+    {
+        QSqlDatabase old = QSqlDatabase::database(name, false);
+        if (old.isValid()) old.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+}
+
+DbLease DbSession::acquire(const QString& extraOptions, QString* err, int timeoutMs) const
+{
+    QThread* self = QThread::currentThread();
+    const qint64 begin = nowMs();
+
+    QString name;
+    qint64 idleMs = -1;   // -1: conexión nueva
+    QVector<Pooled> closing;
+    {
+        QMutexLocker lock(&mutex);
+        if (connStr.isEmpty()) {
+            if (err) *err = "No hay una sesión abierta.";
+            return {};
+        }
+
+        bool waited = false;
+        for (;;) {
+            closing += takeExpired(nowMs(), self);
+            closing += takeRetired(self);
+
+            // 1) Una ociosa de este mismo hilo y con las mismas opciones
+            for (auto& p : pool) {
+                if (p.inUse || p.retired || p.dedicated || p.thread != self || p.options != extraOptions)
+                    continue;
+                p.inUse = true;
+                name = p.name;
+                idleMs = nowMs() - p.lastUsed;
+                break;
+            }
+            if (!name.isEmpty()) break;
+
+            // 2) Pool lleno: se desplaza la ociosa más antigua de otro hilo u opciones. Si es de
+            //    este hilo se cierra ya; si no, se retira y la cierra su hilo.
+            if (counted() >= maxSize) {
+                int oldest = -1;
+                for (int i = 0; i < pool.size(); ++i) {
+                    if (pool[i].inUse || pool[i].retired || pool[i].dedicated) continue;
+                    if (oldest < 0 || pool[i].lastUsed < pool[oldest].lastUsed) oldest = i;
+                }
+                if (oldest >= 0) {
+                    ++stats.evicted;
+                    if (pool[oldest].thread == self) {
+                        closing << pool[oldest];
+                        pool.remove(oldest);
+                    } else {
+                        pool[oldest].retired = true;
+                    }
+                }
+            }
+
+            // 3) Hay sitio: se abre una nueva para este hilo
+            if (counted() < maxSize) {
+                Pooled p;
+                p.name = poolPrefix + QString::number(++seq);
+                p.options = extraOptions;
+                p.thread = self;
+                p.inUse = true;
+                pool << p;
+                name = p.name;
+                watchThread(self);
+                break;
+            }
+
+            const qint64 left = timeoutMs - (nowMs() - begin);
+            if (left <= 0) break;
+            waited = true;
+            freed.wait(&mutex, (unsigned long)left);
+        }
+
+        const qint64 waitMs = nowMs() - begin;
+        if (waited) {
+            ++stats.waits;
+            stats.totalWaitMs += waitMs;
+            stats.maxWaitMs = qMax(stats.maxWaitMs, waitMs);
+        }
+        if (name.isEmpty()) {
+            if (err) *err = QString("No hay conexiones libres (máximo %1) tras esperar %2 ms.")
+                                .arg(maxSize).arg(waitMs);
+        } else {
+            ++stats.checkouts;
+        }
+    }
+
+    for (const auto& p : closing) closeConnection(p.name);
+    if (name.isEmpty()) return {};
+    return openLease(name, idleMs, extraOptions, err);
+}
+
+DbLease DbSession::acquireDedicated(const QString& extraOptions, QString* err) const
+{
+    QThread* self = QThread::currentThread();
+    QString name;
+    QVector<Pooled> closing;
+    {
+        QMutexLocker lock(&mutex);
+        if (connStr.isEmpty()) {
+            if (err) *err = "No hay una sesión abierta.";
+            return {};
+        }
+        closing = takeRetired(self);
+
+        Pooled p;
+        p.name = poolPrefix + QString::number(++seq);
+        p.options = extraOptions;
+        p.thread = self;
+        p.inUse = true;
+        p.dedicated = true;
+        pool << p;
+        name = p.name;
+        watchThread(self);
+    }
+    for (const auto& p : closing) closeConnection(p.name);
+    return openLease(name, -1, extraOptions, err);
+}
+
+void DbSession::post(std::function<void()> job, bool urgent) const
+{
+    workers->start(std::move(job), urgent ? 1 : 0);
+}
+
+void DbSession::killQuery(qint64 connectionId) const
+{
+    if (connectionId <= 0) return;
+    post([this, connectionId](){
+        // Espera corta en el pool; si está agotado, una conexión propia solo para el KILL.
+        DbLease kill = acquire({}, nullptr, 2000);
+        if (!kill.isValid()) kill = acquireDedicated();
+        if (!kill.isValid()) return;
+        QSqlQuery q(kill.db());
+        q.exec(QString("KILL QUERY %1").arg(connectionId));
+    }, true);
+}
+
+QThread* DbSession::spawn(std::function<void()> job) const
+{
+    spawned.removeAll(nullptr);
+    QThread* t = QThread::create(std::move(job));
+    spawned << t;
+    QObject::connect(t, &QThread::finished, t, &QObject::deleteLater);
+    t->start();
+    return t;
+}
+
+DbLease DbSession::openLease(const QString& name, qint64 idleMs, const QString& extraOptions,
+                             QString* err) const
+{
+    // Conexión nueva, o reutilizada que no pasa la comprobación: se (re)abre.
+    bool ok = true;
+    if (idleMs < 0 || !healthy(name, idleMs)) {
+        if (idleMs >= 0) {
+            QMutexLocker lock(&mutex);
+            ++stats.failedChecks;
+        }
+        ok = openConnection(name, err, extraOptions);
+        QMutexLocker lock(&mutex);
+        if (ok) ++stats.opened;
+    }
+
+    if (!ok) {
+        closeConnection(name);
+        QMutexLocker lock(&mutex);
+        for (int i = 0; i < pool.size(); ++i) {
+            if (pool[i].name == name) { pool.remove(i); break; }
+        }
+        freed.wakeOne();
+        return {};
+    }
+    return DbLease(this, name);
+}
+
+bool DbSession::healthy(const QString& name, qint64 idleMs) const
+{
+    QSqlDatabase db = QSqlDatabase::database(name, false);
+    if (!db.isOpen()) return false;
+    // isOpen no detecta que el servidor cortó la conexión (wait_timeout): ping si estuvo ociosa.
+    if (idleMs < healthCheckIdleMs) return true;
+    QSqlQuery q(db);
+    return q.exec("SELECT 1");
+}
+
+void DbSession::release(const QString& name) const
+{
+    // DbLease se devuelve desde el hilo que la pidió: aquí sí se puede cerrar la conexión.
+    {
+        QMutexLocker lock(&mutex);
+        for (int i = 0; i < pool.size(); ++i) {
+            auto& p = pool[i];
+            if (p.name != name) continue;
+            if (!p.dedicated && !p.retired && !orphaned(p)) {
+                p.inUse = false;
+                p.lastUsed = nowMs();
+                freed.wakeOne();
+                return;
+            }
+            pool.remove(i);
+            break;
+        }
+    }
+    // Propia, retirada, de un hilo que ya terminó o ya fuera del pool (se cerró la sesión
+    // mientras estaba prestada)
+    closeConnection(name);
+}
+
+int DbSession::counted() const
+{
+    int n = 0;
+    for (const auto& p : pool)
+        if (!p.retired && !p.dedicated) ++n;
+    return n;
+}
+
+QVector<DbSession::Pooled> DbSession::takeExpired(qint64 now, QThread* self) const
+{
+    QVector<Pooled> out;
+    for (int i = pool.size() - 1; i >= 0; --i) {
+        auto& p = pool[i];
+        if (p.inUse || p.retired || p.dedicated || now - p.lastUsed < idleTimeoutMs) continue;
+        ++stats.evicted;
+        if (p.thread == self) {
+            out << p;
+            pool.remove(i);
+        } else {
+            p.retired = true;
+        }
+    }
+    return out;
+}
+
+QVector<DbSession::Pooled> DbSession::takeRetired(QThread* self) const
+{
+    QVector<Pooled> out;
+    for (int i = pool.size() - 1; i >= 0; --i) {
+        // Las de un hilo que ya terminó las cierra cualquiera: su dueño ya no puede
+        if (!pool[i].retired || pool[i].inUse || (pool[i].thread != self && !orphaned(pool[i]))) continue;
+        out << pool[i];
+        pool.remove(i);
+    }
+    return out;
+}
+
+void DbSession::watchThread(QThread* t) const
+{
+    if (watched.contains(t)) return;
+    // Al terminar un hilo se cierran sus conexiones ociosas desde ese mismo hilo.
+    watched.insert(t, QObject::connect(t, &QThread::finished, [this, t](){ dropThread(t); }));
+}
+
+void DbSession::dropThread(QThread* t) const
+{
+    QVector<Pooled> dropped;
+    {
+        QMutexLocker lock(&mutex);
+        for (int i = pool.size() - 1; i >= 0; --i) {
+            if (pool[i].thread != t || pool[i].inUse) continue;
+            dropped << pool[i];
+            pool.remove(i);
+        }
+        QObject::disconnect(watched.take(t));
+        freed.wakeAll();
+    }
+    for (const auto& p : dropped) closeConnection(p.name);
+}
+
+void DbSession::closePool()
+{
+    // Solo se cierran aquí las ociosas de este hilo. Las prestadas se cierran al devolverlas
+    // y las ociosas de otros hilos desde su hilo (takeRetired / dropThread).
+    QVector<Pooled> idle;
+    QThread* self = QThread::currentThread();
+    {
+        QMutexLocker lock(&mutex);
+        for (int i = pool.size() - 1; i >= 0; --i) {
+            auto& p = pool[i];
+            if (!p.inUse && p.thread == self) {
+                idle << p;
+                pool.remove(i);
+            } else {
+                p.retired = true;
+            }
+        }
+        freed.wakeAll();
+    }
+    for (const auto& p : idle) closeConnection(p.name);
+}
+
+DbSession::PoolStats DbSession::poolStats() const
+{
+    QMutexLocker lock(&mutex);
+    PoolStats st = stats;
+    st.maxSize = maxSize;
+    for (const auto& p : pool) {
+        if (p.retired) ++st.retired;
+        else if (p.dedicated) ++st.dedicated;
+        else if (p.inUse) ++st.inUse;
+        else ++st.idle;
+    }
+    return st;
+}
+
+void DbSession::setMaxPoolSize(int n)
+{
+    QMutexLocker lock(&mutex);
+    maxSize = qMax(1, n);
+    freed.wakeAll();
+}
+
+void DbSession::setIdleTimeout(int sec)
+{
+    QMutexLocker lock(&mutex);
+    idleTimeoutMs = qint64(sec) * 1000;
+}
+
 QSqlDatabase DbSession::db() const
 {
     return QSqlDatabase::database(conn);
@@ -41,3 +556,32 @@ QString DbSession::q(const QString& s)
 {
     return "`" + s + "`";
 }
+
+QString DbSession::literal(const QVariant& v)
+{
+    if (v.isNull()) return "NULL";
+
+    switch (v.userType()) {
+    case QMetaType::Int: case QMetaType::UInt: case QMetaType::LongLong: case QMetaType::ULongLong:
+    case QMetaType::Short: case QMetaType::UShort: case QMetaType::Long: case QMetaType::ULong:
+        return v.toString();
+    case QMetaType::Double: case QMetaType::Float:
+        return QString::number(v.toDouble(), 'g', 17);
+    case QMetaType::Bool:
+        return v.toBool() ? "1" : "0";
+    case QMetaType::QDate:
+        return "'" + v.toDate().toString("yyyy-MM-dd") + "'";
+    case QMetaType::QDateTime:
+        return "'" + v.toDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz") + "'";
+    case QMetaType::QTime:
+        return "'" + v.toTime().toString("HH:mm:ss.zzz") + "'";
+    case QMetaType::QByteArray:
+        return "X'" + QString::fromLatin1(v.toByteArray().toHex()) + "'";
+    default: {
+        QString s = v.toString();
+        s.replace("\\", "\\\\");
+        s.replace("'", "''");
+        return "'" + s + "'";
+    }
+    }
+}
@@ -1,13 +1,155 @@
 #pragma once
+#include <QObject>
 #include <QSqlDatabase>
 #include <QString>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QPointer>
+#include <QList>
+#include <functional>
+
+class DbSession;
+class QSqlQuery;
+class QThread;
+class QThreadPool;
+
+// Préstamo de una conexión del pool. Se devuelve sola al destruirse.
+// Solo se usa en el hilo que la pidió (QSqlDatabase no se comparte entre hilos).
+class DbLease {
+public:
+    DbLease() = default;
+    ~DbLease() { release(); }
+    DbLease(DbLease&& o) noexcept : pool(o.pool), name(o.name) { o.pool = nullptr; o.name.clear(); }
+    DbLease& operator=(DbLease&& o) noexcept;
+    DbLease(const DbLease&) = delete;
+    DbLease& operator=(const DbLease&) = delete;
+
+    bool isValid() const { return pool != nullptr; }
+    QString connectionName() const { return name; }
+    QSqlDatabase db() const;
+    void release();
+
+private:
+    friend class DbSession;
+    DbLease(const DbSession* p, const QString& n) : pool(p), name(n) {}
+
+    const DbSession* pool = nullptr;
+    QString name;
+};
 
 class DbSession {
 public:
+    DbSession();
+    ~DbSession();
+    DbSession(const DbSession&) = delete;
+    DbSession& operator=(const DbSession&) = delete;
+
+    // DSN, cadena ODBC, "QMARIADB:opciones" para el cliente nativo (nativeConnString)
+    // o "QFAKE:opciones" para el servidor simulado (FakeSqlDriver, compilado con DM_HAVE_FAKE).
     bool openWithDsn(const QString& dsnOrConnStr, QString* err = nullptr);
+    // Conexión principal del hilo de la GUI.
     QSqlDatabase db() const;
     static QString q(const QString& s);
+    static QString literal(const QVariant& v);
+
+    // Cliente nativo: compilado con DM_WITH_MARIADB usa MariaDbDriver (lectura en streaming);
+    // si no, el plugin QMYSQL de Qt, que guarda el resultado entero.
+    static bool nativeAvailable();
+    static QString nativeConnString(const QString& host, int port, const QString& user,
+                                    const QString& password, const QString& database,
+                                    bool compress);
+    static QHash<QString, QString> nativeOptions(const QString& connStr);
+    // Ejecuta sql en q por el protocolo de texto (q.exec(sql)) con cualquier driver; las
+    // sentencias con valores enlazados se preparan aparte.
+    static bool execute(QSqlQuery& q, const QString& sql);
+
+    // Pide una conexión con los mismos parámetros de openWithDsn (más opciones ODBC extra)
+    // para el hilo que llama. Reutiliza una ociosa de ese hilo, abre una nueva si hay sitio
+    // o espera hasta timeoutMs a que se libere alguna. Lease inválido si no se pudo.
+    DbLease acquire(const QString& extraOptions = {}, QString* err = nullptr,
+                    int timeoutMs = 30000) const;
+    // Conexión propia del hilo que llama, fuera del tope del pool y que nadie más reutiliza:
+    // para sesiones largas (consola, pestañas de datos) cuyo estado (USE, variables, tablas
+    // temporales) no debe pasar a otros. Se cierra al devolverla.
+    DbLease acquireDedicated(const QString& extraOptions = {}, QString* err = nullptr) const;
+
+    // Trabajos cortos fuera del hilo de la GUI (cargas del autocompletado, KILL QUERY) en
+    // unos pocos hilos que no terminan: sus conexiones del pool se reutilizan de un trabajo
+    // al siguiente. Lo largo (exportar, comparar, EXPLAIN) sigue en su propio hilo. Con
+    // urgent se adelanta a lo que esté en cola.
+    void post(std::function<void()> job, bool urgent = false) const;
+    // KILL QUERY a esa conexión desde uno de esos hilos; no bloquea al que llama.
+    void killQuery(qint64 connectionId) const;
+    // Trabajo largo en su propio hilo que quien lo lanza no espera al cerrarse (sus
+    // resultados vuelven con un QPointer); la sesión sí lo espera al destruirse, para que no
+    // siga usando sus conexiones. Desde el hilo de la GUI.
+    QThread* spawn(std::function<void()> job) const;
+
+    struct PoolStats {
+        int inUse = 0;
+        int idle = 0;
+        int dedicated = 0;        // acquireDedicated, fuera del tope
+        int retired = 0;          // por cerrar desde el hilo que las abrió
+        int maxSize = 0;
+        qint64 checkouts = 0;
+        qint64 waits = 0;         // préstamos que tuvieron que esperar
+        qint64 totalWaitMs = 0;
+        qint64 maxWaitMs = 0;
+        qint64 opened = 0;
+        qint64 evicted = 0;
+        qint64 failedChecks = 0;  // conexiones caídas detectadas al prestarlas
+    };
+    PoolStats poolStats() const;
+
+    void setMaxPoolSize(int n);
+    void setIdleTimeout(int sec);
 
 private:
-    QString conn = "odbc_conn";
+    friend class DbLease;
+
+    struct Pooled {
+        QString name;
+        QString options;
+        QThread* thread = nullptr;
+        qint64 lastUsed = 0;
+        bool inUse = false;
+        bool dedicated = false;
+        // Fuera de uso pero de otro hilo: QSqlDatabase solo se cierra desde el suyo, así que
+        // se cierra en su próximo acquire/release o al terminar. No cuenta para el tope.
+        bool retired = false;
+    };
+
+    bool openConnection(const QString& name, QString* err, const QString& extraOptions) const;
+    static void closeConnection(const QString& name);   // desde el hilo dueño
+    bool healthy(const QString& name, qint64 idleMs) const;
+    void release(const QString& name) const;
+    int counted() const;                                        // con el mutex tomado
+    QVector<Pooled> takeExpired(qint64 now, QThread* self) const; // con el mutex tomado
+    QVector<Pooled> takeRetired(QThread* self) const;           // con el mutex tomado
+    // Su hilo ya terminó (dropThread corrió): nadie más la va a cerrar. Con el mutex tomado.
+    bool orphaned(const Pooled& p) const { return !watched.contains(p.thread); }
+    DbLease openLease(const QString& name, qint64 idleMs, const QString& extraOptions,
+                      QString* err) const;
+    void watchThread(QThread* t) const;              // con el mutex tomado
+    void dropThread(QThread* t) const;
+    void closePool();
+
+    QString conn;        // "odbc_conn", o "odbc_conn_N" si hay otra sesión (comparar datos)
+    QString poolPrefix;
+    QString connStr;
+
+    mutable QMutex mutex;
+    mutable QWaitCondition freed;
+    mutable QVector<Pooled> pool;
+    mutable QHash<QThread*, QMetaObject::Connection> watched;
+    QThreadPool* workers;
+    mutable QList<QPointer<QThread>> spawned;
+    mutable PoolStats stats;
+    mutable int seq = 0;
+    int maxSize = 8;
+    qint64 idleTimeoutMs = 300000;
+    qint64 healthCheckIdleMs = 30000;
 };
@@ -0,0 +1,317 @@
+#include "DdlExporter.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include "SqlText.h"
+#include <QThread>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QtEndian>
+
+static quint32 crc32(const QByteArray& data)
+{
+    static const QVector<quint32> table = [](){
+        QVector<quint32> t(256);
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[int(i)] = c;
+        }
+        return t;
+    }();
+
+    quint32 c = 0xFFFFFFFFu;
+    for (const char ch : data) c = table[int((c ^ uchar(ch)) & 0xFF)] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Un miembro gzip (RFC 1952) a partir de qCompress, que devuelve
+// [tamaño BE 4 bytes][cabecera zlib 2][deflate][adler32 4].
+static QByteArray gzipMember(const QByteArray& data)
+{
+    const QByteArray z = qCompress(data, 6);
+    if (z.size() < 10) return {};
+    const QByteArray deflate = z.mid(6, z.size() - 10);
+
+    QByteArray out;
+    out.reserve(deflate.size() + 18);
+    const char header[10] = { char(0x1f), char(0x8b), 8, 0, 0, 0, 0, 0, 0, char(0xff) };
+    out.append(header, 10);
+    out.append(deflate);
+
+    uchar tail[8];
+    qToLittleEndian<quint32>(crc32(data), tail);
+    qToLittleEndian<quint32>(quint32(data.size()), tail + 4);
+    out.append(reinterpret_cast<const char*>(tail), 8);
+    return out;
+}
+
+DdlExporter::DdlExporter(const DbSession* s, QObject* parent)
+    : QObject(parent), s(s)
+{
+}
+
+DdlExporter::~DdlExporter()
+{
+    if (running) stop(false, "Exportación cancelada.");
+}
+
+QString DdlExporter::fileHeader()
+{
+    QString out;
+    out += "-- DDL General (export)\n";
+    out += "-- Generado: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n\n";
+    return out;
+}
+
+QString DdlExporter::databaseHeader(const QString& db)
+{
+    QString out;
+    out += QString("CREATE DATABASE IF NOT EXISTS %1;\n").arg(DbSession::q(db));
+    out += QString("USE %1;\n\n").arg(DbSession::q(db));
+    return out;
+}
+
+QString DdlExporter::objectSection(MetadataService& meta, const QString& db,
+                                   const QString& kind, const QString& name)
+{
+    // Rutinas y triggers requieren delimitador para ejecutarse como script
+    const QString delim = "$$";
+
+    if (kind == "table")
+        return "-- Tabla: " + name + "\n" + meta.showCreateTable(db, name) + "\n\n";
+    if (kind == "view")
+        return "-- Vista: " + name + "\n" + meta.showCreateView(db, name) + "\n\n";
+    if (kind == "function")
+        return "-- Función: " + name + "\n" + SqlText::wrapWithDelimiter(meta.showCreateFunction(db, name), delim) + "\n";
+    if (kind == "procedure")
+        return "-- Procedimiento: " + name + "\n" + SqlText::wrapWithDelimiter(meta.showCreateProcedure(db, name), delim) + "\n";
+    if (kind == "trigger")
+        return "-- Trigger: " + name + "\n" + SqlText::wrapWithDelimiter(meta.showCreateTrigger(db, name), delim) + "\n";
+    return {};
+}
+
+QString DdlExporter::databaseDdl(MetadataService& meta, const QString& db)
+{
+    QString out = fileHeader() + databaseHeader(db);
+
+    // Tablas (incluye índices dentro del CREATE TABLE), vistas, funciones, procedimientos y triggers
+    const auto o = meta.loadSchema(db);
+    for (const auto& t : o.tables)      out += objectSection(meta, db, "table", t);
+    for (const auto& v : o.views)       out += objectSection(meta, db, "view", v);
+    for (const auto& fn : o.functions)  out += objectSection(meta, db, "function", fn);
+    for (const auto& sp : o.procedures) out += objectSection(meta, db, "procedure", sp);
+    for (const auto& tr : o.triggers)   out += objectSection(meta, db, "trigger", tr);
+
+    return out;
+}
+
+bool DdlExporter::start(const QStringList& databases, const QString& path, bool useGzip,
+                        int workers, QString* err)
+{
+    if (running) {
+        if (err) *err = "Ya hay una exportación en curso.";
+        return false;
+    }
+    if (databases.isEmpty()) {
+        if (err) *err = "No hay bases para exportar.";
+        return false;
+    }
+
+    gzip = useGzip;
+    file.setFileName(path);
+    const QIODevice::OpenMode mode = gzip ? QIODevice::WriteOnly : (QIODevice::WriteOnly | QIODevice::Text);
+    if (!file.open(mode)) {
+        if (err) *err = "No se pudo escribir el archivo:\n" + path;
+        return false;
+    }
+
+    dbNames = databases;
+    objCount = QVector<int>(databases.size(), -1);
+    pending.clear();
+    listed = 0;
+    nextDb = 0;
+    nextObj = -1;
+    done = 0;
+    total = 0;
+    closed = false;
+    cancelled = false;
+    running = true;
+
+    file.write(encode(fileHeader()));
+
+    // Primero se listan todas las bases; los objetos se encolan a medida que llegan los listados.
+    {
+        QMutexLocker lock(&mutex);
+        jobs.clear();
+        for (int i = 0; i < databases.size(); ++i) {
+            Job j;
+            j.db = i;
+            j.dbName = databases[i];
+            jobs.enqueue(j);
+        }
+    }
+
+    // Más hilos que conexiones en el pool solo añadirían esperas
+    const int n = qBound(1, workers, s->poolStats().maxSize);
+    aliveWorkers = n;
+    for (int k = 0; k < n; ++k) {
+        QThread* t = QThread::create([this](){ workerLoop(); });
+        threads << t;
+        t->start();
+    }
+
+    emit progress(0, 0);
+    return true;
+}
+
+void DdlExporter::cancel()
+{
+    if (running) stop(false, "Exportación cancelada.");
+}
+
+bool DdlExporter::takeJob(Job* job)
+{
+    QMutexLocker lock(&mutex);
+    while (jobs.isEmpty() && !closed && !cancelled) wake.wait(&mutex);
+    if (cancelled || jobs.isEmpty()) return false;
+    *job = jobs.dequeue();
+    return true;
+}
+
+QByteArray DdlExporter::encode(const QString& text) const
+{
+    const QByteArray utf8 = text.toUtf8();
+    return gzip ? gzipMember(utf8) : utf8;
+}
+
+void DdlExporter::workerLoop()
+{
+    QString err;
+    DbLease lease = s->acquire({}, &err);
+    if (!lease.isValid()) {
+        QMetaObject::invokeMethod(this, [this, err](){ onWorkerFailed(err); }, Qt::QueuedConnection);
+        return;
+    }
+
+    MetadataService meta(lease.connectionName());
+    Job job;
+    while (takeJob(&job)) {
+        if (job.obj < 0) {
+            const auto o = meta.loadSchema(job.dbName);
+            QStringList kinds, names;
+            auto add = [&](const QString& kind, const QStringList& list){
+                for (const auto& n : list) { kinds << kind; names << n; }
+            };
+            add("table", o.tables);
+            add("view", o.views);
+            add("function", o.functions);
+            add("procedure", o.procedures);
+            add("trigger", o.triggers);
+
+            const int db = job.db;
+            QMetaObject::invokeMethod(this, [this, db, kinds, names](){ onListed(db, kinds, names); },
+                                      Qt::QueuedConnection);
+            continue;
+        }
+
+        // La compresión también se hace aquí, fuera del hilo de la GUI.
+        const QByteArray bytes = encode(objectSection(meta, job.dbName, job.kind, job.name));
+        const int db = job.db;
+        const int obj = job.obj;
+        QMetaObject::invokeMethod(this, [this, db, obj, bytes](){ onObjectReady(db, obj, bytes); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+void DdlExporter::onListed(int db, const QStringList& kinds, const QStringList& names)
+{
+    if (!running) return;
+
+    objCount[db] = names.size();
+    pending.insert(slot(db, -1), encode(databaseHeader(dbNames[db])));
+    total += names.size();
+    ++listed;
+
+    {
+        QMutexLocker lock(&mutex);
+        for (int i = 0; i < names.size(); ++i) {
+            Job j;
+            j.db = db;
+            j.obj = i;
+            j.dbName = dbNames[db];
+            j.kind = kinds[i];
+            j.name = names[i];
+            jobs.enqueue(j);
+        }
+        if (listed == dbNames.size()) closed = true;
+    }
+    wake.wakeAll();
+
+    emit progress(done, total);
+    flush();
+}
+
+void DdlExporter::onObjectReady(int db, int obj, const QByteArray& bytes)
+{
+    if (!running) return;
+    pending.insert(slot(db, obj), bytes);
+    flush();
+}
+
+void DdlExporter::onWorkerFailed(const QString& error)
+{
+    if (!running) return;
+    // Con al menos una conexión viva se sigue; más lento, pero completo.
+    if (--aliveWorkers <= 0) stop(false, error);
+}
+
+void DdlExporter::flush()
+{
+    const int before = done;
+
+    while (nextDb < dbNames.size()) {
+        if (objCount[nextDb] < 0) break;   // aún sin listar
+
+        const auto it = pending.find(slot(nextDb, nextObj));
+        if (it == pending.end()) break;
+
+        if (file.write(it.value()) < 0) {
+            stop(false, "Error al escribir " + file.fileName() + ": " + file.errorString());
+            return;
+        }
+        pending.erase(it);
+        if (nextObj >= 0) ++done;
+
+        if (++nextObj >= objCount[nextDb]) {
+            ++nextDb;
+            nextObj = -1;
+        }
+    }
+
+    if (done != before) emit progress(done, total);
+    if (nextDb >= dbNames.size()) stop(true, "Exportado: " + file.fileName());
+}
+
+void DdlExporter::stop(bool ok, const QString& message)
+{
+    {
+        QMutexLocker lock(&mutex);
+        if (!ok) cancelled = true;
+        closed = true;
+        jobs.clear();
+    }
+    wake.wakeAll();
+
+    for (QThread* t : threads) {
+        t->wait();
+        delete t;
+    }
+    threads.clear();
+
+    file.close();
+    if (!ok) file.remove();
+
+    pending.clear();
+    running = false;
+    emit finished(ok, message);
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+
+class DbSession;
+class MetadataService;
+class QThread;
+
+// Exporta el DDL General de una o varias bases repartiendo los SHOW CREATE entre N
+// conexiones del pool (una por hilo). Cada objeto se escribe en cuanto llega, pero siempre en el
+// mismo orden: base, tablas, vistas, funciones, procedimientos, triggers.
+// Con gzip cada objeto se comprime como un miembro gzip independiente (gunzip los concatena).
+class DdlExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit DdlExporter(const DbSession* s, QObject* parent = nullptr);
+    ~DdlExporter() override;
+
+    bool start(const QStringList& databases, const QString& path, bool gzip, int workers,
+               QString* err = nullptr);
+    void cancel();
+    bool isRunning() const { return running; }
+
+    // Formato compartido con "Generar DDL General"
+    static QString fileHeader();
+    static QString databaseHeader(const QString& db);
+    static QString objectSection(MetadataService& meta, const QString& db,
+                                 const QString& kind, const QString& name);
+    // "Generar DDL General" de una base en memoria, en el orden de la exportación.
+    static QString databaseDdl(MetadataService& meta, const QString& db);
+
+signals:
+    void progress(int done, int total);
+    void finished(bool ok, const QString& message);
+
+private:
+    struct Job {
+        int db = 0;
+        int obj = -1;   // -1: listar los objetos de la base
+        QString dbName;
+        QString kind;
+        QString name;
+    };
+
+    void workerLoop();
+    bool takeJob(Job* job);
+    QByteArray encode(const QString& text) const;
+
+    void onListed(int db, const QStringList& kinds, const QStringList& names);
+    void onObjectReady(int db, int obj, const QByteArray& bytes);
+    void onWorkerFailed(const QString& error);
+    void flush();
+    void stop(bool ok, const QString& message);
+
+    static qint64 slot(int db, int obj) { return (qint64(db) << 32) | quint32(obj + 1); }
+
+    const DbSession* s;
+    bool running = false;
+    bool gzip = false;
+
+    // Cola compartida con los hilos
+    QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Job> jobs;
+    bool closed = false;
+    std::atomic<bool> cancelled{false};
+    QVector<QThread*> threads;
+    int aliveWorkers = 0;
+
+    // Escritura ordenada (hilo GUI)
+    QFile file;
+    QStringList dbNames;
+    QVector<int> objCount;     // -1 hasta que la base esté listada
+    QHash<qint64, QByteArray> pending;
+    int listed = 0;
+    int nextDb = 0;
+    int nextObj = -1;
+    int done = 0;
+    int total = 0;
+};
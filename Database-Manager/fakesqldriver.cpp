@@ -0,0 +1,634 @@
+#include "FakeSqlDriver.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QSqlResult>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QSet>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+QMutex killMutex;
+QSet<qint64> killed;
+std::atomic<qint64> nextConnection{1000};
+
+// splitmix64: mismo valor para la misma celda en cualquier ejecución
+quint64 mix(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+QSqlField field(const QString& name, int type)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return QSqlField(name, QMetaType(type));
+#else
+    return QSqlField(name, QVariant::Type(type));
+#endif
+}
+
+// Identificador `con comillas` o sin ellas
+const QString kName = QStringLiteral("(`(?:[^`]|``)*`|[\\w$]+)");
+const QString kQualified = kName + QStringLiteral("(?:\\s*\\.\\s*") + kName + QStringLiteral(")?");
+const QString kLiteral = QStringLiteral("'((?:[^']|'')*)'");
+
+QRegularExpression re(const QString& pattern)
+{
+    return QRegularExpression("^" + pattern, QRegularExpression::CaseInsensitiveOption
+                                                 | QRegularExpression::DotMatchesEverythingOption);
+}
+
+QString unquote(QString s)
+{
+    if (s.size() >= 2 && s.startsWith('`') && s.endsWith('`')) s = s.mid(1, s.size() - 2).replace("``", "`");
+    return s;
+}
+
+QString unliteral(QString s) { return s.replace("''", "'"); }
+
+int metaTypeOf(const QVariant& v)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    const int t = v.metaType().id();
+#else
+    const int t = int(v.type());
+#endif
+    if (t == QMetaType::Double) {
+        const double d = v.toDouble();
+        return d == qint64(d) ? QMetaType::LongLong : QMetaType::Double;
+    }
+    return t == QMetaType::Bool || t == QMetaType::LongLong || t == QMetaType::Int ? QMetaType::LongLong
+                                                                                 : QMetaType::QString;
+}
+
+// Respuesta con filas ya armadas (listados de metadatos, reglas del script)
+FakeSqlDriver::Response table(const QStringList& columns, const QVector<QVariantList>& data,
+                              QVector<int> types = {})
+{
+    FakeSqlDriver::Response r;
+    r.select = true;
+    r.columns = columns;
+    if (types.isEmpty()) {
+        types.fill(QMetaType::QString, columns.size());
+        for (int c = 0; c < columns.size(); ++c) {
+            for (const auto& row : data) {
+                if (!row.value(c).isNull()) { types[c] = metaTypeOf(row.value(c)); break; }
+            }
+        }
+    }
+    r.types = types;
+    r.rows = data.size();
+    auto rows = std::make_shared<QVector<QVariantList>>(data);
+    r.cell = [rows](int row, int col){ return rows->at(row).value(col); };
+    return r;
+}
+
+FakeSqlDriver::Response failure(const QString& message)
+{
+    FakeSqlDriver::Response r;
+    r.error = message;
+    return r;
+}
+
+class FakeSqlResult : public QSqlResult {
+public:
+    explicit FakeSqlResult(const FakeSqlDriver* d) : QSqlResult(d), drv(d) {}
+
+protected:
+    QVariant data(int i) override
+    {
+        return (r.cell && at() >= 0 && i >= 0 && i < r.columns.size()) ? r.cell(at(), i) : QVariant();
+    }
+    bool isNull(int i) override { return data(i).isNull(); }
+
+    bool reset(const QString& sql) override
+    {
+        setActive(false);
+        setAt(QSql::BeforeFirstRow);
+        FakeSqlDriver::takeKill(drv->connectionId());   // un KILL de antes no afecta a esta
+        r = drv->respond(sql);
+
+        // Latencia simulada en tramos cortos para que KILL QUERY la interrumpa
+        QElapsedTimer clock;
+        clock.start();
+        while (clock.elapsed() < r.latencyMs) {
+            if (FakeSqlDriver::takeKill(drv->connectionId())) {
+                setLastError(QSqlError("QFAKE", "Query execution was interrupted",
+                                       QSqlError::StatementError, "1317"));
+                r = {};
+                return false;
+            }
+            QThread::msleep(ulong(qMin<qint64>(10, r.latencyMs - clock.elapsed())));
+        }
+
+        if (!r.error.isEmpty()) {
+            setLastError(QSqlError("QFAKE", r.error, QSqlError::StatementError));
+            return false;
+        }
+        setSelect(r.select);
+        setActive(true);
+        return true;
+    }
+
+    bool fetch(int i) override
+    {
+        if (i < 0 || i >= r.rows) {
+            setAt(QSql::AfterLastRow);
+            return false;
+        }
+        setAt(i);
+        return true;
+    }
+    bool fetchFirst() override { return fetch(0); }
+    bool fetchLast() override { return fetch(r.rows - 1); }
+    int size() override { return r.select ? r.rows : -1; }
+    int numRowsAffected() override { return r.affected; }
+
+    QSqlRecord record() const override
+    {
+        QSqlRecord rec;
+        if (!isActive() || !isSelect()) return rec;
+        for (int c = 0; c < r.columns.size(); ++c)
+            rec.append(field(r.columns[c], r.types.value(c, QMetaType::QString)));
+        return rec;
+    }
+
+private:
+    const FakeSqlDriver* drv;
+    FakeSqlDriver::Response r;
+};
+
+} // namespace
+
+void FakeSqlDriver::registerDriver()
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+    QSqlDatabase::registerSqlDriver("QFAKE", new QSqlDriverCreator<FakeSqlDriver>);
+}
+
+bool FakeSqlDriver::takeKill(qint64 connectionId)
+{
+    QMutexLocker lock(&killMutex);
+    return killed.remove(connectionId);
+}
+
+FakeSqlDriver::FakeSqlDriver(QObject* parent)
+    : QSqlDriver(parent)
+{
+}
+
+bool FakeSqlDriver::hasFeature(DriverFeature f) const
+{
+    // Sin PreparedQueries: QSqlResult sustituye los ? con formatValue, como texto
+    return f == QuerySize || f == Unicode;
+}
+
+bool FakeSqlDriver::open(const QString& db, const QString&, const QString&, const QString&, int, const QString&)
+{
+    QString options = db;
+    if (options.startsWith(prefix, Qt::CaseInsensitive)) options = options.mid(int(qstrlen(prefix)));
+
+    QString script;
+    for (const auto& part : options.split(';', Qt::SkipEmptyParts)) {
+        const int eq = part.indexOf('=');
+        const QString key = part.left(eq).trimmed().toLower();
+        const QString value = eq < 0 ? QString() : part.mid(eq + 1).trimmed();
+        const int n = qMax(0, value.toInt());
+        if (key == "dbs") dbs = n;
+        else if (key == "tables") tables = n;
+        else if (key == "views") views = n;
+        else if (key == "functions") functions = n;
+        else if (key == "procedures") procedures = n;
+        else if (key == "triggers") triggers = n;
+        else if (key == "rows") rows = n;
+        else if (key == "cols") cols = qMax(1, n);
+        else if (key == "width") width = qMax(1, n);
+        else if (key == "latency") latency = n;
+        else if (key == "jitter") jitter = n;
+        else if (key == "seed") seed = value.toULongLong();
+        else if (key == "script") script = value;
+    }
+
+    QString err;
+    if (!script.isEmpty() && !loadScript(script, &err)) {
+        setLastError(QSqlError("QFAKE", err, QSqlError::ConnectionError));
+        setOpenError(true);
+        return false;
+    }
+
+    connId = nextConnection++;
+    setOpen(true);
+    setOpenError(false);
+    return true;
+}
+
+void FakeSqlDriver::close()
+{
+    setOpen(false);
+    setOpenError(false);
+}
+
+QSqlResult* FakeSqlDriver::createResult() const
+{
+    return new FakeSqlResult(this);
+}
+
+bool FakeSqlDriver::loadScript(const QString& path, QString* err)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) {
+        *err = "No se pudo leer el script de QFAKE:\n" + path;
+        return false;
+    }
+    QJsonParseError parse;
+    const QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &parse);
+    if (!doc.isArray()) {
+        *err = QString("Script de QFAKE inválido (%1): %2").arg(path, parse.errorString());
+        return false;
+    }
+
+    for (const auto& v : doc.array()) {
+        const QJsonObject o = v.toObject();
+        Rule rule;
+        rule.match = QRegularExpression(o.value("match").toString(),
+                                        QRegularExpression::CaseInsensitiveOption
+                                            | QRegularExpression::DotMatchesEverythingOption);
+        if (!rule.match.isValid()) {
+            *err = QString("Expresión inválida en %1: %2").arg(path, o.value("match").toString());
+            return false;
+        }
+        rule.latencyMs = o.value("latency").toInt();
+        if (o.contains("error")) {
+            rule.answers = true;
+            rule.error = o.value("error").toString();
+        }
+        if (o.contains("columns")) {
+            rule.answers = true;
+            for (const auto& c : o.value("columns").toArray()) rule.columns << c.toString();
+            for (const auto& row : o.value("rows").toArray()) {
+                QVariantList values;
+                for (const auto& cell : row.toArray()) values << (cell.isNull() ? QVariant() : cell.toVariant());
+                rule.rows << values;
+            }
+        }
+        if (o.contains("affected")) {
+            rule.answers = true;
+            rule.affected = o.value("affected").toInt();
+        }
+        rules << rule;
+    }
+    return true;
+}
+
+FakeSqlDriver::Response FakeSqlDriver::respond(const QString& sql) const
+{
+    QString s = sql.trimmed();
+    while (s.endsWith(';')) s.chop(1);
+
+    int wait = latency;
+    if (jitter > 0) wait += int(mix(seed ^ ++statements) % quint64(jitter + 1));
+
+    for (const auto& rule : rules) {
+        if (!rule.match.match(s).hasMatch()) continue;
+        wait += rule.latencyMs;
+        if (!rule.answers) continue;
+
+        Response r = rule.error.isEmpty() ? (rule.columns.isEmpty() ? Response() : table(rule.columns, rule.rows))
+                                          : failure(rule.error);
+        r.affected = rule.affected;
+        r.latencyMs = wait;
+        return r;
+    }
+
+    Response r = synthetic(s);
+    r.latencyMs = wait;
+    return r;
+}
+
+QStringList FakeSqlDriver::names(const QString& prefix, int count, int digits) const
+{
+    QStringList r;
+    r.reserve(count);
+    for (int i = 1; i <= count; ++i) r << prefix + QString("%1").arg(i, digits, 10, QChar('0'));
+    return r;
+}
+
+// Número (1..count) de un objeto sintético por su nombre, 0 si no existe
+static int objectNumber(const QString& name, const QString& prefix, int count)
+{
+    if (!name.startsWith(prefix, Qt::CaseInsensitive)) return 0;
+    bool ok = false;
+    const int n = name.mid(prefix.size()).toInt(&ok);
+    return ok && n >= 1 && n <= count ? n : 0;
+}
+
+static int digitsFor(int count) { return qMax(4, QString::number(count).size()); }
+
+QString FakeSqlDriver::columnType(int col) const
+{
+    if (col == 0) return "bigint(20) unsigned";
+    switch (col % 4) {
+    case 1:  return QString("varchar(%1)").arg(width);
+    case 2:  return "decimal(12,2)";
+    case 3:  return "datetime";
+    default: return "int(11)";
+    }
+}
+
+static int metaTypeForColumn(int col)
+{
+    if (col == 0) return QMetaType::LongLong;
+    switch (col % 4) {
+    case 1:  return QMetaType::QString;
+    case 2:  return QMetaType::Double;
+    case 3:  return QMetaType::QDateTime;
+    default: return QMetaType::LongLong;
+    }
+}
+
+static QString columnName(int col) { return col == 0 ? QString("id") : QString("c%1").arg(col); }
+
+QVariant FakeSqlDriver::cell(int table, qint64 id, int col) const
+{
+    if (col == 0) return qlonglong(id);
+    const quint64 h = mix(seed ^ (quint64(table) << 44) ^ (quint64(id) << 8) ^ quint64(col));
+    if (h % 17 == 0) return QVariant();
+
+    switch (col % 4) {
+    case 1: {
+        QString s = QString::number(id) + '-';
+        if (s.size() < width) s += QString(width - s.size(), QChar('a' + int(h % 26)));
+        return s;
+    }
+    case 2:  return double(h % 10000000) / 100.0;
+    case 3:  return QDateTime::fromSecsSinceEpoch(qint64(1577836800 + h % 157680000), QTimeZone::utc());
+    default: return qlonglong(h % 100000);
+    }
+}
+
+QString FakeSqlDriver::createTable(int t) const
+{
+    QString ddl = QString("CREATE TABLE `t%1` (\n").arg(t, digitsFor(tables), 10, QChar('0'));
+    for (int c = 0; c < cols; ++c) {
+        ddl += QString("  `%1` %2 %3,\n").arg(columnName(c), columnType(c),
+                                              c == 0 ? "NOT NULL AUTO_INCREMENT" : "DEFAULT NULL");
+    }
+    ddl += "  PRIMARY KEY (`id`)";
+    if (cols > 1) ddl += ",\n  KEY `ix_c1` (`c1`)";
+    ddl += "\n) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4";
+    return ddl;
+}
+
+FakeSqlDriver::Response FakeSqlDriver::tableRows(const QString& db, const QString& name,
+                                                 const QString& select, const QString& tail) const
+{
+    int t = objectNumber(name, "t", tables);
+    int available = cols;
+    if (!t && tables > 0) {
+        // Cada vista vN es SELECT id, c1 sobre la tabla tN
+        const int v = objectNumber(name, "v", views);
+        if (v) { t = (v - 1) % tables + 1; available = qMin(2, cols); }
+    }
+    if (!t) return failure(QString("Table '%1.%2' doesn't exist").arg(db, name));
+
+    QVector<int> picked;
+    if (select.trimmed() == "*") {
+        for (int c = 0; c < available; ++c) picked << c;
+    } else {
+        for (QString part : select.split(',')) {
+            part = part.trimmed();
+            const int dot = part.lastIndexOf('.');
+            if (dot >= 0) part = part.mid(dot + 1);
+            part = unquote(part.trimmed());
+            int found = -1;
+            for (int c = 0; c < available && found < 0; ++c)
+                if (columnName(c).compare(part, Qt::CaseInsensitive) == 0) found = c;
+            if (found < 0) return failure(QString("Unknown column '%1' in 'field list'").arg(part));
+            picked << found;
+        }
+    }
+
+    // Paginación por clave de TableDataBrowser (WHERE id > N) y LIMIT [offset,] n / LIMIT n OFFSET m
+    static const QRegularExpression keyset("\\bWHERE\\b.*?>\\s*(=)?\\s*\\(?\\s*'?(-?\\d+)",
+                                           QRegularExpression::CaseInsensitiveOption
+                                               | QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression limitRe("\\bLIMIT\\s+(\\d+)(?:\\s*,\\s*(\\d+)|\\s+OFFSET\\s+(\\d+))?",
+                                            QRegularExpression::CaseInsensitiveOption);
+    qint64 first = 1;
+    const auto k = keyset.match(tail);
+    if (k.hasMatch()) first = k.captured(2).toLongLong() + (k.captured(1).isEmpty() ? 1 : 0);
+
+    qint64 limit = rows;
+    const auto l = limitRe.match(tail);
+    if (l.hasMatch()) {
+        if (!l.captured(2).isEmpty()) {
+            first += l.captured(1).toLongLong();
+            limit = l.captured(2).toLongLong();
+        } else {
+            limit = l.captured(1).toLongLong();
+            first += l.captured(3).toLongLong();
+        }
+    }
+    first = qMax<qint64>(1, first);
+
+    Response r;
+    r.select = true;
+    for (int c : picked) {
+        r.columns << columnName(c);
+        r.types << metaTypeForColumn(c);
+    }
+    r.rows = int(qBound<qint64>(0, qMin<qint64>(limit, rows - first + 1), rows));
+    r.cell = [this, t, first, picked](int row, int col){ return cell(t, first + row, picked[col]); };
+    return r;
+}
+
+FakeSqlDriver::Response FakeSqlDriver::synthetic(const QString& s) const
+{
+    static const QRegularExpression showDatabases = re("SHOW\\s+(?:DATABASES|SCHEMAS)\\b");
+    static const QRegularExpression showTables =
+        re("SHOW\\s+FULL\\s+TABLES\\s+FROM\\s+" + kName + "(?:\\s+WHERE\\s+Table_type\\s*=\\s*" + kLiteral + ")?");
+    static const QRegularExpression showTriggers = re("SHOW\\s+TRIGGERS\\s+FROM\\s+" + kName);
+    static const QRegularExpression showStatus =
+        re("SHOW\\s+(FUNCTION|PROCEDURE)\\s+STATUS\\s+WHERE\\s+Db\\s*=\\s*" + kLiteral);
+    static const QRegularExpression procTable =
+        re("SELECT\\s+name\\s*,\\s*type\\s+FROM\\s+mysql\\.proc\\s+WHERE\\s+db\\s*=\\s*" + kLiteral);
+    static const QRegularExpression indexStats =
+        re("SELECT\\s+DISTINCT\\s+table_name\\s*,\\s*index_name\\s+FROM\\s+mysql\\.innodb_index_stats"
+           "\\s+WHERE\\s+database_name\\s*=\\s*" + kLiteral);
+    static const QRegularExpression showIndex =
+        re("SHOW\\s+(?:INDEX|INDEXES|KEYS)\\s+FROM\\s+" + kName + "\\s+FROM\\s+" + kName);
+    static const QRegularExpression showColumns =
+        re("SHOW\\s+(?:FULL\\s+)?COLUMNS\\s+FROM\\s+" + kName + "\\s+FROM\\s+" + kName);
+    static const QRegularExpression showCreate =
+        re("SHOW\\s+CREATE\\s+(TABLE|VIEW|TRIGGER|FUNCTION|PROCEDURE)\\s+" + kQualified);
+    static const QRegularExpression connectionId = re("SELECT\\s+CONNECTION_ID\\s*\\(\\s*\\)");
+    static const QRegularExpression kill = re("KILL\\s+(?:QUERY\\s+)?(\\d+)");
+    static const QRegularExpression use = re("USE\\s+" + kName);
+    static const QRegularExpression count = re("SELECT\\s+COUNT\\s*\\(\\s*\\*\\s*\\)\\s+FROM\\s+" + kQualified + "(.*)$");
+    static const QRegularExpression select = re("SELECT\\s+(.+?)\\s+FROM\\s+" + kQualified + "(.*)$");
+    static const QRegularExpression literal = re("SELECT\\s+(-?\\d+)\\s*$");
+    static const QRegularExpression query = re("(SELECT|SHOW|DESCRIBE|DESC|EXPLAIN|WITH|CALL)\\b");
+
+    const int td = digitsFor(tables), rd = digitsFor(qMax(functions, qMax(procedures, triggers)));
+    QRegularExpressionMatch m;
+
+    if ((m = showDatabases.match(s)).hasMatch()) {
+        QVector<QVariantList> data{{"information_schema"}, {"mysql"}, {"performance_schema"}};
+        for (int i = 1; i <= dbs; ++i) data << QVariantList{QString("fake_%1").arg(i)};
+        return table({"Database"}, data);
+    }
+    if ((m = showTables.match(s)).hasMatch()) {
+        const QString db = unquote(m.captured(1));
+        const QString type = unliteral(m.captured(2));
+        QVector<QVariantList> data;
+        if (type.isEmpty() || type == "BASE TABLE")
+            for (const auto& t : names("t", tables, td)) data << QVariantList{t, "BASE TABLE"};
+        if (type.isEmpty() || type == "VIEW")
+            for (const auto& v : names("v", views, td)) data << QVariantList{v, "VIEW"};
+        return table({"Tables_in_" + db, "Table_type"}, data);
+    }
+    if ((m = showTriggers.match(s)).hasMatch()) {
+        const QStringList t = names("t", tables, td);
+        QVector<QVariantList> data;
+        const QStringList tr = names("tr", tables > 0 ? triggers : 0, rd);
+        for (int i = 0; i < tr.size(); ++i)
+            data << QVariantList{tr[i], "INSERT", t[i % t.size()], "SET NEW.id = NEW.id", "BEFORE"};
+        return table({"Trigger", "Event", "Table", "Statement", "Timing"}, data);
+    }
+    if ((m = showStatus.match(s)).hasMatch()) {
+        const bool isFunction = m.captured(1).toUpper() == "FUNCTION";
+        const QString db = unliteral(m.captured(2));
+        QVector<QVariantList> data;
+        for (const auto& n : isFunction ? names("f", functions, rd) : names("p", procedures, rd))
+            data << QVariantList{db, n, isFunction ? "FUNCTION" : "PROCEDURE"};
+        return table({"Db", "Name", "Type"}, data);
+    }
+    if ((m = procTable.match(s)).hasMatch()) {
+        QVector<QVariantList> data;
+        for (const auto& n : names("f", functions, rd)) data << QVariantList{n, "FUNCTION"};
+        for (const auto& n : names("p", procedures, rd)) data << QVariantList{n, "PROCEDURE"};
+        return table({"name", "type"}, data);
+    }
+    if ((m = indexStats.match(s)).hasMatch()) {
+        QVector<QVariantList> data;
+        for (const auto& t : names("t", tables, td)) {
+            data << QVariantList{t, "PRIMARY"};
+            if (cols > 1) data << QVariantList{t, "ix_c1"};
+        }
+        return table({"table_name", "index_name"}, data);
+    }
+    if ((m = showIndex.match(s)).hasMatch()) {
+        const QString name = unquote(m.captured(1)), db = unquote(m.captured(2));
+        if (!objectNumber(name, "t", tables)) return failure(QString("Table '%1.%2' doesn't exist").arg(db, name));
+        QVector<QVariantList> data{{name, 0, "PRIMARY", 1, "id", "NO"}};
+        if (cols > 1) data << QVariantList{name, 1, "ix_c1", 1, "c1", "YES"};
+        return table({"Table", "Non_unique", "Key_name", "Seq_in_index", "Column_name", "Null"}, data);
+    }
+    if ((m = showColumns.match(s)).hasMatch()) {
+        const QString name = unquote(m.captured(1)), db = unquote(m.captured(2));
+        int available = objectNumber(name, "t", tables) ? cols : 0;
+        if (!available && objectNumber(name, "v", views)) available = qMin(2, cols);
+        if (!available) return failure(QString("Table '%1.%2' doesn't exist").arg(db, name));
+        QVector<QVariantList> data;
+        for (int c = 0; c < available; ++c) {
+            data << QVariantList{columnName(c), columnType(c), c == 0 ? "NO" : "YES",
+                                 c == 0 ? "PRI" : (c == 1 ? "MUL" : ""), QVariant(),
+                                 c == 0 ? "auto_increment" : ""};
+        }
+        return table({"Field", "Type", "Null", "Key", "Default", "Extra"}, data,
+                     {QMetaType::QString, QMetaType::QString, QMetaType::QString, QMetaType::QString,
+                      QMetaType::QString, QMetaType::QString});
+    }
+    if ((m = showCreate.match(s)).hasMatch()) {
+        const QString kind = m.captured(1).toUpper();
+        const QString db = m.captured(3).isEmpty() ? currentDb : unquote(m.captured(2));
+        const QString name = unquote(m.captured(3).isEmpty() ? m.captured(2) : m.captured(3));
+        const QString missing = QString("%1 '%2.%3' doesn't exist").arg(kind.left(1) + kind.mid(1).toLower(), db, name);
+        const QString definer = "CREATE DEFINER=`fake`@`%` ";
+
+        if (kind == "TABLE") {
+            const int t = objectNumber(name, "t", tables);
+            if (!t) return failure(missing);
+            return table({"Table", "Create Table"}, {{name, createTable(t)}});
+        }
+        if (kind == "VIEW") {
+            const int v = objectNumber(name, "v", views);
+            if (!v || tables == 0) return failure(missing);
+            const QString base = names("t", tables, td)[(v - 1) % tables];
+            const QString list = cols > 1 ? "`id`,`c1`" : "`id`";
+            return table({"View", "Create View", "character_set_client", "collation_connection"},
+                         {{name, QString("CREATE ALGORITHM=UNDEFINED DEFINER=`fake`@`%` SQL SECURITY DEFINER "
+                                         "VIEW `%1` AS select %2 from `%3`").arg(name, list, base),
+                           "utf8mb4", "utf8mb4_general_ci"}});
+        }
+        if (kind == "TRIGGER") {
+            const int n = tables > 0 ? objectNumber(name, "tr", triggers) : 0;
+            if (!n) return failure(missing);
+            const QString base = names("t", tables, td)[(n - 1) % tables];
+            return table({"Trigger", "sql_mode", "SQL Original Statement"},
+                         {{name, "", definer + QString("TRIGGER `%1` BEFORE INSERT ON `%2` FOR EACH ROW "
+                                                       "SET NEW.id = NEW.id").arg(name, base)}});
+        }
+        if (kind == "FUNCTION") {
+            const int n = objectNumber(name, "f", functions);
+            if (!n) return failure(missing);
+            return table({"Function", "sql_mode", "Create Function"},
+                         {{name, "", definer + QString("FUNCTION `%1`(x INT) RETURNS int(11)\n"
+                                                       "    DETERMINISTIC\nRETURN x + %2").arg(name).arg(n)}});
+        }
+        const int n = objectNumber(name, "p", procedures);
+        if (!n) return failure(missing);
+        return table({"Procedure", "sql_mode", "Create Procedure"},
+                     {{name, "", definer + QString("PROCEDURE `%1`(IN x INT)\nBEGIN\n  SELECT x + %2;\nEND")
+                                               .arg(name).arg(n)}});
+    }
+    if ((m = connectionId.match(s)).hasMatch())
+        return table({"CONNECTION_ID()"}, {{qlonglong(connId)}});
+    if ((m = kill.match(s)).hasMatch()) {
+        QMutexLocker lock(&killMutex);
+        killed.insert(m.captured(1).toLongLong());
+        return {};
+    }
+    if ((m = use.match(s)).hasMatch()) {
+        currentDb = unquote(m.captured(1));
+        return {};
+    }
+    if ((m = count.match(s)).hasMatch()) {
+        const QString db = m.captured(2).isEmpty() ? currentDb : unquote(m.captured(1));
+        const QString name = unquote(m.captured(2).isEmpty() ? m.captured(1) : m.captured(2));
+        Response all = tableRows(db, name, "*", m.captured(3));
+        if (!all.error.isEmpty()) return all;
+        return table({"COUNT(*)"}, {{qlonglong(all.rows)}});
+    }
+    if ((m = select.match(s)).hasMatch()) {
+        const QString db = m.captured(3).isEmpty() ? currentDb : unquote(m.captured(2));
+        const QString name = unquote(m.captured(3).isEmpty() ? m.captured(2) : m.captured(3));
+        return tableRows(db, name, m.captured(1), m.captured(4));
+    }
+    if ((m = literal.match(s)).hasMatch())
+        return table({m.captured(1)}, {{m.captured(1).toLongLong()}});
+    if (query.match(s).hasMatch())
+        return failure("QFAKE no simula esta sentencia: " + s.left(200));
+
+    // DDL/DML/SET...: se aceptan sin efecto
+    Response ok;
+    static const QRegularExpression dml = re("(INSERT|UPDATE|DELETE|REPLACE)\\b");
+    if (dml.match(s).hasMatch()) ok.affected = 1;
+    return ok;
+}
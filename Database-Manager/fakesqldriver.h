@@ -0,0 +1,88 @@
+#pragma once
+#include <QSqlDriver>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <functional>
+
+// Driver "QFAKE": un MariaDB simulado dentro del proceso, determinista, para medir sin
+// servidor ni ODBC. Responde lo que piden MetadataService, QueryWorker y TableDataBrowser
+// (SHOW DATABASES, SHOW FULL TABLES, SHOW INDEX/COLUMNS/TRIGGERS, SHOW CREATE ...,
+// mysql.proc, innodb_index_stats, CONNECTION_ID, KILL QUERY) y SELECTs sobre tablas
+// sintéticas con el número de filas y el ancho configurados.
+//
+// DbSession lo usa cuando la cadena de conexión empieza por "QFAKE:", seguida de opciones
+// clave=valor separadas por ';' (entre paréntesis el valor por defecto):
+//   dbs (3)  tables (50)  views (5)  functions (5)  procedures (5)  triggers (5)
+//   rows (1000) filas por tabla    cols (6) columnas por tabla    width (24) ancho de los textos
+//   latency (0) ms por sentencia   jitter (0) ms extra, pseudoaleatorio según seed (1)
+//   script  archivo JSON con respuestas por expresión regular, que se prueban primero:
+//     [{"match": "^SELECT .* FROM `ventas`", "latency": 120,
+//       "columns": ["id", "total"], "rows": [[1, 9.5], [2, null]]},
+//      {"match": "^UPDATE", "error": "Lock wait timeout exceeded"},
+//      {"match": "^SHOW CREATE", "latency": 300}]
+//   Una regla solo con latency suma esa espera y deja la respuesta sintética.
+class FakeSqlDriver : public QSqlDriver {
+    Q_OBJECT
+public:
+    static constexpr const char* prefix = "QFAKE:";
+
+    // Registra "QFAKE" en QSqlDatabase (una vez; llamar desde el hilo de la GUI).
+    static void registerDriver();
+
+    explicit FakeSqlDriver(QObject* parent = nullptr);
+
+    bool hasFeature(DriverFeature f) const override;
+    bool open(const QString& db, const QString& user, const QString& password,
+              const QString& host, int port, const QString& connOpts) override;
+    void close() override;
+    QSqlResult* createResult() const override;
+
+    // Respuesta de una sentencia; la usa FakeSqlResult.
+    struct Response {
+        QString error;
+        bool select = false;
+        QStringList columns;
+        QVector<int> types;     // QMetaType de cada columna
+        int rows = 0;
+        std::function<QVariant(int row, int col)> cell;
+        int affected = 0;
+        int latencyMs = 0;
+    };
+    Response respond(const QString& sql) const;
+    qint64 connectionId() const { return connId; }
+
+    // KILL QUERY desde otra conexión: la sentencia en espera de ese id termina con error.
+    static bool takeKill(qint64 connectionId);
+
+private:
+    struct Rule {
+        QRegularExpression match;
+        int latencyMs = 0;
+        bool answers = false;
+        QString error;
+        QStringList columns;
+        QVector<QVariantList> rows;
+        int affected = 0;
+    };
+
+    bool loadScript(const QString& path, QString* err);
+    Response synthetic(const QString& sql) const;
+    Response tableRows(const QString& db, const QString& table, const QString& select,
+                       const QString& tail) const;
+    QString createTable(int t) const;
+    QStringList names(const QString& prefix, int count, int digits) const;
+    QString columnType(int col) const;
+    QVariant cell(int table, qint64 id, int col) const;
+
+    int dbs = 3, tables = 50, views = 5, functions = 5, procedures = 5, triggers = 5;
+    int rows = 1000, cols = 6, width = 24;
+    int latency = 0, jitter = 0;
+    quint64 seed = 1;
+    QVector<Rule> rules;
+
+    qint64 connId = 0;
+    mutable quint64 statements = 0;
+    mutable QString currentDb;
+};
@@ -0,0 +1,108 @@
+#include "HistoryPanel.h"
+#include "QueryHistory.h"
+#include <QAbstractTableModel>
+#include <QLineEdit>
+#include <QTableView>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QElapsedTimer>
+
+enum { ColWhen, ColCount, ColDb, ColProfile, ColTime, ColRows, ColSql, ColumnCount };
+
+// Solo guarda los índices de grupo; el texto se lee del log al pintar cada fila.
+class HistoryModel : public QAbstractTableModel {
+public:
+    explicit HistoryModel(QueryHistory* h, QObject* parent) : QAbstractTableModel(parent), h(h) {}
+
+    void setGroups(QVector<int> g)
+    {
+        beginResetModel();
+        groups = std::move(g);
+        endResetModel();
+    }
+    QString sqlAt(int row) const { return h->entry(h->group(groups[row]).last).sql; }
+
+    int rowCount(const QModelIndex& p = QModelIndex()) const override { return p.isValid() ? 0 : groups.size(); }
+    int columnCount(const QModelIndex& p = QModelIndex()) const override { return p.isValid() ? 0 : ColumnCount; }
+
+    QVariant headerData(int section, Qt::Orientation o, int role) const override
+    {
+        if (o != Qt::Horizontal || role != Qt::DisplayRole) return {};
+        static const char* names[ColumnCount] = {"Última vez", "Veces", "Base", "Perfil", "Tiempo", "Filas", "Sentencia"};
+        return QString(names[section]);
+    }
+
+    QVariant data(const QModelIndex& i, int role) const override
+    {
+        if (!i.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole)) return {};
+        const QueryHistory::Group& g = h->group(groups[i.row()]);
+        const QueryHistory::Entry e = h->entry(g.last);
+        if (role == Qt::ToolTipRole) return e.sql;
+
+        switch (i.column()) {
+        case ColWhen:    return e.when.toString("yyyy-MM-dd HH:mm:ss");
+        case ColCount:   return g.count;
+        case ColDb:      return e.database;
+        case ColProfile: return e.profile;
+        case ColTime:    return QString("%1 ms").arg(e.durationMs);
+        case ColRows:    return e.rows < 0 ? QVariant() : QVariant(e.rows);
+        case ColSql: {
+            QString s = e.sql.simplified();
+            if (s.size() > 200) s = s.left(197) + "...";
+            return s;
+        }
+        }
+        return {};
+    }
+
+private:
+    QueryHistory* h;
+    QVector<int> groups;
+};
+
+HistoryPanel::HistoryPanel(QueryHistory* history, QWidget* p)
+    : QWidget(p), history(history)
+{
+    filter = new QLineEdit;
+    filter->setPlaceholderText("Buscar en el historial (palabras separadas por espacios)...");
+    filter->setClearButtonEnabled(true);
+
+    info = new QLabel;
+
+    model = new HistoryModel(history, this);
+    view = new QTableView;
+    view->setModel(model);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->verticalHeader()->setVisible(false);
+    view->verticalHeader()->setDefaultSectionSize(22);
+    view->horizontalHeader()->setSectionResizeMode(ColSql, QHeaderView::Stretch);
+
+    auto* l = new QVBoxLayout(this);
+    l->setContentsMargins(0,0,0,0);
+    l->addWidget(filter);
+    l->addWidget(info);
+    l->addWidget(view, 1);
+
+    connect(filter, &QLineEdit::textChanged, this, &HistoryPanel::search);
+    connect(history, &QueryHistory::added, this, &HistoryPanel::search);
+    connect(view, &QTableView::doubleClicked, this, [this](const QModelIndex& i){
+        if (i.isValid()) emit openRequested(model->sqlAt(i.row()));
+    });
+
+    search();
+}
+
+void HistoryPanel::search()
+{
+    QElapsedTimer t;
+    t.start();
+    QVector<int> hits = history->search(filter->text());
+    const qint64 ms = t.elapsed();
+    const int n = hits.size();
+    model->setGroups(std::move(hits));
+    info->setText(QString("%1 de %2 consultas distintas (%3 ejecuciones) · %4 ms")
+                  .arg(n).arg(history->groupCount()).arg(history->entryCount()).arg(ms));
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <QWidget>
+
+class QueryHistory;
+class QLineEdit;
+class QTableView;
+class QLabel;
+class HistoryModel;
+
+// Pestaña "Historial": búsqueda incremental sobre QueryHistory (una fila por consulta
+// distinta, la más reciente primero). Doble clic la devuelve a la consola.
+class HistoryPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit HistoryPanel(QueryHistory* history, QWidget* parent = nullptr);
+
+signals:
+    void openRequested(const QString& sql);
+
+private:
+    void search();
+
+    QueryHistory* history;
+    HistoryModel* model;
+    QLineEdit* filter;
+    QTableView* view;
+    QLabel* info;
+};
@@ -1,4 +1,5 @@
 #include "LoginDialog.h"
+#include "DbSession.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -6,6 +7,8 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QSpinBox>
+#include <QCheckBox>
+#include <QStandardItemModel>
 #include <QPushButton>
 #include <QLabel>
 #include <QMessageBox>
@@ -37,6 +40,19 @@ void LoginDialog::buildUi()
     m_pass = new QLineEdit;
     m_pass->setEchoMode(QLineEdit::Password);
 
+    m_backend = new QComboBox;
+    m_backend->addItem("ODBC", "odbc");
+    m_backend->addItem("Nativo (MariaDB)", "nativo");
+    if (!DbSession::nativeAvailable()) {
+        // Sin libmariadb ni plugin QMYSQL no se puede elegir
+        if (auto* model = qobject_cast<QStandardItemModel*>(m_backend->model()))
+            model->item(1)->setEnabled(false);
+        m_backend->setItemData(1, "Esta compilación no incluye el cliente nativo.", Qt::ToolTipRole);
+    }
+    m_compress = new QCheckBox("Protocolo comprimido");
+    m_compress->setToolTip("Menos tráfico en redes lentas a cambio de CPU en ambos extremos.");
+    m_compress->setEnabled(false);
+
     m_btnSaveProfile = new QPushButton("Guardar perfil");
     m_btnDeleteProfile = new QPushButton("Eliminar perfil");
 
@@ -56,6 +72,8 @@ void LoginDialog::buildUi()
     form->addRow("Database (opcional):", m_db);
     form->addRow("Usuario:", m_user);
     form->addRow("Contraseña:", m_pass);
+    form->addRow("Cliente:", m_backend);
+    form->addRow("", m_compress);
 
     auto* btnRow = new QHBoxLayout;
     btnRow->addStretch(1);
@@ -70,6 +88,10 @@ void LoginDialog::buildUi()
     connect(m_profiles, QOverload<int>::of(&QComboBox::currentIndexChanged),
             this, &LoginDialog::onProfileChanged);
 
+    connect(m_backend, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](){
+        m_compress->setEnabled(m_backend->currentData().toString() == "nativo");
+    });
+
     connect(m_btnSaveProfile, &QPushButton::clicked,
             this, &LoginDialog::onSaveProfile);
 
@@ -106,6 +128,8 @@ void LoginDialog::loadProfiles()
         p.database = s.value("database").toString();
         p.user     = s.value("user").toString();
         p.driver   = s.value("driver", "MariaDB ODBC 3.2 Driver").toString();
+        p.backend  = s.value("backend", "odbc").toString();
+        p.compress = s.value("compress", false).toBool();
 
         if (!p.name.trimmed().isEmpty())
             m_items.push_back(p);
@@ -146,6 +170,8 @@ void LoginDialog::saveProfiles()
         s.setValue("database", m_items[i].database);
         s.setValue("user", m_items[i].user);
         s.setValue("driver", m_items[i].driver);
+        s.setValue("backend", m_items[i].backend);
+        s.setValue("compress", m_items[i].compress);
     }
     s.endArray();
 }
@@ -157,6 +183,9 @@ void LoginDialog::applyProfileToUi(const ConnectionProfile& p)
     m_port->setValue(p.port);
     m_db->setText(p.database);
     m_user->setText(p.user);
+    const int backend = m_backend->findData(p.backend);
+    m_backend->setCurrentIndex(backend == 1 && DbSession::nativeAvailable() ? 1 : 0);
+    m_compress->setChecked(p.compress);
     // contraseña nunca se guarda
     m_pass->clear();
 }
@@ -170,6 +199,8 @@ ConnectionProfile LoginDialog::profileFromUi() const
     p.database = m_db->text().trimmed();
     p.user = m_user->text().trimmed();
     p.driver = "MariaDB ODBC 3.2 Driver";
+    p.backend = m_backend->currentData().toString();
+    p.compress = m_compress->isChecked();
     return p;
 }
 
@@ -237,6 +268,16 @@ QString LoginDialog::dsn() const
     const QString user = m_user->text().trimmed();
     const QString pass = m_pass->text(); // no trimmed para permitir espacios si existieran
 
+#ifdef DM_HAVE_FAKE
+    // Servidor simulado para pruebas sin MariaDB, p. ej. "QFAKE:tables=5000;latency=80"
+    // (solo compilado con DM_WITH_FAKE)
+    if (host.startsWith("QFAKE:", Qt::CaseInsensitive))
+        return host;
+#endif
+
+    if (m_backend->currentData().toString() == "nativo")
+        return DbSession::nativeConnString(host, port, user, pass, database, m_compress->isChecked());
+
     QString dsn = QString("DRIVER={%1};SERVER=%2;PORT=%3;UID=%4;PWD=%5;")
                       .arg(driver, host)
                       .arg(port)
@@ -16,6 +16,8 @@ struct ConnectionProfile
     QString database; // puede quedar vacío
     QString user;
     QString driver;   // "MariaDB ODBC 3.2 Driver"
+    QString backend = "odbc";  // "odbc" o "nativo" (libmariadb / QMYSQL)
+    bool    compress = false;  // protocolo comprimido, solo nativo
 };
 
 class LoginDialog : public QDialog
@@ -49,6 +51,8 @@ private:
     QLineEdit*  m_db = nullptr;
     QLineEdit*  m_user = nullptr;
     QLineEdit*  m_pass = nullptr;
+    QComboBox*  m_backend = nullptr;
+    QCheckBox*  m_compress = nullptr;
 
     QPushButton* m_btnSaveProfile = nullptr;
     QPushButton* m_btnDeleteProfile = nullptr;
@@ -23,7 +23,7 @@ static void applyDarkTheme(QApplication& app)
     // Controles principales
     app.setStyleSheet(
         "QWidget { background: #1E1E1E; color: #D4D4D4; }"
-        "QTreeWidget, QPlainTextEdit, QTextEdit, QTableView, QListWidget {"
+        "QTreeView, QPlainTextEdit, QTextEdit, QTableView, QListWidget {"
         "  background: #252526; border: 1px solid #2D2D2D; selection-background-color: #264F78;"
         "}"
         "QHeaderView::section { background: #2D2D30; border: 1px solid #2D2D2D; padding: 4px; }"
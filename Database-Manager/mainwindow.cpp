@@ -2,11 +2,25 @@
 #include "ResultTableWidget.h"
 #include "SqlConsoleWidget.h"
 #include "LoginDialog.h"
+#include "QueryWorker.h"
+#include "TableDataBrowser.h"
+#include "SqlText.h"
+#include "DdlExporter.h"
+#include "ScriptResultsWidget.h"
+#include "ObjectTreeModel.h"
+#include "QueryStats.h"
+#include "TimingPanel.h"
+#include "QueryHistory.h"
+#include "HistoryPanel.h"
+#include "SqlCompleter.h"
+#include "DataComparePanel.h"
+#include "SchemaDiff.h"
+#include "PlanViewer.h"
 
 #include <QApplication>
 #include <QClipboard>
-#include <QTreeWidget>
-#include <QTreeWidgetItem>
+#include <QTreeView>
+#include <QItemSelectionModel>
 #include <QSplitter>
 #include <QPlainTextEdit>
 #include <QMessageBox>
@@ -17,18 +31,25 @@
 #include <QRegularExpression>
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 #include <QMenu>
 #include <QDir>
 #include <QDateTime>
 #include <QGuiApplication>
 #include <QScreen>
+#include <QTabWidget>
+#include <QTabBar>
+#include <QProgressDialog>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QSettings>
 #include <QCoreApplication>
 
-static QString typeOf(QTreeWidgetItem* i){ return i->data(0, Qt::UserRole).toString(); }
-static QString dbOf(QTreeWidgetItem* i){ return i->data(0, Qt::UserRole+1).toString(); }
-static QString nameOf(QTreeWidgetItem* i){ return i->data(0, Qt::UserRole+2).toString(); }
-static QString tableOf(QTreeWidgetItem* i){ return i->data(0, Qt::UserRole+3).toString(); }
+static QString typeOf(const QModelIndex& i){ return i.data(ObjectTreeModel::TypeRole).toString(); }
+static QString dbOf(const QModelIndex& i){ return i.data(ObjectTreeModel::DbRole).toString(); }
+static QString nameOf(const QModelIndex& i){ return i.data(ObjectTreeModel::NameRole).toString(); }
+static QString tableOf(const QModelIndex& i){ return i.data(ObjectTreeModel::TableRole).toString(); }
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent), m_meta(&m_session)
@@ -37,29 +58,59 @@ MainWindow::MainWindow(QWidget* parent)
 
     m_tree->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(m_tree, &QWidget::customContextMenuRequested, this, [this](const QPoint& pos){
-        QTreeWidgetItem* it = m_tree->itemAt(pos);
-        if (!it) return;
+        const QModelIndex it = m_tree->indexAt(pos);
+        if (!it.isValid()) return;
 
         // Seleccionar item bajo el mouse para que las acciones operen sobre él
-        m_tree->setCurrentItem(it);
+        m_tree->setCurrentIndex(it);
 
         QMenu menu;
 
         // Root "MariaDB": toggle system schemas
-        if (it == m_tree->topLevelItem(0)) {
+        if (it == m_treeModel->serverIndex()) {
             QAction* toggleSystem = menu.addAction(
                 m_showSystemSchemas
                     ? "Ocultar bases del sistema (information_schema)"
                     : "Mostrar bases del sistema (information_schema)"
                 );
             QAction* refreshAll = menu.addAction("Refrescar");
+            menu.addSeparator();
+            QAction* expServer = menu.addAction("Exportar DDL General de todas las bases");
+            QAction* expServerGz = menu.addAction("Exportar DDL General de todas las bases (.sql.gz)");
+            menu.addSeparator();
+            QAction* cacheStats = menu.addAction("Estadísticas de caché de metadatos");
+            QAction* poolStats = menu.addAction("Estadísticas del pool de conexiones");
 
             QAction* chosen = menu.exec(m_tree->viewport()->mapToGlobal(pos));
             if (chosen == toggleSystem) {
                 m_showSystemSchemas = !m_showSystemSchemas;
-                loadDatabases();
+                m_treeModel->setShowSystemSchemas(m_showSystemSchemas);
+                m_treeModel->refresh();
             } else if (chosen == refreshAll) {
-                loadDatabases();
+                m_meta.invalidateAll();
+                m_treeModel->refresh();
+            } else if (chosen == expServer) {
+                exportDdlGeneralForServer(false);
+            } else if (chosen == expServerGz) {
+                exportDdlGeneralForServer(true);
+            } else if (chosen == cacheStats) {
+                const auto st = m_meta.cacheStats();
+                const qint64 total = st.hits + st.misses;
+                QMessageBox::information(this, "Caché de metadatos",
+                    QString("Aciertos: %1\nFallos: %2\nEntradas: %3\nConsultas evitadas: %4%")
+                        .arg(st.hits).arg(st.misses).arg(st.entries)
+                        .arg(total > 0 ? 100.0 * st.hits / total : 0.0, 0, 'f', 1));
+            } else if (chosen == poolStats) {
+                const auto st = m_session.poolStats();
+                QMessageBox::information(this, "Pool de conexiones",
+                    QString("En uso: %1\nOciosas: %2\nMáximo: %3\nPropias de sesiones (fuera del máximo): %11\n\n"
+                            "Préstamos: %4\nCon espera: %5\n"
+                            "Espera media: %6 ms\nEspera máxima: %7 ms\n\nAbiertas: %8\nCerradas (inactivas o desplazadas): %9\n"
+                            "Caídas detectadas: %10")
+                        .arg(st.inUse).arg(st.idle).arg(st.maxSize)
+                        .arg(st.checkouts).arg(st.waits)
+                        .arg(st.waits > 0 ? st.totalWaitMs / st.waits : 0).arg(st.maxWaitMs)
+                        .arg(st.opened).arg(st.evicted).arg(st.failedChecks).arg(st.dedicated));
             }
             return;
         }
@@ -73,6 +124,9 @@ MainWindow::MainWindow(QWidget* parent)
             menu.addSeparator();
             QAction* genAll = menu.addAction("Generar DDL General de la base de datos");
             QAction* expAll = menu.addAction("Exportar DDL General de la base de datos");
+            QAction* expAllGz = menu.addAction("Exportar DDL General de la base de datos (.sql.gz)");
+            menu.addSeparator();
+            QAction* diffSchema = menu.addAction("Comparar esquema y generar migración...");
             menu.addSeparator();
             QAction* refreshDb = menu.addAction("Refrescar esta base");
 
@@ -87,8 +141,13 @@ MainWindow::MainWindow(QWidget* parent)
             } else if (chosen == genAll) {
                 m_ddl->setPlainText(ddlForDatabaseGeneral(dbName));
             } else if (chosen == expAll) {
-                exportDdlGeneralForDatabase(dbName);
+                exportDdlGeneralForDatabase(dbName, false);
+            } else if (chosen == expAllGz) {
+                exportDdlGeneralForDatabase(dbName, true);
+            } else if (chosen == diffSchema) {
+                compareSchema(dbName);
             } else if (chosen == refreshDb) {
+                m_meta.invalidateDatabase(dbName);
                 refreshDatabaseNode(dbName);
             }
             return;
@@ -97,6 +156,13 @@ MainWindow::MainWindow(QWidget* parent)
         // Nodos de objetos (tabla/vista/proc/func/trigger/index)
         const bool isObject = (t == "table" || t == "view" || t == "procedure" || t == "function" || t == "trigger" || t == "index");
         if (isObject) {
+            QAction* openData = nullptr;
+            QAction* compareData = nullptr;
+            if (t == "table") {
+                openData = menu.addAction("Abrir datos");
+                compareData = menu.addAction("Comparar datos con otra conexión...");
+                menu.addSeparator();
+            }
             QAction* genDdl = menu.addAction("Generar DDL");
             QAction* expDdl = menu.addAction("Exportar DDL");
             QAction* copyDdl = menu.addAction("Copiar DDL");
@@ -104,7 +170,11 @@ MainWindow::MainWindow(QWidget* parent)
             QAction* chosen = menu.exec(m_tree->viewport()->mapToGlobal(pos));
             if (!chosen) return;
 
-            if (chosen == genDdl) {
+            if (chosen == openData) {
+                openTableData(dbOf(it), nameOf(it));
+            } else if (chosen == compareData) {
+                compareTableData(dbOf(it), nameOf(it));
+            } else if (chosen == genDdl) {
                 m_ddl->setPlainText(ddlForItem(it));
             } else if (chosen == expDdl) {
                 exportDdlForItem(it);
@@ -123,6 +193,10 @@ MainWindow::MainWindow(QWidget* parent)
         return;
     }
 
+    const ConnectionProfile profile = dlg.profile();
+    m_profileName = profile.name.isEmpty() ? profile.host : profile.name;
+    m_results->setProfileName(m_profileName);
+
     QString err;
     if (!m_session.openWithDsn(dlg.dsn(), &err)) {
         QMessageBox::critical(this, "Error de conexión", err);
@@ -141,20 +215,85 @@ MainWindow::MainWindow(QWidget* parent)
     centerOnScreen();
 }
 
-void MainWindow::buildUi()
+MainWindow::~MainWindow()
 {
-    m_tree = new QTreeWidget;
-    m_tree->setHeaderLabel("Servidor");
+    // Los hilos de consultas usan m_session: detenerlos antes de que se destruya.
+    delete m_exporter;
+    m_exporter = nullptr;
+    delete m_schemaDiff;
+    m_schemaDiff = nullptr;
+    m_meta.setInvalidationHook({});
+    delete takeCentralWidget();
+    delete m_query;
+    m_query = nullptr;
+}
 
-    m_results = new ResultTableWidget;
+void MainWindow::buildUi()
+{
+    m_stats = new QueryStats(this);
+    m_meta.setStats(m_stats);
+
+    m_treeModel = new ObjectTreeModel(&m_meta, this);
+    m_treeModel->setStats(m_stats);
+    m_tree = new QTreeView;
+    m_tree->setHeaderHidden(true);
+    m_tree->setUniformRowHeights(true);
+    m_tree->setModel(m_treeModel);
+
+    m_query = new QuerySession(&m_session, this);
+    m_results = new ResultTableWidget(m_query);
+    m_results->setStats(m_stats, "consola");
+    m_timing = new TimingPanel(m_stats);
+
+    // Sin historial (directorio sin permisos, formato desconocido) la app sigue igual
+    m_history = new QueryHistory(this);
+    m_history->open();
+    m_historyPanel = new HistoryPanel(m_history);
 
     m_ddl = new QPlainTextEdit;
     m_ddl->setReadOnly(true);
 
     m_console = new SqlConsoleWidget;
+    m_completer = new SqlCompleter(&m_meta, &m_session, m_console->editor());
+    m_completer->setDatabaseProvider([this](){
+        const QModelIndex it = m_tree->currentIndex();
+        if (it.isValid()) {
+            const QString db = typeOf(it) == "db" ? nameOf(it) : dbOf(it);
+            if (!db.isEmpty()) return db;
+        }
+        return m_consoleDb;
+    });
+    // Lo que invalida la caché de metadatos también se recarga en el autocompletado
+    m_meta.setInvalidationHook([this](const QString& db, const QString& kind, const QString& name){
+        m_completer->invalidate(db, kind, name);
+    });
+
+    m_resultTabs = new QTabWidget;
+    m_resultTabs->setTabsClosable(true);
+    m_resultTabs->addTab(m_results, "Resultado");
+    m_resultTabs->addTab(m_timing, "Tiempos");
+    m_resultTabs->addTab(m_historyPanel, "Historial");
+    // Las pestañas de la consola, tiempos e historial no se cierran
+    for (int i = 0; i < 3; ++i) {
+        m_resultTabs->tabBar()->setTabButton(i, QTabBar::RightSide, nullptr);
+        m_resultTabs->tabBar()->setTabButton(i, QTabBar::LeftSide, nullptr);
+    }
+    // Las instantáneas guardadas desde cualquier resultado se abren en su propia pestaña
+    auto* btnSnapshot = new QPushButton("Abrir instantánea...");
+    btnSnapshot->setFlat(true);
+    m_resultTabs->setCornerWidget(btnSnapshot, Qt::TopRightCorner);
+    connect(btnSnapshot, &QPushButton::clicked, this, &MainWindow::openSnapshot);
+
+    connect(m_resultTabs, &QTabWidget::tabCloseRequested, this, [this](int idx){
+        QWidget* w = m_resultTabs->widget(idx);
+        if (!w || w == m_results || w == m_timing || w == m_historyPanel) return;
+        if (w == m_script && m_script->isRunning()) return;
+        m_resultTabs->removeTab(idx);
+        w->deleteLater();
+    });
 
     auto* right = new QSplitter(Qt::Vertical);
-    right->addWidget(m_results);
+    right->addWidget(m_resultTabs);
     right->addWidget(m_ddl);
     right->addWidget(m_console);
 
@@ -168,302 +307,248 @@ void MainWindow::buildUi()
 
     setCentralWidget(root);
 
-    connect(m_tree, &QTreeWidget::itemExpanded, this, [&](QTreeWidgetItem* i){
-        if(typeOf(i)=="db" && i->childCount()==0)
-            loadDbChildren(nameOf(i));
-    });
-
-    connect(m_tree, &QTreeWidget::itemSelectionChanged, this, &MainWindow::showDdlForNode);
+    connect(m_tree->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::showDdlForNode);
     connect(m_console, &SqlConsoleWidget::executeRequested, this, &MainWindow::executeSql);
-
-    connect(m_tree, &QTreeWidget::itemExpanded, this, [&](QTreeWidgetItem* i){
-        if(typeOf(i)=="db" && i->childCount()==0)
-            loadDbChildren(nameOf(i));
-        if(typeOf(i)=="table" && i->childCount()==0)
-            loadTableChildren(i);
+    connect(m_console, &SqlConsoleWidget::explainRequested, this, &MainWindow::explainSql);
+    connect(m_historyPanel, &HistoryPanel::openRequested, this, [this](const QString& sql){
+        m_console->setSql(sql);
+    });
+    connect(m_console, &SqlConsoleWidget::cancelRequested, this, [this](){
+        if (m_script && m_script->isRunning()) m_script->cancel();
+        else m_results->cancel();
     });
+    connect(m_results, &ResultTableWidget::queryFinished, this, &MainWindow::onSqlFinished);
+
+    connect(m_tree, &QTreeView::expanded, m_treeModel, &ObjectTreeModel::nodeExpanded);
+    connect(m_tree, &QTreeView::collapsed, m_treeModel, &ObjectTreeModel::nodeCollapsed);
 }
 
 void MainWindow::loadDatabases()
 {
-    const QStringList systemSchemas = {
-        "information_schema",
-        "performance_schema",
-        "mysql",
-        "sys"
-    };
-
-    m_tree->clear();
-
-    auto* root = new QTreeWidgetItem(m_tree);
-    root->setText(0,"MariaDB");
-    root->setExpanded(true);
-
-    const auto dbs = m_meta.listDatabases();
-    for (const auto& db : dbs) {
-        if (!m_showSystemSchemas && systemSchemas.contains(db, Qt::CaseInsensitive))
-            continue;
-
-        auto* d = new QTreeWidgetItem(root);
-        d->setText(0,db);
-        d->setData(0,Qt::UserRole,"db");
-        d->setData(0,Qt::UserRole+2,db);
-        d->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
-    }
+    m_treeModel->reload(m_showSystemSchemas);
+    m_tree->expand(m_treeModel->serverIndex());
 }
 
-void MainWindow::loadDbChildren(const QString& db)
+void MainWindow::refreshDatabaseNode(const QString& dbName)
 {
-    auto* root = m_tree->topLevelItem(0);
-    QTreeWidgetItem* dbNode=nullptr;
-
-    for(int i=0;i<root->childCount();++i)
-        if(root->child(i)->text(0)==db) dbNode=root->child(i);
+    m_treeModel->refreshDatabase(dbName);
+}
 
-    // TABLAS
-    auto* tables = new QTreeWidgetItem(dbNode);
-    tables->setText(0,"Tablas");
+void MainWindow::showDdlForNode()
+{
+    const QModelIndex it = m_tree->currentIndex();
+    if (!it.isValid()) return;
 
-    for(const auto& t : m_meta.listTables(db)){
-        auto* it = new QTreeWidgetItem(tables);
-        it->setText(0,t);
-        it->setData(0,Qt::UserRole,"table");
-        it->setData(0,Qt::UserRole+1,db);
-        it->setData(0,Qt::UserRole+2,t);
+    const QString t = typeOf(it);
 
-        // Para que se pueda expandir y cargar índices (flecha visible)
-        it->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
-        new QTreeWidgetItem(it); // dummy child
+    // La definición sale del SHOW CREATE TABLE en caché (MetadataService), no de la consola:
+    // no reemplaza el resultado, no entra al historial y funciona con una consulta en curso.
+    if (t == "index") {
+        showIndexDefinition(dbOf(it), tableOf(it), nameOf(it));
+        return;
     }
 
+    m_ddl->setPlainText(ddlForItem(it));
+}
 
-    auto* indexes = new QTreeWidgetItem(dbNode);
-    indexes->setText(0, "Indices");
-
-    const auto tablesList = m_meta.listTables(db);
+void MainWindow::executeSql(const QString& sql)
+{
+    QString selectedDb;
+    const QModelIndex it = m_tree->currentIndex();
+    if (it.isValid()) {
+        const QString type = typeOf(it);
 
-    for (const auto& t : tablesList) {
-        const auto idxs = m_meta.listIndexes(db, t);
-        for (const auto& idx : idxs) {
-            auto* it = new QTreeWidgetItem(indexes);
-            it->setText(0, QString("%1.%2").arg(t, idx));
-            it->setData(0, Qt::UserRole, "index");
-            it->setData(0, Qt::UserRole+1, db);   // db
-            it->setData(0, Qt::UserRole+2, idx);  // index name (PRIMARY, fk_..., etc.)
-            it->setData(0, Qt::UserRole+3, t);    // table
+        if (type == "db") {
+            selectedDb = nameOf(it);
+        } else if (type == "table") {
+            selectedDb = dbOf(it);
         }
     }
 
+    m_historySql = sql;
 
-    // VISTAS
-    auto* views = new QTreeWidgetItem(dbNode);
-    views->setText(0,"Vistas");
-    for (const auto& v : m_meta.listViews(db)) {
-        auto* it = new QTreeWidgetItem(views);
-        it->setText(0, v);
-        it->setData(0, Qt::UserRole, "view");
-        it->setData(0, Qt::UserRole+1, db);
-        it->setData(0, Qt::UserRole+2, v);
-    }
-
-    // FUNCIONES
-    auto* funcs = new QTreeWidgetItem(dbNode);
-    funcs->setText(0,"Funciones");
-    for (const auto& fn : m_meta.listFunctions(db)) {
-        auto* it = new QTreeWidgetItem(funcs);
-        it->setText(0, fn);
-        it->setData(0, Qt::UserRole, "function");
-        it->setData(0, Qt::UserRole+1, db);
-        it->setData(0, Qt::UserRole+2, fn);
-    }
-
-    // PROCEDURES
-    auto* procs = new QTreeWidgetItem(dbNode);
-    procs->setText(0,"Procedimientos");
-    for (const auto& sp : m_meta.listProcedures(db)) {
-        auto* it = new QTreeWidgetItem(procs);
-        it->setText(0, sp);
-        it->setData(0, Qt::UserRole, "procedure");
-        it->setData(0, Qt::UserRole+1, db);
-        it->setData(0, Qt::UserRole+2, sp);
-    }
-
-    // TRIGGERS
-    auto* triggers = new QTreeWidgetItem(dbNode);
-    triggers->setText(0,"Triggers");
-    for (const auto& tr : m_meta.listTriggers(db)) {
-        auto* it = new QTreeWidgetItem(triggers);
-        it->setText(0, tr);
-        it->setData(0, Qt::UserRole, "trigger");
-        it->setData(0, Qt::UserRole+1, db);
-        it->setData(0, Qt::UserRole+2, tr);
+    // Varias sentencias: se ejecutan como script, cada una con su estado y su resultado
+    const auto statements = SqlText::splitStatements(sql);
+    if (statements.size() > 1) {
+        runScript(statements, selectedDb);
+        return;
     }
-}
-
-void MainWindow::loadTableChildren(QTreeWidgetItem* tableNode)
-{
-    if (!tableNode || typeOf(tableNode) != "table") return;
+    const QString one = statements.isEmpty() ? sql : statements.first().sql;
 
-    while (tableNode->childCount() > 0) {
-        delete tableNode->takeChild(0);
+    QString err;
+    if (!m_results->execute(one, &err)) {
+        m_console->setStatusError(err);
+        return;
     }
 
-    const QString dbName = dbOf(tableNode);
-    const QString tableName = nameOf(tableNode);
-
-    auto* idxFolder = new QTreeWidgetItem(tableNode);
-    idxFolder->setText(0, "Índices");
-
-    const auto idxs = m_meta.listIndexes(dbName, tableName);
-    for (const auto& idx : idxs) {
-        auto* it = new QTreeWidgetItem(idxFolder);
-        it->setText(0, idx);
-        it->setData(0, Qt::UserRole, "index");
-        it->setData(0, Qt::UserRole+1, dbName);
-        it->setData(0, Qt::UserRole+2, idx);
-        it->setData(0, Qt::UserRole+3, tableName);
-    }
+    m_pendingSql = one;
+    m_pendingDb = selectedDb;
+    m_console->setRunning(true);
 }
 
-void MainWindow::refreshDatabaseNode(const QString& dbName)
+void MainWindow::explainSql(const QString& sql, bool analyze)
 {
-    auto* root = m_tree->topLevelItem(0);
-    if (!root) return;
-
-    QTreeWidgetItem* dbNode = nullptr;
-    for (int i = 0; i < root->childCount(); ++i) {
-        if (root->child(i)->text(0) == dbName) {
-            dbNode = root->child(i);
-            break;
-        }
+    // ANALYZE ejecuta la sentencia de verdad: confirmar lo que no sea una consulta
+    if (analyze) {
+        const QString first = SqlText::firstTokenUpper(sql);
+        if (first != "SELECT" && first != "WITH" &&
+            QMessageBox::question(this, "Analyze",
+                                  "ANALYZE ejecuta la sentencia y aplica sus cambios.\n¿Continuar?")
+                != QMessageBox::Yes)
+            return;
     }
-    if (!dbNode) return;
-
-    // Limpia hijos actuales
-    dbNode->takeChildren();
 
-    // Vuelve a cargar
-    loadDbChildren(dbName);
+    QString db = m_consoleDb;
+    const QModelIndex it = m_tree->currentIndex();
+    if (it.isValid()) {
+        const QString type = typeOf(it);
+        if (type == "db") db = nameOf(it);
+        else if (type == "table") db = dbOf(it);
+    }
 
-    // Mantén expandido
-    dbNode->setExpanded(true);
+    if (!m_plan) {
+        m_plan = new PlanViewer(&m_session, &m_meta);
+        connect(m_plan, &PlanViewer::indexActivated, this, &MainWindow::showIndexDefinition);
+        connect(m_plan, &PlanViewer::finished, this, [this](bool ok, const QString& message){
+            if (ok) m_console->setStatusOk(message);
+            else m_console->setStatusError(message);
+        });
+    }
+    if (!m_plan->explain(sql, db, analyze)) {
+        m_console->setStatusError("Todavía se está obteniendo el plan anterior.");
+        return;
+    }
+    if (m_resultTabs->indexOf(m_plan) < 0) m_resultTabs->addTab(m_plan, "Plan");
+    m_resultTabs->setCurrentWidget(m_plan);
 }
 
-void MainWindow::showDdlForNode()
+void MainWindow::showIndexDefinition(const QString& db, const QString& table, const QString& index)
 {
-    auto* it = m_tree->currentItem();
-    if (!it) return;
+    const QString ddl = m_meta.showCreateTable(db, table);
+    const QString line = SchemaDiff::parseTable(ddl).indexes.value(index);
+    m_ddl->setPlainText(QString("-- Índice %1 de %2.%3\n%4\n\n%5")
+                            .arg(index, db, table, line.isEmpty() ? QString("-- (no encontrado)") : line, ddl));
+}
 
-    const QString t = typeOf(it);
+void MainWindow::onSqlFinished(bool ok, const QString& message)
+{
+    m_console->setRunning(false);
 
+    const QString sql = m_pendingSql;
+    const QString selectedDb = m_pendingDb;
+    m_pendingSql.clear();
+    m_pendingDb.clear();
 
-    if (t == "index") {
-        const QString db = dbOf(it);
-        const QString table = tableOf(it);
-        const QString sql = QString("SHOW INDEX FROM %1 FROM %2;")
-                                .arg(DbSession::q(table), DbSession::q(db));
+    m_history->add(m_historySql, m_profileName, selectedDb.isEmpty() ? m_consoleDb : selectedDb,
+                   m_console->elapsedMs(), ok ? m_results->rowCount() : -1);
 
-        QString err;
-        const bool ok = m_results->setQuery(sql, "odbc_conn", &err);
-        if (!ok) m_console->setStatusError(err);
-        else     m_console->setStatusOk("OK");
-
-        m_ddl->setPlainText(sql + "\n-- Índice seleccionado: " + nameOf(it));
+    if (!ok) {
+        m_console->setStatusError(message);
         return;
     }
 
-    m_ddl->setPlainText(ddlForItem(it));
+    m_console->setStatusOk(QString("OK (%1 ms)").arg(m_console->elapsedMs()));
+
+    bool dbLevel = false;
+    QSet<QString> changedDbs;
+    noteExecuted(sql, selectedDb, &dbLevel, &changedDbs);
+    refreshAfterSql(dbLevel, changedDbs);
 }
 
-static QString firstTokenUpper(QString s)
+void MainWindow::runScript(const QVector<SqlStatement>& statements, const QString& selectedDb)
 {
-    s = s.trimmed();
-    if (s.isEmpty()) return {};
-
-    while (s.startsWith("--")) {
-        int nl = s.indexOf('\n');
-        if (nl < 0) return {};
-        s = s.mid(nl + 1).trimmed();
+    if (!m_script) {
+        m_script = new ScriptResultsWidget(m_query);
+        m_script->setStats(m_stats);
+        connect(m_script, &ScriptResultsWidget::statementSucceeded, this, [this](const QString& sql){
+            noteExecuted(sql, m_pendingDb, &m_scriptDbLevel, &m_scriptDbs);
+        });
+        connect(m_script, &ScriptResultsWidget::scriptFinished, this, &MainWindow::onScriptFinished);
     }
+    if (m_resultTabs->indexOf(m_script) < 0) m_resultTabs->addTab(m_script, "Script");
 
-    while (s.startsWith("/*")) {
-        int end = s.indexOf("*/");
-        if (end < 0) return {};
-        s = s.mid(end + 2).trimmed();
+    QString err;
+    if (!m_script->run(statements, !m_console->continueOnError(), &err)) {
+        m_console->setStatusError(err);
+        return;
     }
 
-    int i = 0;
-    while (i < s.size() && !s[i].isSpace() && s[i] != ';') i++;
-    return s.left(i).toUpper();
+    m_resultTabs->setCurrentWidget(m_script);
+    m_pendingDb = selectedDb;
+    m_scriptDbLevel = false;
+    m_scriptDbs.clear();
+    m_console->setRunning(true);
 }
 
-static bool isDbLevelDdl(const QString& sql)
+void MainWindow::onScriptFinished(bool ok, const QString& message)
 {
-    const QString t = firstTokenUpper(sql);
-    if (t == "CREATE" || t == "DROP" || t == "ALTER" || t == "RENAME") {
-        const QString u = sql.trimmed().toUpper();
-        return u.contains(" DATABASE ") || u.contains(" SCHEMA ");
-    }
-    return false;
-}
+    m_console->setRunning(false);
+    m_history->add(m_historySql, m_profileName, m_pendingDb.isEmpty() ? m_consoleDb : m_pendingDb,
+                   m_console->elapsedMs(), -1);
+    m_pendingDb.clear();
 
-static bool isTableLevelDdlOrDmlThatAffectsMetadata(const QString& sql)
-{
-    const QString t = firstTokenUpper(sql);
-    if (t == "CREATE" || t == "DROP" || t == "ALTER" || t == "RENAME" || t == "TRUNCATE")
-        return true;
+    const QString msg = QString("%1 (%2 ms)").arg(message).arg(m_console->elapsedMs());
+    if (ok) m_console->setStatusOk(msg);
+    else    m_console->setStatusError(msg);
 
-    return false;
+    // Aunque alguna falle, las anteriores pudieron cambiar el esquema
+    refreshAfterSql(m_scriptDbLevel, m_scriptDbs);
 }
 
-void MainWindow::executeSql(const QString& sql)
+void MainWindow::noteExecuted(const QString& sql, const QString& selectedDb,
+                              bool* dbLevel, QSet<QString>* changedDbs)
 {
-    QString selectedDb;
-    if (auto* it = m_tree->currentItem()) {
-        const QString type = typeOf(it);
-
-        if (type == "db") {
-            selectedDb = nameOf(it);
-        } else if (type == "table") {
-            selectedDb = dbOf(it);
+    if (SqlText::firstTokenUpper(sql) == "USE") {
+        const QStringList parts = sql.trimmed().split(QRegularExpression("\\s+"));
+        if (parts.size() >= 2) {
+            QString db = parts[1];
+            db.remove('`');
+            db.remove(';');
+            m_consoleDb = db;
         }
     }
 
-    QString err;
-    const bool ok = m_results->setQuery(sql, "odbc_conn", &err);
-
-    if (!ok) {
-        m_console->setStatusError(err);
-        return;
+    // Invalidar en la caché sólo lo que tocó la sentencia
+    const QString defaultDb = !selectedDb.isEmpty() ? selectedDb : m_consoleDb;
+    const auto targets = SqlText::ddlTargets(sql);
+    const bool dbDdl = SqlText::isDbLevelDdl(sql);
+    const bool tableDdl = !dbDdl && SqlText::isTableLevelDdlOrDmlThatAffectsMetadata(sql);
+    bool located = false;
+    for (const auto& t : targets) {
+        const QString db = t.db.isEmpty() ? defaultDb : t.db;
+        if (t.kind == "index") m_meta.invalidate(db, "index", t.table);
+        else                   m_meta.invalidate(db, t.kind, t.name);
+        if (tableDdl && !db.isEmpty()) {
+            changedDbs->insert(db);
+            located = true;
+        }
     }
 
-    m_console->setStatusOk("OK");
-
-    // Refrescar metadatos SOLO si hubo cambios estructurales
-    if (isDbLevelDdl(sql)) {
-        loadDatabases();
+    if (dbDdl) *dbLevel = true;
 
-        if (!selectedDb.isEmpty()) {
-            auto* root = m_tree->topLevelItem(0);
-            if (root) {
-                for (int i=0; i<root->childCount(); ++i) {
-                    if (root->child(i)->text(0) == selectedDb) {
-                        root->child(i)->setExpanded(true);
-                        break;
-                    }
-                }
-            }
+    // DDL que no se supo analizar: descartar la base entera para que el refresco la vea
+    if ((dbDdl || tableDdl) && targets.isEmpty()) {
+        if (defaultDb.isEmpty()) {
+            m_meta.invalidateAll();
+            *dbLevel = true;
+        } else {
+            m_meta.invalidateDatabase(defaultDb);
+            if (tableDdl) changedDbs->insert(defaultDb);
         }
-        return;
     }
+    // Objetos sin base (ni USE previo): no se sabe qué nodo refrescar
+    if (tableDdl && !targets.isEmpty() && !located) *dbLevel = true;
+}
 
-    if (isTableLevelDdlOrDmlThatAffectsMetadata(sql)) {
-        if (selectedDb.isEmpty()) {
-            loadDatabases();
-        } else {
-            refreshDatabaseNode(selectedDb);
-        }
+void MainWindow::refreshAfterSql(bool dbLevel, const QSet<QString>& changedDbs)
+{
+    // Refrescar metadatos SOLO si hubo cambios estructurales, y sólo en las bases tocadas:
+    // el árbol entero únicamente tras CREATE/DROP DATABASE.
+    if (dbLevel) {
+        m_treeModel->refresh();
+        return;
     }
+    for (const auto& db : changedDbs) m_treeModel->refreshDatabase(db);
 }
 
 QString MainWindow::exportBaseDir() const
@@ -491,29 +576,9 @@ QString MainWindow::exportBaseDir() const
     return dir.filePath(sub);
 }
 
-static QString stripTrailingSemicolon(QString s)
+QString MainWindow::ddlForItem(const QModelIndex& it)
 {
-    s = s.trimmed();
-    if (s.endsWith(';')) s.chop(1);
-    return s.trimmed();
-}
-
-static QString wrapWithDelimiter(const QString& ddl, const QString& delim)
-{
-    const QString body = stripTrailingSemicolon(ddl);
-    if (body.isEmpty()) return {};
-
-    QString out;
-    out += QString("DELIMITER %1\n").arg(delim);
-    out += body;
-    out += QString("%1\n").arg(delim);
-    out += "DELIMITER ;\n";
-    return out;
-}
-
-QString MainWindow::ddlForItem(QTreeWidgetItem* it)
-{
-    if (!it) return {};
+    if (!it.isValid()) return {};
 
     const QString t = typeOf(it);
 
@@ -557,55 +622,12 @@ QString MainWindow::ddlForItem(QTreeWidgetItem* it)
 QString MainWindow::ddlForDatabaseGeneral(const QString& dbName)
 {
     if (dbName.trimmed().isEmpty()) return {};
-
-    const QString db = dbName;
-    QString out;
-    out += "-- DDL General (export)\n";
-    out += "-- Generado: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n\n";
-    out += QString("CREATE DATABASE IF NOT EXISTS %1;\n").arg(DbSession::q(db));
-    out += QString("USE %1;\n\n").arg(DbSession::q(db));
-
-    // Tablas (incluye índices dentro del CREATE TABLE)
-    const auto tables = m_meta.listTables(db);
-    for (const auto& t : tables) {
-        out += "-- Tabla: " + t + "\n";
-        out += m_meta.showCreateTable(db, t) + "\n\n";
-    }
-
-    // Vistas
-    const auto views = m_meta.listViews(db);
-    for (const auto& v : views) {
-        out += "-- Vista: " + v + "\n";
-        out += m_meta.showCreateView(db, v) + "\n\n";
-    }
-
-    // Rutinas y triggers requieren delimitador para ejecutarse como script
-    const QString delim = "$$";
-
-    const auto funcs = m_meta.listFunctions(db);
-    for (const auto& fn : funcs) {
-        out += "-- Función: " + fn + "\n";
-        out += wrapWithDelimiter(m_meta.showCreateFunction(db, fn), delim) + "\n";
-    }
-
-    const auto procs = m_meta.listProcedures(db);
-    for (const auto& sp : procs) {
-        out += "-- Procedimiento: " + sp + "\n";
-        out += wrapWithDelimiter(m_meta.showCreateProcedure(db, sp), delim) + "\n";
-    }
-
-    const auto triggers = m_meta.listTriggers(db);
-    for (const auto& tr : triggers) {
-        out += "-- Trigger: " + tr + "\n";
-        out += wrapWithDelimiter(m_meta.showCreateTrigger(db, tr), delim) + "\n";
-    }
-
-    return out;
+    return DdlExporter::databaseDdl(m_meta, dbName);
 }
 
-QString MainWindow::suggestedDdlFileNameForItem(QTreeWidgetItem* it) const
+QString MainWindow::suggestedDdlFileNameForItem(const QModelIndex& it) const
 {
-    if (!it) return "ddl.sql";
+    if (!it.isValid()) return "ddl.sql";
 
     const QString t = typeOf(it);
 
@@ -620,7 +642,7 @@ QString MainWindow::suggestedDdlFileNameForItem(QTreeWidgetItem* it) const
     return "ddl.sql";
 }
 
-QString MainWindow::exportFilePathForItem(QTreeWidgetItem* it) const
+QString MainWindow::exportFilePathForItem(const QModelIndex& it) const
 {
     QDir dir(exportBaseDir());
     QString fileName = suggestedDdlFileNameForItem(it);
@@ -639,29 +661,24 @@ QString MainWindow::exportFilePathForItem(QTreeWidgetItem* it) const
     return dir.filePath(QString("%1_%2").arg(fileName, ts));
 }
 
-QString MainWindow::exportFilePathForDatabaseGeneral(const QString& dbName) const
+QString MainWindow::exportFilePathForDatabaseGeneral(const QString& dbName, bool gzip) const
 {
     QDir dir(exportBaseDir());
-    QString fileName = QString("%1_ddl_general.sql").arg(dbName);
-    fileName.replace('`', "");
-    fileName.replace(' ', "_");
+    QString base = QString("%1_ddl_general").arg(dbName);
+    base.replace('`', "");
+    base.replace(' ', "_");
+    const QString ext = gzip ? ".sql.gz" : ".sql";
 
-    QString full = dir.filePath(fileName);
+    QString full = dir.filePath(base + ext);
     if (!QFile::exists(full)) return full;
 
     const QString ts = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
-    const int dot = fileName.lastIndexOf('.');
-    if (dot > 0) {
-        const QString n = fileName.left(dot);
-        const QString ext = fileName.mid(dot);
-        return dir.filePath(QString("%1_%2%3").arg(n, ts, ext));
-    }
-    return dir.filePath(QString("%1_%2").arg(fileName, ts));
+    return dir.filePath(QString("%1_%2%3").arg(base, ts, ext));
 }
 
-void MainWindow::exportDdlForItem(QTreeWidgetItem* it)
+void MainWindow::exportDdlForItem(const QModelIndex& it)
 {
-    if (!it) return;
+    if (!it.isValid()) return;
 
     const QString ddl = ddlForItem(it);
     if (ddl.trimmed().isEmpty()) {
@@ -686,26 +703,217 @@ void MainWindow::exportDdlForItem(QTreeWidgetItem* it)
     m_console->setStatusOk("Exportado: " + path);
 }
 
-void MainWindow::exportDdlGeneralForDatabase(const QString& dbName)
+void MainWindow::exportDdlGeneralForDatabase(const QString& dbName, bool gzip)
 {
-    const QString ddl = ddlForDatabaseGeneral(dbName);
-    if (ddl.trimmed().isEmpty()) {
-        QMessageBox::warning(this, "DDL General", "No se pudo generar el DDL general para la base seleccionada.");
+    startDdlExport(QStringList() << dbName, exportFilePathForDatabaseGeneral(dbName, gzip), gzip);
+}
+
+void MainWindow::exportDdlGeneralForServer(bool gzip)
+{
+    QStringList dbs;
+    for (const auto& db : m_meta.listDatabases()) {
+        if (!m_showSystemSchemas && ObjectTreeModel::isSystemSchema(db))
+            continue;
+        dbs << db;
+    }
+    startDdlExport(dbs, exportFilePathForDatabaseGeneral("servidor", gzip), gzip);
+}
+
+void MainWindow::startDdlExport(const QStringList& dbs, const QString& path, bool gzip)
+{
+    if (!m_exporter) {
+        m_exporter = new DdlExporter(&m_session, this);
+
+        connect(m_exporter, &DdlExporter::progress, this, [this](int done, int total){
+            if (!m_exportProgress) return;
+            m_exportProgress->setMaximum(qMax(total, 1));
+            m_exportProgress->setValue(done);
+            m_exportProgress->setLabelText(QString("Exportando DDL... %1 / %2 objetos").arg(done).arg(total));
+        });
+
+        connect(m_exporter, &DdlExporter::finished, this, [this](bool ok, const QString& message){
+            if (m_exportProgress) {
+                m_exportProgress->deleteLater();
+                m_exportProgress = nullptr;
+            }
+            if (ok) m_console->setStatusOk(message);
+            else    m_console->setStatusError(message);
+        });
+    }
+
+    QSettings st("UNITEC", "Database-Manager");
+    const int workers = st.value("export/workers", 4).toInt();
+
+    QString err;
+    if (!m_exporter->start(dbs, path, gzip, workers, &err)) {
+        QMessageBox::critical(this, "Exportar DDL General", err);
         return;
     }
 
-    const QString path = exportFilePathForDatabaseGeneral(dbName);
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Exportar DDL General", "No se pudo escribir el archivo:\n" + path);
+    m_exportProgress = new QProgressDialog("Exportando DDL...", "Cancelar", 0, 1, this);
+    m_exportProgress->setWindowModality(Qt::WindowModal);
+    m_exportProgress->setMinimumDuration(300);
+    m_exportProgress->setAutoClose(false);
+    m_exportProgress->setAutoReset(false);
+    connect(m_exportProgress, &QProgressDialog::canceled, m_exporter, &DdlExporter::cancel);
+}
+
+void MainWindow::openTableData(const QString& dbName, const QString& table)
+{
+    // Si ya está abierta, sólo se activa
+    for (int i = 0; i < m_resultTabs->count(); ++i) {
+        auto* b = qobject_cast<TableDataBrowser*>(m_resultTabs->widget(i));
+        if (b && b->database() == dbName && b->table() == table) {
+            m_resultTabs->setCurrentIndex(i);
+            return;
+        }
+    }
+
+    const QStringList keys = m_meta.keyColumns(dbName, table);
+    auto* browser = new TableDataBrowser(&m_session, dbName, table, keys, m_meta.listColumns(dbName, table),
+                                         m_meta.largeColumns(dbName, table),
+                                         m_meta.fractionalColumns(dbName, table));
+    browser->setStats(m_stats);
+    browser->setProfileName(m_profileName);
+    const int idx = m_resultTabs->addTab(browser, QString("%1.%2").arg(dbName, table));
+    m_resultTabs->setCurrentIndex(idx);
+
+    if (keys.isEmpty())
+        m_console->setStatusError("La tabla no tiene llave primaria ni índice único: sin paginación por llave.");
+}
+
+void MainWindow::openSnapshot()
+{
+    QSettings st("UNITEC", "Database-Manager");
+    const QString path = QFileDialog::getOpenFileName(this, "Abrir instantánea de resultados",
+                                                      st.value("snapshots/lastDir", QDir::homePath()).toString(),
+                                                      "Instantáneas de resultados (*.dmsnap)");
+    if (path.isEmpty()) return;
+    st.setValue("snapshots/lastDir", QFileInfo(path).absolutePath());
+
+    auto* view = new ResultTableWidget(nullptr);
+    QString err;
+    if (!view->openSnapshot(path, &err)) {
+        delete view;
+        QMessageBox::warning(this, "Abrir instantánea", err);
         return;
     }
+    const int idx = m_resultTabs->addTab(view, QFileInfo(path).completeBaseName());
+    m_resultTabs->setTabToolTip(idx, path);
+    m_resultTabs->setCurrentIndex(idx);
+}
 
-    QTextStream ts(&f);
-    ts << ddl;
-    f.close();
+void MainWindow::compareTableData(const QString& dbName, const QString& table)
+{
+    const QStringList keys = m_meta.keyColumns(dbName, table);
+    if (keys.isEmpty()) {
+        QMessageBox::warning(this, "Comparar datos",
+                             "La tabla no tiene llave primaria ni índice único: no se puede partir por rangos.");
+        return;
+    }
 
-    m_console->setStatusOk("Exportado: " + path);
+    // Otro perfil (u otro servidor) como destino
+    LoginDialog dlg(this);
+    dlg.setWindowTitle(QString("Comparar %1.%2: conexión de destino").arg(dbName, table));
+    if (dlg.exec() != QDialog::Accepted) return;
+    const ConnectionProfile target = dlg.profile();
+
+    bool ok = false;
+    const QString targetDb = QInputDialog::getText(this, "Comparar datos", "Base de datos en el destino:",
+                                                   QLineEdit::Normal, dbName, &ok).trimmed();
+    if (!ok || targetDb.isEmpty()) return;
+
+    auto* panel = new DataComparePanel(&m_session);
+    QString err;
+    if (!panel->start(dlg.dsn(), target.name.isEmpty() ? target.host : target.name, dbName, targetDb,
+                      table, keys, m_meta.listColumns(dbName, table), &err)) {
+        delete panel;
+        QMessageBox::critical(this, "Comparar datos", err);
+        return;
+    }
+    connect(panel, &DataComparePanel::finished, this, [this](bool ok, const QString& message){
+        if (ok) m_console->setStatusOk(message);
+        else    m_console->setStatusError(message);
+    });
+
+    const int idx = m_resultTabs->addTab(panel, QString("Comparar %1.%2").arg(dbName, table));
+    m_resultTabs->setCurrentIndex(idx);
+}
+
+void MainWindow::compareSchema(const QString& dbName)
+{
+    if (m_schemaDiff && m_schemaDiff->isRunning()) {
+        QMessageBox::information(this, "Comparar esquema", "Ya hay una comparación de esquemas en curso.");
+        return;
+    }
+
+    bool ok = false;
+    const QStringList choices{"Otra base de esta conexión", "Otra conexión (perfil)..."};
+    const QString choice = QInputDialog::getItem(this, "Comparar esquema",
+                                                 QString("Destino de la migración (quedará como %1):").arg(dbName),
+                                                 choices, 0, false, &ok);
+    if (!ok) return;
+
+    QString connStr;
+    QString targetDb;
+    if (choice == choices[0]) {
+        QStringList dbs = m_meta.listDatabases();
+        dbs.removeAll(dbName);
+        if (dbs.isEmpty()) {
+            QMessageBox::information(this, "Comparar esquema", "No hay otra base en esta conexión.");
+            return;
+        }
+        targetDb = QInputDialog::getItem(this, "Comparar esquema", "Base de destino:", dbs, 0, false, &ok);
+        if (!ok) return;
+    } else {
+        LoginDialog dlg(this);
+        dlg.setWindowTitle(QString("Comparar esquema de %1: conexión de destino").arg(dbName));
+        if (dlg.exec() != QDialog::Accepted) return;
+        connStr = dlg.dsn();
+        targetDb = QInputDialog::getText(this, "Comparar esquema", "Base de datos en el destino:",
+                                         QLineEdit::Normal, dbName, &ok).trimmed();
+        if (!ok || targetDb.isEmpty()) return;
+    }
+
+    if (!m_schemaDiff) {
+        m_schemaDiff = new SchemaDiff(&m_session, this);
+
+        connect(m_schemaDiff, &SchemaDiff::progress, this, [this](int done, int total){
+            if (!m_diffProgress) return;
+            m_diffProgress->setMaximum(qMax(total, 1));
+            m_diffProgress->setValue(done);
+            m_diffProgress->setLabelText(QString("Comparando esquemas... %1 / %2 objetos").arg(done).arg(total));
+        });
+
+        connect(m_schemaDiff, &SchemaDiff::finished, this, [this](bool ok, const QString& message){
+            if (m_diffProgress) {
+                m_diffProgress->deleteLater();
+                m_diffProgress = nullptr;
+            }
+            if (ok) {
+                m_ddl->setPlainText(m_schemaDiff->script());
+                m_console->setStatusOk(message);
+            } else {
+                m_console->setStatusError(message);
+            }
+        });
+    }
+
+    QSettings st("UNITEC", "Database-Manager");
+    const int workers = st.value("export/workers", 4).toInt();
+
+    QString err;
+    if (!m_schemaDiff->start(dbName, connStr, targetDb, workers, &err)) {
+        QMessageBox::critical(this, "Comparar esquema", err);
+        return;
+    }
+
+    m_diffProgress = new QProgressDialog("Comparando esquemas...", "Cancelar", 0, 1, this);
+    m_diffProgress->setWindowModality(Qt::WindowModal);
+    m_diffProgress->setMinimumDuration(300);
+    m_diffProgress->setAutoClose(false);
+    m_diffProgress->setAutoReset(false);
+    connect(m_diffProgress, &QProgressDialog::canceled, m_schemaDiff, &SchemaDiff::cancel);
 }
 
 void MainWindow::centerOnScreen()
@@ -2,53 +2,107 @@
 
 #pragma once
 #include <QMainWindow>
+#include <QPointer>
+#include <QSet>
 #include "DbSession.h"
 #include "MetadataService.h"
+#include "SqlText.h"
 
-class QTreeWidgetItem;
-class QTreeWidget;
+class QTreeView;
+class QModelIndex;
+class ObjectTreeModel;
 class QPlainTextEdit;
 class ResultTableWidget;
 class SqlConsoleWidget;
+class QuerySession;
+class QTabWidget;
+class QProgressDialog;
+class DdlExporter;
+class ScriptResultsWidget;
+class QueryStats;
+class TimingPanel;
+class QueryHistory;
+class HistoryPanel;
+class SqlCompleter;
+class SchemaDiff;
+class PlanViewer;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
     explicit MainWindow(QWidget* parent = nullptr);
+    ~MainWindow() override;
     bool isReady() const { return m_ready; }
 
 private:
     void buildUi();
     void loadDatabases();
-    void loadDbChildren(const QString& dbName);
-    void loadTableChildren(QTreeWidgetItem* tableNode);
 
     bool m_ready = false;
     void centerOnScreen();
 
     void showDdlForNode();
     void executeSql(const QString& sql);
+    void explainSql(const QString& sql, bool analyze);
+    void showIndexDefinition(const QString& db, const QString& table, const QString& index);
+    void onSqlFinished(bool ok, const QString& message);
+    void runScript(const QVector<SqlStatement>& statements, const QString& selectedDb);
+    void onScriptFinished(bool ok, const QString& message);
+    // dbLevel: CREATE/DROP DATABASE o DDL sin base conocida (se refresca el árbol entero);
+    // changedDbs: bases cuyo esquema cambió (solo se refrescan sus nodos).
+    void noteExecuted(const QString& sql, const QString& selectedDb, bool* dbLevel, QSet<QString>* changedDbs);
+    void refreshAfterSql(bool dbLevel, const QSet<QString>& changedDbs);
     void refreshDatabaseNode(const QString& dbName);
 
-    QString ddlForItem(QTreeWidgetItem* it);
+    QString ddlForItem(const QModelIndex& it);
     QString ddlForDatabaseGeneral(const QString& dbName);
-    QString suggestedDdlFileNameForItem(QTreeWidgetItem* it) const;
+    QString suggestedDdlFileNameForItem(const QModelIndex& it) const;
 
     QString exportBaseDir() const;
-    QString exportFilePathForItem(QTreeWidgetItem* it) const;
-    QString exportFilePathForDatabaseGeneral(const QString& dbName) const;
+    QString exportFilePathForItem(const QModelIndex& it) const;
+    QString exportFilePathForDatabaseGeneral(const QString& dbName, bool gzip) const;
 
-    void exportDdlForItem(QTreeWidgetItem* it);
-    void exportDdlGeneralForDatabase(const QString& dbName);
+    void exportDdlForItem(const QModelIndex& it);
+    void exportDdlGeneralForDatabase(const QString& dbName, bool gzip);
+    void exportDdlGeneralForServer(bool gzip);
+    void startDdlExport(const QStringList& dbs, const QString& path, bool gzip);
+
+    void openTableData(const QString& dbName, const QString& table);
+    void openSnapshot();
+    void compareTableData(const QString& dbName, const QString& table);
+    void compareSchema(const QString& dbName);
 
 private:
     DbSession m_session;
     MetadataService m_meta;
+    QuerySession* m_query = nullptr;
+    DdlExporter* m_exporter = nullptr;
+    QProgressDialog* m_exportProgress = nullptr;
+    SchemaDiff* m_schemaDiff = nullptr;
+    QProgressDialog* m_diffProgress = nullptr;
+    QueryStats* m_stats = nullptr;
+    QueryHistory* m_history = nullptr;
+    QString m_profileName;   // perfil de conexión, para el historial
 
-    QTreeWidget* m_tree = nullptr;
+    QTreeView* m_tree = nullptr;
+    ObjectTreeModel* m_treeModel = nullptr;
+    QTabWidget* m_resultTabs = nullptr;
     ResultTableWidget* m_results = nullptr;
+    TimingPanel* m_timing = nullptr;
+    HistoryPanel* m_historyPanel = nullptr;
     QPlainTextEdit* m_ddl = nullptr;
     SqlConsoleWidget* m_console = nullptr;
+    SqlCompleter* m_completer = nullptr;
 
     bool m_showSystemSchemas = false;
+
+    // Consulta en curso (para refrescar metadatos al terminar)
+    QString m_pendingSql;
+    QString m_pendingDb;
+    QString m_consoleDb;   // último USE ejecutado en la consola
+    QString m_historySql;  // texto completo enviado por la consola (sentencia o script)
+    QPointer<ScriptResultsWidget> m_script;
+    QPointer<PlanViewer> m_plan;
+    bool m_scriptDbLevel = false;
+    QSet<QString> m_scriptDbs;
 };
@@ -0,0 +1,787 @@
+#include "MariaDbDriver.h"
+#include "DbSession.h"
+#include <mysql.h>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlField>
+#include <QSqlRecord>
+#include <QSqlResult>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <QVector>
+#include <cstring>
+
+namespace {
+
+const unsigned kBinaryCharset = 63;
+const unsigned long kStringBuffer = 64 * 1024;   // lo más largo se pide aparte (mysql_stmt_fetch_column)
+const unsigned kUnsupportedPs = 1295;            // ER_UNSUPPORTED_PS
+
+struct FieldInfo {
+    QString name;
+    QString table;
+    enum_field_types type;
+    unsigned flags;
+    unsigned charset;
+    unsigned long length;
+    int metaType;
+};
+
+int metaTypeFor(const MYSQL_FIELD& f)
+{
+    switch (f.type) {
+    case MYSQL_TYPE_TINY: case MYSQL_TYPE_SHORT: case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24: case MYSQL_TYPE_YEAR:
+        return QMetaType::LongLong;
+    case MYSQL_TYPE_LONGLONG:
+        return (f.flags & UNSIGNED_FLAG) ? QMetaType::ULongLong : QMetaType::LongLong;
+    case MYSQL_TYPE_BIT:
+        return QMetaType::ULongLong;
+    case MYSQL_TYPE_FLOAT: case MYSQL_TYPE_DOUBLE:
+        return QMetaType::Double;
+    case MYSQL_TYPE_DATE: case MYSQL_TYPE_NEWDATE:
+        return QMetaType::QDate;
+    case MYSQL_TYPE_DATETIME: case MYSQL_TYPE_TIMESTAMP:
+        return QMetaType::QDateTime;
+    case MYSQL_TYPE_TIME:
+        return QMetaType::QTime;
+    case MYSQL_TYPE_TINY_BLOB: case MYSQL_TYPE_MEDIUM_BLOB: case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB: case MYSQL_TYPE_STRING: case MYSQL_TYPE_VAR_STRING: case MYSQL_TYPE_GEOMETRY:
+        return f.charsetnr == kBinaryCharset ? QMetaType::QByteArray : QMetaType::QString;
+    default:
+        // DECIMAL conserva todos sus dígitos como texto
+        return QMetaType::QString;
+    }
+}
+
+QVariant nullOf(int type)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return QVariant(QMetaType(type));
+#else
+    return QVariant(QVariant::Type(type));
+#endif
+}
+
+QSqlField sqlField(const FieldInfo& f)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QSqlField field(f.name, QMetaType(f.metaType), f.table);
+#else
+    QSqlField field(f.name, QVariant::Type(f.metaType));
+    field.setTableName(f.table);
+#endif
+    field.setRequiredStatus((f.flags & NOT_NULL_FLAG) ? QSqlField::Required : QSqlField::Optional);
+    field.setAutoValue(f.flags & AUTO_INCREMENT_FLAG);
+    return field;
+}
+
+// BIT(n) llega como bytes big-endian
+qulonglong bits(const char* p, unsigned long n)
+{
+    qulonglong v = 0;
+    for (unsigned long i = 0; i < n; ++i) v = (v << 8) | uchar(p[i]);
+    return v;
+}
+
+// Protocolo de texto
+QVariant fromText(const char* p, unsigned long n, const FieldInfo& f)
+{
+    const QByteArray raw = QByteArray::fromRawData(p, int(n));
+    switch (f.metaType) {
+    case QMetaType::LongLong:
+        return qlonglong(raw.toLongLong());
+    case QMetaType::ULongLong:
+        return f.type == MYSQL_TYPE_BIT ? bits(p, n) : qulonglong(raw.toULongLong());
+    case QMetaType::Double:
+        return raw.toDouble();
+    case QMetaType::QDate: {
+        const QDate d = QDate::fromString(QString::fromLatin1(raw), Qt::ISODate);
+        return d.isValid() ? QVariant(d) : QVariant(QString::fromLatin1(raw));   // 0000-00-00
+    }
+    case QMetaType::QDateTime: {
+        const QString s = QString::fromLatin1(raw);
+        const QDateTime dt = QDateTime::fromString(QString(s).replace(' ', 'T'), Qt::ISODateWithMs);
+        return dt.isValid() ? QVariant(dt) : QVariant(s);
+    }
+    case QMetaType::QTime: {
+        const QString s = QString::fromLatin1(raw);
+        const QTime t = QTime::fromString(s, Qt::ISODateWithMs);
+        return t.isValid() ? QVariant(t) : QVariant(s);   // TIME fuera de 00..23 h
+    }
+    case QMetaType::QByteArray:
+        return QByteArray(p, int(n));
+    default:
+        return QString::fromUtf8(p, int(n));
+    }
+}
+
+// Protocolo binario
+QVariant fromTime(const MYSQL_TIME& t, const FieldInfo& f)
+{
+    const QTime time(int(t.hour), int(t.minute), int(t.second), int(t.second_part / 1000));
+    if (f.metaType == QMetaType::QTime) {
+        if (!t.neg && t.hour < 24) return time;
+        return QString("%1%2:%3:%4").arg(t.neg ? "-" : "").arg(t.hour, 2, 10, QChar('0'))
+                                    .arg(t.minute, 2, 10, QChar('0')).arg(t.second, 2, 10, QChar('0'));
+    }
+    const QDate date(int(t.year), int(t.month), int(t.day));
+    if (!date.isValid()) {
+        return f.metaType == QMetaType::QDate ? QString("0000-00-00") : QString("0000-00-00 00:00:00");
+    }
+    if (f.metaType == QMetaType::QDate) return date;
+    return QDateTime(date, time);
+}
+
+} // namespace
+
+class MariaDbResult : public QSqlResult {
+public:
+    explicit MariaDbResult(const MariaDbDriver* d) : QSqlResult(d), drv(d) {}
+    ~MariaDbResult() override { cleanup(); }
+
+    // La conexión pasa a otra sentencia: se descarta lo pendiente de esta.
+    void detach()
+    {
+        cleanup();
+        setActive(false);
+        setAt(QSql::AfterLastRow);
+    }
+
+protected:
+    QVariant data(int i) override;
+    bool isNull(int i) override;
+    bool reset(const QString& sql) override;
+    bool prepare(const QString& sql) override;
+    bool exec() override;
+    bool fetch(int i) override;
+    bool fetchNext() override;
+    bool fetchFirst() override;
+    bool fetchLast() override;
+    int size() override { return isSelect() ? rows : -1; }
+    int numRowsAffected() override { return isSelect() ? rows : int(affected); }
+    QVariant lastInsertId() const override { return insertId ? QVariant(qulonglong(insertId)) : QVariant(); }
+    QSqlRecord record() const override;
+
+private:
+    struct Column {
+        QByteArray buffer;
+        unsigned long length = 0;
+        my_bool null = 0;
+        my_bool error = 0;
+    };
+
+    MYSQL* mysql() const { return drv->mysql; }
+    bool fail(const QString& text, unsigned code, const char* message);
+    void readFields(MYSQL_RES* meta);
+    bool bindParams();
+    bool bindResult();
+    bool fetchTruncated();
+    void finishStream();
+    void cleanup();
+
+    const MariaDbDriver* drv;
+    MYSQL_STMT* stmt = nullptr;
+    MYSQL_RES* res = nullptr;          // texto: las filas; binario: los metadatos
+    MYSQL_ROW row = nullptr;
+    unsigned long* lengths = nullptr;
+    QString textSql;                   // preparada que el servidor no admite: va como texto
+    bool streaming = false;
+    int rows = -1;
+    quint64 affected = 0;
+    quint64 insertId = 0;
+
+    QVector<FieldInfo> fields;
+    QVector<Column> columns;
+    QVector<MYSQL_BIND> binds;
+    // Parámetros: deben vivir hasta mysql_stmt_execute
+    QVector<MYSQL_BIND> params;
+    QVector<QByteArray> paramData;
+    QVector<my_bool> paramNull;
+};
+
+bool MariaDbResult::fail(const QString& text, unsigned code, const char* message)
+{
+    setLastError(QSqlError(text, QString::fromUtf8(message), QSqlError::StatementError, QString::number(code)));
+    drv->release(this);
+    return false;
+}
+
+void MariaDbResult::readFields(MYSQL_RES* meta)
+{
+    fields.clear();
+    const unsigned n = mysql_num_fields(meta);
+    const MYSQL_FIELD* f = mysql_fetch_fields(meta);
+    fields.reserve(int(n));
+    for (unsigned i = 0; i < n; ++i) {
+        FieldInfo info;
+        info.name = QString::fromUtf8(f[i].name);
+        info.table = QString::fromUtf8(f[i].org_table);
+        info.type = f[i].type;
+        info.flags = f[i].flags;
+        info.charset = f[i].charsetnr;
+        info.length = f[i].length;
+        info.metaType = metaTypeFor(f[i]);
+        fields << info;
+    }
+}
+
+void MariaDbResult::finishStream()
+{
+    // Leídas todas las filas: la conexión queda libre aunque el QSqlQuery siga vivo
+    if (!streaming) return;
+    streaming = false;
+    if (stmt) {
+        mysql_stmt_free_result(stmt);
+        while (mysql_stmt_more_results(stmt) && mysql_stmt_next_result(stmt) == 0)
+            mysql_stmt_free_result(stmt);
+    } else {
+        if (res) { mysql_free_result(res); res = nullptr; }
+        while (mysql_more_results(mysql()) && mysql_next_result(mysql()) == 0) {
+            if (MYSQL_RES* extra = mysql_store_result(mysql())) mysql_free_result(extra);
+        }
+    }
+    drv->release(this);
+}
+
+void MariaDbResult::cleanup()
+{
+    if (mysql()) finishStream();
+    if (res) { mysql_free_result(res); res = nullptr; }
+    if (stmt) { mysql_stmt_close(stmt); stmt = nullptr; }
+    drv->release(this);
+    row = nullptr;
+    lengths = nullptr;
+    rows = -1;
+    affected = 0;
+    insertId = 0;
+    fields.clear();
+    columns.clear();
+    binds.clear();
+}
+
+bool MariaDbResult::reset(const QString& sql)
+{
+    cleanup();
+    textSql.clear();
+    setActive(false);
+    setAt(QSql::BeforeFirstRow);
+    if (!mysql()) return false;
+    drv->claim(this);
+
+    const QByteArray q = sql.toUtf8();
+    if (mysql_real_query(mysql(), q.constData(), q.size()))
+        return fail("No se pudo ejecutar la consulta", mysql_errno(mysql()), mysql_error(mysql()));
+
+    if (mysql_field_count(mysql()) == 0) {
+        affected = mysql_affected_rows(mysql());
+        insertId = mysql_insert_id(mysql());
+        while (mysql_more_results(mysql()) && mysql_next_result(mysql()) == 0) {
+            if (MYSQL_RES* extra = mysql_store_result(mysql())) mysql_free_result(extra);
+        }
+        drv->release(this);
+        setSelect(false);
+        setActive(true);
+        return true;
+    }
+
+    streaming = isForwardOnly();
+    res = streaming ? mysql_use_result(mysql()) : mysql_store_result(mysql());
+    if (!res) {
+        streaming = false;
+        return fail("No se pudo leer el resultado", mysql_errno(mysql()), mysql_error(mysql()));
+    }
+    readFields(res);
+    if (!streaming) {
+        rows = int(mysql_num_rows(res));
+        // Resultados extra (CALL): se descartan para dejar la conexión libre
+        while (mysql_more_results(mysql()) && mysql_next_result(mysql()) == 0) {
+            if (MYSQL_RES* extra = mysql_store_result(mysql())) mysql_free_result(extra);
+        }
+        drv->release(this);
+    }
+    setSelect(true);
+    setActive(true);
+    return true;
+}
+
+bool MariaDbResult::prepare(const QString& sql)
+{
+    cleanup();
+    textSql.clear();
+    setActive(false);
+    setAt(QSql::BeforeFirstRow);
+    if (!mysql()) return false;
+    drv->claim(this);
+
+    stmt = mysql_stmt_init(mysql());
+    if (!stmt) return fail("No se pudo preparar la sentencia", mysql_errno(mysql()), mysql_error(mysql()));
+
+    const QByteArray q = sql.toUtf8();
+    if (mysql_stmt_prepare(stmt, q.constData(), q.size())) {
+        const unsigned code = mysql_stmt_errno(stmt);
+        const QByteArray message = mysql_stmt_error(stmt);
+        mysql_stmt_close(stmt);
+        stmt = nullptr;
+        if (code == kUnsupportedPs) {
+            textSql = sql;
+            drv->release(this);
+            return true;
+        }
+        return fail("No se pudo preparar la sentencia", code, message.constData());
+    }
+    drv->release(this);
+    return true;
+}
+
+bool MariaDbResult::bindParams()
+{
+    const QVariantList values = boundValues();
+    const int n = int(mysql_stmt_param_count(stmt));
+    if (values.size() != n) {
+        setLastError(QSqlError("Parámetros incorrectos",
+                               QString("La sentencia espera %1 parámetros y se dieron %2.").arg(n).arg(values.size()),
+                               QSqlError::StatementError));
+        return false;
+    }
+    if (n == 0) return true;
+
+    params = QVector<MYSQL_BIND>(n);
+    paramData = QVector<QByteArray>(n);
+    paramNull = QVector<my_bool>(n, 0);
+    std::memset(params.data(), 0, sizeof(MYSQL_BIND) * size_t(n));
+
+    for (int i = 0; i < n; ++i) {
+        const QVariant& v = values[i];
+        MYSQL_BIND& b = params[i];
+        if (v.isNull()) {
+            paramNull[i] = 1;
+            b.buffer_type = MYSQL_TYPE_NULL;
+            b.is_null = &paramNull[i];
+            continue;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        const int type = v.metaType().id();
+#else
+        const int type = int(v.type());
+#endif
+        switch (type) {
+        case QMetaType::Int: case QMetaType::LongLong: case QMetaType::Bool:
+        case QMetaType::UInt: case QMetaType::ULongLong: {
+            const qint64 x = v.toLongLong();
+            paramData[i] = QByteArray(reinterpret_cast<const char*>(&x), sizeof x);
+            b.buffer_type = MYSQL_TYPE_LONGLONG;
+            b.is_unsigned = type == QMetaType::UInt || type == QMetaType::ULongLong;
+            break;
+        }
+        case QMetaType::Double: {
+            const double x = v.toDouble();
+            paramData[i] = QByteArray(reinterpret_cast<const char*>(&x), sizeof x);
+            b.buffer_type = MYSQL_TYPE_DOUBLE;
+            break;
+        }
+        case QMetaType::QByteArray:
+            paramData[i] = v.toByteArray();
+            b.buffer_type = MYSQL_TYPE_BLOB;
+            break;
+        default:
+            // Fechas y demás como texto: el servidor las convierte
+            paramData[i] = (type == QMetaType::QDateTime ? v.toDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz")
+                                                        : v.toString()).toUtf8();
+            b.buffer_type = MYSQL_TYPE_STRING;
+            break;
+        }
+        b.buffer = paramData[i].data();
+        b.buffer_length = static_cast<unsigned long>(paramData[i].size());
+    }
+
+    if (mysql_stmt_bind_param(stmt, params.data())) {
+        setLastError(QSqlError("No se pudieron enlazar los parámetros", QString::fromUtf8(mysql_stmt_error(stmt)),
+                               QSqlError::StatementError, QString::number(mysql_stmt_errno(stmt))));
+        return false;
+    }
+    return true;
+}
+
+bool MariaDbResult::bindResult()
+{
+    const int n = fields.size();
+    columns = QVector<Column>(n);
+    binds = QVector<MYSQL_BIND>(n);
+    std::memset(binds.data(), 0, sizeof(MYSQL_BIND) * size_t(n));
+
+    for (int i = 0; i < n; ++i) {
+        const FieldInfo& f = fields[i];
+        MYSQL_BIND& b = binds[i];
+        Column& c = columns[i];
+        switch (f.metaType) {
+        case QMetaType::LongLong:
+            b.buffer_type = MYSQL_TYPE_LONGLONG;
+            c.buffer.resize(8);
+            break;
+        case QMetaType::ULongLong:
+            if (f.type == MYSQL_TYPE_BIT) {
+                b.buffer_type = MYSQL_TYPE_BIT;
+                c.buffer.resize(8);
+            } else {
+                b.buffer_type = MYSQL_TYPE_LONGLONG;
+                b.is_unsigned = 1;
+                c.buffer.resize(8);
+            }
+            break;
+        case QMetaType::Double:
+            b.buffer_type = MYSQL_TYPE_DOUBLE;
+            c.buffer.resize(8);
+            break;
+        case QMetaType::QDate:
+        case QMetaType::QDateTime:
+        case QMetaType::QTime:
+            b.buffer_type = f.metaType == QMetaType::QDate ? MYSQL_TYPE_DATE
+                          : f.metaType == QMetaType::QTime ? MYSQL_TYPE_TIME : MYSQL_TYPE_DATETIME;
+            c.buffer.resize(int(sizeof(MYSQL_TIME)));
+            break;
+        default:
+            b.buffer_type = f.metaType == QMetaType::QByteArray ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+            c.buffer.resize(int(qBound<unsigned long>(16, f.length + 1, kStringBuffer)));
+            break;
+        }
+        b.buffer = c.buffer.data();
+        b.buffer_length = static_cast<unsigned long>(c.buffer.size());
+        b.length = &c.length;
+        b.is_null = &c.null;
+        b.error = &c.error;
+    }
+
+    if (mysql_stmt_bind_result(stmt, binds.data())) {
+        setLastError(QSqlError("No se pudo leer el resultado", QString::fromUtf8(mysql_stmt_error(stmt)),
+                               QSqlError::StatementError, QString::number(mysql_stmt_errno(stmt))));
+        return false;
+    }
+    return true;
+}
+
+bool MariaDbResult::exec()
+{
+    if (!textSql.isEmpty()) {
+        if (!boundValues().isEmpty()) {
+            setLastError(QSqlError("Parámetros no admitidos",
+                                   "El servidor no admite esta sentencia como preparada.",
+                                   QSqlError::StatementError));
+            return false;
+        }
+        const QString sql = textSql;
+        const bool ok = reset(sql);
+        textSql = sql;   // reset() lo limpia; la sentencia se puede volver a ejecutar
+        return ok;
+    }
+    if (!stmt || !mysql()) return false;
+
+    drv->claim(this);
+    setActive(false);
+    setAt(QSql::BeforeFirstRow);
+    // Re-ejecución: lo que quedara del resultado anterior
+    if (streaming) { streaming = false; mysql_stmt_free_result(stmt); }
+    if (res) { mysql_free_result(res); res = nullptr; }
+    rows = -1;
+
+    if (!bindParams()) { drv->release(this); return false; }
+    if (mysql_stmt_execute(stmt))
+        return fail("No se pudo ejecutar la consulta", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+
+    res = mysql_stmt_result_metadata(stmt);
+    if (!res) {
+        affected = mysql_stmt_affected_rows(stmt);
+        insertId = mysql_stmt_insert_id(stmt);
+        drv->release(this);
+        setSelect(false);
+        setActive(true);
+        return true;
+    }
+
+    readFields(res);
+    if (!bindResult()) { drv->release(this); return false; }
+
+    streaming = isForwardOnly();
+    if (!streaming) {
+        if (mysql_stmt_store_result(stmt))
+            return fail("No se pudo leer el resultado", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+        rows = int(mysql_stmt_num_rows(stmt));
+        // Con más resultados pendientes (CALL) la conexión sigue ocupada hasta liberar este
+        if (!mysql_stmt_more_results(stmt)) drv->release(this);
+    }
+    setSelect(true);
+    setActive(true);
+    return true;
+}
+
+bool MariaDbResult::fetchTruncated()
+{
+    // Columnas más largas que el buffer: se piden enteras a un buffer del tamaño justo
+    for (int i = 0; i < columns.size(); ++i) {
+        Column& c = columns[i];
+        if (c.null || c.length <= static_cast<unsigned long>(c.buffer.size())) continue;
+        QByteArray full(int(c.length), Qt::Uninitialized);
+        MYSQL_BIND b;
+        std::memset(&b, 0, sizeof b);
+        b.buffer_type = binds[i].buffer_type;
+        b.buffer = full.data();
+        b.buffer_length = c.length;
+        if (mysql_stmt_fetch_column(stmt, &b, unsigned(i), 0)) return false;
+        c.buffer = full;
+        binds[i].buffer = c.buffer.data();
+        binds[i].buffer_length = c.length;
+        // El próximo fetch usa el buffer más grande; queda enlazado de nuevo
+        if (mysql_stmt_bind_result(stmt, binds.data())) return false;
+    }
+    return true;
+}
+
+bool MariaDbResult::fetchNext()
+{
+    if (!isActive() || !isSelect() || at() == QSql::AfterLastRow) return false;
+
+    if (stmt) {
+        const int r = mysql_stmt_fetch(stmt);
+        if (r == 1) {
+            setLastError(QSqlError("No se pudo leer la fila", QString::fromUtf8(mysql_stmt_error(stmt)),
+                                   QSqlError::StatementError, QString::number(mysql_stmt_errno(stmt))));
+            finishStream();
+            setAt(QSql::AfterLastRow);
+            return false;
+        }
+        if (r == MYSQL_NO_DATA) {
+            finishStream();
+            setAt(QSql::AfterLastRow);
+            return false;
+        }
+        if (r == MYSQL_DATA_TRUNCATED && !fetchTruncated()) {
+            setLastError(QSqlError("No se pudo leer la columna", QString::fromUtf8(mysql_stmt_error(stmt)),
+                                   QSqlError::StatementError, QString::number(mysql_stmt_errno(stmt))));
+            return false;
+        }
+    } else {
+        row = res ? mysql_fetch_row(res) : nullptr;
+        if (!row) {
+            if (mysql_errno(mysql())) {
+                setLastError(QSqlError("No se pudo leer la fila", QString::fromUtf8(mysql_error(mysql())),
+                                       QSqlError::StatementError, QString::number(mysql_errno(mysql()))));
+            }
+            finishStream();
+            setAt(QSql::AfterLastRow);
+            return false;
+        }
+        lengths = mysql_fetch_lengths(res);
+    }
+    setAt(at() + 1);
+    return true;
+}
+
+bool MariaDbResult::fetch(int i)
+{
+    if (!isActive() || !isSelect() || i < 0) return false;
+    if (streaming) {
+        // Solo hacia adelante
+        if (i <= at()) return i == at();
+        while (at() < i) {
+            if (!fetchNext()) return false;
+        }
+        return true;
+    }
+    if (i >= rows) {
+        setAt(QSql::AfterLastRow);
+        return false;
+    }
+    if (stmt) mysql_stmt_data_seek(stmt, quint64(i));
+    else mysql_data_seek(res, quint64(i));
+    setAt(i - 1);
+    return fetchNext();
+}
+
+bool MariaDbResult::fetchFirst()
+{
+    if (streaming) return at() == QSql::BeforeFirstRow ? fetchNext() : at() == 0;
+    return fetch(0);
+}
+
+bool MariaDbResult::fetchLast()
+{
+    if (streaming) return false;
+    return fetch(rows - 1);
+}
+
+bool MariaDbResult::isNull(int i)
+{
+    if (i < 0 || i >= fields.size()) return true;
+    if (stmt) return columns[i].null;
+    return !row || !row[i];
+}
+
+QVariant MariaDbResult::data(int i)
+{
+    if (i < 0 || i >= fields.size()) return {};
+    const FieldInfo& f = fields[i];
+    if (isNull(i)) return nullOf(f.metaType);
+
+    if (!stmt) return fromText(row[i], lengths[i], f);
+
+    const Column& c = columns[i];
+    const char* p = c.buffer.constData();
+    switch (binds[i].buffer_type) {
+    case MYSQL_TYPE_LONGLONG: {
+        qint64 v;
+        std::memcpy(&v, p, sizeof v);
+        return f.metaType == QMetaType::ULongLong ? QVariant(qulonglong(v)) : QVariant(qlonglong(v));
+    }
+    case MYSQL_TYPE_BIT:
+        return bits(p, c.length);
+    case MYSQL_TYPE_DOUBLE: {
+        double v;
+        std::memcpy(&v, p, sizeof v);
+        return v;
+    }
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_DATETIME: {
+        MYSQL_TIME t;
+        std::memcpy(&t, p, sizeof t);
+        return fromTime(t, f);
+    }
+    case MYSQL_TYPE_BLOB:
+        return QByteArray(p, int(c.length));
+    default:
+        return QString::fromUtf8(p, int(c.length));
+    }
+}
+
+QSqlRecord MariaDbResult::record() const
+{
+    QSqlRecord rec;
+    if (!isActive() || !isSelect()) return rec;
+    for (const auto& f : fields) rec.append(sqlField(f));
+    return rec;
+}
+
+void MariaDbDriver::registerDriver()
+{
+    static bool done = false;
+    if (done) return;
+    done = true;
+    QSqlDatabase::registerSqlDriver("QMARIADB", new QSqlDriverCreator<MariaDbDriver>);
+}
+
+MariaDbDriver::MariaDbDriver(QObject* parent)
+    : QSqlDriver(parent)
+{
+}
+
+MariaDbDriver::~MariaDbDriver()
+{
+    close();
+}
+
+bool MariaDbDriver::hasFeature(DriverFeature f) const
+{
+    switch (f) {
+    case Transactions: case QuerySize: case BLOB: case Unicode: case PreparedQueries:
+    case PositionalPlaceholders: case LastInsertId:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MariaDbDriver::open(const QString& db, const QString&, const QString&, const QString&, int, const QString&)
+{
+    if (isOpen()) close();
+
+    const QHash<QString, QString> o = DbSession::nativeOptions(db);
+    mysql = mysql_init(nullptr);
+    if (!mysql) {
+        setLastError(QSqlError("No se pudo iniciar libmariadb", {}, QSqlError::ConnectionError));
+        setOpenError(true);
+        return false;
+    }
+
+    mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+    if (o.value("compress") == "1") mysql_options(mysql, MYSQL_OPT_COMPRESS, nullptr);
+    const unsigned timeout = o.value("timeout", "15").toUInt();
+    mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+
+    const QByteArray host = o.value("host").toUtf8();
+    const QByteArray user = o.value("user").toUtf8();
+    const QByteArray password = o.value("password").toUtf8();
+    const QByteArray database = o.value("database").toUtf8();
+    const unsigned port = o.value("port", "3306").toUInt();
+
+    if (!mysql_real_connect(mysql, host.isEmpty() ? nullptr : host.constData(), user.constData(),
+                            password.constData(), database.isEmpty() ? nullptr : database.constData(),
+                            port, nullptr, CLIENT_MULTI_RESULTS)) {
+        setLastError(QSqlError("No se pudo conectar a MariaDB", QString::fromUtf8(mysql_error(mysql)),
+                               QSqlError::ConnectionError, QString::number(mysql_errno(mysql))));
+        mysql_close(mysql);
+        mysql = nullptr;
+        setOpenError(true);
+        return false;
+    }
+
+    setOpen(true);
+    setOpenError(false);
+    return true;
+}
+
+void MariaDbDriver::close()
+{
+    if (busy) busy->detach();
+    busy = nullptr;
+    if (mysql) {
+        mysql_close(mysql);
+        mysql = nullptr;
+    }
+    setOpen(false);
+    setOpenError(false);
+}
+
+QSqlResult* MariaDbDriver::createResult() const
+{
+    return new MariaDbResult(this);
+}
+
+void MariaDbDriver::claim(MariaDbResult* r) const
+{
+    if (busy && busy != r) busy->detach();
+    busy = r;
+}
+
+void MariaDbDriver::release(MariaDbResult* r) const
+{
+    if (busy == r) busy = nullptr;
+}
+
+bool MariaDbDriver::beginTransaction()
+{
+    claim(nullptr);
+    return mysql && mysql_autocommit(mysql, 0) == 0;
+}
+
+bool MariaDbDriver::commitTransaction()
+{
+    claim(nullptr);
+    const bool ok = mysql && mysql_commit(mysql) == 0;
+    if (mysql) mysql_autocommit(mysql, 1);
+    return ok;
+}
+
+bool MariaDbDriver::rollbackTransaction()
+{
+    claim(nullptr);
+    const bool ok = mysql && mysql_rollback(mysql) == 0;
+    if (mysql) mysql_autocommit(mysql, 1);
+    return ok;
+}
+
+QString MariaDbDriver::escapeIdentifier(const QString& identifier, IdentifierType) const
+{
+    if (identifier.startsWith('`') && identifier.endsWith('`')) return identifier;
+    return "`" + QString(identifier).replace("`", "``") + "`";
+}
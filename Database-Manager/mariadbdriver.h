@@ -0,0 +1,46 @@
+#pragma once
+#include <QSqlDriver>
+
+struct st_mysql;
+class MariaDbResult;
+
+// Driver "QMARIADB" sobre libmariadb (Connector/C), sin la capa ODBC:
+//  - Las sentencias preparadas (QSqlQuery::prepare + exec) van por el protocolo binario;
+//    lo que el servidor no acepta como preparada (ER_UNSUPPORTED_PS) se envía como texto.
+//  - Con setForwardOnly(true) las filas se leen del socket a medida que se piden
+//    (mysql_use_result / mysql_stmt_fetch sin store): el resultado nunca está entero en
+//    memoria. El resto de consultas se guarda completo y admite seek, como en QMYSQL.
+//  - Una conexión solo puede tener un resultado en streaming: si otra sentencia usa la
+//    conexión, el anterior se descarta (se leen y tiran sus filas pendientes).
+// La cadena de conexión es la de DbSession::nativeConnString ("QMARIADB:host=..;port=..;
+// user=..;password=..;database=..;compress=1;" con los valores codificados en %XX).
+class MariaDbDriver : public QSqlDriver {
+    Q_OBJECT
+public:
+    // Registra "QMARIADB" en QSqlDatabase (una vez; llamar desde el hilo de la GUI).
+    static void registerDriver();
+
+    explicit MariaDbDriver(QObject* parent = nullptr);
+    ~MariaDbDriver() override;
+
+    bool hasFeature(DriverFeature f) const override;
+    bool open(const QString& db, const QString& user, const QString& password,
+              const QString& host, int port, const QString& connOpts) override;
+    void close() override;
+    QSqlResult* createResult() const override;
+
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+    QString escapeIdentifier(const QString& identifier, IdentifierType type) const override;
+
+private:
+    friend class MariaDbResult;
+
+    // El resultado que va a usar la conexión descarta el que la tenía ocupada.
+    void claim(MariaDbResult* r) const;
+    void release(MariaDbResult* r) const;
+
+    st_mysql* mysql = nullptr;
+    mutable MariaDbResult* busy = nullptr;
+};
@@ -1,44 +1,217 @@
 #include "MetadataService.h"
 #include "DbSession.h"
+#include "QueryStats.h"
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlRecord>
 #include <QSet>
+#include <QHash>
+#include <QSettings>
+#include <QRegularExpression>
 
-MetadataService::MetadataService(DbSession* s):s(s){}
+MetadataService::MetadataService(DbSession* s):s(s)
+{
+    QSettings st("UNITEC", "Database-Manager");
+    setCacheTtl(st.value("metadata/cacheTtlSec", 60).toInt());
+    clock.start();
+}
+
+MetadataService::MetadataService(const QString& connectionName)
+    : connName(connectionName), ttlMs(0)
+{
+    clock.start();
+}
+
+struct MetadataService::ServerCall {
+    ServerCall(const MetadataService* m, const char* kind, const QString& db, const QString& name = {})
+        : m(m), kind(kind), db(db), name(name) { t.start(); }
+    ~ServerCall()
+    {
+        if (!m->stats) return;
+        QString what = QString::fromLatin1(kind) + " " + db;
+        if (!name.isEmpty()) what += "." + name;
+        m->stats->recordSimple("metadatos", what, t.elapsed());
+    }
+    const MetadataService* m;
+    const char* kind;
+    QString db, name;
+    QElapsedTimer t;
+};
+
+QSqlDatabase MetadataService::conn() const
+{
+    return s ? s->db() : QSqlDatabase::database(connName, false);
+}
+
+// Separador que no aparece en nombres de objetos.
+static const QChar kSep(0x1F);
+
+QString MetadataService::key(const QString& db, const QString& kind, const QString& name)
+{
+    return db + kSep + kind + kSep + name;
+}
+
+bool MetadataService::lookup(const QString& db, const QString& kind, const QString& name, QVariant* out)
+{
+    const auto it = cache.constFind(key(db, kind, name));
+    if (it == cache.constEnd() || it->expires <= clock.elapsed()) {
+        ++misses;
+        return false;
+    }
+    ++hits;
+    *out = it->value;
+    return true;
+}
+
+void MetadataService::store(const QString& db, const QString& kind, const QString& name, const QVariant& v)
+{
+    if (ttlMs <= 0) return;
+    cache.insert(key(db, kind, name), Entry{v, clock.elapsed() + ttlMs});
+}
+
+void MetadataService::removeMatching(const QString& db, const QString& kind, const QString& name)
+{
+    if (!db.isEmpty()) {
+        cache.remove(key(db, kind, name));
+        return;
+    }
+    // Sin base conocida: la entrada de ese tipo/nombre en cualquier base.
+    const QString suffix = kSep + kind + kSep + name;
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (it.key().endsWith(suffix)) it = cache.erase(it);
+        else ++it;
+    }
+}
+
+void MetadataService::invalidate(const QString& db, const QString& kind, const QString& name)
+{
+    ++invalidations;
+    if (invalidated) invalidated(db, kind, name);
+
+    if (kind == "database") {
+        invalidateDatabase(name);
+        removeMatching({}, "databases", {});
+        return;
+    }
+
+    if (kind == "index") {
+        // name es la tabla del índice
+        removeMatching(db, "indexes", name);
+        removeMatching(db, "keys", name);
+        removeMatching(db, "table", name);
+        removeMatching(db, "dbindexes", {});
+        return;
+    }
+
+    removeMatching(db, kind, name);
+    removeMatching(db, kind + "s", {});
+
+    if (kind == "table" || kind == "view") {
+        removeMatching(db, "columns", name);
+        removeMatching(db, "lobcolumns", name);
+        removeMatching(db, "fraccolumns", name);
+    }
+
+    if (kind == "table") {
+        // DROP/ALTER TABLE también cambia sus índices y triggers
+        removeMatching(db, "indexes", name);
+        removeMatching(db, "keys", name);
+        removeMatching(db, "triggers", {});
+        removeMatching(db, "dbindexes", {});
+    }
+}
+
+void MetadataService::invalidateDatabase(const QString& db)
+{
+    ++invalidations;
+    if (invalidated) invalidated(db, "database", db);
+    const QString prefix = db + kSep;
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (it.key().startsWith(prefix)) it = cache.erase(it);
+        else ++it;
+    }
+}
+
+void MetadataService::invalidateAll()
+{
+    ++invalidations;
+    cache.clear();
+    if (invalidated) invalidated({}, {}, {});
+}
+
+void MetadataService::adopt(const MetadataService& from, quint64 since)
+{
+    if (since != invalidations || ttlMs <= 0) return;
+    const qint64 expires = clock.elapsed() + ttlMs;
+    for (auto it = from.cache.constBegin(); it != from.cache.constEnd(); ++it)
+        cache.insert(it.key(), Entry{it->value, expires});
+}
+
+MetadataService::CacheStats MetadataService::cacheStats() const
+{
+    CacheStats st;
+    st.hits = hits;
+    st.misses = misses;
+    st.entries = cache.size();
+    return st;
+}
 
 QStringList MetadataService::listDatabases(){
-    QStringList r; QSqlQuery q(s->db());
-    q.exec("SHOW DATABASES");
+    QVariant c;
+    if (lookup({}, "databases", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "databases", {});
+
+    QStringList r; QSqlQuery q(conn());
+    if (!q.exec("SHOW DATABASES")) return r;
     while(q.next()) r << q.value(0).toString();
+    store({}, "databases", {}, r);
     return r;
 }
 
 QStringList MetadataService::listTables(const QString& db){
-    QStringList r; QSqlQuery q(s->db());
-    q.exec("SHOW FULL TABLES FROM " + DbSession::q(db) + " WHERE Table_type = 'BASE TABLE'");
+    QVariant c;
+    if (lookup(db, "tables", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "tables", db);
+
+    QStringList r; QSqlQuery q(conn());
+    if (!q.exec("SHOW FULL TABLES FROM " + DbSession::q(db) + " WHERE Table_type = 'BASE TABLE'")) return r;
     while(q.next()) r << q.value(0).toString();
+    store(db, "tables", {}, r);
     return r;
 }
 
 QStringList MetadataService::listViews(const QString& db)
 {
-    QStringList r; QSqlQuery q(s->db());
-    q.exec("SHOW FULL TABLES FROM " + DbSession::q(db) + " WHERE Table_type = 'VIEW'");
+    QVariant c;
+    if (lookup(db, "views", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "views", db);
+
+    QStringList r; QSqlQuery q(conn());
+    if (!q.exec("SHOW FULL TABLES FROM " + DbSession::q(db) + " WHERE Table_type = 'VIEW'")) return r;
     while (q.next()) r << q.value(0).toString();
+    store(db, "views", {}, r);
     return r;
 }
 
 QStringList MetadataService::listTriggers(const QString& db)
 {
-    QStringList r; QSqlQuery q(s->db());
-    q.exec("SHOW TRIGGERS FROM " + DbSession::q(db));
+    QVariant c;
+    if (lookup(db, "triggers", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "triggers", db);
+
+    QStringList r; QSqlQuery q(conn());
+    if (!q.exec("SHOW TRIGGERS FROM " + DbSession::q(db))) return r;
     while (q.next()) r << q.value(0).toString(); // columna Trigger
+    store(db, "triggers", {}, r);
     return r;
 }
 
 QStringList MetadataService::listFunctions(const QString& db)
 {
-    QStringList r; QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "functions", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "functions", db);
+
+    QStringList r; QSqlQuery q(conn());
     q.prepare("SHOW FUNCTION STATUS WHERE Db = ?");
     q.addBindValue(db);
     if (!q.exec()) return r;
@@ -47,12 +220,17 @@ QStringList MetadataService::listFunctions(const QString& db)
     while (q.next()) {
         r << (nameIdx >= 0 ? q.value(nameIdx).toString() : q.value(1).toString());
     }
+    store(db, "functions", {}, r);
     return r;
 }
 
 QStringList MetadataService::listProcedures(const QString& db)
 {
-    QStringList r; QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "procedures", {}, &c)) return c.toStringList();
+    const ServerCall call(this, "procedures", db);
+
+    QStringList r; QSqlQuery q(conn());
     q.prepare("SHOW PROCEDURE STATUS WHERE Db = ?");
     q.addBindValue(db);
     if (!q.exec()) return r;
@@ -61,14 +239,19 @@ QStringList MetadataService::listProcedures(const QString& db)
     while (q.next()) {
         r << (nameIdx >= 0 ? q.value(nameIdx).toString() : q.value(1).toString());
     }
+    store(db, "procedures", {}, r);
     return r;
 }
 
 QStringList MetadataService::listIndexes(const QString& db, const QString& table)
 {
+    QVariant c;
+    if (lookup(db, "indexes", table, &c)) return c.toStringList();
+    const ServerCall call(this, "indexes", db, table);
+
     QSet<QString> uniq;
-    QSqlQuery q(s->db());
-    q.exec("SHOW INDEX FROM " + DbSession::q(table) + " FROM " + DbSession::q(db));
+    QSqlQuery q(conn());
+    if (!q.exec("SHOW INDEX FROM " + DbSession::q(table) + " FROM " + DbSession::q(db))) return {};
 
     const int keyIdx = q.record().indexOf("Key_name");
     while (q.next()) {
@@ -78,53 +261,296 @@ QStringList MetadataService::listIndexes(const QString& db, const QString& table
 
     QStringList r = uniq.values();
     r.sort(Qt::CaseInsensitive);
+    store(db, "indexes", table, r);
+    return r;
+}
+
+bool MetadataService::readColumns(const QString& db, const QString& table, QStringList* all, QStringList* lobs,
+                                  QStringList* fractional)
+{
+    const ServerCall call(this, "columns", db, table);
+
+    QSqlQuery q(conn());
+    if (!q.exec("SHOW COLUMNS FROM " + DbSession::q(table) + " FROM " + DbSession::q(db))) return false;
+    // JSON es LONGTEXT en MariaDB; MySQL lo devuelve como "json"
+    static const QRegularExpression large("^(text|blob|json|(medium|long)(text|blob))\\b",
+                                          QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression frac("^(datetime|timestamp|time)\\([1-6]\\)",
+                                         QRegularExpression::CaseInsensitiveOption);
+    while (q.next()) {
+        const QString name = q.value(0).toString(); // columna Field
+        const QString type = q.value(1).toString(); // columna Type
+        *all << name;
+        if (large.match(type).hasMatch()) *lobs << name;
+        if (frac.match(type).hasMatch()) *fractional << name;
+    }
+    store(db, "columns", table, *all);
+    store(db, "lobcolumns", table, *lobs);
+    store(db, "fraccolumns", table, *fractional);
+    return true;
+}
+
+QStringList MetadataService::listColumns(const QString& db, const QString& table)
+{
+    QVariant c;
+    if (lookup(db, "columns", table, &c)) return c.toStringList();
+    QStringList all, lobs, fractional;
+    readColumns(db, table, &all, &lobs, &fractional);
+    return all;
+}
+
+QStringList MetadataService::largeColumns(const QString& db, const QString& table)
+{
+    QVariant c;
+    if (lookup(db, "lobcolumns", table, &c)) return c.toStringList();
+    QStringList all, lobs, fractional;
+    readColumns(db, table, &all, &lobs, &fractional);
+    return lobs;
+}
+
+QStringList MetadataService::fractionalColumns(const QString& db, const QString& table)
+{
+    QVariant c;
+    if (lookup(db, "fraccolumns", table, &c)) return c.toStringList();
+    QStringList all, lobs, fractional;
+    readColumns(db, table, &all, &lobs, &fractional);
+    return fractional;
+}
+
+MetadataService::SchemaObjects MetadataService::loadSchema(const QString& db)
+{
+    SchemaObjects o;
+    QVariant c;
+
+    // Tablas y vistas en una sola sentencia
+    const bool haveTables = lookup(db, "tables", {}, &c);
+    if (haveTables) o.tables = c.toStringList();
+    const bool haveViews = lookup(db, "views", {}, &c);
+    if (haveViews) o.views = c.toStringList();
+
+    if (!haveTables || !haveViews) {
+        const ServerCall call(this, "schema", db);
+        QSqlQuery q(conn());
+        if (q.exec("SHOW FULL TABLES FROM " + DbSession::q(db))) {
+            QStringList tables, views;
+            while (q.next()) {
+                const QString type = q.value(1).toString();
+                if (type == "VIEW") views << q.value(0).toString();
+                else if (type == "BASE TABLE") tables << q.value(0).toString();
+            }
+            o.tables = tables;
+            o.views = views;
+            store(db, "tables", {}, tables);
+            store(db, "views", {}, views);
+        }
+    }
+
+    // Funciones y procedimientos: mysql.proc en una lectura si hay permiso
+    const bool haveFuncs = lookup(db, "functions", {}, &c);
+    if (haveFuncs) o.functions = c.toStringList();
+    const bool haveProcs = lookup(db, "procedures", {}, &c);
+    if (haveProcs) o.procedures = c.toStringList();
+
+    if (!haveFuncs || !haveProcs) {
+        const ServerCall call(this, "routines", db);
+        QSqlQuery q(conn());
+        q.prepare("SELECT name, type FROM mysql.proc WHERE db = ? ORDER BY name");
+        q.addBindValue(db);
+        if (q.exec()) {
+            QStringList funcs, procs;
+            while (q.next()) {
+                const QString type = q.value(1).toString();
+                if (type == "FUNCTION") funcs << q.value(0).toString();
+                else if (type == "PROCEDURE") procs << q.value(0).toString();
+            }
+            o.functions = funcs;
+            o.procedures = procs;
+            store(db, "functions", {}, funcs);
+            store(db, "procedures", {}, procs);
+        } else {
+            o.functions = listFunctions(db);
+            o.procedures = listProcedures(db);
+        }
+    }
+
+    o.triggers = listTriggers(db);
+    return o;
+}
+
+QHash<QString, QStringList> MetadataService::listIndexesForDatabase(const QString& db)
+{
+    QVariant c;
+    if (lookup(db, "dbindexes", {}, &c)) return c.value<QHash<QString, QStringList>>();
+    const ServerCall call(this, "dbindexes", db);
+
+    QHash<QString, QStringList> r;
+    const QStringList tables = loadSchema(db).tables;
+
+    QStringList missing;
+    for (const auto& t : tables) {
+        if (lookup(db, "indexes", t, &c)) r.insert(t, c.toStringList());
+        else missing << t;
+    }
+    if (missing.isEmpty()) {
+        store(db, "dbindexes", {}, QVariant::fromValue(r));
+        return r;
+    }
+
+    // Una lectura en lote de mysql.innodb_index_stats (sin information_schema). Solo trae
+    // índices B-tree de tablas InnoDB con estadísticas: las que no aparecen (otro motor, sin
+    // ANALYZE todavía) y las que muestran FTS_DOC_ID_INDEX (tienen FULLTEXT, que no está en
+    // las estadísticas) van por SHOW INDEX. Lo de las estadísticas no se guarda en la caché
+    // por tabla: la carpeta Índices de una tabla siempre usa SHOW INDEX.
+    QHash<QString, QSet<QString>> found;
+    QSet<QString> fulltext;
+    QSqlQuery q(conn());
+    q.prepare("SELECT DISTINCT table_name, index_name FROM mysql.innodb_index_stats WHERE database_name = ?");
+    q.addBindValue(db);
+    if (q.exec()) {
+        while (q.next()) {
+            // Las particiones aparecen como tabla#P#p0
+            QString t = q.value(0).toString();
+            const int part = t.indexOf("#P#");
+            if (part > 0) t.truncate(part);
+
+            QSet<QString>& set = found[t];
+            const QString idx = q.value(1).toString();
+            // Índices internos de InnoDB: el implícito de las tablas sin PRIMARY KEY y el
+            // de la columna oculta de FULLTEXT
+            if (idx == "FTS_DOC_ID_INDEX") fulltext.insert(t);
+            else if (idx != "GEN_CLUST_INDEX") set.insert(idx);
+        }
+    }
+
+    for (const auto& t : missing) {
+        auto it = found.constFind(t);
+        if (it == found.constEnd() || fulltext.contains(t)) {
+            r.insert(t, listIndexes(db, t));
+            continue;
+        }
+        QStringList idx = it->values();
+        idx.sort(Qt::CaseInsensitive);
+        r.insert(t, idx);
+    }
+    store(db, "dbindexes", {}, QVariant::fromValue(r));
+    return r;
+}
+
+QStringList MetadataService::keyColumns(const QString& db, const QString& table)
+{
+    QVariant c;
+    if (lookup(db, "keys", table, &c)) return c.toStringList();
+    const ServerCall call(this, "keys", db, table);
+
+    QSqlQuery q(conn());
+    if (!q.exec("SHOW INDEX FROM " + DbSession::q(table) + " FROM " + DbSession::q(db))) return {};
+
+    const QSqlRecord rec = q.record();
+    const int nonUniqueIdx = rec.indexOf("Non_unique");
+    const int keyIdx = rec.indexOf("Key_name");
+    const int colIdx = rec.indexOf("Column_name");
+    const int nullIdx = rec.indexOf("Null");
+    if (keyIdx < 0 || colIdx < 0) return {};
+
+    // SHOW INDEX devuelve las columnas de cada índice ordenadas por Seq_in_index.
+    QStringList order;
+    QHash<QString, QStringList> cols;
+    QSet<QString> rejected;
+    while (q.next()) {
+        const QString k = q.value(keyIdx).toString();
+        const bool unique = nonUniqueIdx >= 0 && q.value(nonUniqueIdx).toInt() == 0;
+        const bool nullable = nullIdx >= 0 && q.value(nullIdx).toString() == "YES";
+        if (!unique || nullable) rejected.insert(k);
+        if (!cols.contains(k)) order << k;
+        cols[k] << q.value(colIdx).toString();
+    }
+
+    QStringList r;
+    if (cols.contains("PRIMARY")) {
+        r = cols.value("PRIMARY");
+    } else {
+        for (const auto& k : order) {
+            if (!rejected.contains(k)) { r = cols.value(k); break; }
+        }
+    }
+    store(db, "keys", table, r);
     return r;
 }
 
 QString MetadataService::showCreateTable(const QString& db,const QString& t){
-    QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "table", t, &c)) return c.toString();
+    const ServerCall call(this, "table", db, t);
+
+    QSqlQuery q(conn());
     q.exec("SHOW CREATE TABLE " + DbSession::q(db) + "." + DbSession::q(t));
     if (!q.next()) return {};
-    return q.value(1).toString() + ";";
+    const QString r = q.value(1).toString() + ";";
+    store(db, "table", t, r);
+    return r;
 }
 
 QString MetadataService::showCreateView(const QString& db, const QString& v)
 {
-    QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "view", v, &c)) return c.toString();
+    const ServerCall call(this, "view", db, v);
+
+    QSqlQuery q(conn());
     q.exec("SHOW CREATE VIEW " + DbSession::q(db) + "." + DbSession::q(v));
     if (!q.next()) return {};
-    return q.value(1).toString() + ";";
+    const QString r = q.value(1).toString() + ";";
+    store(db, "view", v, r);
+    return r;
 }
 
 QString MetadataService::showCreateTrigger(const QString& db, const QString& tr)
 {
-    QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "trigger", tr, &c)) return c.toString();
+    const ServerCall call(this, "trigger", db, tr);
+
+    QSqlQuery q(conn());
     q.exec("SHOW CREATE TRIGGER " + DbSession::q(db) + "." + DbSession::q(tr));
     if (!q.next()) return {};
 
     int idx = q.record().indexOf("SQL Original Statement");
     if (idx < 0) idx = q.record().indexOf("Create Trigger");
-    return (idx >= 0 ? q.value(idx).toString() : q.value(2).toString()) + ";";
+    const QString r = (idx >= 0 ? q.value(idx).toString() : q.value(2).toString()) + ";";
+    store(db, "trigger", tr, r);
+    return r;
 }
 
 QString MetadataService::showCreateFunction(const QString& db, const QString& fn)
 {
-    QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "function", fn, &c)) return c.toString();
+    const ServerCall call(this, "function", db, fn);
+
+    QSqlQuery q(conn());
     q.exec("SHOW CREATE FUNCTION " + DbSession::q(db) + "." + DbSession::q(fn));
     if (!q.next()) return {};
 
     int idx = q.record().indexOf("Create Function");
     if (idx < 0) idx = 2;
-    return q.value(idx).toString() + ";";
+    const QString r = q.value(idx).toString() + ";";
+    store(db, "function", fn, r);
+    return r;
 }
 
 QString MetadataService::showCreateProcedure(const QString& db, const QString& sp)
 {
-    QSqlQuery q(s->db());
+    QVariant c;
+    if (lookup(db, "procedure", sp, &c)) return c.toString();
+    const ServerCall call(this, "procedure", db, sp);
+
+    QSqlQuery q(conn());
     q.exec("SHOW CREATE PROCEDURE " + DbSession::q(db) + "." + DbSession::q(sp));
     if (!q.next()) return {};
 
     int idx = q.record().indexOf("Create Procedure");
     if (idx < 0) idx = 2;
-    return q.value(idx).toString() + ";";
+    const QString r = q.value(idx).toString() + ";";
+    store(db, "procedure", sp, r);
+    return r;
 }
@@ -1,12 +1,20 @@
 #pragma once
 #include <QStringList>
 #include <QString>
+#include <QHash>
+#include <QVariant>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <functional>
 
 class DbSession;
+class QueryStats;
 
 class MetadataService {
 public:
     explicit MetadataService(DbSession* s);
+    // Sobre una conexión con nombre del hilo llamador (p. ej. un worker), sin caché.
+    explicit MetadataService(const QString& connectionName);
 
     QStringList listDatabases();
     QStringList listTables(const QString& db);
@@ -17,6 +25,28 @@ public:
     QStringList listProcedures(const QString& db);
 
     QStringList listIndexes(const QString& db, const QString& table);
+    // Columnas de una tabla o vista (SHOW COLUMNS), en orden.
+    QStringList listColumns(const QString& db, const QString& table);
+    // Columnas TEXT/BLOB/JSON grandes (sin TINY*), las que el navegador de datos pide recortadas.
+    QStringList largeColumns(const QString& db, const QString& table);
+    // DATETIME/TIMESTAMP/TIME con fracción de segundo: QDateTime/QTime solo guardan
+    // milisegundos, así que como llave de paginación se piden como texto.
+    QStringList fractionalColumns(const QString& db, const QString& table);
+
+    // Introspección en lote de una base: SHOW FULL TABLES (tablas y vistas), mysql.proc
+    // (funciones y procedimientos, con SHOW ... STATUS de respaldo) y SHOW TRIGGERS.
+    // Llena la caché de cada lista, así que los list*() siguientes no van al servidor.
+    struct SchemaObjects {
+        QStringList tables, views, functions, procedures, triggers;
+    };
+    SchemaObjects loadSchema(const QString& db);
+
+    // Índices de todas las tablas de la base: una lectura de mysql.innodb_index_stats, con
+    // SHOW INDEX solo para las tablas que no están ahí o tienen FULLTEXT. El resultado
+    // completo se guarda en la caché como "dbindexes" de la base.
+    QHash<QString, QStringList> listIndexesForDatabase(const QString& db);
+    // Columnas de la PRIMARY KEY (o del primer índice UNIQUE sin NULLs), en orden.
+    QStringList keyColumns(const QString& db, const QString& table);
 
     QString showCreateTable(const QString& db, const QString& t);
     QString showCreateView(const QString& db, const QString& v);
@@ -24,6 +54,58 @@ public:
     QString showCreateFunction(const QString& db, const QString& fn);
     QString showCreateProcedure(const QString& db, const QString& sp);
 
+    // Caché por (base, tipo, nombre). kind usa los tipos del árbol: "table", "view", "function",
+    // "procedure", "trigger", "index", "database". db vacío = todas las bases.
+    // Para "index", name es la tabla del índice.
+    void invalidate(const QString& db, const QString& kind, const QString& name);
+    void invalidateDatabase(const QString& db);
+    void invalidateAll();
+    // Se llama con lo que se invalida (kind vacío = todo), para cachés derivadas.
+    void setInvalidationHook(std::function<void(const QString& db, const QString& kind, const QString& name)> hook)
+    { invalidated = std::move(hook); }
+
+    void setCacheTtl(int seconds) { ttlMs = qint64(seconds) * 1000; }
+
+    // Solo la caché, sin ir al servidor: para decidir en la GUI si hace falta un worker.
+    // kind como en la caché interna: "databases", "tables", "views", "functions",
+    // "procedures", "columns" (name = tabla), "dbindexes"...
+    bool cached(const QString& db, const QString& kind, const QString& name, QVariant* out)
+    { return lookup(db, kind, name, out); }
+    // Lo que leyó del servidor un MetadataService de un worker (con setCacheTtl) pasa a esta
+    // caché con el TTL de esta, salvo que algo se haya invalidado después de since
+    // (generation() tomado antes de lanzar el worker).
+    void adopt(const MetadataService& from, quint64 since);
+    quint64 generation() const { return invalidations; }
+
+    struct CacheStats { qint64 hits = 0; qint64 misses = 0; int entries = 0; };
+    CacheStats cacheStats() const;
+
+    // Cada lectura del servidor (fallo de caché) se registra con origen "metadatos".
+    void setStats(QueryStats* st) { stats = st; }
+
 private:
-    DbSession* s;
+    struct ServerCall;   // mide una lectura del servidor mientras está en ámbito
+    struct Entry { QVariant value; qint64 expires = 0; };
+
+    static QString key(const QString& db, const QString& kind, const QString& name);
+    bool lookup(const QString& db, const QString& kind, const QString& name, QVariant* out);
+    void store(const QString& db, const QString& kind, const QString& name, const QVariant& v);
+    void removeMatching(const QString& db, const QString& kind, const QString& name);
+    // SHOW COLUMNS: guarda "columns", "lobcolumns" y "fraccolumns" de la tabla con una sola lectura.
+    bool readColumns(const QString& db, const QString& table, QStringList* all, QStringList* lobs,
+                     QStringList* fractional);
+
+    QSqlDatabase conn() const;
+
+    DbSession* s = nullptr;
+    QString connName;
+
+    QHash<QString, Entry> cache;
+    QElapsedTimer clock;
+    qint64 ttlMs = 60 * 1000;
+    qint64 hits = 0;
+    qint64 misses = 0;
+    quint64 invalidations = 0;
+    QueryStats* stats = nullptr;
+    std::function<void(const QString&, const QString&, const QString&)> invalidated;
 };
@@ -0,0 +1,453 @@
+#include "ObjectTreeModel.h"
+#include "MetadataService.h"
+#include "QueryStats.h"
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QSet>
+#include <iterator>
+
+bool ObjectTreeModel::isSystemSchema(const QString& db)
+{
+    static const QStringList system = {
+        "information_schema",
+        "performance_schema",
+        "mysql",
+        "sys"
+    };
+    return system.contains(db, Qt::CaseInsensitive);
+}
+
+bool ObjectTreeModel::Node::expandable() const
+{
+    return type == "server" || type == "db" || type == "table" || type == "folder" || type == "indexes";
+}
+
+ObjectTreeModel::ObjectTreeModel(MetadataService* meta, QObject* parent)
+    : QAbstractItemModel(parent), meta(meta), root(new Node)
+{
+    QSettings s("UNITEC", "Database-Manager");
+    batch = qMax(100, s.value("tree/batchSize", 1000).toInt());
+    maxNodes = qMax(1000, s.value("tree/maxNodes", 200000).toInt());
+}
+
+ObjectTreeModel::~ObjectTreeModel()
+{
+    delete root;
+}
+
+void ObjectTreeModel::reload(bool showSystemSchemas)
+{
+    beginResetModel();
+    qDeleteAll(root->children);
+    root->children.clear();
+    collapsed.clear();
+    nodes = 0;
+    showSystem = showSystemSchemas;
+    Node* server = addChild(root, "server", "MariaDB");
+    server->childType = "db";
+    endResetModel();
+
+    fetchMore(indexOf(server));
+}
+
+QModelIndex ObjectTreeModel::serverIndex() const
+{
+    return root->children.isEmpty() ? QModelIndex() : indexOf(root->children.first());
+}
+
+QModelIndex ObjectTreeModel::databaseIndex(const QString& db) const
+{
+    if (root->children.isEmpty()) return {};
+    for (Node* d : root->children.first()->children)
+        if (d->name == db) return indexOf(d);
+    return {};
+}
+
+ObjectTreeModel::Node* ObjectTreeModel::nodeOf(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : root;
+}
+
+QModelIndex ObjectTreeModel::indexOf(Node* n) const
+{
+    if (!n || n == root) return {};
+    return createIndex(n->row, 0, n);
+}
+
+ObjectTreeModel::Node* ObjectTreeModel::addChild(Node* parent, const QString& type, const QString& text)
+{
+    auto* n = new Node;
+    n->type = type;
+    n->text = text;
+    n->parent = parent;
+    n->row = parent->children.size();
+    if (parent != root) n->db = parent->db;
+    parent->children.append(n);
+    ++nodes;
+    return n;
+}
+
+QModelIndex ObjectTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (column != 0 || row < 0) return {};
+    Node* p = nodeOf(parent);
+    if (row >= p->children.size()) return {};
+    return createIndex(row, 0, p->children[row]);
+}
+
+QModelIndex ObjectTreeModel::parent(const QModelIndex& child) const
+{
+    if (!child.isValid()) return {};
+    return indexOf(nodeOf(child)->parent);
+}
+
+int ObjectTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0) return 0;
+    return nodeOf(parent)->children.size();
+}
+
+int ObjectTreeModel::columnCount(const QModelIndex&) const
+{
+    return 1;
+}
+
+QVariant ObjectTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid()) return {};
+    const Node* n = nodeOf(index);
+    switch (role) {
+    case Qt::DisplayRole: return n->text;
+    case TypeRole:        return n->type;
+    case DbRole:          return n->db;
+    case NameRole:        return n->name;
+    case TableRole:       return n->table;
+    default:              return {};
+    }
+}
+
+bool ObjectTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    const Node* n = nodeOf(parent);
+    if (n == root) return !root->children.isEmpty();
+    if (!n->expandable()) return false;
+    if (!n->loaded) return true;
+    return !n->children.isEmpty() || n->hasPending();
+}
+
+bool ObjectTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Node* n = nodeOf(parent);
+    if (n == root || !n->expandable()) return false;
+    return !n->loaded || n->hasPending();
+}
+
+void ObjectTreeModel::fetchMore(const QModelIndex& parent)
+{
+    Node* n = nodeOf(parent);
+    if (n == root || !n->expandable()) return;
+
+    QElapsedTimer t;
+    t.start();
+    const int before = nodes;
+    if (!n->loaded) load(n);
+    insertBatch(n);
+    if (stats) stats->recordSimple("árbol", "expandir " + n->text, t.elapsed(), nodes - before);
+    trim();
+}
+
+void ObjectTreeModel::listChildren(Node* n, QStringList* names, QStringList* tables)
+{
+    if (n->type == "server") {
+        for (const auto& db : meta->listDatabases()) {
+            if (showSystem || !isSystemSchema(db)) *names << db;
+        }
+        return;
+    }
+
+    if (n->type == "indexes") {
+        const auto byTable = meta->listIndexesForDatabase(n->db);
+        QStringList sorted = byTable.keys();
+        sorted.sort(Qt::CaseInsensitive);
+        for (const auto& t : sorted) {
+            for (const auto& idx : byTable.value(t)) {
+                *names << idx;
+                *tables << t;
+            }
+        }
+        return;
+    }
+
+    // Carpetas: la caché de MetadataService responde salvo lo que se invalidó
+    const QString& k = n->childType;
+    if (k == "table")          *names = meta->listTables(n->db);
+    else if (k == "view")      *names = meta->listViews(n->db);
+    else if (k == "function")  *names = meta->listFunctions(n->db);
+    else if (k == "procedure") *names = meta->listProcedures(n->db);
+    else if (k == "trigger")   *names = meta->listTriggers(n->db);
+    else if (k == "index")     *names = meta->listIndexes(n->db, n->table);
+}
+
+void ObjectTreeModel::load(Node* n)
+{
+    n->loaded = true;
+    n->pending.clear();
+    n->pendingTables.clear();
+    n->pendingPos = 0;
+
+    if (n->type == "db") {
+        // Una pasada en lote; las carpetas quedan cargadas con sus nombres pendientes
+        const auto schema = meta->loadSchema(n->name);
+        struct Folder { const char* text; const char* childType; const QStringList* names; };
+        const Folder folders[] = {
+            {"Tablas", "table", &schema.tables},
+            {"Indices", nullptr, nullptr},
+            {"Vistas", "view", &schema.views},
+            {"Funciones", "function", &schema.functions},
+            {"Procedimientos", "procedure", &schema.procedures},
+            {"Triggers", "trigger", &schema.triggers},
+        };
+
+        beginInsertRows(indexOf(n), 0, int(std::size(folders)) - 1);
+        for (const auto& f : folders) {
+            if (!f.childType) {
+                // INDICES (perezoso: se leen al expandir)
+                addChild(n, "indexes", f.text)->childType = "index";
+                continue;
+            }
+            Node* folder = addChild(n, "folder", f.text);
+            folder->loaded = true;
+            folder->childType = f.childType;
+            folder->pending = *f.names;
+        }
+        endInsertRows();
+        return;
+    }
+
+    if (n->type == "table") {
+        beginInsertRows(indexOf(n), 0, 0);
+        Node* folder = addChild(n, "folder", "Índices");
+        folder->loaded = true;
+        folder->childType = "index";
+        folder->table = n->name;
+        folder->pending = meta->listIndexes(n->db, n->name);
+        endInsertRows();
+        return;
+    }
+
+    // Servidor, carpeta de índices de la base y carpetas liberadas por trim()
+    listChildren(n, &n->pending, &n->pendingTables);
+}
+
+ObjectTreeModel::Node* ObjectTreeModel::createChild(Node* n, const QString& name, const QString& table) const
+{
+    auto* c = new Node;
+    c->type = n->childType;
+    c->text = table.isEmpty() ? name : table + "." + name;
+    c->name = name;
+    c->parent = n;
+    c->db = n->type == "server" ? name : n->db;
+    if (!table.isEmpty()) c->table = table;
+    else if (n->childType == "index") c->table = n->table;
+    return c;
+}
+
+void ObjectTreeModel::insertBatch(Node* n)
+{
+    const int k = qMin(batch, n->pending.size() - n->pendingPos);
+    if (k <= 0) return;
+
+    const int first = n->children.size();
+    beginInsertRows(indexOf(n), first, first + k - 1);
+    n->children.reserve(first + k);
+    const bool qualified = !n->pendingTables.isEmpty();
+    for (int i = n->pendingPos; i < n->pendingPos + k; ++i) {
+        Node* c = createChild(n, n->pending[i], qualified ? n->pendingTables[i] : QString());
+        c->row = n->children.size();
+        n->children.append(c);
+    }
+    nodes += k;
+    n->pendingPos += k;
+    if (!n->hasPending()) {
+        n->pending.clear();
+        n->pendingTables.clear();
+        n->pendingPos = 0;
+    }
+    endInsertRows();
+}
+
+void ObjectTreeModel::refresh()
+{
+    if (root->children.isEmpty()) return;
+    Node* server = root->children.first();
+    if (!server->loaded) return;
+
+    QElapsedTimer t;
+    t.start();
+    QStringList dbs, none;
+    listChildren(server, &dbs, &none);
+    applyDiff(server, dbs, none);
+
+    for (Node* db : server->children) refreshNode(db);
+    if (stats) stats->recordSimple("árbol", "refrescar", t.elapsed(), nodes);
+}
+
+void ObjectTreeModel::refreshDatabase(const QString& db)
+{
+    const QModelIndex idx = databaseIndex(db);
+    if (idx.isValid()) refreshNode(nodeOf(idx));
+}
+
+void ObjectTreeModel::refreshNode(Node* n)
+{
+    if (!n->loaded) return;
+
+    if (n->type == "folder" || n->type == "indexes") {
+        QStringList names, tables;
+        listChildren(n, &names, &tables);
+        applyDiff(n, names, tables);
+    }
+    // Bases, tablas y carpetas: bajar a los hijos ya cargados
+    for (Node* c : n->children) {
+        if (c->expandable()) refreshNode(c);
+    }
+}
+
+void ObjectTreeModel::renumber(Node* n, int from)
+{
+    for (int i = from; i < n->children.size(); ++i) n->children[i]->row = i;
+}
+
+void ObjectTreeModel::applyDiff(Node* n, const QStringList& names, const QStringList& tables)
+{
+    const bool qualified = !tables.isEmpty();
+    QStringList keys;
+    keys.reserve(names.size());
+    for (int i = 0; i < names.size(); ++i)
+        keys << (qualified ? tables[i] + "." + names[i] : names[i]);
+
+    QSet<QString> fresh;
+    fresh.reserve(keys.size());
+    for (const auto& k : keys) fresh.insert(k);
+
+    const QModelIndex parent = indexOf(n);
+
+    // 1) Bajas: cada tramo contiguo en una sola beginRemoveRows
+    for (int i = n->children.size() - 1; i >= 0; --i) {
+        if (fresh.contains(n->children[i]->text)) continue;
+        const int last = i;
+        while (i > 0 && !fresh.contains(n->children[i - 1]->text)) --i;
+
+        beginRemoveRows(parent, i, last);
+        for (int k = i; k <= last; ++k) {
+            Node* c = n->children[k];
+            forget(c);
+            nodes -= 1 + countBelow(c);
+            delete c;
+        }
+        n->children.remove(i, last - i + 1);
+        renumber(n, i);
+        endRemoveRows();
+    }
+
+    // 2) Altas en su posición según el orden del listado. Si la carpeta aún no mostró
+    // todos sus hijos, lo que cae después del último visible queda pendiente.
+    QSet<QString> present;
+    present.reserve(n->children.size());
+    for (const Node* c : n->children) present.insert(c->text);
+
+    const bool hadPending = n->hasPending();
+    QStringList newPending, newPendingTables;
+    QVector<int> run;        // índices (en names) a insertar juntos
+    int runStart = 0;
+    int row = 0;             // fila en la lista final
+
+    auto flushRun = [&](){
+        if (run.isEmpty()) return;
+        beginInsertRows(parent, runStart, runStart + run.size() - 1);
+        for (int j = 0; j < run.size(); ++j) {
+            const int k = run[j];
+            n->children.insert(runStart + j, createChild(n, names[k], qualified ? tables[k] : QString()));
+        }
+        nodes += run.size();
+        renumber(n, runStart);
+        endInsertRows();
+        run.clear();
+    };
+
+    for (int k = 0; k < keys.size(); ++k) {
+        const int existing = row - run.size();   // siguiente hijo actual aún no recorrido
+        if (existing < n->children.size() && n->children[existing]->text == keys[k]) {
+            flushRun();
+            ++row;
+            continue;
+        }
+        if (present.contains(keys[k])) continue;   // fuera de orden: se deja donde está
+
+        if (hadPending && existing >= n->children.size()) {
+            newPending << names[k];
+            if (qualified) newPendingTables << tables[k];
+            continue;
+        }
+        if (run.isEmpty()) runStart = row;
+        run << k;
+        ++row;
+    }
+    flushRun();
+
+    if (hadPending) {
+        n->pending = newPending;
+        n->pendingTables = newPendingTables;
+        n->pendingPos = 0;
+    }
+}
+
+int ObjectTreeModel::countBelow(const Node* n) const
+{
+    int total = n->children.size();
+    for (const Node* c : n->children) total += countBelow(c);
+    return total;
+}
+
+void ObjectTreeModel::forget(Node* n)
+{
+    collapsed.removeAll(n);
+    for (Node* c : n->children) forget(c);
+}
+
+void ObjectTreeModel::releaseChildren(Node* n)
+{
+    for (Node* c : n->children) forget(c);
+    if (!n->children.isEmpty()) {
+        beginRemoveRows(indexOf(n), 0, n->children.size() - 1);
+        nodes -= countBelow(n);
+        qDeleteAll(n->children);
+        n->children.clear();
+        endRemoveRows();
+    }
+    n->loaded = false;
+    n->pending.clear();
+    n->pendingTables.clear();
+    n->pendingPos = 0;
+}
+
+void ObjectTreeModel::trim()
+{
+    while (nodes > maxNodes && !collapsed.isEmpty()) {
+        releaseChildren(collapsed.takeFirst());
+    }
+}
+
+void ObjectTreeModel::nodeExpanded(const QModelIndex& index)
+{
+    collapsed.removeAll(nodeOf(index));
+}
+
+void ObjectTreeModel::nodeCollapsed(const QModelIndex& index)
+{
+    Node* n = nodeOf(index);
+    if (n == root || !n->loaded || n->children.isEmpty()) return;
+    collapsed.removeAll(n);
+    collapsed.append(n);
+    trim();
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <QAbstractItemModel>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+
+class MetadataService;
+class QueryStats;
+
+// Árbol de objetos del servidor. Los hijos se piden a MetadataService al expandir
+// (canFetchMore/fetchMore) y se insertan por tramos: una carpeta con 50.000 tablas
+// solo crea los primeros nodos y la vista pide más al llegar al final del scroll.
+// Si el árbol supera tree/maxNodes se liberan los hijos de las carpetas plegadas
+// (las menos recientes primero); se vuelven a pedir al expandirlas.
+class ObjectTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+public:
+    // Mismos roles que usaba el QTreeWidget: tipo, base, nombre y tabla (índices)
+    enum Roles { TypeRole = Qt::UserRole, DbRole, NameRole, TableRole };
+
+    explicit ObjectTreeModel(MetadataService* meta, QObject* parent = nullptr);
+    ~ObjectTreeModel() override;
+
+    // Vuelve a crear el nodo del servidor con su lista de bases.
+    void reload(bool showSystemSchemas);
+    void setShowSystemSchemas(bool show) { showSystem = show; }
+
+    // Vuelve a listar lo ya cargado y aplica sólo las altas y bajas, sin tocar el resto:
+    // se conservan los nodos expandidos y la selección. Como MetadataService responde
+    // desde la caché salvo lo invalidado, el coste depende de lo que cambió.
+    void refresh();
+    void refreshDatabase(const QString& db);
+
+    QModelIndex serverIndex() const;
+    QModelIndex databaseIndex(const QString& db) const;
+    int nodeCount() const { return nodes; }
+
+    // Cada expansión y refresco se registra con origen "árbol" (lectura + inserción).
+    void setStats(QueryStats* st) { stats = st; }
+
+    static bool isSystemSchema(const QString& db);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+public slots:
+    // Conectar a QTreeView::expanded/collapsed para saber qué carpetas se pueden liberar.
+    void nodeExpanded(const QModelIndex& index);
+    void nodeCollapsed(const QModelIndex& index);
+
+private:
+    struct Node {
+        QString type;    // "server", "db", "folder", "indexes", "table", "view", ...
+        QString text;
+        QString db;
+        QString name;
+        QString table;
+        Node* parent = nullptr;
+        int row = 0;
+        QVector<Node*> children;
+        bool loaded = false;
+
+        // Hijos conocidos que aún no se insertaron en el modelo
+        QString childType;
+        QStringList pending;
+        QStringList pendingTables;   // tabla de cada índice pendiente
+        int pendingPos = 0;
+
+        bool expandable() const;
+        bool hasPending() const { return pendingPos < pending.size(); }
+        ~Node() { qDeleteAll(children); }
+    };
+
+    Node* nodeOf(const QModelIndex& index) const;
+    QModelIndex indexOf(Node* n) const;
+    Node* addChild(Node* parent, const QString& type, const QString& text);
+    Node* createChild(Node* n, const QString& name, const QString& table) const;
+    void listChildren(Node* n, QStringList* names, QStringList* tables);
+    void load(Node* n);
+    void insertBatch(Node* n);
+    void refreshNode(Node* n);
+    void applyDiff(Node* n, const QStringList& names, const QStringList& tables);
+    static void renumber(Node* n, int from);
+    void releaseChildren(Node* n);
+    void forget(Node* n);
+    int countBelow(const Node* n) const;
+    void trim();
+
+    MetadataService* meta;
+    QueryStats* stats = nullptr;
+    Node* root;
+    bool showSystem = false;
+    int batch = 1000;
+    int maxNodes = 200000;
+    int nodes = 0;
+    QList<Node*> collapsed;   // carpetas cargadas y plegadas, la más antigua primero
+};
@@ -0,0 +1,422 @@
+#include "PlanViewer.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QThread>
+#include <QCoreApplication>
+#include <QLabel>
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QHeaderView>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <functional>
+#include <algorithm>
+
+enum PlanColumn { ColNode, ColAccess, ColKey, ColRows, ColRealRows, ColFiltered, ColTime, ColCost, ColDetail };
+
+// Cuántos nodos se resaltan como los más caros
+static const int kHotNodes = 3;
+
+static const QColor kHotColor("#f8d0d0");
+static const QColor kSortColor("#fff0c0");
+
+// MySQL manda algunos números como cadenas ("filtered": "100.00")
+static double number(const QJsonValue& v)
+{
+    if (v.isDouble()) return v.toDouble();
+    if (v.isString()) {
+        bool ok = false;
+        const double d = v.toString().toDouble(&ok);
+        return ok ? d : -1;
+    }
+    return -1;
+}
+
+static QString numberText(double v, int decimals = 0)
+{
+    return v < 0 ? QString() : QString::number(v, 'f', decimals);
+}
+
+// Operaciones del plan que son un nodo del árbol (MariaDB y MySQL)
+static QString operationLabel(const QString& key)
+{
+    static const QHash<QString, QString> labels = {
+        {"filesort", "filesort"},
+        {"read_sorted_file", "leer archivo ordenado"},
+        {"ordering_operation", "ordenar"},
+        {"temporary_table", "tabla temporal"},
+        {"grouping_operation", "agrupar"},
+        {"duplicates_removal", "eliminar duplicados"},
+        {"materialized", "materializada"},
+        {"block-nl-join", "join por bloques"},
+        {"window_functions_computation", "funciones de ventana"},
+        {"union_result", "UNION"},
+        {"expression_cache", "caché de subconsulta"},
+    };
+    return labels.value(key);
+}
+
+static void fillCommon(PlanViewer::Node& n, const QJsonObject& o)
+{
+    n.loops = number(o.value("r_loops"));
+    n.timeMs = number(o.value("r_total_time_ms"));
+    if (n.timeMs < 0 && o.contains("r_table_time_ms"))
+        n.timeMs = number(o.value("r_table_time_ms")) + qMax(0.0, number(o.value("r_other_time_ms")));
+
+    n.cost = number(o.value("cost"));
+    const QJsonObject ci = o.value("cost_info").toObject();
+    if (n.cost < 0) n.cost = number(ci.value("query_cost"));
+    if (n.cost < 0 && ci.contains("read_cost"))
+        n.cost = number(ci.value("read_cost")) + qMax(0.0, number(ci.value("eval_cost")));
+
+    if (o.value("using_filesort").toBool()) n.filesort = true;
+    if (o.value("using_temporary_table").toBool()) n.temporary = true;
+    const QString cond = o.value("attached_condition").toString();
+    if (!cond.isEmpty()) n.detail = cond;
+}
+
+static void walkObject(const QJsonObject& o, PlanViewer::Node* parent);
+
+static void walk(const QJsonValue& v, PlanViewer::Node* parent)
+{
+    if (v.isObject()) {
+        walkObject(v.toObject(), parent);
+    } else if (v.isArray()) {
+        for (const auto& x : v.toArray()) walk(x, parent);
+    }
+}
+
+static void walkObject(const QJsonObject& o, PlanViewer::Node* parent)
+{
+    for (auto it = o.constBegin(); it != o.constEnd(); ++it) {
+        const QString k = it.key();
+        const QJsonValue v = it.value();
+        if (!v.isObject() && !v.isArray()) continue;
+        const QJsonObject obj = v.toObject();
+
+        PlanViewer::Node n;
+        n.kind = k;
+        if (k == "query_block") {
+            n.label = obj.contains("select_id")
+                          ? "SELECT #" + obj.value("select_id").toVariant().toString()
+                          : QString("SELECT");
+        } else if (k == "table") {
+            n.label = obj.value("table_name").toString();
+            n.accessType = obj.value("access_type").toString();
+            n.key = obj.value("key").toString();
+            QStringList possible;
+            for (const auto& x : obj.value("possible_keys").toArray()) possible << x.toString();
+            n.possibleKeys = possible.join(", ");
+            n.rows = number(obj.value("rows"));
+            if (n.rows < 0) n.rows = number(obj.value("rows_examined_per_scan"));
+            n.rRows = number(obj.value("r_rows"));
+            n.filtered = number(obj.value("filtered"));
+            n.rFiltered = number(obj.value("r_filtered"));
+            // index: recorre el índice entero, igual de caro en filas que ALL
+            n.fullScan = n.accessType == "ALL" || n.accessType == "index";
+        } else {
+            // Contenedores sin significado propio (nested_loop, subqueries...): sus nodos
+            // cuelgan del padre
+            n.label = operationLabel(k);
+            if (n.label.isEmpty() || !v.isObject()) {
+                walk(v, parent);
+                continue;
+            }
+            if (k == "filesort" || k == "read_sorted_file") n.filesort = true;
+            if (k == "temporary_table") n.temporary = true;
+            if (k == "union_result") n.label = "UNION " + obj.value("table_name").toString();
+            n.detail = obj.value("sort_key").toString();
+        }
+        fillCommon(n, obj);
+        walkObject(obj, &n);
+        parent->children.push_back(std::move(n));
+    }
+}
+
+PlanViewer::Node PlanViewer::parse(const QJsonObject& plan)
+{
+    Node root;
+    root.kind = "plan";
+    walkObject(plan, &root);
+    return root;
+}
+
+PlanViewer::PlanViewer(const DbSession* s, MetadataService* meta, QWidget* parent)
+    : QWidget(parent), s(s), meta(meta)
+{
+    title = new QLabel;
+    title->setWordWrap(true);
+    title->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    status = new QLabel;
+    status->setWordWrap(true);
+
+    tree = new QTreeWidget;
+    tree->setHeaderLabels({"Operación", "Acceso", "Llave", "Filas est.", "Filas reales",
+                           "Filtrado % (est. / real)", "Tiempo ms", "Coste", "Detalle"});
+    tree->setUniformRowHeights(true);
+    tree->header()->setStretchLastSection(true);
+
+    raw = new QPlainTextEdit;
+    raw->setReadOnly(true);
+    raw->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    tabs = new QTabWidget;
+    tabs->addTab(tree, "Árbol");
+    tabs->addTab(raw, "JSON");
+
+    auto* l = new QVBoxLayout(this);
+    l->addWidget(title);
+    l->addWidget(status);
+    l->addWidget(tabs, 1);
+}
+
+PlanViewer::~PlanViewer()
+{
+    // El hilo no se espera (lo hace la sesión al cerrarse): se corta la sentencia y lo que
+    // devuelva se descarta (QPointer)
+    cancel();
+}
+
+bool PlanViewer::isRunning() const
+{
+    return job && !job->isFinished();
+}
+
+void PlanViewer::cancel()
+{
+    if (!isRunning() || !run) return;
+    run->cancelled = true;
+    // Sin id todavía: el hilo ve cancelled antes de ejecutar
+    s->killQuery(run->connId);
+}
+
+bool PlanViewer::explain(const QString& sql, const QString& database, bool analyzeIt)
+{
+    if (isRunning()) return false;
+
+    db = database;
+    analyze = analyzeIt;
+    const QString stmt = (analyze ? "ANALYZE FORMAT=JSON " : "EXPLAIN FORMAT=JSON ") + sql;
+    title->setText((analyze ? "ANALYZE: " : "EXPLAIN: ") + sql.simplified().left(300));
+    status->setText(analyze ? "Ejecutando la sentencia para medir el plan..." : "Obteniendo el plan...");
+    tree->clear();
+    raw->clear();
+
+    // Índices de la caché de MetadataService; si faltan, los lee el hilo y vuelven a la caché
+    QVariant c;
+    const bool needIndexes = !database.isEmpty() && !meta->cached(database, "dbindexes", {}, &c);
+    indexes = c.value<QHash<QString, QStringList>>();
+    const quint64 since = meta->generation();
+
+    // Conexión propia (se cierra al terminar): el USE no queda en una conexión del pool y la
+    // consola sigue libre mientras tanto
+    run = std::make_shared<Run>();
+    const std::shared_ptr<Run> r = run;
+    const QPointer<PlanViewer> self(this);
+    const DbSession* session = s;
+    job = session->spawn([self, r, session, stmt, database, needIndexes, since](){
+        QElapsedTimer clock;
+        clock.start();
+        QString err;
+        QByteArray json;
+        Node root;
+        std::shared_ptr<MetadataService> read;
+        QHash<QString, QStringList> dbIndexes;
+        {
+            DbLease lease = session->acquireDedicated({}, &err);
+            if (lease.isValid()) {
+                QSqlQuery q(lease.db());
+                q.setForwardOnly(true);
+                if (q.exec("SELECT CONNECTION_ID()") && q.next())
+                    r->connId = q.value(0).toLongLong();
+                if (r->cancelled)
+                    err = "Cancelado.";
+                else if (!database.isEmpty() && !q.exec("USE " + DbSession::q(database)))
+                    err = q.lastError().text();
+                else if (!DbSession::execute(q, stmt))
+                    err = r->cancelled ? QString("Cancelado.") : q.lastError().text();
+                else if (!q.next())
+                    err = "El servidor no devolvió un plan.";
+                else
+                    json = q.value(0).toString().toUtf8();
+
+                if (err.isEmpty() && needIndexes) {
+                    read = std::make_shared<MetadataService>(lease.connectionName());
+                    read->setCacheTtl(3600);   // solo para que adopt() lo pase a la caché de la GUI
+                    dbIndexes = read->listIndexesForDatabase(database);
+                }
+                r->connId = -1;
+            }
+        }
+        if (err.isEmpty()) {
+            QJsonParseError pe;
+            const QJsonDocument doc = QJsonDocument::fromJson(json, &pe);
+            if (pe.error != QJsonParseError::NoError || !doc.isObject()) {
+                err = "El plan no es JSON: " + pe.errorString();
+            } else {
+                root = parse(doc.object());
+                json = doc.toJson(QJsonDocument::Indented);
+            }
+        }
+        const qint64 ms = clock.elapsed();
+        // El visor puede haberse cerrado: self se comprueba ya en el hilo de la GUI
+        QMetaObject::invokeMethod(qApp, [self, root, json, err, ms, read, dbIndexes, since](){
+            if (!self) return;
+            if (!err.isEmpty()) {
+                self->status->setText(err);
+                emit self->finished(false, err);
+                return;
+            }
+            if (read) {
+                self->meta->adopt(*read, since);
+                self->indexes = dbIndexes;
+            }
+            self->display(root, json, ms);
+        }, Qt::QueuedConnection);
+    });
+    return true;
+}
+
+QString PlanViewer::indexTable(const QString& table, const QString& key) const
+{
+    if (key.isEmpty() || indexes.isEmpty()) return {};
+    auto has = [&](const QString& t){
+        for (const auto& i : indexes.value(t))
+            if (i.compare(key, Qt::CaseInsensitive) == 0) return true;
+        return false;
+    };
+    if (has(table)) return table;
+
+    // table_name es el alias de la consulta: vale la única tabla de la base con ese índice
+    if (key.compare("PRIMARY", Qt::CaseInsensitive) == 0) return {};
+    QString found;
+    for (auto it = indexes.constBegin(); it != indexes.constEnd(); ++it) {
+        if (!has(it.key())) continue;
+        if (!found.isEmpty()) return {};
+        found = it.key();
+    }
+    return found;
+}
+
+void PlanViewer::display(const Node& root, const QByteArray& json, qint64 ms)
+{
+    raw->setPlainText(QString::fromUtf8(json));
+
+    // Nodos que compiten por "más caro" (los bloques SELECT suman a sus hijos)
+    QVector<const Node*> all;
+    double totalMs = -1;
+    std::function<void(const Node&)> collect = [&](const Node& n){
+        if (n.kind == "query_block") {
+            if (totalMs < 0) totalMs = n.timeMs;
+        } else if (n.kind != "plan") {
+            all << &n;
+        }
+        for (const auto& c : n.children) collect(c);
+    };
+    collect(root);
+
+    // Con ANALYZE manda el tiempo real; si no, el coste si el servidor lo da; si no, las filas
+    bool haveTime = false, haveCost = false;
+    for (const Node* n : all) {
+        haveTime |= n->timeMs > 0;
+        haveCost |= n->cost > 0;
+    }
+    auto weight = [&](const Node* n){
+        if (haveTime) return n->timeMs;
+        if (haveCost) return n->cost;
+        return n->rows * qMax(1.0, n->loops);
+    };
+    QVector<const Node*> hot;
+    for (const Node* n : all)
+        if (weight(n) > 0) hot << n;
+    std::sort(hot.begin(), hot.end(), [&](const Node* a, const Node* b){ return weight(a) > weight(b); });
+    if (hot.size() > kHotNodes) hot.resize(kHotNodes);
+
+    tree->clear();
+    for (const auto& c : root.children) addItem(c, nullptr, hot);
+    tree->expandAll();
+    for (int c = 0; c < ColDetail; ++c) tree->resizeColumnToContents(c);
+
+    int tables = 0, scans = 0, sorts = 0;
+    for (const Node* n : all) {
+        tables += n->kind == "table";
+        scans += n->fullScan;
+        sorts += n->filesort || n->temporary;
+    }
+    QStringList parts;
+    parts << QString("%1 en %2 ms").arg(analyze ? "ANALYZE" : "EXPLAIN").arg(ms);
+    if (totalMs >= 0) parts << QString("consulta: %1 ms").arg(totalMs, 0, 'f', 1);
+    parts << QString("%1 tablas").arg(tables)
+          << QString("%1 recorridos completos").arg(scans)
+          << QString("%1 filesort / temporales").arg(sorts);
+    if (!hot.isEmpty())
+        parts << QString("en rojo los %1 más caros por %2")
+                     .arg(QString::number(hot.size()),
+                          haveTime ? QString("tiempo real") : haveCost ? QString("coste estimado") : QString("filas estimadas"));
+    const QString summary = parts.join(" · ");
+    status->setText(summary);
+    emit finished(true, summary);
+}
+
+void PlanViewer::addItem(const Node& n, QTreeWidgetItem* parent, const QVector<const Node*>& hot)
+{
+    auto* item = parent ? new QTreeWidgetItem(parent) : new QTreeWidgetItem(tree);
+    item->setText(ColNode, n.label);
+    item->setText(ColAccess, n.accessType);
+    item->setText(ColRows, numberText(n.rows));
+    item->setText(ColRealRows, numberText(n.rRows, n.rRows >= 0 && n.rRows < 10 ? 1 : 0));
+    if (n.filtered >= 0 || n.rFiltered >= 0)
+        item->setText(ColFiltered, QString("%1 / %2").arg(numberText(n.filtered, 1), numberText(n.rFiltered, 1)));
+    item->setText(ColTime, numberText(n.timeMs, 2));
+    item->setText(ColCost, numberText(n.cost, 2));
+    item->setText(ColDetail, n.detail);
+    item->setToolTip(ColDetail, n.detail);
+    if (!n.possibleKeys.isEmpty()) item->setToolTip(ColKey, "Posibles: " + n.possibleKeys);
+
+    const QString table = n.kind == "table" ? indexTable(n.label, n.key) : QString();
+    if (!table.isEmpty()) {
+        auto* link = new QLabel(QString("<a href=\"#\">%1</a>").arg(n.key.toHtmlEscaped()));
+        link->setToolTip(QString("Índice de %1.%2").arg(db, table));
+        const QString key = n.key;
+        connect(link, &QLabel::linkActivated, this, [this, table, key](){ emit indexActivated(db, table, key); });
+        tree->setItemWidget(item, ColKey, link);
+    } else {
+        item->setText(ColKey, n.key);
+    }
+
+    if (hot.contains(&n)) {
+        for (int c = 0; c <= ColDetail; ++c) item->setBackground(c, kHotColor);
+        item->setToolTip(ColNode, "Uno de los nodos más caros del plan");
+    } else if (n.filesort || n.temporary) {
+        for (int c = 0; c <= ColDetail; ++c) item->setBackground(c, kSortColor);
+    }
+    if (n.filesort || n.temporary)
+        item->setToolTip(ColNode, item->toolTip(ColNode) + (n.filesort ? " · ordena en un archivo (filesort)"
+                                                                      : " · usa una tabla temporal"));
+
+    if (n.fullScan) {
+        QFont f = item->font(ColAccess);
+        f.setBold(true);
+        item->setFont(ColAccess, f);
+        item->setForeground(ColAccess, QColor("#c00000"));
+        item->setToolTip(ColAccess, n.accessType == "ALL" ? "Recorrido completo de la tabla"
+                                                          : "Recorrido completo del índice");
+    }
+
+    // Estimación del optimizador desviada en un orden de magnitud o más
+    if (n.rows >= 0 && n.rRows >= 0) {
+        const double hi = qMax(n.rows, n.rRows), lo = qMax(1.0, qMin(n.rows, n.rRows));
+        if (hi / lo >= 10) {
+            item->setForeground(ColRealRows, QColor("#c06000"));
+            item->setToolTip(ColRealRows, QString("Estimadas %1, reales %2").arg(numberText(n.rows), numberText(n.rRows, 1)));
+        }
+    }
+
+    for (const auto& c : n.children) addItem(c, item, hot);
+}
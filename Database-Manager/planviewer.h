@@ -0,0 +1,90 @@
+#pragma once
+#include <QWidget>
+#include <QPointer>
+#include <QJsonObject>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+class DbSession;
+class MetadataService;
+class QThread;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QPlainTextEdit;
+class QTabWidget;
+
+// Plan de ejecución de una sentencia como árbol: EXPLAIN FORMAT=JSON o, si se pide,
+// ANALYZE FORMAT=JSON (que la ejecuta) en una conexión propia, en otro hilo. Cerrar el visor
+// con un ANALYZE en curso lo cancela con KILL QUERY sin esperarlo.
+// Se resaltan los nodos más caros (tiempo real, coste o filas estimadas, según lo que traiga
+// el plan), los recorridos completos y los filesort / tablas temporales. Las llaves que
+// MetadataService conoce como índices de la base son enlaces (indexActivated); si no están en
+// su caché se leen en el mismo hilo del plan y se guardan en ella.
+class PlanViewer : public QWidget {
+    Q_OBJECT
+public:
+    PlanViewer(const DbSession* s, MetadataService* meta, QWidget* parent = nullptr);
+    ~PlanViewer() override;
+
+    // false si todavía se está obteniendo el plan anterior.
+    bool explain(const QString& sql, const QString& db, bool analyze);
+    bool isRunning() const;
+    // KILL QUERY a la sentencia en curso desde una conexión lateral; no bloquea.
+    void cancel();
+
+    struct Node {
+        QString kind;          // "query_block", "table" o la operación (filesort, ...)
+        QString label;
+        QString accessType;
+        QString key;
+        QString possibleKeys;
+        QString detail;        // condición, clave de orden...
+        double rows = -1;      // estimadas por recorrido
+        double rRows = -1;     // reales (ANALYZE)
+        double filtered = -1;
+        double rFiltered = -1;
+        double loops = -1;
+        double timeMs = -1;
+        double cost = -1;
+        bool fullScan = false;
+        bool filesort = false;
+        bool temporary = false;
+        std::vector<Node> children;
+    };
+    static Node parse(const QJsonObject& plan);
+
+signals:
+    void indexActivated(const QString& db, const QString& table, const QString& index);
+    void finished(bool ok, const QString& message);
+
+private:
+    void display(const Node& root, const QByteArray& json, qint64 ms);
+    void addItem(const Node& n, QTreeWidgetItem* parent, const QVector<const Node*>& hot);
+    QString indexTable(const QString& table, const QString& key) const;
+
+    // Compartido con el hilo, que puede seguir vivo después de cerrar el visor
+    struct Run {
+        std::atomic<qint64> connId{-1};      // de la conexión del hilo, para KILL QUERY
+        std::atomic<bool> cancelled{false};
+    };
+
+    const DbSession* s;
+    MetadataService* meta;
+    QPointer<QThread> job;
+    std::shared_ptr<Run> run;
+
+    QString db;
+    bool analyze = false;
+    QHash<QString, QStringList> indexes;   // de la base, para enlazar las llaves
+
+    QLabel* title;
+    QLabel* status;
+    QTabWidget* tabs;
+    QTreeWidget* tree;
+    QPlainTextEdit* raw;
+};
@@ -0,0 +1,303 @@
+#include "QueryHistory.h"
+#include "SqlText.h"
+#include <QStandardPaths>
+#include <QDir>
+#include <QByteArrayMatcher>
+#include <QRegularExpression>
+#include <cstring>
+
+static const quint32 kLogMagic = 0x4C484D44;     // "DMHL"
+static const quint32 kIdxMagic = 0x49484D44;     // "DMHI"
+static const quint32 kRecordMagic = 0x52484D44;  // "DMHR"
+static const quint32 kVersion = 1;
+static const qint64 kFileHeader = 8;             // magic + versión
+
+QueryHistory::QueryHistory(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QueryHistory::~QueryHistory()
+{
+    if (logMap) log.unmap(logMap);
+    if (idxMap) idx.unmap(idxMap);
+}
+
+quint64 QueryHistory::hash(const QString& fingerprint)
+{
+    // FNV-1a de 64 bits: estable entre ejecuciones (qHash usa semilla aleatoria)
+    quint64 h = 14695981039346656037ULL;
+    const QByteArray b = fingerprint.toUtf8();
+    for (const char c : b) {
+        h ^= quint8(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static bool openWithHeader(QFile& f, quint32 magic, QString* err)
+{
+    if (!f.open(QIODevice::ReadWrite)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    if (f.size() < kFileHeader) {
+        const quint32 h[2] = { magic, kVersion };
+        f.resize(0);
+        if (f.write(reinterpret_cast<const char*>(h), sizeof(h)) != sizeof(h)) {
+            if (err) *err = f.errorString();
+            return false;
+        }
+        f.flush();
+        return true;
+    }
+    quint32 h[2] = {0, 0};
+    f.seek(0);
+    if (f.read(reinterpret_cast<char*>(h), sizeof(h)) != sizeof(h) || h[0] != magic || h[1] != kVersion) {
+        if (err) *err = "Formato desconocido: " + f.fileName();
+        return false;
+    }
+    return true;
+}
+
+bool QueryHistory::open(const QString& dir, QString* err)
+{
+    const QString path = dir.isEmpty()
+        ? QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) : dir;
+    QDir().mkpath(path);
+
+    log.setFileName(path + "/history.log");
+    idx.setFileName(path + "/history.idx");
+    if (!openWithHeader(log, kLogMagic, err)) { log.close(); return false; }
+    if (!openWithHeader(idx, kIdxMagic, err)) {
+        // Índice ilegible: se reconstruye entero desde el log
+        idx.close();
+        if (!idx.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+            if (err) *err = idx.errorString();
+            log.close();
+            return false;
+        }
+        idx.close();
+        if (!openWithHeader(idx, kIdxMagic, err)) { log.close(); return false; }
+    }
+    if (!recover(err)) {
+        log.close();
+        idx.close();
+        return false;
+    }
+
+    // Grupos: recorrido desde la más reciente, así la primera vista de cada huella
+    // es la última ejecución y solo se lee su SQL
+    for (int i = entryCount() - 1; i >= 0; --i) {
+        const IndexEntry e = indexAt(i);
+        int g = groupOf.value(e.fingerprint, -1);
+        if (g < 0) {
+            g = groups.size();
+            groupOf.insert(e.fingerprint, g);
+            Group grp;
+            grp.fingerprint = e.fingerprint;
+            grp.last = i;
+            grp.folded = entry(i).sql.toLower().toUtf8();
+            groups.append(grp);
+            byRecency.append(g);
+        }
+        ++groups[g].count;
+    }
+    return true;
+}
+
+bool QueryHistory::recover(QString* err)
+{
+    const qint64 logSize = log.size();
+    logMap = log.map(0, logSize);
+    logMapSize = logMap ? logSize : 0;
+
+    const qint64 idxSize = idx.size();
+    int n = int((idxSize - kFileHeader) / qint64(sizeof(IndexEntry)));
+    idxMap = idx.map(0, idxSize);
+    if (!logMap || !idxMap) {
+        if (err) *err = "No se pudo mapear el historial en memoria.";
+        return false;
+    }
+    mappedCount = n;
+
+    // Entradas que apuntan más allá del log (el log se truncó): fuera
+    auto endOf = [this](quint64 offset) -> qint64 {
+        RecordHeader h;
+        if (!readHeader(offset, &h)) return -1;
+        return qint64(offset) + qint64(sizeof(h)) + h.sqlBytes + h.profileBytes + h.dbBytes;
+    };
+    qint64 pos = kFileHeader;
+    while (n > 0) {
+        const qint64 end = endOf(indexAt(n - 1).offset);
+        if (end > 0 && end <= logSize) { pos = end; break; }
+        --n;
+    }
+    if (n != mappedCount || idxSize != kFileHeader + qint64(n) * qint64(sizeof(IndexEntry))) {
+        idx.unmap(idxMap);
+        idx.resize(kFileHeader + qint64(n) * qint64(sizeof(IndexEntry)));
+        idxMap = idx.map(0, idx.size());
+        mappedCount = n;
+        if (!idxMap) {
+            if (err) *err = idx.errorString();
+            return false;
+        }
+    }
+
+    // Registros del log que no llegaron al índice
+    for (;;) {
+        RecordHeader h;
+        const qint64 end = endOf(quint64(pos));
+        if (end < 0 || end > logSize || !readHeader(quint64(pos), &h)) break;
+        const QByteArray body = recordAt(quint64(pos) + sizeof(h), h.sqlBytes);
+        appendIndex(IndexEntry{ quint64(pos), hash(SqlText::fingerprint(QString::fromUtf8(body))),
+                                h.timestamp, h.rows, h.durationMs });
+        pos = end;
+    }
+
+    // Cola a medio escribir
+    if (pos < logSize) {
+        log.unmap(logMap);
+        log.resize(pos);
+        logMap = pos > 0 ? log.map(0, pos) : nullptr;
+        logMapSize = logMap ? pos : 0;
+    }
+    logEnd = pos;
+    return true;
+}
+
+QueryHistory::IndexEntry QueryHistory::indexAt(int i) const
+{
+    if (i >= mappedCount) return added[i - mappedCount];
+    IndexEntry e;
+    std::memcpy(&e, idxMap + kFileHeader + qint64(i) * qint64(sizeof(IndexEntry)), sizeof(e));
+    return e;
+}
+
+QByteArray QueryHistory::recordAt(quint64 offset, qint64 size) const
+{
+    if (qint64(offset) + size <= logMapSize)
+        return QByteArray(reinterpret_cast<const char*>(logMap + offset), int(size));
+    // Escrito en esta sesión, después del mapeo
+    if (!log.seek(qint64(offset))) return {};
+    return log.read(size);
+}
+
+bool QueryHistory::readHeader(quint64 offset, RecordHeader* h) const
+{
+    const QByteArray b = recordAt(offset, sizeof(RecordHeader));
+    if (b.size() != int(sizeof(RecordHeader))) return false;
+    std::memcpy(h, b.constData(), sizeof(RecordHeader));
+    return h->magic == kRecordMagic;
+}
+
+void QueryHistory::appendIndex(const IndexEntry& e)
+{
+    idx.seek(idx.size());
+    idx.write(reinterpret_cast<const char*>(&e), sizeof(e));
+    idx.flush();
+    added.append(e);
+}
+
+QueryHistory::Entry QueryHistory::entry(int index) const
+{
+    Entry out;
+    const IndexEntry e = indexAt(index);
+    RecordHeader h;
+    if (!readHeader(e.offset, &h)) return out;
+
+    const QByteArray body = recordAt(e.offset + sizeof(h), qint64(h.sqlBytes) + h.profileBytes + h.dbBytes);
+    out.sql = QString::fromUtf8(body.constData(), int(h.sqlBytes));
+    out.profile = QString::fromUtf8(body.constData() + h.sqlBytes, int(h.profileBytes));
+    out.database = QString::fromUtf8(body.constData() + h.sqlBytes + h.profileBytes, int(h.dbBytes));
+    out.when = QDateTime::fromMSecsSinceEpoch(h.timestamp);
+    out.durationMs = h.durationMs;
+    out.rows = h.rows;
+    return out;
+}
+
+void QueryHistory::add(const QString& sql, const QString& profile, const QString& database,
+                       qint64 durationMs, qint64 rows)
+{
+    if (!isOpen() || sql.trimmed().isEmpty()) return;
+
+    const QByteArray s = sql.toUtf8(), p = profile.toUtf8(), d = database.toUtf8();
+    RecordHeader h;
+    h.magic = kRecordMagic;
+    h.sqlBytes = quint32(s.size());
+    h.profileBytes = quint32(p.size());
+    h.dbBytes = quint32(d.size());
+    h.timestamp = QDateTime::currentMSecsSinceEpoch();
+    h.rows = rows;
+    h.durationMs = durationMs;
+
+    QByteArray rec(reinterpret_cast<const char*>(&h), sizeof(h));
+    rec += s;
+    rec += p;
+    rec += d;
+
+    // Primero el log: si el índice no llega a escribirse, recover() lo completa
+    log.seek(logEnd);
+    if (log.write(rec) != rec.size()) return;
+    log.flush();
+
+    const IndexEntry e{ quint64(logEnd), hash(SqlText::fingerprint(sql)), h.timestamp, rows, durationMs };
+    logEnd += rec.size();
+    appendIndex(e);
+
+    // Grupo al frente de la lista por recencia
+    const int i = entryCount() - 1;
+    int g = groupOf.value(e.fingerprint, -1);
+    if (g < 0) {
+        g = groups.size();
+        groupOf.insert(e.fingerprint, g);
+        Group grp;
+        grp.fingerprint = e.fingerprint;
+        groups.append(grp);
+    } else {
+        byRecency.removeOne(g);
+    }
+    byRecency.prepend(g);
+    Group& grp = groups[g];
+    grp.last = i;
+    ++grp.count;
+    grp.folded = sql.toLower().toUtf8();
+
+    lastQuery.clear();
+    lastHits.clear();
+    emit added(g);
+}
+
+QVector<int> QueryHistory::search(const QString& text)
+{
+    const QString q = text.toLower();
+    const QStringList words = q.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    if (words.isEmpty()) {
+        lastQuery.clear();
+        lastHits.clear();
+        return byRecency;
+    }
+
+    // Si el texto nuevo extiende al anterior, cada palabra vieja es prefijo de una nueva:
+    // los aciertos nuevos son un subconjunto de los anteriores
+    const bool narrow = !lastQuery.isEmpty() && q.startsWith(lastQuery);
+    const QVector<int>& base = narrow ? lastHits : byRecency;
+
+    QVector<QByteArrayMatcher> matchers;
+    matchers.reserve(words.size());
+    for (const auto& w : words) matchers.append(QByteArrayMatcher(w.toUtf8()));
+
+    QVector<int> hits;
+    for (int g : base) {
+        const QByteArray& f = groups[g].folded;
+        bool all = true;
+        for (const auto& m : matchers) {
+            if (m.indexIn(f) < 0) { all = false; break; }
+        }
+        if (all) hits.append(g);
+    }
+
+    lastQuery = q;
+    lastHits = hits;
+    return hits;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+#include <QDateTime>
+
+// Historial de consultas persistente. Dos archivos en el directorio de datos de la app:
+//   history.log  registros de solo-anexar (cabecera fija + SQL, perfil y base en UTF-8)
+//   history.idx  un IndexEntry de 40 bytes por registro
+// Al abrir se mapean ambos en memoria; el índice se repara desde el log si quedó corto
+// (cierre a mitad de escritura). Las repeticiones se agrupan por la huella de
+// SqlText::fingerprint y la búsqueda recorre un texto en minúsculas por grupo, no por
+// ejecución, así que el coste depende de las consultas distintas.
+class QueryHistory : public QObject {
+    Q_OBJECT
+public:
+    struct Entry {
+        QString sql;
+        QString profile;
+        QString database;
+        QDateTime when;
+        qint64 durationMs = 0;
+        qint64 rows = -1;
+    };
+
+    // Consultas que comparten huella; la más reciente representa al grupo.
+    struct Group {
+        quint64 fingerprint = 0;
+        int last = -1;       // índice de la ejecución más reciente
+        int count = 0;
+        QByteArray folded;   // SQL de la última ejecución en minúsculas (UTF-8)
+    };
+
+    explicit QueryHistory(QObject* parent = nullptr);
+    ~QueryHistory() override;
+
+    // dir vacío = QStandardPaths::AppLocalDataLocation
+    bool open(const QString& dir = {}, QString* err = nullptr);
+    bool isOpen() const { return log.isOpen(); }
+
+    void add(const QString& sql, const QString& profile, const QString& database,
+             qint64 durationMs, qint64 rows);
+
+    int entryCount() const { return mappedCount + added.size(); }
+    Entry entry(int index) const;
+
+    const Group& group(int g) const { return groups[g]; }
+    int groupCount() const { return groups.size(); }
+
+    // Grupos cuyo SQL contiene todas las palabras de text (sin distinguir mayúsculas),
+    // el más reciente primero. Si text amplía la búsqueda anterior solo se filtran
+    // los aciertos previos.
+    QVector<int> search(const QString& text);
+
+    static quint64 hash(const QString& fingerprint);
+
+signals:
+    void added(int group);
+
+private:
+#pragma pack(push, 1)
+    struct RecordHeader {
+        quint32 magic;
+        quint32 sqlBytes;
+        quint32 profileBytes;
+        quint32 dbBytes;
+        qint64 timestamp;    // ms desde epoch (UTC)
+        qint64 rows;
+        qint64 durationMs;
+    };
+    struct IndexEntry {
+        quint64 offset;
+        quint64 fingerprint;
+        qint64 timestamp;
+        qint64 rows;
+        qint64 durationMs;
+    };
+#pragma pack(pop)
+
+    IndexEntry indexAt(int i) const;
+    QByteArray recordAt(quint64 offset, qint64 size) const;
+    bool readHeader(quint64 offset, RecordHeader* h) const;
+    bool recover(QString* err);
+    void appendIndex(const IndexEntry& e);
+
+    mutable QFile log;             // se lee con seek lo escrito tras el mapeo
+    QFile idx;
+    uchar* logMap = nullptr;
+    qint64 logMapSize = 0;
+    uchar* idxMap = nullptr;
+    int mappedCount = 0;           // entradas del índice mapeado
+    QVector<IndexEntry> added;     // escritas en esta sesión (o reparadas al abrir)
+    qint64 logEnd = 0;
+
+    QVector<Group> groups;
+    QHash<quint64, int> groupOf;   // huella -> grupo
+    QVector<int> byRecency;        // grupos, el más reciente primero
+
+    QString lastQuery;
+    QVector<int> lastHits;
+};
@@ -0,0 +1,90 @@
+#include "QueryStats.h"
+#include "SqlText.h"
+#include <QSettings>
+#include <algorithm>
+
+QueryStats::QueryStats(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QueryTiming>("QueryTiming");
+
+    QSettings s("UNITEC", "Database-Manager");
+    maxEntries = qMax(10, s.value("timing/history", 200).toInt());
+}
+
+QString QueryStats::kindOf(const QString& sql)
+{
+    const QString t = SqlText::firstTokenUpper(sql);
+    return t.isEmpty() ? QString("?") : t;
+}
+
+int QueryStats::begin(const QString& source, const QString& sql)
+{
+    QueryTiming t;
+    t.key = ++nextKey;
+    t.source = source;
+    t.sql = sql;
+    t.kind = kindOf(sql);
+    entries.append(t);
+    if (entries.size() > maxEntries) entries.remove(0, entries.size() - maxEntries);
+    emit changed();
+    return t.key;
+}
+
+void QueryStats::record(const QueryTiming& t)
+{
+    // Las activas están al final: búsqueda desde atrás
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        QueryTiming& e = entries[i];
+        if (e.key != t.key) continue;
+
+        const bool finishing = t.done && !e.done;
+        const QString source = e.source, sql = e.sql, kind = e.kind;
+        e = t;
+        e.source = source;
+        e.sql = sql;
+        e.kind = kind;
+
+        if (finishing && e.ok) {
+            QVector<qint64>& v = samples[e.kind];
+            v.append(e.activeMs());
+            if (v.size() > maxSamples) v.remove(0, v.size() - maxSamples);
+        }
+        emit changed();
+        return;
+    }
+}
+
+void QueryStats::recordSimple(const QString& source, const QString& what, qint64 ms, qint64 rows)
+{
+    begin(source, what);
+    // El tipo de las llamadas internas es su origen, no la primera palabra
+    entries.last().kind = source;
+
+    QueryTiming t = entries.last();
+    t.executeMs = ms;
+    t.rows = qMax<qint64>(rows, 0);
+    t.done = true;
+    record(t);
+}
+
+static qint64 percentile(QVector<qint64> v, double p)
+{
+    if (v.isEmpty()) return 0;
+    const int k = qBound(0, int(p * (v.size() - 1) + 0.5), v.size() - 1);
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+QHash<QString, QueryStats::Percentiles> QueryStats::percentilesByKind() const
+{
+    QHash<QString, Percentiles> out;
+    for (auto it = samples.constBegin(); it != samples.constEnd(); ++it) {
+        Percentiles p;
+        p.samples = it->size();
+        p.p50 = percentile(*it, 0.50);
+        p.p95 = percentile(*it, 0.95);
+        out.insert(it.key(), p);
+    }
+    return out;
+}
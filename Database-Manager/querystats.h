@@ -0,0 +1,60 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMetaType>
+#include <QElapsedTimer>
+
+// Tiempos de una ejecución, todos en ms medidos con reloj monótono.
+// -1 = todavía no ocurrió / no aplica.
+struct QueryTiming {
+    int key = -1;            // asignado por QueryStats::begin
+    QString source;          // "consola", "datos", "script", "metadatos", "árbol"
+    QString kind;            // tipo de sentencia (SELECT, SHOW, ...)
+    QString sql;
+
+    qint64 executeMs = -1;   // hasta que exec() vuelve (servidor)
+    qint64 firstRowMs = -1;  // desde el inicio hasta la primera fila leída
+    qint64 fetchMs = 0;      // suma de los tramos leídos por ODBC
+    qint64 rows = 0;
+    qint64 bytes = 0;        // bytes de los valores ya convertidos (no del protocolo)
+    qint64 modelMs = 0;      // inserción en el modelo
+    qint64 renderMs = 0;     // pintado de la vista mientras llegaban filas
+    bool done = false;
+    bool ok = true;
+
+    // Tiempo activo: servidor + fetch + GUI (sin las pausas entre scrolls)
+    qint64 activeMs() const { return qMax<qint64>(executeMs, 0) + fetchMs + modelMs + renderMs; }
+};
+Q_DECLARE_METATYPE(QueryTiming)
+
+// Últimas N ejecuciones y p50/p95 por tipo de sentencia. Solo hilo de la GUI.
+class QueryStats : public QObject {
+    Q_OBJECT
+public:
+    explicit QueryStats(QObject* parent = nullptr);
+
+    // Reserva una entrada; record() la va actualizando con la misma key.
+    int begin(const QString& source, const QString& sql);
+    void record(const QueryTiming& t);
+    // Para llamadas sin fetch por tramos (metadatos, árbol)
+    void recordSimple(const QString& source, const QString& what, qint64 ms, qint64 rows = -1);
+
+    const QVector<QueryTiming>& history() const { return entries; }
+
+    struct Percentiles { int samples = 0; qint64 p50 = 0; qint64 p95 = 0; };
+    QHash<QString, Percentiles> percentilesByKind() const;
+
+    static QString kindOf(const QString& sql);
+
+signals:
+    void changed();
+
+private:
+    QVector<QueryTiming> entries;      // la más antigua primero
+    QHash<QString, QVector<qint64>> samples;
+    int nextKey = 0;
+    int maxEntries = 200;
+    int maxSamples = 1000;
+};
@@ -0,0 +1,407 @@
+#include "QueryWorker.h"
+#include "DbSession.h"
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlRecord>
+#include <QtSql/QSqlError>
+#include <QElapsedTimer>
+#include <QSettings>
+
+// Tamaño de los bloques que se envían a la GUI dentro de un tramo.
+static const int kRowBlock = 500;
+static const qint64 kBlockBytes = 8 * 1024 * 1024;
+
+QueryWorker::QueryWorker(const DbSession* s)
+    : s(s)
+{
+    // Los TEXT/BLOB se guardan recortados: la vista solo enseña el principio
+    QSettings st("UNITEC", "Database-Manager");
+    previewBytes = qMax(0, st.value("results/lobPreviewBytes", 64 * 1024).toInt());
+}
+
+QueryWorker::~QueryWorker()
+{
+    releaseConnection();
+}
+
+void QueryWorker::releaseConnection()
+{
+    closeCursor();
+    lease.release();
+    connId = -1;
+}
+
+bool QueryWorker::ensureOpen(QString* err)
+{
+    if (lease.isValid() && lease.db().isOpen())
+        return true;
+
+    connId = -1;
+    // NO_CACHE: el conector ODBC no guarda todo el result set en memoria antes de la primera fila.
+    // Conexión propia y fuera del tope del pool: la sesión la retiene mientras exista (su USE y
+    // sus variables siguen ahí) y no deja sin conexiones a exportaciones, comparaciones, etc.
+    lease = s->acquireDedicated("NO_CACHE=1;", err);
+    if (!lease.isValid()) return false;
+
+    QSqlQuery q(lease.db());
+    if (q.exec("SELECT CONNECTION_ID()") && q.next())
+        connId = q.value(0).toLongLong();
+    return true;
+}
+
+void QueryWorker::closeCursor()
+{
+    cursor.reset();
+    cursorId = -1;
+    types.clear();
+    fields.clear();
+    lengths.clear();
+}
+
+QStringList QueryWorker::describe(const QSqlRecord& rec)
+{
+    // `col__dm_len` junto a `col` es su tamaño real: se pliega en ella y no se muestra
+    const QVector<ColumnType> all = ResultBuffer::typesFor(rec);
+    const QString suffix = ResultBuffer::lengthSuffix();
+    QStringList cols;
+    types.clear();
+    fields.clear();
+    lengths.clear();
+    for (int c = 0; c < rec.count(); ++c) {
+        const QString name = rec.fieldName(c);
+        if (name.endsWith(suffix) && rec.indexOf(name.chopped(suffix.size())) >= 0) continue;
+        cols << name;
+        types << all[c];
+        fields << c;
+        lengths << rec.indexOf(name + suffix);
+    }
+    return cols;
+}
+
+void QueryWorker::addRow(ChunkBuilder& block) const
+{
+    for (int c = 0; c < fields.size(); ++c) {
+        block.addValue(c, cursor->value(fields[c]));
+        if (lengths[c] < 0) continue;
+        const QVariant n = cursor->value(lengths[c]);
+        if (!n.isNull()) block.setFullLength(c, n.toLongLong());
+    }
+    block.endRow();
+}
+
+void QueryWorker::run(int id, const QString& sql, int firstChunk)
+{
+    closeCursor();
+
+    QString err;
+    if (!ensureOpen(&err)) {
+        emit finished(id, false, err, -1);
+        return;
+    }
+    emit started(id);
+
+    timing = QueryTiming();
+    runClock.start();
+
+    cursor.reset(new QSqlQuery(lease.db()));
+    cursor->setForwardOnly(true);
+
+    const bool executed = DbSession::execute(*cursor, sql);
+    timing.executeMs = runClock.elapsed();
+    if (!executed) {
+        err = isCancelled(id) ? "Consulta cancelada." : cursor->lastError().text();
+        closeCursor();
+        timing.ok = false;
+        timing.done = true;
+        emit timingUpdated(id, timing);
+        emit finished(id, false, err, -1);
+        return;
+    }
+
+    if (!cursor->isSelect()) {
+        const qint64 affected = cursor->numRowsAffected();
+        closeCursor();
+        timing.done = true;
+        emit timingUpdated(id, timing);
+        emit finished(id, true, {}, affected);
+        return;
+    }
+
+    emit columnsReady(id, describe(cursor->record()));
+
+    cursorId = id;
+    const bool ok = fetchChunk(id, firstChunk, &err);
+    emit timingUpdated(id, timing);
+    if (!ok) {
+        emit finished(id, false, err, -1);
+        return;
+    }
+    emit finished(id, true, {}, -1);
+}
+
+void QueryWorker::fetchMore(int id, int n)
+{
+    if (id != cursorId || !cursor) return;
+
+    QString err;
+    const bool ok = fetchChunk(id, n, &err);
+    emit timingUpdated(id, timing);
+    if (!ok) emit fetchFailed(id, err);
+}
+
+bool QueryWorker::fetchChunk(int id, int n, QString* err)
+{
+    // Las filas se convierten a formato columnar aquí, fuera del hilo de la GUI.
+    ChunkBuilder block(types, previewBytes);
+    QElapsedTimer clock;
+    clock.start();
+    auto send = [&](){
+        timing.bytes += block.memoryUsage();
+        emit rowsReady(id, block.take());
+    };
+    // Pasa el tiempo de este tramo a timing en cualquier salida
+    struct Stopwatch {
+        QueryTiming& t; QElapsedTimer& c;
+        ~Stopwatch() { t.fetchMs += c.elapsed(); }
+    } stopwatch{timing, clock};
+
+    bool more = true;
+    for (int fetched = 0; fetched < n; ++fetched) {
+        if (isCancelled(id)) {
+            if (!block.isEmpty()) send();
+            closeCursor();
+            timing.ok = false;
+            timing.done = true;
+            emit fetchDone(id, false);
+            *err = "Consulta cancelada.";
+            return false;
+        }
+
+        if (!cursor->next()) {
+            more = false;
+            break;
+        }
+
+        if (timing.firstRowMs < 0) timing.firstRowMs = runClock.elapsed();
+        ++timing.rows;
+
+        addRow(block);
+
+        // Bloques parciales para que la vista muestre filas mientras se sigue leyendo.
+        if (block.rowCount() >= kRowBlock || block.memoryUsage() >= kBlockBytes)
+            send();
+    }
+    if (!block.isEmpty()) send();
+
+    if (!more) {
+        const QSqlError e = cursor->lastError();
+        closeCursor();
+        timing.done = true;
+        timing.ok = e.type() == QSqlError::NoError;
+        emit fetchDone(id, false);
+        if (e.type() != QSqlError::NoError) {
+            *err = isCancelled(id) ? "Consulta cancelada." : e.text();
+            return false;
+        }
+        return true;
+    }
+
+    emit fetchDone(id, true);
+    return true;
+}
+
+void QueryWorker::runScript(int id, const QStringList& statements, int maxRows, bool stopOnError)
+{
+    closeCursor();
+
+    QString err;
+    if (!ensureOpen(&err)) {
+        emit finished(id, false, err, -1);
+        return;
+    }
+    emit started(id);
+
+    int failed = 0;
+    int ran = 0;
+    QString firstError;
+    for (int i = 0; i < statements.size() && !isCancelled(id); ++i) {
+        emit statementStarted(id, i);
+
+        QElapsedTimer t;
+        t.start();
+        qint64 affected = -1;
+        bool truncated = false;
+        const bool ok = runStatement(id, i, statements[i], maxRows, &err, &affected, &truncated);
+        emit statementFinished(id, i, ok, ok ? QString() : err, affected, t.elapsed(), truncated);
+        ++ran;
+
+        if (!ok) {
+            ++failed;
+            if (firstError.isEmpty()) firstError = QString("Sentencia %1: %2").arg(i + 1).arg(err);
+            if (stopOnError) break;
+        }
+    }
+
+    if (isCancelled(id)) {
+        emit finished(id, false, QString("Script cancelado tras %1 de %2 sentencias.")
+                                     .arg(ran).arg(statements.size()), -1);
+    } else if (failed > 0) {
+        emit finished(id, false, QString("%1 de %2 sentencias con error. %3")
+                                     .arg(failed).arg(statements.size()).arg(firstError), -1);
+    } else {
+        emit finished(id, true, {}, ran);
+    }
+}
+
+bool QueryWorker::runStatement(int id, int index, const QString& sql, int maxRows,
+                               QString* err, qint64* affected, bool* truncated)
+{
+    cursor.reset(new QSqlQuery(lease.db()));
+    cursor->setForwardOnly(true);
+
+    if (!DbSession::execute(*cursor, sql)) {
+        *err = isCancelled(id) ? "Consulta cancelada." : cursor->lastError().text();
+        closeCursor();
+        return false;
+    }
+
+    if (!cursor->isSelect()) {
+        *affected = cursor->numRowsAffected();
+        closeCursor();
+        return true;
+    }
+
+    emit statementColumns(id, index, describe(cursor->record()));
+
+    ChunkBuilder block(types, previewBytes);
+    qint64 rows = 0;
+    bool more = true;
+    while (!isCancelled(id)) {
+        if (!cursor->next()) {
+            more = false;
+            break;
+        }
+        if (rows >= maxRows) break;
+
+        addRow(block);
+        ++rows;
+
+        if (block.rowCount() >= kRowBlock || block.memoryUsage() >= kBlockBytes)
+            emit statementRows(id, index, block.take());
+    }
+    if (!block.isEmpty()) emit statementRows(id, index, block.take());
+
+    const QSqlError e = more ? QSqlError() : cursor->lastError();
+    // Cerrar el cursor descarta en el servidor las filas que no se leyeron.
+    closeCursor();
+    *affected = rows;
+    *truncated = more && !isCancelled(id);
+
+    if (isCancelled(id)) {
+        *err = "Consulta cancelada.";
+        return false;
+    }
+    if (e.type() != QSqlError::NoError) {
+        *err = e.text();
+        return false;
+    }
+    return true;
+}
+
+QuerySession::QuerySession(const DbSession* s, QObject* parent)
+    : QObject(parent), s(s)
+{
+    qRegisterMetaType<ResultChunk>("ResultChunk");
+    qRegisterMetaType<QueryTiming>("QueryTiming");
+
+    worker = new QueryWorker(s);
+    worker->moveToThread(&thread);
+    // La conexión vuelve al pool desde el propio hilo, antes de que termine.
+    QueryWorker* w = worker;
+    connect(&thread, &QThread::finished, worker, [w](){ w->releaseConnection(); }, Qt::DirectConnection);
+    connect(&thread, &QThread::finished, worker, &QObject::deleteLater);
+
+    connect(worker, &QueryWorker::started, this, &QuerySession::started);
+    connect(worker, &QueryWorker::columnsReady, this, &QuerySession::columnsReady);
+    connect(worker, &QueryWorker::rowsReady, this, &QuerySession::rowsReady);
+    connect(worker, &QueryWorker::fetchDone, this, &QuerySession::fetchDone);
+    connect(worker, &QueryWorker::fetchFailed, this, &QuerySession::fetchFailed);
+    connect(worker, &QueryWorker::timingUpdated, this, &QuerySession::timingUpdated);
+    connect(worker, &QueryWorker::statementStarted, this, &QuerySession::statementStarted);
+    connect(worker, &QueryWorker::statementColumns, this, &QuerySession::statementColumns);
+    connect(worker, &QueryWorker::statementRows, this, &QuerySession::statementRows);
+    connect(worker, &QueryWorker::statementFinished, this, &QuerySession::statementFinished);
+    connect(worker, &QueryWorker::finished, this,
+            [this](int id, bool ok, const QString& error, qint64 affected){
+                if (id == current) current = -1;
+                emit finished(id, ok, error, affected);
+            });
+
+    thread.start();
+}
+
+QuerySession::~QuerySession()
+{
+    cancel();
+    thread.quit();
+    thread.wait();
+}
+
+int QuerySession::begin()
+{
+    if (current >= 0) return -1;
+
+    // Un cursor a medio leer retiene la conexión: se aborta en el servidor antes de reutilizarla.
+    const int open = worker->openCursor();
+    if (open >= 0) {
+        worker->requestCancel(open);
+        killRunning();
+    }
+
+    current = ++nextId;
+    return current;
+}
+
+int QuerySession::execute(const QString& sql, int firstChunk)
+{
+    const int id = begin();
+    if (id < 0) return -1;
+
+    QueryWorker* w = worker;
+    QMetaObject::invokeMethod(w, [w, id, sql, firstChunk](){ w->run(id, sql, firstChunk); },
+                              Qt::QueuedConnection);
+    return id;
+}
+
+int QuerySession::executeScript(const QStringList& statements, int maxRows, bool stopOnError)
+{
+    const int id = begin();
+    if (id < 0) return -1;
+
+    QueryWorker* w = worker;
+    QMetaObject::invokeMethod(w, [w, id, statements, maxRows, stopOnError](){
+        w->runScript(id, statements, maxRows, stopOnError);
+    }, Qt::QueuedConnection);
+    return id;
+}
+
+void QuerySession::fetchMore(int id, int n)
+{
+    QueryWorker* w = worker;
+    QMetaObject::invokeMethod(w, [w, id, n](){ w->fetchMore(id, n); }, Qt::QueuedConnection);
+}
+
+void QuerySession::cancel()
+{
+    const int id = current >= 0 ? current : worker->openCursor();
+    if (id < 0) return;
+    worker->requestCancel(id);
+    killRunning();
+}
+
+void QuerySession::killRunning()
+{
+    // KILL QUERY desde una conexión lateral: el hilo del worker puede estar bloqueado en
+    // exec(). Se envía desde un hilo de trabajo: esperar una conexión aquí congelaría la GUI.
+    s->killQuery(worker->connectionId());
+}
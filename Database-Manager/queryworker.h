@@ -0,0 +1,115 @@
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include "ResultBuffer.h"
+#include "DbSession.h"
+#include "QueryStats.h"
+
+class QSqlQuery;
+
+// Vive en el hilo de QuerySession y tiene una conexión propia (acquireDedicated) mientras exista.
+// Un SELECT deja el cursor abierto (forward-only) y las filas se leen por tramos con fetchMore.
+class QueryWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit QueryWorker(const DbSession* s);
+    ~QueryWorker() override;
+
+    // Seguros de llamar desde otro hilo.
+    void requestCancel(int id) { cancelled = id; }
+    qint64 connectionId() const { return connId; }
+    int openCursor() const { return cursorId; }
+
+    // Devuelve la conexión al pool; llamar desde el hilo del worker.
+    void releaseConnection();
+
+public slots:
+    void run(int id, const QString& sql, int firstChunk);
+    void fetchMore(int id, int n);
+    // Ejecuta las sentencias una tras otra sin volver a la GUI entre ellas.
+    // Los SELECT se leen completos hasta maxRows filas; el resto se descarta.
+    void runScript(int id, const QStringList& statements, int maxRows, bool stopOnError);
+
+signals:
+    void started(int id);
+    void columnsReady(int id, const QStringList& columns);
+    void rowsReady(int id, const ResultChunk& rows);
+    void fetchDone(int id, bool more);
+    void fetchFailed(int id, const QString& error);
+    void finished(int id, bool ok, const QString& error, qint64 affected);
+    // Acumulado de la consulta tras exec y tras cada tramo (modelMs/renderMs los pone la GUI)
+    void timingUpdated(int id, const QueryTiming& timing);
+
+    void statementStarted(int id, int index);
+    void statementColumns(int id, int index, const QStringList& columns);
+    void statementRows(int id, int index, const ResultChunk& rows);
+    // affected: filas afectadas, o filas leídas si fue un SELECT
+    void statementFinished(int id, int index, bool ok, const QString& error,
+                           qint64 affected, qint64 elapsedMs, bool truncated);
+
+private:
+    bool ensureOpen(QString* err);
+    bool runStatement(int id, int index, const QString& sql, int maxRows,
+                      QString* err, qint64* affected, bool* truncated);
+    bool fetchChunk(int id, int n, QString* err);
+    QStringList describe(const QSqlRecord& rec);
+    void addRow(ChunkBuilder& block) const;
+    void closeCursor();
+    bool isCancelled(int id) const { return cancelled == id; }
+
+    const DbSession* s;
+    DbLease lease;
+    std::unique_ptr<QSqlQuery> cursor;
+    QVector<ColumnType> types;
+    QVector<int> fields;     // campo del cursor de cada columna visible
+    QVector<int> lengths;    // campo con su OCTET_LENGTH(), o -1
+    int previewBytes = 0;    // results/lobPreviewBytes
+    std::atomic<int> cursorId{-1};
+    std::atomic<int> cancelled{-1};
+    std::atomic<qint64> connId{-1};
+    QElapsedTimer runClock;
+    QueryTiming timing;
+};
+
+// Lado GUI: ejecuta cada consulta en un hilo propio y reenvía los resultados por señales.
+class QuerySession : public QObject {
+    Q_OBJECT
+public:
+    explicit QuerySession(const DbSession* s, QObject* parent = nullptr);
+    ~QuerySession() override;
+
+    int execute(const QString& sql, int firstChunk);
+    int executeScript(const QStringList& statements, int maxRows, bool stopOnError);
+    void fetchMore(int id, int n);
+    bool isRunning() const { return current >= 0; }
+    void cancel();
+
+signals:
+    void started(int id);
+    void columnsReady(int id, const QStringList& columns);
+    void rowsReady(int id, const ResultChunk& rows);
+    void fetchDone(int id, bool more);
+    void fetchFailed(int id, const QString& error);
+    void finished(int id, bool ok, const QString& error, qint64 affected);
+    // Acumulado de la consulta tras exec y tras cada tramo (modelMs/renderMs los pone la GUI)
+    void timingUpdated(int id, const QueryTiming& timing);
+
+    void statementStarted(int id, int index);
+    void statementColumns(int id, int index, const QStringList& columns);
+    void statementRows(int id, int index, const ResultChunk& rows);
+    void statementFinished(int id, int index, bool ok, const QString& error,
+                           qint64 affected, qint64 elapsedMs, bool truncated);
+
+private:
+    int begin();
+    void killRunning();
+
+    const DbSession* s;
+    QThread thread;
+    QueryWorker* worker = nullptr;
+    int nextId = 0;
+    int current = -1;
+};
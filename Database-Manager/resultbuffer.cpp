@@ -0,0 +1,664 @@
+#include "ResultBuffer.h"
+#include <QtSql/QSqlRecord>
+#include <QtSql/QSqlField>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <QTemporaryFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDir>
+#include <QSet>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <climits>
+
+// Archivo mapeado con tramos: el temporal de volcado de un resultado o una instantánea
+// abierta. Se cierra (y el temporal se borra) cuando ya no queda ningún tramo que lo use,
+// también entre las copias de los hilos de orden/filtro.
+class MappedFile {
+public:
+    explicit MappedFile(QFile* f) : file(f) {}
+    ~MappedFile()
+    {
+        for (uchar* p : maps) file->unmap(p);
+    }
+
+    std::unique_ptr<QFile> file;
+    QVector<uchar*> maps;
+    qint64 size = 0;
+};
+
+static void appendU32(QByteArray& a, quint32 v) { a.append(reinterpret_cast<const char*>(&v), sizeof v); }
+static void append64(QByteArray& a, const void* v) { a.append(static_cast<const char*>(v), 8); }
+
+// Lectura con memcpy: los QByteArray no garantizan alineación a 8.
+static quint32 readU32(const QByteArray& a, int i)
+{
+    quint32 v; std::memcpy(&v, a.constData() + qsizetype(i) * 4, 4); return v;
+}
+static qint64 readI64(const QByteArray& a, int i)
+{
+    qint64 v; std::memcpy(&v, a.constData() + qsizetype(i) * 8, 8); return v;
+}
+static double readF64(const QByteArray& a, int i)
+{
+    double v; std::memcpy(&v, a.constData() + qsizetype(i) * 8, 8); return v;
+}
+
+static ColumnType columnTypeFor(int typeId)
+{
+    switch (typeId) {
+    case QMetaType::Int: case QMetaType::UInt: case QMetaType::LongLong:
+    case QMetaType::Short: case QMetaType::UShort: case QMetaType::Long: case QMetaType::ULong:
+    case QMetaType::Char: case QMetaType::SChar: case QMetaType::UChar:
+        return ColumnType::Int64;
+    case QMetaType::Double: case QMetaType::Float:
+        return ColumnType::Double;
+    case QMetaType::Bool:
+        return ColumnType::Bool;
+    case QMetaType::QDate:
+        return ColumnType::Date;
+    case QMetaType::QDateTime:
+        return ColumnType::DateTime;
+    case QMetaType::QTime:
+        return ColumnType::Time;
+    case QMetaType::QByteArray:
+        return ColumnType::Bytes;
+    default:
+        // ULongLong (BIGINT UNSIGNED) y DECIMAL se guardan como texto para no perder precisión.
+        return ColumnType::Text;
+    }
+}
+
+QVector<ColumnType> ResultBuffer::typesFor(const QSqlRecord& rec)
+{
+    QVector<ColumnType> t(rec.count());
+    for (int i = 0; i < rec.count(); ++i) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        t[i] = columnTypeFor(rec.field(i).metaType().id());
+#else
+        t[i] = columnTypeFor(int(rec.field(i).type()));
+#endif
+    }
+    return t;
+}
+
+bool ResultChunk::isNull(int row, int col) const
+{
+    const ColumnBlock& b = columns[col];
+    return (uchar(b.nulls.at(row >> 3)) >> (row & 7)) & 1;
+}
+
+QVariant ResultChunk::value(int row, int col) const
+{
+    if (isNull(row, col)) return {};
+
+    const ColumnBlock& b = columns[col];
+    switch (b.type) {
+    case ColumnType::Int64:    return QVariant(readI64(b.fixed, row));
+    case ColumnType::Double:   return QVariant(readF64(b.fixed, row));
+    case ColumnType::Bool:     return QVariant(readI64(b.fixed, row) != 0);
+    case ColumnType::Date:     return QVariant(QDate::fromJulianDay(readI64(b.fixed, row)));
+    case ColumnType::DateTime: return QVariant(QDateTime::fromMSecsSinceEpoch(readI64(b.fixed, row)));
+    case ColumnType::Time:     return QVariant(QTime::fromMSecsSinceStartOfDay(int(readI64(b.fixed, row))));
+    case ColumnType::Text:
+    case ColumnType::Bytes: {
+        // Acotados al arena: los offsets de una instantánea no se recorren al abrirla
+        const quint32 n = quint32(b.arena.size());
+        const quint32 s = qMin(readU32(b.offsets, row), n);
+        const quint32 e = qBound(s, readU32(b.offsets, row + 1), n);
+        const char* p = b.arena.constData() + s;
+        if (b.type == ColumnType::Text) return QString::fromUtf8(p, int(e - s));
+        return QByteArray(p, int(e - s));
+    }
+    }
+    return {};
+}
+
+qint64 ResultChunk::fullLength(int row, int col) const
+{
+    const QByteArray& cut = columns[col].cut;
+    int lo = 0, hi = int(cut.size() / 16);
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const qint64 r = readI64(cut, mid * 2);
+        if (r == row) return readI64(cut, mid * 2 + 1);
+        if (r < row) lo = mid + 1; else hi = mid;
+    }
+    return -1;
+}
+
+qint64 ResultChunk::memoryUsage() const
+{
+    qint64 n = sizeof(ResultChunk);
+    // Las páginas del mapeo son del archivo: el sistema las descarta sin pasar por swap
+    if (disk) return n + columns.size() * qint64(sizeof(ColumnBlock));
+    for (const auto& b : columns)
+        n += sizeof(ColumnBlock) + b.nulls.capacity() + b.fixed.capacity() + b.offsets.capacity()
+             + b.arena.capacity() + b.cut.capacity();
+    return n;
+}
+
+ChunkBuilder::ChunkBuilder(const QVector<ColumnType>& types, int previewBytes)
+    : types(types), preview(previewBytes)
+{
+    chunk.columns.resize(types.size());
+    for (int c = 0; c < types.size(); ++c) chunk.columns[c].type = types[c];
+}
+
+void ChunkBuilder::addValue(int col, const QVariant& v)
+{
+    ColumnBlock& b = chunk.columns[col];
+    const int row = chunk.rows;
+
+    if (b.nulls.size() <= (row >> 3)) b.nulls.append('\0');
+    bool null = v.isNull();
+
+    switch (b.type) {
+    case ColumnType::Text:
+    case ColumnType::Bytes:
+        if (b.offsets.isEmpty()) appendU32(b.offsets, 0);
+        if (!null) {
+            const QByteArray bytes = (b.type == ColumnType::Text ? v.toString().toUtf8() : v.toByteArray());
+            if (preview > 0 && bytes.size() > preview) {
+                int n = preview;
+                // Sin partir un carácter UTF-8: se retrocede sobre los bytes de continuación
+                if (b.type == ColumnType::Text)
+                    while (n > 0 && (uchar(bytes.at(n)) & 0xC0) == 0x80) --n;
+                b.arena.append(bytes.constData(), n);
+                const qint64 pair[2] = {row, bytes.size()};
+                b.cut.append(reinterpret_cast<const char*>(pair), sizeof pair);
+            } else {
+                b.arena += bytes;
+            }
+        }
+        appendU32(b.offsets, quint32(b.arena.size()));
+        break;
+    case ColumnType::Double: {
+        const double d = null ? 0.0 : v.toDouble();
+        append64(b.fixed, &d);
+        break;
+    }
+    default: {
+        qint64 x = 0;
+        if (!null) {
+            switch (b.type) {
+            case ColumnType::Bool:     x = v.toBool() ? 1 : 0; break;
+            case ColumnType::Date:     null = !v.toDate().isValid(); x = v.toDate().toJulianDay(); break;
+            case ColumnType::DateTime: null = !v.toDateTime().isValid(); x = v.toDateTime().toMSecsSinceEpoch(); break;
+            case ColumnType::Time:     null = !v.toTime().isValid(); x = v.toTime().msecsSinceStartOfDay(); break;
+            default:                   x = v.toLongLong(); break;
+            }
+        }
+        append64(b.fixed, &x);
+        break;
+    }
+    }
+
+    if (null) b.nulls[row >> 3] = char(uchar(b.nulls.at(row >> 3)) | (1u << (row & 7)));
+}
+
+void ChunkBuilder::setFullLength(int col, qint64 bytes)
+{
+    ColumnBlock& b = chunk.columns[col];
+    if (b.type != ColumnType::Text && b.type != ColumnType::Bytes) return;
+    const int row = chunk.rows;
+    const qint64 stored = readU32(b.offsets, row + 1) - readU32(b.offsets, row);
+    if (bytes <= stored) return;
+
+    const qint64 pair[2] = {row, bytes};
+    // addValue ya pudo recortar esta fila con previewBytes: el tamaño real manda
+    if (b.cut.size() >= 16 && readI64(b.cut, int(b.cut.size() / 8) - 2) == row)
+        std::memcpy(b.cut.data() + b.cut.size() - 16, pair, sizeof pair);
+    else
+        b.cut.append(reinterpret_cast<const char*>(pair), sizeof pair);
+}
+
+ResultChunk ChunkBuilder::take()
+{
+    for (auto& b : chunk.columns) {
+        b.nulls.squeeze();
+        b.fixed.squeeze();
+        b.offsets.squeeze();
+        b.arena.squeeze();
+        b.cut.squeeze();
+    }
+
+    ResultChunk out = chunk;
+    chunk = ResultChunk();
+    chunk.columns.resize(types.size());
+    for (int c = 0; c < types.size(); ++c) chunk.columns[c].type = types[c];
+    return out;
+}
+
+void ResultBuffer::reset(const QStringList& columns)
+{
+    static std::atomic<quint64> lineages{0};
+    names = columns;
+    lineage = ++lineages;
+    chunks.clear();
+    starts.clear();
+    total = 0;
+    bytes = 0;
+    lastChunk = 0;
+    spill.reset();
+    spilledChunks = 0;
+    spilledBytes = 0;
+}
+
+void ResultBuffer::append(const ResultChunk& chunk)
+{
+    if (chunk.rowCount() == 0) return;
+    starts.push_back(total);
+    chunks.push_back(chunk);
+    total += chunk.rowCount();
+    bytes += chunk.memoryUsage();
+}
+
+qint64 ResultBuffer::pinnedBy(const QVector<const ResultBuffer*>& copies) const
+{
+    // Dentro de un mismo linaje, un tramo residente de la copia que empieza antes de la
+    // primera fila residente de aquí ya se volcó aquí (los volcados unen tramos enteros)
+    const int resident = spilledChunks < chunks.size() ? starts[spilledChunks] : total;
+    QSet<QPair<quint64, int>> seen;
+    qint64 n = 0;
+    for (const ResultBuffer* c : copies) {
+        const int limit = c->lineage == lineage ? resident : INT_MAX;
+        for (int i = c->spilledChunks; i < c->chunks.size() && c->starts[i] < limit; ++i) {
+            const QPair<quint64, int> key(c->lineage, c->starts[i]);
+            if (seen.contains(key)) continue;
+            seen.insert(key);
+            n += c->chunks[i].memoryUsage();
+        }
+    }
+    return n;
+}
+
+int ResultBuffer::chunkFor(int row) const
+{
+    // La vista pinta filas contiguas: casi siempre cae en el mismo tramo.
+    if (lastChunk < chunks.size() && row >= starts[lastChunk]
+        && row < starts[lastChunk] + chunks[lastChunk].rowCount())
+        return lastChunk;
+
+    const auto it = std::upper_bound(starts.cbegin(), starts.cend(), row);
+    lastChunk = int(it - starts.cbegin()) - 1;
+    return lastChunk;
+}
+
+bool ResultBuffer::isNull(int row, int col) const
+{
+    const int c = chunkFor(row);
+    return chunks[c].isNull(row - starts[c], col);
+}
+
+QVariant ResultBuffer::value(int row, int col) const
+{
+    const int c = chunkFor(row);
+    return chunks[c].value(row - starts[c], col);
+}
+
+qint64 ResultBuffer::fullLength(int row, int col) const
+{
+    const int c = chunkFor(row);
+    return chunks[c].fullLength(row - starts[c], col);
+}
+
+qint64 ResultBuffer::dataBytes(const ResultChunk& c)
+{
+    qint64 n = 0;
+    for (const auto& b : c.columns)
+        n += b.nulls.size() + b.fixed.size() + b.offsets.size() + b.arena.size() + b.cut.size();
+    return n;
+}
+
+qint64 ResultBuffer::writeMerged(QFileDevice& f, const QVector<ResultChunk>& parts, int first, int end,
+                                 QVector<ColumnSpans>* spans)
+{
+    // Cada arreglo se escribe parte por parte, sin armar el tramo unido en memoria
+    int rows = 0;
+    for (int i = first; i < end; ++i) rows += parts[i].rowCount();
+
+    qint64 pos = 0;
+    bool ok = true;
+    auto put = [&](const char* data, qint64 n){
+        if (ok && n > 0) ok = f.write(data, n) == n;
+        pos += n;
+    };
+
+    const int ncols = parts[first].columnCount();
+    spans->fill(ColumnSpans(), ncols);
+    for (int col = 0; col < ncols && ok; ++col) {
+        const ColumnType type = parts[first].column(col).type;
+        ColumnSpans& sp = (*spans)[col];
+
+        // nulls: los bitmaps de cada parte se desplazan a su primera fila
+        QByteArray nulls((rows + 7) / 8, '\0');
+        int r = 0;
+        for (int i = first; i < end; ++i) {
+            const QByteArray& src = parts[i].column(col).nulls;
+            const int shift = r & 7;
+            for (int k = 0; k < src.size(); ++k) {
+                const uint b = uchar(src.at(k));
+                if (!b) continue;
+                const int at = (r >> 3) + k;
+                if (at >= nulls.size()) break;
+                nulls[at] = char(uchar(nulls.at(at)) | uchar(b << shift));
+                if (shift && (b >> (8 - shift)) && at + 1 < nulls.size())
+                    nulls[at + 1] = char(uchar(nulls.at(at + 1)) | uchar(b >> (8 - shift)));
+            }
+            r += parts[i].rowCount();
+        }
+        sp[0] = {pos, nulls.size()};
+        put(nulls.constData(), nulls.size());
+
+        sp[1].at = pos;
+        for (int i = first; i < end; ++i) {
+            const QByteArray& a = parts[i].column(col).fixed;
+            put(a.constData(), a.size());
+        }
+        sp[1].len = pos - sp[1].at;
+
+        if (type != ColumnType::Text && type != ColumnType::Bytes) continue;
+
+        // offsets: los de cada parte, corridos por lo que ya ocupa el arena
+        sp[2].at = pos;
+        quint32 arenaBase = 0;
+        put(reinterpret_cast<const char*>(&arenaBase), 4);
+        for (int i = first; i < end; ++i) {
+            const ColumnBlock& b = parts[i].column(col);
+            const int n = parts[i].rowCount();
+            QByteArray o;
+            o.reserve(n * 4);
+            for (int k = 1; k <= n; ++k) appendU32(o, arenaBase + readU32(b.offsets, k));
+            put(o.constData(), o.size());
+            arenaBase += quint32(b.arena.size());
+        }
+        sp[2].len = pos - sp[2].at;
+
+        sp[3].at = pos;
+        for (int i = first; i < end; ++i) {
+            const QByteArray& a = parts[i].column(col).arena;
+            put(a.constData(), a.size());
+        }
+        sp[3].len = pos - sp[3].at;
+
+        sp[4].at = pos;
+        int rowBase = 0;
+        for (int i = first; i < end; ++i) {
+            const QByteArray& cut = parts[i].column(col).cut;
+            for (int k = 0; k < cut.size() / 16; ++k) {
+                const qint64 pair[2] = {rowBase + readI64(cut, k * 2), readI64(cut, k * 2 + 1)};
+                put(reinterpret_cast<const char*>(pair), sizeof pair);
+            }
+            rowBase += parts[i].rowCount();
+        }
+        sp[4].len = pos - sp[4].at;
+    }
+    return ok ? pos : -1;
+}
+
+ResultChunk ResultBuffer::mappedChunk(const uchar* base, int rows, const QVector<ColumnType>& types,
+                                      const QVector<ColumnSpans>& spans,
+                                      const std::shared_ptr<MappedFile>& file, qint64 diskBytes)
+{
+    ResultChunk c;
+    c.rows = rows;
+    c.disk = file;
+    c.diskBytes = diskBytes;
+    c.columns.resize(types.size());
+    const char* p = reinterpret_cast<const char*>(base);
+    for (int col = 0; col < types.size(); ++col) {
+        ColumnBlock& b = c.columns[col];
+        b.type = types[col];
+        QByteArray* arrays[5] = {&b.nulls, &b.fixed, &b.offsets, &b.arena, &b.cut};
+        for (int k = 0; k < 5; ++k)
+            if (spans[col][k].len > 0)
+                *arrays[k] = QByteArray::fromRawData(p + spans[col][k].at, int(spans[col][k].len));
+    }
+    return c;
+}
+
+bool ResultBuffer::spillOldest(qint64 segmentBytes, const QString& dir, QString* err)
+{
+    // Tramos consecutivos desde el primero residente hasta llenar el segmento (al menos uno)
+    const int first = spilledChunks;
+    int end = first;
+    qint64 freed = 0;
+    int rows = 0;
+    while (end < chunks.size() && (end == first || freed + chunks[end].memoryUsage() <= segmentBytes)) {
+        freed += chunks[end].memoryUsage();
+        rows += chunks[end].rowCount();
+        ++end;
+    }
+    if (end == first) return false;
+
+    if (!spill) {
+        auto* tmp = new QTemporaryFile(QDir(dir.isEmpty() ? QDir::tempPath() : dir).filePath("dm_result_XXXXXX.spill"));
+        auto f = std::make_shared<MappedFile>(tmp);
+        if (!tmp->open()) {
+            if (err) *err = tmp->errorString();
+            return false;
+        }
+        spill = f;
+    }
+
+    QFile& f = *spill->file;
+    const qint64 base = spill->size;
+    QVector<ColumnSpans> spans;
+    qint64 written = f.seek(base) ? writeMerged(f, chunks, first, end, &spans) : -1;
+    uchar* map = nullptr;
+    if (written >= 0 && f.flush()) map = f.map(base, written);
+    if (!map) {
+        if (err) *err = f.errorString();
+        f.resize(base);
+        return false;
+    }
+    spill->maps << map;
+    spill->size = base + written;
+
+    QVector<ColumnType> types;
+    for (int col = 0; col < columnCount(); ++col) types << chunks[first].column(col).type;
+    const ResultChunk merged = mappedChunk(map, rows, types, spans, spill, written);
+
+    chunks.erase(chunks.begin() + first + 1, chunks.begin() + end);
+    starts.erase(starts.begin() + first + 1, starts.begin() + end);
+    chunks[first] = merged;
+    bytes += merged.memoryUsage() - freed;
+    spilledBytes += written;
+    spilledChunks = first + 1;
+    lastChunk = 0;
+    return true;
+}
+
+// Instantánea: cabecera fija, segmentos (mismo formato que el volcado), metadatos JSON
+// (columnas con su tipo, filas y lo que aporte quien guarda) y el directorio de segmentos.
+// Los enteros van en el orden de bytes de la máquina.
+namespace {
+const char kSnapshotMagic[8] = {'D', 'M', 'S', 'N', 'A', 'P', '\0', '\1'};
+const quint32 kSnapshotVersion = 1;
+const qint64 kSnapshotSegment = 32 * 1024 * 1024;
+
+struct SnapshotHeader {
+    char magic[8];
+    quint32 version;
+    quint32 columns;
+    qint64 metaAt;
+    qint64 metaLen;
+    qint64 dirAt;
+    qint64 segments;
+};
+
+// Entrada del directorio; le siguen columns * 5 pares (at, len) relativos al segmento.
+struct SegmentEntry {
+    qint64 rows;
+    qint64 at;
+    qint64 len;
+};
+}
+
+bool ResultBuffer::save(const QString& path, const QJsonObject& meta, QString* err) const
+{
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, kSnapshotMagic, sizeof h.magic);
+    h.version = kSnapshotVersion;
+    h.columns = quint32(columnCount());
+    bool ok = f.write(reinterpret_cast<const char*>(&h), sizeof h) == qint64(sizeof h);
+
+    QByteArray dir;
+    qint64 pos = sizeof h;
+    for (int first = 0; ok && first < chunks.size();) {
+        int end = first;
+        qint64 size = 0;
+        int rows = 0;
+        while (end < chunks.size() && (end == first || size + dataBytes(chunks[end]) <= kSnapshotSegment)) {
+            size += dataBytes(chunks[end]);
+            rows += chunks[end].rowCount();
+            ++end;
+        }
+        QVector<ColumnSpans> spans;
+        const qint64 written = writeMerged(f, chunks, first, end, &spans);
+        if (written < 0) { ok = false; break; }
+
+        const SegmentEntry e{rows, pos, written};
+        dir.append(reinterpret_cast<const char*>(&e), sizeof e);
+        for (const auto& sp : spans)
+            for (const auto& span : sp) {
+                const qint64 pair[2] = {span.at, span.len};
+                dir.append(reinterpret_cast<const char*>(pair), sizeof pair);
+            }
+        pos += written;
+        first = end;
+    }
+
+    QJsonObject m = meta;
+    QJsonArray cols;
+    for (int c = 0; c < columnCount(); ++c)
+        cols << QJsonObject{{"name", names[c]}, {"type", int(columnType(c))}};
+    m["columns"] = cols;
+    m["rows"] = double(total);
+    const QByteArray json = QJsonDocument(m).toJson(QJsonDocument::Compact);
+
+    h.metaAt = pos;
+    h.metaLen = json.size();
+    h.dirAt = pos + json.size();
+    h.segments = dir.size() / qint64(sizeof(SegmentEntry) + columnCount() * 5 * 16);
+    ok = ok && f.write(json) == json.size() && f.write(dir) == dir.size()
+         && f.seek(0) && f.write(reinterpret_cast<const char*>(&h), sizeof h) == qint64(sizeof h);
+    if (!ok) {
+        if (err) *err = f.errorString();
+        f.cancelWriting();
+        return false;
+    }
+    if (!f.commit()) {
+        if (err) *err = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+// [at, at + len) dentro de [0, limit), sin desbordar con valores leídos del archivo
+static bool within(qint64 at, qint64 len, qint64 limit)
+{
+    return at >= 0 && len >= 0 && at <= limit && len <= limit - at;
+}
+
+bool ResultBuffer::load(const QString& path, QJsonObject* meta, QString* err)
+{
+    auto fail = [err](const QString& e){ if (err) *err = e; return false; };
+
+    auto* file = new QFile(path);
+    auto mapped = std::make_shared<MappedFile>(file);
+    if (!file->open(QIODevice::ReadOnly)) return fail(file->errorString());
+    const qint64 size = file->size();
+    if (size < qint64(sizeof(SnapshotHeader))) return fail("No es una instantánea de resultados.");
+
+    // Todo el archivo en un solo mapeo: los tramos apuntan a él, no se lee nada más
+    uchar* map = file->map(0, size);
+    if (!map) return fail(file->errorString());
+    mapped->maps << map;
+    mapped->size = size;
+
+    SnapshotHeader h;
+    std::memcpy(&h, map, sizeof h);
+    if (std::memcmp(h.magic, kSnapshotMagic, sizeof h.magic) != 0)
+        return fail("No es una instantánea de resultados.");
+    if (h.version != kSnapshotVersion)
+        return fail(QString("Versión de instantánea no soportada: %1.").arg(h.version));
+
+    const qint64 entryBytes = sizeof(SegmentEntry) + qint64(h.columns) * 5 * 16;
+    if (h.metaLen > INT_MAX || !within(h.metaAt, h.metaLen, size) || h.metaAt < qint64(sizeof h)
+        || h.dirAt < 0 || h.dirAt > size || h.segments < 0 || h.segments > (size - h.dirAt) / entryBytes)
+        return fail("La instantánea está dañada.");
+
+    QJsonParseError pe;
+    const QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(reinterpret_cast<const char*>(map + h.metaAt), int(h.metaLen)), &pe);
+    if (pe.error != QJsonParseError::NoError || !doc.isObject()) return fail("La instantánea está dañada.");
+    const QJsonObject m = doc.object();
+
+    QStringList cols;
+    QVector<ColumnType> types;
+    for (const auto& v : m.value("columns").toArray()) {
+        const int t = v.toObject().value("type").toInt(-1);
+        if (t < 0 || t > int(ColumnType::Bytes)) return fail("La instantánea está dañada.");
+        cols << v.toObject().value("name").toString();
+        types << ColumnType(t);
+    }
+    if (cols.size() != int(h.columns)) return fail("La instantánea está dañada.");
+
+    ResultBuffer out;
+    out.reset(cols);
+    const uchar* dir = map + h.dirAt;
+    qint64 totalRows = 0;
+    for (qint64 i = 0; i < h.segments; ++i) {
+        SegmentEntry e;
+        std::memcpy(&e, dir, sizeof e);
+        dir += sizeof e;
+        if (e.rows <= 0 || e.rows > INT_MAX || e.at < qint64(sizeof h) || !within(e.at, e.len, h.metaAt))
+            return fail("La instantánea está dañada.");
+        totalRows += e.rows;
+        if (totalRows > INT_MAX)
+            return fail(QString("La instantánea tiene más de %1 filas.").arg(INT_MAX));
+
+        QVector<ColumnSpans> spans(cols.size());
+        for (int c = 0; c < cols.size(); ++c)
+            for (int k = 0; k < 5; ++k) {
+                qint64 pair[2];
+                std::memcpy(pair, dir, sizeof pair);
+                dir += sizeof pair;
+                if (pair[1] > INT_MAX || !within(pair[0], pair[1], e.len))
+                    return fail("La instantánea está dañada.");
+                spans[c][k] = {pair[0], pair[1]};
+            }
+
+        // Solo tamaños de los bloques (O(columnas), no O(filas)): así todo índice de fila cae
+        // dentro del mapeo. Los offsets de texto no se recorren; ResultChunk::value y el
+        // ordenar/filtrar los acotan al arena al leerlos.
+        const int rows = int(e.rows);
+        for (int c = 0; c < cols.size(); ++c) {
+            const bool text = types[c] == ColumnType::Text || types[c] == ColumnType::Bytes;
+            const ColumnSpans& sp = spans[c];
+            if (sp[0].len < (qint64(rows) + 7) / 8 || (!text && sp[1].len != qint64(rows) * 8)
+                || (text && sp[2].len != (qint64(rows) + 1) * 4) || sp[4].len % 16 != 0)
+                return fail("La instantánea está dañada.");
+        }
+        out.append(mappedChunk(map + e.at, rows, types, spans, mapped, e.len));
+    }
+
+    out.spilledChunks = out.chunks.size();
+    out.spilledBytes = h.metaAt - qint64(sizeof h);
+    *this = out;
+    if (meta) *meta = m;
+    return true;
+}
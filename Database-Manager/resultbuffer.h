@@ -0,0 +1,153 @@
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <QVariant>
+#include <QStringList>
+#include <QJsonObject>
+#include <memory>
+#include <array>
+
+class QSqlRecord;
+class QFileDevice;
+class MappedFile;
+
+enum class ColumnType : quint8 {
+    Int64, Double, Bool, Date, DateTime, Time, Text, Bytes
+};
+
+// Una columna de un tramo. Numéricos y fechas usan 8 bytes por fila en `fixed`
+// (Date = día juliano, DateTime = ms epoch, Time = ms del día); Text/Bytes van
+// en un único arena UTF-8 con offsets quint32 (filas + 1).
+// Los Text/Bytes grandes se guardan recortados; su tamaño real va en `cut`.
+struct ColumnBlock {
+    ColumnType type = ColumnType::Text;
+    QByteArray nulls;    // bitmap, 1 bit por fila
+    QByteArray fixed;
+    QByteArray offsets;
+    QByteArray arena;
+    QByteArray cut;      // pares qint64 (fila, bytes del valor completo), por fila creciente
+};
+
+// Tramo de filas en formato columnar. Se copia barato (QByteArray compartido),
+// así que puede viajar entre hilos por señales.
+// Un tramo volcado a disco tiene el mismo formato: sus QByteArray apuntan a un mapeo del
+// archivo temporal, que vive mientras quede alguna copia del tramo.
+class ResultChunk {
+public:
+    int rowCount() const { return rows; }
+    int columnCount() const { return columns.size(); }
+
+    bool isNull(int row, int col) const;
+    QVariant value(int row, int col) const;
+    // Bytes del valor completo si la celda guarda solo un recorte; si no, -1.
+    qint64 fullLength(int row, int col) const;
+    qint64 memoryUsage() const;
+    qint64 diskUsage() const { return diskBytes; }
+    bool isSpilled() const { return disk != nullptr; }
+
+    // Datos crudos de una columna (para ordenar/filtrar sin QVariant).
+    const ColumnBlock& column(int col) const { return columns[col]; }
+
+private:
+    friend class ChunkBuilder;
+    friend class ResultBuffer;
+    int rows = 0;
+    QVector<ColumnBlock> columns;
+    std::shared_ptr<MappedFile> disk;
+    qint64 diskBytes = 0;
+};
+Q_DECLARE_METATYPE(ResultChunk)
+
+// Arma un ResultChunk fila por fila (en el hilo del worker).
+// Con previewBytes > 0 los Text/Bytes más largos se recortan a ese tamaño.
+class ChunkBuilder {
+public:
+    explicit ChunkBuilder(const QVector<ColumnType>& types = {}, int previewBytes = 0);
+
+    void addValue(int col, const QVariant& v);
+    // Tamaño real del valor recién añadido en col, cuando llegó ya recortado (LEFT() en el SQL).
+    void setFullLength(int col, qint64 bytes);
+    void endRow() { ++chunk.rows; }
+
+    int rowCount() const { return chunk.rows; }
+    qint64 memoryUsage() const { return chunk.memoryUsage(); }
+    bool isEmpty() const { return chunk.rows == 0; }
+
+    ResultChunk take();
+
+private:
+    QVector<ColumnType> types;
+    int preview = 0;
+    ResultChunk chunk;
+};
+
+// Resultado completo en el lado GUI: lista de tramos columnar.
+class ResultBuffer {
+public:
+    static QVector<ColumnType> typesFor(const QSqlRecord& rec);
+
+    // Sufijo de la columna con OCTET_LENGTH() que acompaña a un LEFT() de un TEXT/BLOB:
+    // `doc`, `doc__dm_len` se muestran como una sola columna recortada.
+    static QString lengthSuffix() { return QStringLiteral("__dm_len"); }
+
+    void reset(const QStringList& columns);
+    void append(const ResultChunk& chunk);
+
+    int rowCount() const { return total; }
+    int columnCount() const { return names.size(); }
+    QString columnName(int col) const { return names.value(col); }
+
+    bool isNull(int row, int col) const;
+    QVariant value(int row, int col) const;
+    qint64 fullLength(int row, int col) const;
+    // Lo que ocupa en RAM; lo volcado a disco va aparte.
+    qint64 memoryUsage() const { return bytes; }
+    qint64 diskUsage() const { return spilledBytes; }
+    // Bytes en RAM que retienen copias anteriores de este buffer (las de los hilos) y que
+    // este ya no tiene en RAM: lo volcado después de copiar, o todo si hubo un reset().
+    // Un tramo compartido por varias copias cuenta una vez.
+    qint64 pinnedBy(const QVector<const ResultBuffer*>& copies) const;
+
+    // Vuelca a un archivo temporal de dir los tramos residentes más antiguos, unidos en uno
+    // de hasta segmentBytes, y los sustituye por su mapeo. false si no quedaba nada en RAM
+    // o no se pudo escribir (err).
+    bool spillOldest(qint64 segmentBytes, const QString& dir, QString* err = nullptr);
+
+    // Instantánea en un archivo: los tramos en el formato del volcado, más columnas y meta
+    // (SQL, perfil, tiempos...) en JSON. load() mapea el archivo entero y los tramos apuntan
+    // al mapeo: abrir varios GB no lee los datos.
+    bool save(const QString& path, const QJsonObject& meta, QString* err = nullptr) const;
+    bool load(const QString& path, QJsonObject* meta, QString* err = nullptr);
+
+    int chunkCount() const { return chunks.size(); }
+    const ResultChunk& chunk(int i) const { return chunks[i]; }
+    int chunkStart(int i) const { return starts[i]; }
+    ColumnType columnType(int col) const { return chunks.isEmpty() ? ColumnType::Text : chunks[0].column(col).type; }
+
+private:
+    int chunkFor(int row) const;
+
+    struct Span { qint64 at = 0; qint64 len = 0; };
+    using ColumnSpans = std::array<Span, 5>;   // nulls, fixed, offsets, arena, cut
+    static qint64 dataBytes(const ResultChunk& c);
+    // Escribe parts[first, end) como un solo tramo en la posición actual de f; devuelve
+    // los bytes escritos (-1 si falla) y en spans dónde quedó cada arreglo.
+    static qint64 writeMerged(QFileDevice& f, const QVector<ResultChunk>& parts, int first, int end,
+                              QVector<ColumnSpans>* spans);
+    static ResultChunk mappedChunk(const uchar* base, int rows, const QVector<ColumnType>& types,
+                                   const QVector<ColumnSpans>& spans,
+                                   const std::shared_ptr<MappedFile>& file, qint64 diskBytes);
+
+    QStringList names;
+    QVector<ResultChunk> chunks;
+    QVector<int> starts;     // primera fila de cada tramo
+    int total = 0;
+    qint64 bytes = 0;
+    mutable int lastChunk = 0;
+    quint64 lineage = 0;     // cambia en cada reset(); las copias lo comparten
+
+    // Los primeros spilledChunks tramos están en disco; el resto, en RAM.
+    std::shared_ptr<MappedFile> spill;
+    int spilledChunks = 0;
+    qint64 spilledBytes = 0;
+};
@@ -0,0 +1,261 @@
+#include "ResultModel.h"
+#include <QColor>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QSettings>
+#include <QSet>
+
+// Tamaño de cada segmento del archivo de volcado (cada uno es un mapeo)
+static const qint64 kSpillSegment = 32 * 1024 * 1024;
+
+// Modelos vivos, para el presupuesto global (hilo GUI)
+static QList<ResultModel*>& liveModels()
+{
+    static QList<ResultModel*> all;
+    return all;
+}
+
+ResultModel::ResultModel(QObject* parent) : QAbstractTableModel(parent)
+{
+    QSettings s("UNITEC", "Database-Manager");
+    budget = qMax<qint64>(0, s.value("results/memoryBudgetMB", 512).toLongLong()) * 1024 * 1024;
+    globalBudget = qMax<qint64>(0, s.value("results/globalMemoryBudgetMB", 2048).toLongLong()) * 1024 * 1024;
+    spillDir = s.value("results/spillDir").toString();
+    liveModels() << this;
+}
+
+ResultModel::~ResultModel()
+{
+    liveModels().removeAll(this);
+
+    // Los hilos de la vista llaman de vuelta a este objeto: esperar a que terminen
+    cancelJobs();
+    for (const auto& t : jobs)
+        if (t) t->wait();
+}
+
+void ResultModel::cancelJobs()
+{
+    ++generation;
+    if (cancelFlag) cancelFlag->store(true);
+    cancelFlag.reset();
+}
+
+void ResultModel::setView(const ResultViewSpec& s)
+{
+    cancelJobs();
+    spec = s;
+
+    if (spec.isIdentity()) {
+        if (!viewActive) return;
+        beginResetModel();
+        viewActive = false;
+        order.clear();
+        endResetModel();
+        emit viewReady(0);
+        return;
+    }
+
+    // El hilo trabaja sobre una copia: los tramos se comparten, los que lleguen después no
+    std::shared_ptr<const ResultBuffer> snapshot = share();
+    const int gen = generation;
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    cancelFlag = cancel;
+
+    QThread* t = QThread::create([this, snapshot, s, gen, cancel]() mutable {
+        QElapsedTimer clock;
+        clock.start();
+        QVector<int> rows;
+        const bool ok = ResultViewBuilder::build(*snapshot, s, &rows, cancel.get());
+        snapshot.reset();
+        if (!ok) return;
+        const qint64 ms = clock.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, gen, rows, ms]() mutable {
+            if (gen != generation) return;
+            cancelFlag.reset();
+            beginResetModel();
+            order = std::move(rows);
+            viewActive = true;
+            endResetModel();
+            emit viewReady(ms);
+        }, Qt::QueuedConnection);
+    });
+    jobs << t;
+    connect(t, &QThread::finished, this, [this, t](){
+        jobs.removeAll(t);
+        t->deleteLater();
+        enforceBudget();
+    });
+    t->start(QThread::LowPriority);
+}
+
+void ResultModel::reset(const QStringList& columns)
+{
+    cancelJobs();
+    beginResetModel();
+    spec = ResultViewSpec();
+    viewActive = false;
+    order.clear();
+    buffer.reset(columns);
+    spillErr.clear();
+    more = false;
+    pending = false;
+    endResetModel();
+}
+
+void ResultModel::setResult(const ResultBuffer& data)
+{
+    cancelJobs();
+    beginResetModel();
+    spec = ResultViewSpec();
+    viewActive = false;
+    order.clear();
+    buffer = data;
+    spillErr.clear();
+    more = false;
+    pending = false;
+    endResetModel();
+}
+
+void ResultModel::appendRows(const ResultChunk& chunk)
+{
+    if (chunk.rowCount() == 0) return;
+    if (viewActive || isViewPending()) {
+        buffer.append(chunk);
+        enforceBudget();
+        emit viewStale();
+        return;
+    }
+    const int first = buffer.rowCount();
+    beginInsertRows(QModelIndex(), first, first + chunk.rowCount() - 1);
+    buffer.append(chunk);
+    endInsertRows();
+    enforceBudget();
+}
+
+std::shared_ptr<const ResultBuffer> ResultModel::share()
+{
+    auto copy = std::make_shared<const ResultBuffer>(buffer);
+    copies << copy;
+    return copy;
+}
+
+qint64 ResultModel::pinnedBytes() const
+{
+    if (copies.isEmpty()) return 0;
+    QVector<std::shared_ptr<const ResultBuffer>> alive;
+    QVector<const ResultBuffer*> held;
+    for (auto it = copies.begin(); it != copies.end();) {
+        if (auto c = it->lock()) {
+            held << c.get();
+            alive << std::move(c);
+            ++it;
+        } else {
+            it = copies.erase(it);
+        }
+    }
+    return buffer.pinnedBy(held);
+}
+
+bool ResultModel::spillOldest()
+{
+    if (!spillErr.isEmpty()) return false;
+    // Volcar un tramo que también tiene una copia no libera nada hasta que la suelten
+    const qint64 before = memoryUsage();
+    QString err;
+    if (buffer.spillOldest(kSpillSegment, spillDir, &err)) return memoryUsage() < before;
+    spillErr = err;
+    return false;
+}
+
+void ResultModel::enforceBudget()
+{
+    if (budget > 0)
+        while (buffer.memoryUsage() > budget && spillOldest()) {}
+    if (globalBudget <= 0) return;
+
+    // Entre todos los resultados abiertos: se vuelca primero el que más ocupa. Los que no
+    // pueden volcar (sin tramos completos, error de disco) se saltan y se prueba el siguiente.
+    QSet<ResultModel*> stuck;
+    for (;;) {
+        qint64 total = 0;
+        ResultModel* largest = nullptr;
+        for (ResultModel* m : liveModels()) {
+            total += m->memoryUsage();
+            if (stuck.contains(m)) continue;
+            if (!largest || m->memoryUsage() > largest->memoryUsage()) largest = m;
+        }
+        if (total <= globalBudget || !largest) break;
+        if (!largest->spillOldest()) stuck.insert(largest);
+    }
+}
+
+void ResultModel::setFetchDone(bool hasMoreRows)
+{
+    more = hasMoreRows;
+    pending = false;
+}
+
+void ResultModel::clear()
+{
+    reset({});
+}
+
+int ResultModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return viewActive ? order.size() : buffer.rowCount();
+}
+
+int ResultModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : buffer.columnCount();
+}
+
+QVariant ResultModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) return {};
+    const int row = sourceRow(index.row());
+
+    if (role == Qt::DisplayRole) {
+        if (buffer.isNull(row, index.column())) return QVariant("NULL");
+        const qint64 full = buffer.fullLength(row, index.column());
+        if (full < 0) return buffer.value(row, index.column());
+        // Recortado: basta el principio para la celda; el valor completo lo carga el visor
+        return buffer.value(row, index.column()).toString().left(256)
+               + QString(" … (%1)").arg(QLocale().formattedDataSize(full, 1, QLocale::DataSizeTraditionalFormat));
+    }
+    if (role == FullLengthRole) {
+        return buffer.fullLength(row, index.column());
+    }
+    if (role == Qt::ToolTipRole && buffer.fullLength(row, index.column()) >= 0) {
+        return QString("Valor recortado: doble clic para verlo completo");
+    }
+    if (role == Qt::ForegroundRole && buffer.isNull(row, index.column())) {
+        return QColor("#808080");
+    }
+    return {};
+}
+
+QVariant ResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return {};
+    if (orientation == Qt::Horizontal) return buffer.columnName(section);
+    // Número de fila original, también con la vista ordenada o filtrada
+    return (section < rowCount() ? sourceRow(section) : section) + 1;
+}
+
+bool ResultModel::canFetchMore(const QModelIndex& parent) const
+{
+    // Con orden o filtro activos no se piden más tramos al llegar al final
+    return !parent.isValid() && more && !pending && !viewActive;
+}
+
+void ResultModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent)) return;
+    pending = true;
+    emit fetchRequested();
+}
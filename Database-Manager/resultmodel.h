@@ -0,0 +1,93 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QList>
+#include <QPointer>
+#include <memory>
+#include <atomic>
+#include "ResultBuffer.h"
+#include "ResultView.h"
+
+class QThread;
+
+// Modelo de resultados virtualizado: recibe tramos columnar desde QueryWorker
+// y pide el siguiente (fetchRequested) cuando la vista llega al final.
+// QVariant/QString se crean solo para las celdas que la vista pide.
+// Con una vista (orden/filtro) activa, las filas del modelo son una permutación de las
+// del buffer calculada en otro hilo; mientras tanto se sigue mostrando la anterior.
+class ResultModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    // Bytes del valor completo de una celda recortada (-1 si está entera)
+    enum Roles { FullLengthRole = Qt::UserRole };
+
+    explicit ResultModel(QObject* parent = nullptr);
+    ~ResultModel() override;
+
+    void reset(const QStringList& columns);
+    void appendRows(const ResultChunk& chunk);
+    // Resultado completo ya armado (una instantánea abierta): sin más filas que pedir.
+    void setResult(const ResultBuffer& data);
+    void setFetchDone(bool more);
+    void clear();
+
+    bool hasMore() const { return more; }
+    bool isFetching() const { return pending; }
+    // Incluye lo que retienen las copias de los hilos aunque el buffer ya lo volcara
+    qint64 memoryUsage() const { return buffer.memoryUsage() + pinnedBytes(); }
+    qint64 diskUsage() const { return buffer.diskUsage(); }
+    // Último error al volcar a disco; desde entonces el resultado se queda en RAM.
+    QString spillError() const { return spillErr; }
+    const ResultBuffer& result() const { return buffer; }
+    // Copia del resultado para un hilo (vista, instantánea). Mientras viva cuenta para el
+    // presupuesto lo que retenga; el hilo la suelta en cuanto termina y quien la pidió
+    // llama después a enforceBudget() para volcar lo que no se pudo entretanto.
+    std::shared_ptr<const ResultBuffer> share();
+
+    // Presupuesto de RAM (results/memoryBudgetMB por resultado, results/globalMemoryBudgetMB
+    // entre todos): al pasarlo se vuelcan a disco los tramos más antiguos.
+    void enforceBudget();
+
+    // Orden y filtros en el cliente sobre lo ya obtenido; el resultado llega por viewReady.
+    void setView(const ResultViewSpec& spec);
+    const ResultViewSpec& view() const { return spec; }
+    bool isViewActive() const { return viewActive; }
+    bool isViewPending() const { return cancelFlag != nullptr; }
+    int sourceRow(int row) const { return viewActive ? order[row] : row; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+signals:
+    void fetchRequested();
+    void viewReady(qint64 ms);
+    // Llegaron filas mientras había una vista: hay que volver a calcularla
+    void viewStale();
+
+private:
+    void cancelJobs();
+    // false si no se pudo volcar o si no liberó nada (los tramos siguen en una copia)
+    bool spillOldest();
+    qint64 pinnedBytes() const;
+
+    ResultBuffer buffer;
+    ResultViewSpec spec;
+    QVector<int> order;
+    bool viewActive = false;
+    int generation = 0;
+    std::shared_ptr<std::atomic<bool>> cancelFlag;   // el del cálculo en curso
+    QList<QPointer<QThread>> jobs;
+    mutable QList<std::weak_ptr<const ResultBuffer>> copies;   // las de share()
+    bool more = false;
+    bool pending = false;
+
+    qint64 budget = 0;         // 0 = sin límite
+    qint64 globalBudget = 0;
+    QString spillDir;
+    QString spillErr;
+};
@@ -1,90 +1,527 @@
 #include "ResultTableWidget.h"
+#include "ResultModel.h"
+#include "QueryWorker.h"
+#include "CellViewer.h"
+#include "DbSession.h"
 #include <QTableView>
 #include <QVBoxLayout>
 #include <QStackedWidget>
 #include <QLabel>
-#include <QtSql/QSqlQueryModel>
-#include <QtSql/QSqlDatabase>
-#include <QtSql/QSqlQuery>
-#include <QtSql/QSqlError>
+#include <QLineEdit>
+#include <QHeaderView>
+#include <QMenu>
+#include <QInputDialog>
+#include <QTimer>
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QThread>
+#include <functional>
 
-static bool looksLikeResultSet(const QString& sql)
+static QString humanBytes(qint64 n)
 {
-    const QString s = sql.trimmed();
-    if (s.isEmpty()) return false;
-
-    const QString u = s.left(32).toUpper();
-    return u.startsWith("SELECT") || u.startsWith("SHOW") || u.startsWith("DESCRIBE") ||
-           u.startsWith("DESC") || u.startsWith("EXPLAIN") || u.startsWith("WITH");
+    if (n < 1024) return QString("%1 B").arg(n);
+    if (n < 1024 * 1024) return QString("%1 KB").arg(n / 1024.0, 0, 'f', 1);
+    if (n < 1024LL * 1024 * 1024) return QString("%1 MB").arg(n / (1024.0 * 1024.0), 0, 'f', 1);
+    return QString("%1 GB").arg(n / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
 }
 
-ResultTableWidget::ResultTableWidget(QWidget* p):QWidget(p){
-    view=new QTableView;
-    model=new QSqlQueryModel(this);
+// QTableView que informa cuánto tarda cada pintado.
+class TimedTableView : public QTableView {
+public:
+    std::function<void(qint64)> onPaint;
+
+protected:
+    void paintEvent(QPaintEvent* e) override
+    {
+        QElapsedTimer t;
+        t.start();
+        QTableView::paintEvent(e);
+        if (onPaint) onPaint(t.elapsed());
+    }
+};
+
+ResultTableWidget::ResultTableWidget(QuerySession* session, QWidget* p)
+    : QWidget(p), session(session)
+{
+    QSettings s("UNITEC", "Database-Manager");
+    chunk = qMax(1, s.value("results/chunkSize", 500).toInt());
+
+    auto* timed = new TimedTableView;
+    timed->onPaint = [this](qint64 ms){
+        if (!renderOpen) return;
+        timing.renderMs += ms;
+        if (timing.done) renderOpen = false;
+        recordTiming();
+    };
+    view = timed;
+    model=new ResultModel(this);
     view->setModel(model);
 
+    // Clic en la cabecera: ascendente, descendente, sin orden. Menú contextual: filtros.
+    QHeaderView* header = view->horizontalHeader();
+    header->setSectionsClickable(true);
+    header->setSortIndicatorShown(false);
+    header->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(header, &QHeaderView::sectionClicked, this, &ResultTableWidget::onHeaderClicked);
+    connect(header, &QWidget::customContextMenuRequested, this, &ResultTableWidget::showHeaderMenu);
+    connect(view, &QAbstractItemView::doubleClicked, this, &ResultTableWidget::openCell);
+    view->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(view, &QWidget::customContextMenuRequested, this, &ResultTableWidget::showViewMenu);
+
+    quickFilter = new QLineEdit;
+    quickFilter->setPlaceholderText("Filtrar filas obtenidas...");
+    quickFilter->setClearButtonEnabled(true);
+
+    viewTimer = new QTimer(this);
+    viewTimer->setSingleShot(true);
+    viewTimer->setInterval(200);
+    connect(viewTimer, &QTimer::timeout, this, &ResultTableWidget::applyView);
+    connect(quickFilter, &QLineEdit::textChanged, this, [this](const QString& text){
+        viewSpec.quickText = text;
+        viewTimer->start();
+    });
+    connect(model, &ResultModel::viewStale, viewTimer, qOverload<>(&QTimer::start));
+    connect(model, &ResultModel::viewReady, this, [this](qint64 ms){
+        viewMs = ms;
+        updateProgress();
+    });
+
     info = new QLabel;
     info->setWordWrap(true);
     info->setTextInteractionFlags(Qt::TextSelectableByMouse);
 
+    progress = new QLabel;
+    progress->setStyleSheet("color: #808080;");
+
     stack = new QStackedWidget;
     stack->addWidget(view);  // index 0
     stack->addWidget(info);  // index 1
 
     auto* l=new QVBoxLayout(this);
+    l->addWidget(quickFilter);
     l->addWidget(stack);
+    l->addWidget(progress);
+
+    // Sin sesión (instantánea abierta) no hay consultas que escuchar
+    if (!session) return;
+
+    connect(model, &ResultModel::fetchRequested, this, [this](){
+        if (current < 0) return;
+        session->fetchMore(current, chunk);
+        updateProgress();
+    });
+
+    connect(session, &QuerySession::columnsReady, this, [this](int id, const QStringList& cols){
+        if (id != current) return;
+        model->reset(cols);
+        stack->setCurrentWidget(view);
+    });
+
+    connect(session, &QuerySession::rowsReady, this, [this](int id, const ResultChunk& rows){
+        if (id != current) return;
+        QElapsedTimer t;
+        t.start();
+        model->appendRows(rows);
+        timing.modelMs += t.elapsed();
+        updateProgress();
+    });
+
+    connect(session, &QuerySession::timingUpdated, this, [this](int id, const QueryTiming& t){
+        if (id != current) return;
+        // Lo del worker reemplaza lo suyo; modelo y pintado se miden aquí
+        const qint64 modelMs = timing.modelMs, renderMs = timing.renderMs;
+        const int key = timing.key;
+        timing = t;
+        timing.key = key;
+        timing.modelMs = modelMs;
+        timing.renderMs = renderMs;
+        recordTiming();
+    });
+
+    connect(session, &QuerySession::fetchDone, this, [this](int id, bool more){
+        if (id != current) return;
+        model->setFetchDone(more);
+        updateProgress();
+    });
+
+    connect(session, &QuerySession::fetchFailed, this, [this](int id, const QString& error){
+        if (id != current) return;
+        model->setFetchDone(false);
+        progress->setText(QString("%1 filas obtenidas · error: %2").arg(model->result().rowCount()).arg(error));
+    });
+
+    connect(session, &QuerySession::finished, this,
+            [this](int id, bool ok, const QString& error, qint64 affected){
+                if (id != current) return;
+                running = false;
+
+                if (!ok) {
+                    if (model->result().rowCount() == 0) showMessage(error);
+                    updateProgress();
+                    emit queryFinished(false, error);
+                    return;
+                }
+
+                // DDL / DML sin result set.
+                if (model->columnCount() == 0) {
+                    const QString msg = (affected >= 0)
+                                            ? QString("Ejecutado correctamente. Filas afectadas: %1").arg(affected)
+                                            : QString("Ejecutado correctamente.");
+                    showMessage(msg);
+                    progress->clear();
+                    emit queryFinished(true, msg);
+                    return;
+                }
+
+                updateProgress();
+                emit queryFinished(true, QString("%1 filas").arg(model->result().rowCount()));
+            });
+}
+
+ResultTableWidget::~ResultTableWidget()
+{
+    // El guardado de una instantánea llama de vuelta a este objeto
+    if (saveJob) saveJob->wait();
 }
 
-bool ResultTableWidget::setQuery(const QString& sql, const QString& c, QString* outError)
+bool ResultTableWidget::execute(const QString& sql, QString* outError)
 {
     if (outError) outError->clear();
 
-    QSqlDatabase db = QSqlDatabase::database(c);
-    if (!db.isValid() || !db.isOpen()) {
-        const QString e = "Conexión inválida o cerrada.";
+    const QString s = sql.trimmed();
+    if (s.isEmpty()) {
+        const QString e = "SQL vacío.";
         if (outError) *outError = e;
-        info->setText(e);
-        stack->setCurrentWidget(info);
+        showMessage(e);
         return false;
     }
 
-    const QString s = sql.trimmed();
-    if (s.isEmpty()) {
-        info->setText("SQL vacío.");
-        stack->setCurrentWidget(info);
+    if (!session || session->isRunning()) {
+        const QString e = "Ya hay una consulta en ejecución.";
+        if (outError) *outError = e;
         return false;
     }
 
-    if (looksLikeResultSet(s)) {
-        model->setQuery(s, db);
-        const auto err = model->lastError();
-        if (err.isValid()) {
-            const QString e = err.text();
-            if (outError) *outError = e;
-            info->setText(e);
-            stack->setCurrentWidget(info);
-            return false;
+    viewTimer->stop();
+    viewSpec = ResultViewSpec();
+    viewMs = -1;
+    {
+        const QSignalBlocker block(quickFilter);
+        quickFilter->clear();
+    }
+    view->horizontalHeader()->setSortIndicatorShown(false);
+    model->clear();
+    progress->clear();
+    progress->setToolTip(QString());
+    lastSql = s;
+    snapshotMeta = QJsonObject();
+    snapshotNote.clear();
+    timing = QueryTiming();
+    if (stats) timing.key = stats->begin(source, s);
+    renderOpen = true;
+    current = session->execute(s, chunk);
+    running = current >= 0;
+    return running;
+}
+
+bool ResultTableWidget::isRunning() const
+{
+    return running;
+}
+
+void ResultTableWidget::cancel()
+{
+    if (session && (running || model->hasMore())) session->cancel();
+}
+
+void ResultTableWidget::setStats(QueryStats* st, const QString& src)
+{
+    stats = st;
+    source = src;
+}
+
+void ResultTableWidget::recordTiming()
+{
+    if (stats && timing.key >= 0) stats->record(timing);
+}
+
+void ResultTableWidget::setChunkSize(int rows)
+{
+    chunk = qMax(1, rows);
+}
+
+int ResultTableWidget::rowCount() const
+{
+    return model->result().rowCount();
+}
+
+int ResultTableWidget::columnIndex(const QString& name) const
+{
+    const ResultBuffer& r = model->result();
+    for (int c = 0; c < r.columnCount(); ++c)
+        if (r.columnName(c).compare(name, Qt::CaseInsensitive) == 0) return c;
+    return -1;
+}
+
+QVariant ResultTableWidget::value(int row, int column) const
+{
+    return model->result().value(row, column);
+}
+
+void ResultTableWidget::setCellSource(const DbSession* s, const QString& db, const QString& table,
+                                      const QStringList& keyColumns)
+{
+    cellSession = s;
+    cellDb = db;
+    cellTable = table;
+    cellKeys = keyColumns;
+}
+
+void ResultTableWidget::openCell(const QModelIndex& index)
+{
+    if (!index.isValid()) return;
+    const ResultBuffer& r = model->result();
+    const int row = model->sourceRow(index.row());
+    const int col = index.column();
+    const QString name = r.columnName(col);
+    const qint64 full = r.fullLength(row, col);
+
+    // Celda recortada de una tabla con llave: SELECT col FROM db.t WHERE llave = valores de la fila
+    QString sql;
+    if (full >= 0 && cellSession && !cellKeys.isEmpty()) {
+        QStringList where;
+        for (const auto& k : cellKeys) {
+            const int c = columnIndex(k);
+            if (c < 0) { where.clear(); break; }
+            where << QString("%1 = %2").arg(DbSession::q(k), DbSession::literal(r.value(row, c)));
         }
-        stack->setCurrentWidget(view);
-        return true;
+        if (!where.isEmpty())
+            sql = QString("SELECT %1 FROM %2.%3 WHERE %4")
+                      .arg(DbSession::q(name), DbSession::q(cellDb), DbSession::q(cellTable), where.join(" AND "));
     }
 
-    // DDL / DML sin result set.
-    QSqlQuery q(db);
-    const bool ok = q.exec(s);
-    if (!ok) {
-        const QString e = q.lastError().text();
-        if (outError) *outError = e;
-        info->setText(e);
-        stack->setCurrentWidget(info);
-        return false;
+    auto* viewer = new CellViewer(name, r.value(row, col), full, cellSession, sql, this);
+    viewer->show();
+}
+
+void ResultTableWidget::showViewMenu(const QPoint& pos)
+{
+    QMenu menu(this);
+    QAction* actSave = menu.addAction("Guardar instantánea del resultado...");
+    actSave->setEnabled(model->columnCount() > 0 && !running && !saveJob);
+    if (menu.exec(view->viewport()->mapToGlobal(pos)) == actSave) saveSnapshot();
+}
+
+void ResultTableWidget::setProfileName(const QString& name)
+{
+    profile = name;
+}
+
+void ResultTableWidget::saveSnapshot()
+{
+    if (saveJob || running || model->columnCount() == 0) return;
+
+    QSettings st("UNITEC", "Database-Manager");
+    const QString dir = st.value("snapshots/lastDir", QDir::homePath()).toString();
+    const QString path = QFileDialog::getSaveFileName(this, "Guardar instantánea del resultado",
+                                                      QDir(dir).filePath("resultado.dmsnap"),
+                                                      "Instantáneas de resultados (*.dmsnap)");
+    if (path.isEmpty()) return;
+    st.setValue("snapshots/lastDir", QFileInfo(path).absolutePath());
+
+    // Una instantánea reabierta conserva el origen de la primera
+    QJsonObject meta = snapshotMeta;
+    if (meta.isEmpty()) {
+        meta["sql"] = lastSql;
+        meta["profile"] = profile;
+        meta["source"] = source;
+        meta["savedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        meta["complete"] = !model->hasMore();
+        meta["timing"] = QJsonObject{
+            {"executeMs", double(timing.executeMs)},
+            {"firstRowMs", double(timing.firstRowMs)},
+            {"fetchMs", double(timing.fetchMs)},
+            {"activeMs", double(timing.activeMs())},
+            {"rows", double(timing.rows)},
+            {"bytes", double(timing.bytes)},
+        };
+    }
+
+    // Se escribe en otro hilo sobre una copia: los tramos se comparten y no cambian
+    std::shared_ptr<const ResultBuffer> data = model->share();
+    progress->setText("Guardando instantánea...");
+    QThread* t = QThread::create([this, data, meta, path]() mutable {
+        QElapsedTimer clock;
+        clock.start();
+        QString err;
+        const bool ok = data->save(path, meta, &err);
+        data.reset();
+        const qint64 ms = clock.elapsed();
+        QMetaObject::invokeMethod(this, [this, ok, err, path, ms](){
+            model->enforceBudget();
+            updateProgress();
+            progress->setText(ok ? QString("Instantánea guardada en %1 (%2 ms)").arg(path, QString::number(ms))
+                                 : "No se pudo guardar la instantánea: " + err);
+        }, Qt::QueuedConnection);
+    });
+    saveJob = t;
+    connect(t, &QThread::finished, t, &QObject::deleteLater);
+    t->start(QThread::LowPriority);
+}
+
+bool ResultTableWidget::openSnapshot(const QString& path, QString* err)
+{
+    ResultBuffer data;
+    QJsonObject meta;
+    if (!data.load(path, &meta, err)) return false;
+
+    viewTimer->stop();
+    viewSpec = ResultViewSpec();
+    viewMs = -1;
+    {
+        const QSignalBlocker block(quickFilter);
+        quickFilter->clear();
     }
+    view->horizontalHeader()->setSortIndicatorShown(false);
+    model->setResult(data);
+    stack->setCurrentWidget(view);
+
+    snapshotMeta = meta;
+    lastSql = meta.value("sql").toString();
+    const QJsonObject t = meta.value("timing").toObject();
+    QStringList parts;
+    parts << "instantánea del " + QDateTime::fromString(meta.value("savedAt").toString(), Qt::ISODate)
+                                      .toString("yyyy-MM-dd HH:mm");
+    if (!meta.value("profile").toString().isEmpty()) parts << "perfil " + meta.value("profile").toString();
+    if (t.value("activeMs").toDouble() > 0)
+        parts << QString("consulta original: %1 ms").arg(qint64(t.value("activeMs").toDouble()));
+    if (!meta.value("complete").toBool(true)) parts << "sin las filas que no se habían leído";
+    snapshotNote = " · " + parts.join(" · ");
+    progress->setToolTip(lastSql);
+    updateProgress();
+    return true;
+}
 
-    const qint64 aff = q.numRowsAffected();
-    const QString msg = (aff >= 0)
-                            ? QString("Ejecutado correctamente. Filas afectadas: %1").arg(aff)
-                            : QString("Ejecutado correctamente.");
+void ResultTableWidget::showMessage(const QString& msg)
+{
     info->setText(msg);
     stack->setCurrentWidget(info);
-    return true;
+}
+
+void ResultTableWidget::onHeaderClicked(int column)
+{
+    if (viewSpec.sortColumn != column) {
+        viewSpec.sortColumn = column;
+        viewSpec.descending = false;
+    } else if (!viewSpec.descending) {
+        viewSpec.descending = true;
+    } else {
+        viewSpec.sortColumn = -1;
+    }
+
+    QHeaderView* header = view->horizontalHeader();
+    header->setSortIndicatorShown(viewSpec.sortColumn >= 0);
+    if (viewSpec.sortColumn >= 0)
+        header->setSortIndicator(column, viewSpec.descending ? Qt::DescendingOrder : Qt::AscendingOrder);
+    applyView();
+}
+
+void ResultTableWidget::showHeaderMenu(const QPoint& pos)
+{
+    QHeaderView* header = view->horizontalHeader();
+    const int column = header->logicalIndexAt(pos);
+    if (column < 0) return;
+    const QString name = model->result().columnName(column);
+
+    QMenu menu(this);
+    QAction* actFilter = menu.addAction(QString("Filtrar \"%1\"...").arg(name));
+    QAction* actClearColumn = menu.addAction(QString("Quitar filtros de \"%1\"").arg(name));
+    QAction* actClearAll = menu.addAction("Quitar orden y filtros");
+
+    bool hasColumnFilter = false;
+    for (const auto& f : viewSpec.filters) hasColumnFilter |= f.column == column;
+    actClearColumn->setEnabled(hasColumnFilter);
+    actClearAll->setEnabled(!viewSpec.isIdentity());
+
+    QAction* chosen = menu.exec(header->mapToGlobal(pos));
+    if (chosen == actFilter) {
+        bool ok = false;
+        const QString text = QInputDialog::getText(
+            this, "Filtrar columna",
+            QString("Condición para \"%1\":\n"
+                    "= x   != x   < x   <= x   > x   >= x   ^ empieza   ~ contiene   NULL   !NULL").arg(name),
+            QLineEdit::Normal, QString(), &ok);
+        if (!ok) return;
+        ResultFilter f;
+        QString err;
+        if (!ResultFilter::parse(column, text, &f, &err)) {
+            progress->setText(err);
+            return;
+        }
+        viewSpec.filters << f;
+    } else if (chosen == actClearColumn) {
+        for (int i = viewSpec.filters.size() - 1; i >= 0; --i)
+            if (viewSpec.filters[i].column == column) viewSpec.filters.remove(i);
+    } else if (chosen == actClearAll) {
+        viewSpec = ResultViewSpec();
+        const QSignalBlocker block(quickFilter);
+        quickFilter->clear();
+        header->setSortIndicatorShown(false);
+    } else {
+        return;
+    }
+    applyView();
+}
+
+void ResultTableWidget::applyView()
+{
+    viewTimer->stop();
+    model->setView(viewSpec);
+    updateProgress();
+}
+
+QString ResultTableWidget::viewSummary() const
+{
+    const ResultBuffer& r = model->result();
+    QStringList parts;
+    if (viewSpec.sortColumn >= 0)
+        parts << QString("orden: %1 %2").arg(r.columnName(viewSpec.sortColumn), viewSpec.descending ? "desc" : "asc");
+    for (const auto& f : viewSpec.filters)
+        parts << QString("%1 %2").arg(r.columnName(f.column), f.toString());
+    if (!viewSpec.quickText.trimmed().isEmpty())
+        parts << QString("texto: \"%1\"").arg(viewSpec.quickText.trimmed());
+    return parts.join(" · ");
+}
+
+void ResultTableWidget::updateProgress()
+{
+    if (model->columnCount() == 0) return;
+
+    // Orden/filtro local: lo que se ve y cuánto tardó
+    QString local;
+    if (model->isViewPending())
+        local = " · ordenando/filtrando...";
+    else if (model->isViewActive())
+        local = QString(" · mostrando %1 (%2, %3 ms)").arg(model->rowCount()).arg(viewSummary()).arg(viewMs);
+
+    local += snapshotNote;
+
+    const int n = model->result().rowCount();
+    // "en memoria" cuenta solo lo residente; lo volcado se lee del archivo mapeado
+    QString mem = humanBytes(model->memoryUsage()) + " en memoria";
+    if (model->diskUsage() > 0) mem += " · " + humanBytes(model->diskUsage()) + " en disco";
+    if (!model->spillError().isEmpty()) mem += " (no se pudo volcar a disco: " + model->spillError() + ")";
+    if (running || model->isFetching())
+        progress->setText(QString("%1 filas obtenidas hasta ahora · obteniendo... · %2%3").arg(n).arg(mem, local));
+    else if (model->hasMore() && model->isViewActive())
+        progress->setText(QString("%1 filas obtenidas · hay más (quita orden y filtros para seguir cargando) · %2%3").arg(n).arg(mem, local));
+    else if (model->hasMore())
+        progress->setText(QString("%1 filas obtenidas · hay más (desplázate para cargar) · %2%3").arg(n).arg(mem, local));
+    else
+        progress->setText(QString("%1 filas · %2%3").arg(n).arg(mem, local));
 }
@@ -1,21 +1,101 @@
 #pragma once
 #include <QWidget>
+#include <QPointer>
+#include <QJsonObject>
+#include "QueryStats.h"
+#include "ResultView.h"
 
 class QTableView;
-class QSqlQueryModel;
 class QLabel;
+class QLineEdit;
+class QTimer;
 class QStackedWidget;
+class QuerySession;
+class ResultModel;
+class DbSession;
+class QModelIndex;
+class QThread;
 
 class ResultTableWidget : public QWidget {
     Q_OBJECT
 public:
-    explicit ResultTableWidget(QWidget* parent=nullptr);
+    // session nulo: solo muestra instantáneas (openSnapshot), no ejecuta consultas.
+    explicit ResultTableWidget(QuerySession* session, QWidget* parent=nullptr);
+    ~ResultTableWidget() override;
 
-    bool setQuery(const QString& sql, const QString& conn, QString* outError = nullptr);
+    // Asíncrono: el resultado llega por queryFinished.
+    bool execute(const QString& sql, QString* outError = nullptr);
+    bool isRunning() const;
+    void cancel();
+
+    // Filas por tramo al hacer scroll (results/chunkSize en QSettings).
+    int chunkSize() const { return chunk; }
+    void setChunkSize(int rows);
+
+    // Registra los tiempos de cada consulta en stats con el origen indicado.
+    void setStats(QueryStats* stats, const QString& source);
+
+    // Acceso a las filas ya obtenidas, en el orden del servidor (sin el orden/filtro local).
+    int rowCount() const;
+    int columnIndex(const QString& name) const;
+    QVariant value(int row, int column) const;
+
+    // Las filas son de db.table: el visor de celdas pide por llave el valor completo
+    // de las celdas recortadas.
+    void setCellSource(const DbSession* s, const QString& db, const QString& table,
+                       const QStringList& keyColumns);
+
+    // Instantáneas (.dmsnap): el resultado obtenido con su SQL, perfil y tiempos.
+    // Se guardan en otro hilo; al abrirlas el archivo se mapea y no se leen los datos.
+    void setProfileName(const QString& name);
+    void saveSnapshot();
+    bool openSnapshot(const QString& path, QString* err = nullptr);
+
+signals:
+    void queryFinished(bool ok, const QString& message);
 
 private:
+    void showMessage(const QString& msg);
+    void updateProgress();
+    void recordTiming();
+    void openCell(const QModelIndex& index);
+    void showViewMenu(const QPoint& pos);
+
+    // Orden y filtros locales sobre las filas obtenidas
+    void onHeaderClicked(int column);
+    void showHeaderMenu(const QPoint& pos);
+    void applyView();
+    QString viewSummary() const;
+
+    QuerySession* session;
+    int current = -1;
+    bool running = false;
+    int chunk = 500;
+
+    QueryStats* stats = nullptr;
+    QString source;
+    QueryTiming timing;
+    bool renderOpen = false;   // se suma el pintado hasta el primero tras terminar
+
+    const DbSession* cellSession = nullptr;
+    QString cellDb;
+    QString cellTable;
+    QStringList cellKeys;
+
+    QString lastSql;
+    QString profile;
+    QJsonObject snapshotMeta;  // de la instantánea abierta
+    QString snapshotNote;
+    QPointer<QThread> saveJob;
+
+    ResultViewSpec viewSpec;
+    qint64 viewMs = -1;        // último cálculo de orden/filtro
+
     QTableView* view;
-    QSqlQueryModel* model;
+    ResultModel* model;
     QLabel* info;
+    QLabel* progress;
+    QLineEdit* quickFilter;
+    QTimer* viewTimer;         // agrupa cambios del filtro y tramos que llegan
     QStackedWidget* stack;
 };
@@ -0,0 +1,460 @@
+#include "ResultView.h"
+#include <QThread>
+#include <QDate>
+#include <QDateTime>
+#include <QTime>
+#include <QLocale>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int kParallelMinRows = 50000;   // por debajo, un solo hilo
+
+struct StrRef { const char* p = nullptr; int n = 0; };
+
+qint64 readI64(const QByteArray& a, int i)
+{
+    qint64 v; std::memcpy(&v, a.constData() + qsizetype(i) * 8, 8); return v;
+}
+double readF64(const QByteArray& a, int i)
+{
+    double v; std::memcpy(&v, a.constData() + qsizetype(i) * 8, 8); return v;
+}
+bool nullAt(const ColumnBlock& b, int r)
+{
+    return (uchar(b.nulls.at(r >> 3)) >> (r & 7)) & 1;
+}
+StrRef textAt(const ColumnBlock& b, int r)
+{
+    quint32 s, e;
+    std::memcpy(&s, b.offsets.constData() + qsizetype(r) * 4, 4);
+    std::memcpy(&e, b.offsets.constData() + qsizetype(r + 1) * 4, 4);
+    // Acotados al arena, como en ResultChunk::value (instantáneas sin validar fila a fila)
+    const quint32 n = quint32(b.arena.size());
+    s = qMin(s, n);
+    e = qBound(s, e, n);
+    return { b.arena.constData() + s, int(e - s) };
+}
+
+inline uchar fold(char c)
+{
+    const uchar u = uchar(c);
+    return (u >= 'A' && u <= 'Z') ? uchar(u + 32) : u;
+}
+QByteArray foldAll(const QString& s)
+{
+    QByteArray b = s.toUtf8();
+    for (char& c : b) c = char(fold(c));
+    return b;
+}
+int compareText(StrRef a, StrRef b)
+{
+    const int n = qMin(a.n, b.n);
+    for (int i = 0; i < n; ++i) {
+        const uchar x = fold(a.p[i]), y = fold(b.p[i]);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return a.n == b.n ? 0 : (a.n < b.n ? -1 : 1);
+}
+// needle ya plegado
+bool containsFolded(StrRef hay, const QByteArray& needle, bool prefixOnly = false)
+{
+    const int m = needle.size();
+    if (m == 0) return true;
+    const int last = prefixOnly ? 0 : hay.n - m;
+    for (int i = 0; i <= last && i + m <= hay.n; ++i) {
+        int k = 0;
+        while (k < m && fold(hay.p[i + k]) == uchar(needle[k])) ++k;
+        if (k == m) return true;
+    }
+    return false;
+}
+bool toNumber(StrRef s, double* out)
+{
+    if (s.n == 0) return false;
+    bool ok = false;
+    *out = QByteArray::fromRawData(s.p, s.n).toDouble(&ok);
+    return ok;
+}
+
+// Texto mostrado de una celda (sin plegar)
+QByteArray displayText(const ResultChunk& c, const ColumnBlock& b, int r, int col)
+{
+    switch (b.type) {
+    case ColumnType::Text:
+    case ColumnType::Bytes: {
+        const StrRef s = textAt(b, r);
+        return QByteArray::fromRawData(s.p, s.n);
+    }
+    case ColumnType::Int64:  return QByteArray::number(readI64(b.fixed, r));
+    case ColumnType::Double: return QString::number(readF64(b.fixed, r), 'g', QLocale::FloatingPointShortest).toUtf8();
+    default:                 return c.value(r, col).toString().toUtf8();
+    }
+}
+
+// Ejecuta f(0..parts-1), cada parte en su hilo (la 0 en el llamador).
+template <class F>
+void runParallel(int parts, F f)
+{
+    if (parts <= 1) { f(0); return; }
+    QVector<QThread*> threads;
+    for (int p = 1; p < parts; ++p) {
+        QThread* t = QThread::create([&f, p](){ f(p); });
+        threads << t;
+        t->start();
+    }
+    f(0);
+    for (QThread* t : threads) {
+        t->wait();
+        delete t;
+    }
+}
+
+int threadsFor(qint64 rows)
+{
+    if (rows < kParallelMinRows) return 1;
+    return qBound(1, QThread::idealThreadCount(), 16);
+}
+
+bool cancelled(const std::atomic<bool>* cancel)
+{
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+// Reparte los tramos del buffer en `parts` rangos contiguos de tamaño parecido.
+QVector<int> chunkRanges(const ResultBuffer& data, int parts)
+{
+    QVector<int> bounds(parts + 1, data.chunkCount());
+    bounds[0] = 0;
+    int c = 0;
+    for (int p = 1; p < parts; ++p) {
+        const qint64 target = qint64(data.rowCount()) * p / parts;
+        while (c < data.chunkCount() && data.chunkStart(c) < target) ++c;
+        bounds[p] = c;
+    }
+    return bounds;
+}
+
+// Filtro ya interpretado para el tipo de su columna
+struct Compiled {
+    ResultFilter f;
+    ColumnType type = ColumnType::Text;
+    QByteArray folded;      // valor plegado (texto)
+    bool typed = false;     // num/key válidos para comparar sin texto
+    double num = 0;         // Int64/Double, o texto numérico
+    qint64 key = 0;         // Date/DateTime/Time/Bool
+    bool numericText = false;
+};
+
+Compiled compile(const ResultFilter& f, ColumnType type)
+{
+    Compiled c;
+    c.f = f;
+    c.type = type;
+    c.folded = foldAll(f.value);
+    const QString v = f.value.trimmed();
+    bool ok = false;
+    switch (type) {
+    case ColumnType::Int64:
+    case ColumnType::Double:
+        c.num = v.toDouble(&ok);
+        c.typed = ok;
+        break;
+    case ColumnType::Bool: {
+        const QString l = v.toLower();
+        if (l == "1" || l == "true" || l == "si" || l == "sí") { c.key = 1; c.typed = true; }
+        else if (l == "0" || l == "false" || l == "no")       { c.key = 0; c.typed = true; }
+        break;
+    }
+    case ColumnType::Date: {
+        const QDate d = QDate::fromString(v, Qt::ISODate);
+        c.typed = d.isValid();
+        c.key = d.toJulianDay();
+        break;
+    }
+    case ColumnType::DateTime: {
+        const QDateTime d = QDateTime::fromString(v, Qt::ISODate);
+        c.typed = d.isValid();
+        c.key = d.toMSecsSinceEpoch();
+        break;
+    }
+    case ColumnType::Time: {
+        const QTime t = QTime::fromString(v, Qt::ISODate);
+        c.typed = t.isValid();
+        c.key = t.msecsSinceStartOfDay();
+        break;
+    }
+    case ColumnType::Text:
+    case ColumnType::Bytes:
+        c.num = v.toDouble(&ok);
+        c.numericText = ok;
+        break;
+    }
+    return c;
+}
+
+template <class T>
+bool compareOp(ResultFilter::Op op, T a, T b)
+{
+    switch (op) {
+    case ResultFilter::Equal:        return a == b;
+    case ResultFilter::NotEqual:     return a != b;
+    case ResultFilter::Less:         return a < b;
+    case ResultFilter::LessEqual:    return a <= b;
+    case ResultFilter::Greater:      return a > b;
+    case ResultFilter::GreaterEqual: return a >= b;
+    default:                         return false;
+    }
+}
+
+bool matches(const Compiled& c, const ResultChunk& chunk, int r)
+{
+    const int col = c.f.column;
+    const ColumnBlock& b = chunk.column(col);
+    const bool null = nullAt(b, r);
+    if (c.f.op == ResultFilter::IsNull) return null;
+    if (c.f.op == ResultFilter::NotNull) return !null;
+    if (null) return false;
+
+    const bool textOp = c.f.op == ResultFilter::Contains || c.f.op == ResultFilter::StartsWith;
+    if (b.type == ColumnType::Text || b.type == ColumnType::Bytes) {
+        const StrRef s = textAt(b, r);
+        if (textOp) return containsFolded(s, c.folded, c.f.op == ResultFilter::StartsWith);
+        double d;
+        if (c.numericText && toNumber(s, &d)) return compareOp(c.f.op, d, c.num);
+        return compareOp(c.f.op, compareText(s, {c.folded.constData(), c.folded.size()}), 0);
+    }
+
+    if (!textOp && c.typed) {
+        if (b.type == ColumnType::Double) return compareOp(c.f.op, readF64(b.fixed, r), c.num);
+        if (b.type == ColumnType::Int64)  return compareOp(c.f.op, double(readI64(b.fixed, r)), c.num);
+        return compareOp(c.f.op, readI64(b.fixed, r), c.key);
+    }
+
+    // Sin valor tipado (p. ej. "contiene" sobre una fecha): por el texto mostrado
+    const QByteArray t = displayText(chunk, b, r, col);
+    const StrRef s{t.constData(), t.size()};
+    if (textOp) return containsFolded(s, c.folded, c.f.op == ResultFilter::StartsWith);
+    return compareOp(c.f.op, compareText(s, {c.folded.constData(), c.folded.size()}), 0);
+}
+
+bool quickMatch(const QByteArray& needle, const ResultChunk& chunk, int r)
+{
+    for (int col = 0; col < chunk.columnCount(); ++col) {
+        const ColumnBlock& b = chunk.column(col);
+        if (nullAt(b, r)) continue;
+        if (b.type == ColumnType::Text || b.type == ColumnType::Bytes) {
+            if (containsFolded(textAt(b, r), needle)) return true;
+            continue;
+        }
+        const QByteArray t = displayText(chunk, b, r, col);
+        if (containsFolded({t.constData(), t.size()}, needle)) return true;
+    }
+    return false;
+}
+
+// Merge sort estable en paralelo sobre índices de fila.
+template <class Less>
+bool parallelSort(QVector<int>& v, Less less, const std::atomic<bool>* cancel)
+{
+    const int n = v.size();
+    const int parts = threadsFor(n);
+    QVector<int> bounds(parts + 1);
+    for (int p = 0; p <= parts; ++p) bounds[p] = int(qint64(n) * p / parts);
+
+    int* data = v.data();
+    runParallel(parts, [&](int p){
+        std::stable_sort(data + bounds[p], data + bounds[p + 1], less);
+    });
+    if (cancelled(cancel)) return false;
+
+    // Fusiones por pares: log2(parts) rondas, cada par en su hilo
+    QVector<int> tmp(n);
+    int* src = data;
+    int* dst = tmp.data();
+    for (int width = 1; width < parts; width *= 2) {
+        const int pairs = (parts + 2 * width - 1) / (2 * width);
+        runParallel(pairs, [&](int k){
+            const int i = k * 2 * width;
+            const int lo = bounds[i];
+            const int mid = bounds[qMin(i + width, parts)];
+            const int hi = bounds[qMin(i + 2 * width, parts)];
+            std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, less);
+        });
+        std::swap(src, dst);
+        if (cancelled(cancel)) return false;
+    }
+    if (src != data) std::copy(src, src + n, data);
+    return true;
+}
+
+template <class Key, class KeyLess>
+bool sortByKeys(QVector<int>& rows, const QVector<Key>& keyVec, const QVector<char>& nullVec,
+                bool desc, KeyLess keyLess, const std::atomic<bool>* cancel)
+{
+    const Key* keys = keyVec.constData();
+    const char* nulls = nullVec.constData();
+    auto less = [&](int a, int b){
+        const bool na = nulls[a], nb = nulls[b];
+        if (na || nb) return desc ? (!na && nb) : (na && !nb);
+        return desc ? keyLess(keys[b], keys[a]) : keyLess(keys[a], keys[b]);
+    };
+    return parallelSort(rows, less, cancel);
+}
+
+} // namespace
+
+bool ResultFilter::parse(int column, const QString& text, ResultFilter* out, QString* err)
+{
+    const QString t = text.trimmed();
+    if (t.isEmpty()) {
+        if (err) *err = "Filtro vacío.";
+        return false;
+    }
+
+    ResultFilter f;
+    f.column = column;
+    if (t.compare("NULL", Qt::CaseInsensitive) == 0) f.op = IsNull;
+    else if (t.compare("!NULL", Qt::CaseInsensitive) == 0) f.op = NotNull;
+    else {
+        static const struct { const char* token; Op op; } ops[] = {
+            {"!=", NotEqual}, {"<>", NotEqual}, {"<=", LessEqual}, {">=", GreaterEqual},
+            {"=", Equal}, {"<", Less}, {">", Greater}, {"^", StartsWith}, {"~", Contains},
+        };
+        f.op = Contains;
+        f.value = t;
+        for (const auto& o : ops) {
+            if (t.startsWith(QLatin1String(o.token))) {
+                f.op = o.op;
+                f.value = t.mid(int(std::strlen(o.token))).trimmed();
+                break;
+            }
+        }
+        if (f.value.isEmpty()) {
+            if (err) *err = "Falta el valor del filtro.";
+            return false;
+        }
+    }
+    *out = f;
+    return true;
+}
+
+QString ResultFilter::toString() const
+{
+    switch (op) {
+    case Equal:        return "= " + value;
+    case NotEqual:     return "!= " + value;
+    case Less:         return "< " + value;
+    case LessEqual:    return "<= " + value;
+    case Greater:      return "> " + value;
+    case GreaterEqual: return ">= " + value;
+    case StartsWith:   return "^ " + value;
+    case Contains:     return "~ " + value;
+    case IsNull:       return "NULL";
+    case NotNull:      return "!NULL";
+    }
+    return value;
+}
+
+bool ResultViewBuilder::build(const ResultBuffer& data, const ResultViewSpec& spec, QVector<int>* rows,
+                              const std::atomic<bool>* cancel)
+{
+    const int n = data.rowCount();
+    const int parts = threadsFor(n);
+    const QVector<int> ranges = chunkRanges(data, parts);
+
+    // 1) Filtro: cada hilo recorre sus tramos y junta las filas que pasan, en orden
+    QVector<Compiled> filters;
+    for (const auto& f : spec.filters) {
+        if (f.column >= 0 && f.column < data.columnCount())
+            filters << compile(f, data.columnType(f.column));
+    }
+    const QByteArray quick = foldAll(spec.quickText.trimmed());
+
+    if (filters.isEmpty() && quick.isEmpty()) {
+        rows->resize(n);
+        for (int i = 0; i < n; ++i) (*rows)[i] = i;
+    } else {
+        QVector<QVector<int>> found(parts);
+        QVector<int>* foundOut = found.data();
+        runParallel(parts, [&](int p){
+            QVector<int>& out = foundOut[p];
+            for (int ci = ranges[p]; ci < ranges[p + 1]; ++ci) {
+                if (cancelled(cancel)) return;
+                const ResultChunk& c = data.chunk(ci);
+                const int base = data.chunkStart(ci);
+                for (int r = 0; r < c.rowCount(); ++r) {
+                    bool ok = true;
+                    for (const auto& f : filters) {
+                        if (!matches(f, c, r)) { ok = false; break; }
+                    }
+                    if (ok && !quick.isEmpty()) ok = quickMatch(quick, c, r);
+                    if (ok) out << base + r;
+                }
+            }
+        });
+        if (cancelled(cancel)) return false;
+        rows->clear();
+        int total = 0;
+        for (const auto& f : found) total += f.size();
+        rows->reserve(total);
+        for (const auto& f : found) *rows += f;
+    }
+
+    const int col = spec.sortColumn;
+    if (col < 0 || col >= data.columnCount() || rows->size() < 2) return !cancelled(cancel);
+
+    // 2) Claves de la columna de orden, indexadas por fila del buffer
+    const ColumnType type = data.columnType(col);
+    const bool text = type == ColumnType::Text || type == ColumnType::Bytes;
+    QVector<char> nulls(n, 0);
+    QVector<qint64> ints;
+    QVector<double> reals;
+    QVector<StrRef> strs;
+    if (type == ColumnType::Double || text) reals.resize(n);
+    if (text) strs.resize(n);
+    if (!text && type != ColumnType::Double) ints.resize(n);
+    // Punteros antes de repartir: los hilos escriben en posiciones disjuntas
+    char* nullOut = nulls.data();
+    qint64* intOut = ints.data();
+    double* realOut = reals.data();
+    StrRef* strOut = strs.data();
+
+    QVector<char> numericPart(parts, 1);
+    char* numericOut = numericPart.data();
+    runParallel(parts, [&](int p){
+        bool numeric = true;
+        for (int ci = ranges[p]; ci < ranges[p + 1]; ++ci) {
+            if (cancelled(cancel)) return;
+            const ColumnBlock& b = data.chunk(ci).column(col);
+            const int base = data.chunkStart(ci);
+            const int count = data.chunk(ci).rowCount();
+            for (int r = 0; r < count; ++r) {
+                const int g = base + r;
+                if (nullAt(b, r)) { nullOut[g] = 1; continue; }
+                if (text) {
+                    strOut[g] = textAt(b, r);
+                    if (numeric) numeric = toNumber(strOut[g], &realOut[g]);
+                } else if (type == ColumnType::Double) {
+                    realOut[g] = readF64(b.fixed, r);
+                } else {
+                    intOut[g] = readI64(b.fixed, r);
+                }
+            }
+        }
+        numericOut[p] = numeric;
+    });
+    if (cancelled(cancel)) return false;
+
+    // 3) Orden
+    if (text) {
+        if (!numericPart.contains(0))
+            return sortByKeys(*rows, reals, nulls, spec.descending, [](double a, double b){ return a < b; }, cancel);
+        return sortByKeys(*rows, strs, nulls, spec.descending,
+                          [](StrRef a, StrRef b){ return compareText(a, b) < 0; }, cancel);
+    }
+    if (type == ColumnType::Double)
+        return sortByKeys(*rows, reals, nulls, spec.descending, [](double a, double b){ return a < b; }, cancel);
+    return sortByKeys(*rows, ints, nulls, spec.descending, [](qint64 a, qint64 b){ return a < b; }, cancel);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <QVector>
+#include <QString>
+#include <atomic>
+#include "ResultBuffer.h"
+
+// Predicado sobre una columna de las filas ya obtenidas.
+struct ResultFilter {
+    enum Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Contains, StartsWith, IsNull, NotNull };
+    int column = -1;
+    Op op = Contains;
+    QString value;
+
+    // "= x", "!= x" ("<> x"), "< x", "<= x", "> x", ">= x", "^ x" (empieza por),
+    // "~ x" o solo "x" (contiene), "NULL", "!NULL".
+    static bool parse(int column, const QString& text, ResultFilter* out, QString* err = nullptr);
+    QString toString() const;
+};
+
+// Orden y filtros aplicados en el cliente sobre un ResultBuffer.
+struct ResultViewSpec {
+    int sortColumn = -1;
+    bool descending = false;
+    QVector<ResultFilter> filters;
+    QString quickText;     // en cualquier columna
+
+    bool isIdentity() const { return sortColumn < 0 && filters.isEmpty() && quickText.isEmpty(); }
+};
+
+// Calcula qué filas se ven y en qué orden, sobre los datos columnar tipados (sin QVariant
+// por comparación salvo en filtros de texto sobre fechas). Se extrae una clave por fila y
+// se ordenan índices con un merge sort estable en paralelo: un tramo por hilo y fusiones
+// por pares. NULL va primero en ascendente y último en descendente, como en MariaDB.
+// Los textos se comparan por bytes con mayúsculas ASCII plegadas; si todos los valores
+// de una columna de texto son números (DECIMAL, BIGINT UNSIGNED) se comparan como números.
+class ResultViewBuilder {
+public:
+    // Devuelve false si cancel se activó antes de terminar.
+    static bool build(const ResultBuffer& data, const ResultViewSpec& spec, QVector<int>* rows,
+                      const std::atomic<bool>* cancel = nullptr);
+};
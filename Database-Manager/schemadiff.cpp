@@ -0,0 +1,473 @@
+#include "SchemaDiff.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include "SqlText.h"
+#include <QThread>
+#include <QMutexLocker>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QSet>
+#include <algorithm>
+
+static const char* const kKinds[] = { "table", "view", "function", "procedure", "trigger" };
+
+static QString objectKey(const QString& kind, const QString& name) { return kind + "/" + name; }
+
+// s[*pos] es '`'; deja *pos después del cierre
+static QString readIdentifier(const QString& s, int* pos)
+{
+    QString r;
+    int i = *pos + 1;
+    while (i < s.size()) {
+        if (s[i] == '`') {
+            if (i + 1 < s.size() && s[i + 1] == '`') { r += '`'; i += 2; continue; }
+            ++i;
+            break;
+        }
+        r += s[i++];
+    }
+    *pos = i;
+    return r;
+}
+
+SchemaDiff::SchemaDiff(const DbSession* source, QObject* parent)
+    : QObject(parent)
+{
+    sessions[Source] = source;
+}
+
+SchemaDiff::~SchemaDiff()
+{
+    if (running) stop(false, "Comparación de esquemas cancelada.");
+}
+
+QString SchemaDiff::normalize(const QString& kind, const QString& ddl, const QString& db)
+{
+    static const QRegularExpression definer(R"(\s+DEFINER\s*=\s*(`[^`]*`|'[^']*'|\S+)@(`[^`]*`|'[^']*'|\S+))");
+    static const QRegularExpression autoInc(R"(\s+AUTO_INCREMENT=\d+)");
+
+    QString s = SqlText::stripTrailingSemicolon(ddl).trimmed();
+    s.remove(definer);
+    if (kind == "table") s.remove(autoInc);
+    // SHOW CREATE VIEW califica todo con la base: bajo USE del destino sobra
+    s.remove(DbSession::q(db) + ".");
+    return s;
+}
+
+SchemaDiff::TableDef SchemaDiff::parseTable(const QString& ddl)
+{
+    static const QRegularExpression autoInc(R"(\s*AUTO_INCREMENT=\d+)");
+
+    TableDef t;
+    const QStringList lines = SqlText::stripTrailingSemicolon(ddl).split('\n');
+    for (int n = 1; n < lines.size(); ++n) {
+        QString l = lines[n].trimmed();
+        if (l.startsWith(')')) {
+            // Opciones de la tabla y, en las líneas siguientes, el particionado
+            QStringList rest{l.mid(1).trimmed()};
+            for (int k = n + 1; k < lines.size(); ++k) rest << lines[k].trimmed();
+            t.options = rest.join(' ').remove(autoInc).trimmed();
+            break;
+        }
+        if (l.endsWith(',')) l.chop(1);
+        if (l.isEmpty()) continue;
+
+        if (l.startsWith('`')) {
+            int p = 0;
+            const QString name = readIdentifier(l, &p);
+            t.columnOrder << name;
+            t.columns.insert(name, l);
+        } else if (l.startsWith("PRIMARY KEY")) {
+            t.indexOrder << "PRIMARY";
+            t.indexes.insert("PRIMARY", l);
+        } else if (l.startsWith("CONSTRAINT ")) {
+            int p = 11;
+            const QString name = l.mid(p).startsWith('`') ? readIdentifier(l, &p) : l;
+            const QString rest = l.mid(p).trimmed();
+            if (rest.startsWith("FOREIGN KEY")) t.foreignKeys.insert(name, l);
+            else if (rest.startsWith("CHECK")) t.checks.insert(name, l);
+            else { t.indexOrder << name; t.indexes.insert(name, l); }
+        } else {
+            // UNIQUE KEY, KEY, FULLTEXT KEY, SPATIAL KEY...
+            int p = l.indexOf("KEY `");
+            QString name = l;
+            if (p >= 0) {
+                p += 4;
+                name = readIdentifier(l, &p);
+            }
+            t.indexOrder << name;
+            t.indexes.insert(name, l);
+        }
+    }
+    return t;
+}
+
+bool SchemaDiff::start(const QString& sourceDb, const QString& targetConnStr, const QString& targetDb,
+                       int workers, QString* err)
+{
+    if (running) {
+        if (err) *err = "Ya hay una comparación de esquemas en curso.";
+        return false;
+    }
+
+    ownTarget.reset();
+    sessions[Target] = sessions[Source];
+    if (!targetConnStr.isEmpty()) {
+        ownTarget.reset(new DbSession);
+        QString openErr;
+        if (!ownTarget->openWithDsn(targetConnStr, &openErr)) {
+            ownTarget.reset();
+            if (err) *err = "No se pudo conectar al destino:\n" + openErr;
+            return false;
+        }
+        sessions[Target] = ownTarget.get();
+    } else if (sourceDb == targetDb) {
+        if (err) *err = "El origen y el destino son la misma base.";
+        return false;
+    }
+
+    dbs[Source] = sourceDb;
+    dbs[Target] = targetDb;
+    for (auto& o : objects) o.clear();
+    listed = 0;
+    done = 0;
+    total = 0;
+    sum = Summary();
+    out.clear();
+    closed = false;
+    cancelled = false;
+    running = true;
+
+    {
+        QMutexLocker lock(&mutex);
+        jobs.clear();
+        jobs.enqueue({Source, {}, {}});
+        jobs.enqueue({Target, {}, {}});
+    }
+
+    // Con la misma conexión cada hilo usa una sola del pool para los dos lados
+    int n = qBound(1, workers, sessions[Source]->poolStats().maxSize);
+    if (ownTarget) n = qMin(n, ownTarget->poolStats().maxSize);
+    aliveWorkers = n;
+    for (int k = 0; k < n; ++k) {
+        QThread* t = QThread::create([this](){ workerLoop(); });
+        threads << t;
+        t->start();
+    }
+
+    emit progress(0, 0);
+    return true;
+}
+
+void SchemaDiff::cancel()
+{
+    if (running) stop(false, "Comparación de esquemas cancelada.");
+}
+
+bool SchemaDiff::takeJob(Job* job)
+{
+    QMutexLocker lock(&mutex);
+    while (jobs.isEmpty() && !closed && !cancelled) wake.wait(&mutex);
+    if (cancelled || jobs.isEmpty()) return false;
+    *job = jobs.dequeue();
+    return true;
+}
+
+void SchemaDiff::workerLoop()
+{
+    const bool shared = sessions[Source] == sessions[Target];
+    DbLease leases[2];
+    std::unique_ptr<MetadataService> metas[2];
+
+    Job job;
+    while (takeJob(&job)) {
+        const int slot = shared ? 0 : job.side;
+        if (!leases[slot].isValid()) {
+            QString err;
+            leases[slot] = sessions[job.side]->acquire({}, &err);
+            if (!leases[slot].isValid()) {
+                // El trabajo vuelve a la cola para otro hilo
+                {
+                    QMutexLocker lock(&mutex);
+                    jobs.prepend(job);
+                }
+                wake.wakeOne();
+                QMetaObject::invokeMethod(this, [this, err](){ onWorkerFailed(err); }, Qt::QueuedConnection);
+                return;
+            }
+            metas[slot].reset(new MetadataService(leases[slot].connectionName()));
+        }
+        MetadataService& meta = *metas[slot];
+        const Side side = job.side;
+        const QString& db = dbs[side];
+
+        if (job.kind.isEmpty()) {
+            const auto o = meta.loadSchema(db);
+            QStringList kinds, names;
+            auto add = [&](const QString& kind, const QStringList& list){
+                for (const auto& n : list) { kinds << kind; names << n; }
+            };
+            add("table", o.tables);
+            add("view", o.views);
+            add("function", o.functions);
+            add("procedure", o.procedures);
+            add("trigger", o.triggers);
+            QMetaObject::invokeMethod(this, [this, side, kinds, names](){ onListed(side, kinds, names); },
+                                      Qt::QueuedConnection);
+            continue;
+        }
+
+        QString ddl;
+        if (job.kind == "table")          ddl = meta.showCreateTable(db, job.name);
+        else if (job.kind == "view")      ddl = meta.showCreateView(db, job.name);
+        else if (job.kind == "function")  ddl = meta.showCreateFunction(db, job.name);
+        else if (job.kind == "procedure") ddl = meta.showCreateProcedure(db, job.name);
+        else                              ddl = meta.showCreateTrigger(db, job.name);
+
+        // El hash se calcula aquí, fuera del hilo de la GUI
+        const QByteArray hash = QCryptographicHash::hash(normalize(job.kind, ddl, db).toUtf8(),
+                                                         QCryptographicHash::Md5);
+        const QString kind = job.kind;
+        const QString name = job.name;
+        QMetaObject::invokeMethod(this, [this, side, kind, name, ddl, hash](){
+            onObject(side, kind, name, ddl, hash);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void SchemaDiff::onListed(Side side, const QStringList& kinds, const QStringList& names)
+{
+    if (!running) return;
+
+    total += names.size();
+    ++listed;
+    {
+        QMutexLocker lock(&mutex);
+        for (int i = 0; i < names.size(); ++i) jobs.enqueue({side, kinds[i], names[i]});
+        if (listed == 2) closed = true;
+    }
+    wake.wakeAll();
+    emit progress(done, total);
+
+    finishIfDone();
+}
+
+void SchemaDiff::onObject(Side side, const QString& kind, const QString& name, const QString& ddl,
+                          const QByteArray& hash)
+{
+    if (!running) return;
+
+    objects[side].insert(objectKey(kind, name), {ddl, hash});
+    ++done;
+    if (done % 64 == 0 || done == total) emit progress(done, total);
+
+    finishIfDone();
+}
+
+void SchemaDiff::finishIfDone()
+{
+    if (listed < 2 || done < total) return;
+    buildScript();
+    stop(true, QString("Esquemas comparados: %1 iguales, %2 nuevos, %3 distintos, %4 sobrantes.")
+                   .arg(sum.identical).arg(sum.added).arg(sum.changed).arg(sum.removed));
+}
+
+void SchemaDiff::onWorkerFailed(const QString& error)
+{
+    if (!running) return;
+    if (--aliveWorkers <= 0) stop(false, error);
+}
+
+QString SchemaDiff::forTarget(const QString& kind, const QString& ddl) const
+{
+    return normalize(kind, ddl, dbs[Source]) + ";";
+}
+
+QString SchemaDiff::alterTable(const QString& name, const TableDef& from, const TableDef& to,
+                               QStringList* dropFks, QStringList* addFks) const
+{
+    const QString table = DbSession::q(name);
+    QStringList clauses;
+
+    // Llaves foráneas aparte: se quitan antes y se ponen después de tocar todas las tablas
+    for (auto it = from.foreignKeys.cbegin(); it != from.foreignKeys.cend(); ++it) {
+        if (to.foreignKeys.value(it.key()) != it.value())
+            *dropFks << QString("ALTER TABLE %1 DROP FOREIGN KEY %2;").arg(table, DbSession::q(it.key()));
+    }
+    for (auto it = to.foreignKeys.cbegin(); it != to.foreignKeys.cend(); ++it) {
+        if (from.foreignKeys.value(it.key()) != it.value())
+            *addFks << QString("ALTER TABLE %1 ADD %2;").arg(table, it.value());
+    }
+
+    for (const auto& idx : from.indexOrder) {
+        if (to.indexes.value(idx) == from.indexes.value(idx)) continue;
+        clauses << (idx == "PRIMARY" ? QString("DROP PRIMARY KEY") : "DROP INDEX " + DbSession::q(idx));
+    }
+    for (auto it = from.checks.cbegin(); it != from.checks.cend(); ++it) {
+        if (to.checks.value(it.key()) != it.value()) clauses << "DROP CONSTRAINT " + DbSession::q(it.key());
+    }
+    for (const auto& col : from.columnOrder) {
+        if (!to.columns.contains(col)) clauses << "DROP COLUMN " + DbSession::q(col);
+    }
+
+    // Posición: la columna anterior entre las que existen en los dos lados
+    auto previousCommon = [](const QStringList& order, const TableDef& other){
+        QHash<QString, QString> prev;
+        QString last;
+        for (const auto& c : order) {
+            if (!other.columns.contains(c)) continue;
+            prev.insert(c, last);
+            last = c;
+        }
+        return prev;
+    };
+    const QHash<QString, QString> prevTo = previousCommon(to.columnOrder, from);
+    const QHash<QString, QString> prevFrom = previousCommon(from.columnOrder, to);
+
+    for (int i = 0; i < to.columnOrder.size(); ++i) {
+        const QString& col = to.columnOrder[i];
+        const QString position = i == 0 ? QString("FIRST") : "AFTER " + DbSession::q(to.columnOrder[i - 1]);
+        if (!from.columns.contains(col))
+            clauses << QString("ADD COLUMN %1 %2").arg(to.columns[col], position);
+        else if (from.columns[col] != to.columns[col] || prevTo.value(col) != prevFrom.value(col))
+            clauses << QString("MODIFY COLUMN %1 %2").arg(to.columns[col], position);
+    }
+
+    for (const auto& idx : to.indexOrder) {
+        if (from.indexes.value(idx) != to.indexes.value(idx)) clauses << "ADD " + to.indexes[idx];
+    }
+    for (auto it = to.checks.cbegin(); it != to.checks.cend(); ++it) {
+        if (from.checks.value(it.key()) != it.value()) clauses << "ADD " + it.value();
+    }
+    if (from.options != to.options && !to.options.isEmpty()) clauses << to.options;
+
+    if (clauses.isEmpty()) return {};
+    return QString("ALTER TABLE %1\n  %2;\n").arg(table, clauses.join(",\n  "));
+}
+
+void SchemaDiff::buildScript()
+{
+    // Nombres por tipo y estado, ordenados para que el script sea estable
+    QHash<QString, QStringList> added, changed, removed;
+    for (const char* kind : kKinds) {
+        QSet<QString> names;
+        const QString prefix = QString(kind) + "/";
+        for (int side = 0; side < 2; ++side) {
+            for (auto it = objects[side].cbegin(); it != objects[side].cend(); ++it)
+                if (it.key().startsWith(prefix)) names.insert(it.key().mid(prefix.size()));
+        }
+        QStringList sorted(names.begin(), names.end());
+        std::sort(sorted.begin(), sorted.end());
+        for (const auto& n : sorted) {
+            const auto s = objects[Source].constFind(objectKey(kind, n));
+            const auto t = objects[Target].constFind(objectKey(kind, n));
+            if (t == objects[Target].cend())      { added[kind] << n; ++sum.added; }
+            else if (s == objects[Source].cend()) { removed[kind] << n; ++sum.removed; }
+            else if (s->hash != t->hash)          { changed[kind] << n; ++sum.changed; }
+            else                                  ++sum.identical;
+        }
+    }
+
+    auto ddlOf = [this](Side side, const QString& kind, const QString& name){
+        return objects[side].value(objectKey(kind, name)).ddl;
+    };
+    auto section = [](const QString& title, const QStringList& body){
+        return body.isEmpty() ? QString() : "-- " + title + "\n" + body.join("\n") + "\n\n";
+    };
+
+    // 1. Lo que depende de las tablas se quita antes de tocarlas
+    QStringList drops;
+    for (const auto& tr : removed["trigger"] + changed["trigger"])
+        drops << "DROP TRIGGER IF EXISTS " + DbSession::q(tr) + ";";
+    for (const auto& v : removed["view"] + changed["view"])
+        drops << "DROP VIEW IF EXISTS " + DbSession::q(v) + ";";
+    for (const auto& fn : removed["function"] + changed["function"])
+        drops << "DROP FUNCTION IF EXISTS " + DbSession::q(fn) + ";";
+    for (const auto& sp : removed["procedure"] + changed["procedure"])
+        drops << "DROP PROCEDURE IF EXISTS " + DbSession::q(sp) + ";";
+
+    // 2. Tablas: solo las distintas se analizan
+    QStringList dropFks, addFks, alters, creates, dropTables;
+    for (const auto& t : changed["table"]) {
+        const QString alter = alterTable(t, parseTable(ddlOf(Target, "table", t)),
+                                         parseTable(ddlOf(Source, "table", t)), &dropFks, &addFks);
+        if (!alter.isEmpty()) alters << alter;
+    }
+    for (const auto& t : removed["table"]) dropTables << "DROP TABLE IF EXISTS " + DbSession::q(t) + ";";
+    for (const auto& t : added["table"]) creates << forTarget("table", ddlOf(Source, "table", t)) + "\n";
+
+    // 3. Vistas en orden de dependencia (una vista puede leer de otra que también se crea)
+    QStringList views = added["view"] + changed["view"];
+    QStringList viewDdl;
+    QSet<QString> pendingViews(views.begin(), views.end());
+    while (!views.isEmpty()) {
+        int pick = 0;
+        for (int i = 0; i < views.size(); ++i) {
+            const QString ddl = ddlOf(Source, "view", views[i]);
+            bool ready = true;
+            for (const auto& other : pendingViews) {
+                if (other != views[i] && ddl.contains(DbSession::q(other))) { ready = false; break; }
+            }
+            if (ready) { pick = i; break; }   // con un ciclo se toma la primera
+        }
+        const QString v = views.takeAt(pick);
+        pendingViews.remove(v);
+        viewDdl << forTarget("view", ddlOf(Source, "view", v));
+    }
+
+    QStringList routines, triggers;
+    for (const auto& fn : added["function"] + changed["function"])
+        routines << SqlText::wrapWithDelimiter(forTarget("function", ddlOf(Source, "function", fn)), "$$");
+    for (const auto& sp : added["procedure"] + changed["procedure"])
+        routines << SqlText::wrapWithDelimiter(forTarget("procedure", ddlOf(Source, "procedure", sp)), "$$");
+    for (const auto& tr : added["trigger"] + changed["trigger"])
+        triggers << SqlText::wrapWithDelimiter(forTarget("trigger", ddlOf(Source, "trigger", tr)), "$$");
+
+    out.clear();
+    out += QString("-- Migración de esquema: %1 (destino) queda como %2 (origen)\n")
+               .arg(DbSession::q(dbs[Target]), DbSession::q(dbs[Source]));
+    out += "-- Generado: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n";
+    out += QString("-- Objetos: %1 iguales, %2 nuevos, %3 distintos, %4 sobrantes\n\n")
+               .arg(sum.identical).arg(sum.added).arg(sum.changed).arg(sum.removed);
+
+    if (sum.added + sum.changed + sum.removed == 0) {
+        out += "-- Sin diferencias.\n";
+        return;
+    }
+
+    out += "USE " + DbSession::q(dbs[Target]) + ";\n";
+    out += "SET FOREIGN_KEY_CHECKS = 0;\n\n";
+    out += section("Triggers, vistas y rutinas que se quitan o se rehacen", drops);
+    out += section("Llaves foráneas que cambian", dropFks);
+    out += section("Tablas sobrantes", dropTables);
+    out += section("Tablas nuevas", creates);
+    out += section("Tablas distintas", alters);
+    out += section("Llaves foráneas nuevas", addFks);
+    out += section("Vistas", viewDdl);
+    out += section("Funciones y procedimientos", routines);
+    out += section("Triggers", triggers);
+    out += "SET FOREIGN_KEY_CHECKS = 1;\n";
+}
+
+void SchemaDiff::stop(bool ok, const QString& message)
+{
+    {
+        QMutexLocker lock(&mutex);
+        if (!ok) cancelled = true;
+        closed = true;
+        jobs.clear();
+    }
+    wake.wakeAll();
+
+    for (QThread* t : threads) {
+        t->wait();
+        delete t;
+    }
+    threads.clear();
+
+    for (auto& o : objects) o.clear();
+    ownTarget.reset();
+    running = false;
+    emit finished(ok, message);
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <atomic>
+#include <memory>
+
+class DbSession;
+class QThread;
+
+// Diferencias de esquema entre dos bases (del mismo servidor o de dos conexiones) y script
+// de migración para que el destino quede como el origen.
+// Los SHOW CREATE de los dos lados se piden a la vez, repartidos entre N hilos con una
+// conexión del pool cada uno, como en DdlExporter. De cada objeto se guarda el hash del DDL
+// normalizado (sin DEFINER, AUTO_INCREMENT=n ni el nombre de la base), así los objetos
+// iguales se descartan sin analizarlos. Solo las tablas distintas se parten en columnas,
+// índices, llaves foráneas y CHECKs para generar ALTER TABLE. Las vistas, rutinas y
+// triggers distintos se borran y se vuelven a crear.
+class SchemaDiff : public QObject {
+    Q_OBJECT
+public:
+    explicit SchemaDiff(const DbSession* source, QObject* parent = nullptr);
+    ~SchemaDiff() override;
+
+    // targetConnStr vacío: el destino es otra base de la misma conexión.
+    bool start(const QString& sourceDb, const QString& targetConnStr, const QString& targetDb,
+               int workers, QString* err = nullptr);
+    void cancel();
+    bool isRunning() const { return running; }
+
+    struct Summary {
+        int identical = 0;
+        int added = 0;      // solo en el origen: se crean
+        int changed = 0;
+        int removed = 0;    // solo en el destino: se borran
+    };
+    Summary summary() const { return sum; }
+    QString script() const { return out; }
+
+    // Partes de un SHOW CREATE TABLE, por nombre.
+    struct TableDef {
+        QStringList columnOrder;
+        QHash<QString, QString> columns;       // nombre -> definición completa
+        QStringList indexOrder;
+        QHash<QString, QString> indexes;       // "PRIMARY" o nombre -> línea
+        QHash<QString, QString> foreignKeys;   // nombre -> línea CONSTRAINT ... FOREIGN KEY
+        QHash<QString, QString> checks;        // nombre -> línea CONSTRAINT ... CHECK
+        QString options;                       // ENGINE=... sin AUTO_INCREMENT
+    };
+    static TableDef parseTable(const QString& ddl);
+    // DDL sin lo que no cuenta como diferencia: DEFINER, AUTO_INCREMENT=n y `db`.
+    static QString normalize(const QString& kind, const QString& ddl, const QString& db);
+
+signals:
+    void progress(int done, int total);
+    void finished(bool ok, const QString& message);
+
+private:
+    enum Side { Source = 0, Target = 1 };
+
+    struct Job {
+        Side side = Source;
+        QString kind;   // vacío: listar la base
+        QString name;
+    };
+
+    struct Object {
+        QString ddl;
+        QByteArray hash;
+    };
+
+    void workerLoop();
+    bool takeJob(Job* job);
+    void onListed(Side side, const QStringList& kinds, const QStringList& names);
+    void onObject(Side side, const QString& kind, const QString& name, const QString& ddl,
+                  const QByteArray& hash);
+    void finishIfDone();
+    void onWorkerFailed(const QString& error);
+    void buildScript();
+    void stop(bool ok, const QString& message);
+
+    QString alterTable(const QString& name, const TableDef& from, const TableDef& to,
+                       QStringList* dropFks, QStringList* addFks) const;
+    QString forTarget(const QString& kind, const QString& ddl) const;
+
+    const DbSession* sessions[2] = {nullptr, nullptr};
+    std::unique_ptr<DbSession> ownTarget;
+    bool running = false;
+    QString dbs[2];
+
+    QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Job> jobs;
+    bool closed = false;
+    std::atomic<bool> cancelled{false};
+    QVector<QThread*> threads;
+    int aliveWorkers = 0;
+
+    // Hilo GUI
+    QHash<QString, Object> objects[2];   // "kind/name"
+    int listed = 0;
+    int done = 0;
+    int total = 0;
+    Summary sum;
+    QString out;
+};
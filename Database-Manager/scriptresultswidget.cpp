@@ -0,0 +1,194 @@
+#include "ScriptResultsWidget.h"
+#include "QueryStats.h"
+#include "ResultModel.h"
+#include "QueryWorker.h"
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QTableView>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QSettings>
+
+enum { ColLine, ColSql, ColStatus, ColTime, ColRows };
+
+static QString oneLine(const QString& sql)
+{
+    QString s = sql.simplified();
+    if (s.size() > 120) s = s.left(117) + "...";
+    return s;
+}
+
+ScriptResultsWidget::ScriptResultsWidget(QuerySession* session, QWidget* p)
+    : QWidget(p), session(session)
+{
+    list = new QTableWidget(0, 5);
+    list->setHorizontalHeaderLabels({"Línea", "Sentencia", "Estado", "Tiempo", "Filas"});
+    list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    list->setSelectionBehavior(QAbstractItemView::SelectRows);
+    list->verticalHeader()->setVisible(false);
+    list->horizontalHeader()->setSectionResizeMode(ColSql, QHeaderView::Stretch);
+
+    summary = new QLabel;
+    summary->setWordWrap(true);
+    summary->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+    auto* messages = new QWidget;
+    auto* ml = new QVBoxLayout(messages);
+    ml->setContentsMargins(0,0,0,0);
+    ml->addWidget(summary);
+    ml->addWidget(list, 1);
+
+    tabs = new QTabWidget;
+    tabs->addTab(messages, "Mensajes");
+
+    auto* l = new QVBoxLayout(this);
+    l->setContentsMargins(0,0,0,0);
+    l->addWidget(tabs);
+
+    // Doble clic en una sentencia con resultado: ir a su pestaña
+    connect(list, &QTableWidget::cellDoubleClicked, this, [this](int row, int){
+        ResultModel* m = models.value(row);
+        if (!m) return;
+        for (int t = 1; t < tabs->count(); ++t) {
+            auto* v = qobject_cast<QTableView*>(tabs->widget(t));
+            if (v && v->model() == m) { tabs->setCurrentIndex(t); return; }
+        }
+    });
+
+    connect(session, &QuerySession::statementStarted, this, [this](int id, int index){
+        if (id != current) return;
+        setStatus(index, "Ejecutando...", QColor("#D4D4D4"));
+        list->scrollToItem(list->item(index, ColStatus));
+    });
+
+    connect(session, &QuerySession::statementColumns, this,
+            [this](int id, int index, const QStringList& cols){
+                if (id != current) return;
+                auto* model = new ResultModel(this);
+                model->reset(cols);
+                models.insert(index, model);
+
+                auto* view = new QTableView;
+                view->setModel(model);
+                tabs->addTab(view, QString("Resultado %1").arg(models.size()));
+                tabs->setTabToolTip(tabs->count() - 1, oneLine(statements[index].sql));
+            });
+
+    connect(session, &QuerySession::statementRows, this,
+            [this](int id, int index, const ResultChunk& rows){
+                if (id != current) return;
+                if (ResultModel* m = models.value(index)) m->appendRows(rows);
+            });
+
+    connect(session, &QuerySession::statementFinished, this,
+            [this](int id, int index, bool ok, const QString& error,
+                   qint64 affected, qint64 elapsedMs, bool truncated){
+                if (id != current) return;
+
+                list->item(index, ColTime)->setText(QString("%1 ms").arg(elapsedMs));
+                if (stats) {
+                    QueryTiming t;
+                    t.key = stats->begin("script", statements[index].sql);
+                    t.executeMs = elapsedMs;
+                    t.rows = qMax<qint64>(affected, 0);
+                    t.ok = ok;
+                    t.done = true;
+                    stats->record(t);
+                }
+                if (ResultModel* m = models.value(index)) m->setFetchDone(false);
+
+                if (!ok) {
+                    setStatus(index, "Error: " + error, QColor("#F44747"));
+                    list->item(index, ColStatus)->setToolTip(error);
+                    return;
+                }
+
+                setStatus(index, "OK", QColor("#9CDCFE"));
+                if (affected >= 0) {
+                    QString rows = QString::number(affected);
+                    if (truncated) rows += " (truncado)";
+                    list->item(index, ColRows)->setText(rows);
+                }
+                emit statementSucceeded(statements[index].sql);
+            });
+
+    connect(session, &QuerySession::finished, this,
+            [this](int id, bool ok, const QString& error, qint64){
+                if (id != current) return;
+                current = -1;
+
+                // Las que no llegaron a ejecutarse
+                for (int i = 0; i < statements.size(); ++i) {
+                    if (list->item(i, ColStatus)->text() == "Pendiente")
+                        setStatus(i, "Omitida", QColor("#808080"));
+                }
+
+                const QString msg = ok ? QString("Script ejecutado: %1 sentencias.").arg(statements.size())
+                                       : error;
+                summary->setText(msg);
+                summary->setStyleSheet(ok ? "color: #9CDCFE;" : "color: #F44747;");
+                emit scriptFinished(ok, msg);
+            });
+}
+
+bool ScriptResultsWidget::run(const QVector<SqlStatement>& stmts, bool stopOnError, QString* outError)
+{
+    if (outError) outError->clear();
+    if (session->isRunning()) {
+        if (outError) *outError = "Ya hay una consulta en ejecución.";
+        return false;
+    }
+
+    // Borra las pestañas de la ejecución anterior
+    while (tabs->count() > 1) {
+        QWidget* w = tabs->widget(1);
+        tabs->removeTab(1);
+        delete w;
+    }
+    qDeleteAll(models);
+    models.clear();
+
+    statements = stmts;
+    list->setRowCount(statements.size());
+    QStringList sqls;
+    for (int i = 0; i < statements.size(); ++i) {
+        const auto& st = statements[i];
+        sqls << st.sql;
+        list->setItem(i, ColLine, new QTableWidgetItem(QString::number(st.line)));
+        auto* text = new QTableWidgetItem(oneLine(st.sql));
+        text->setToolTip(st.sql.left(2000));
+        list->setItem(i, ColSql, text);
+        list->setItem(i, ColStatus, new QTableWidgetItem("Pendiente"));
+        list->setItem(i, ColTime, new QTableWidgetItem);
+        list->setItem(i, ColRows, new QTableWidgetItem);
+    }
+    summary->setText(QString("%1 sentencias · %2")
+                         .arg(statements.size())
+                         .arg(stopOnError ? "se detiene en el primer error" : "continúa tras los errores"));
+    summary->setStyleSheet("color: #D4D4D4;");
+    tabs->setCurrentIndex(0);
+
+    QSettings s("UNITEC", "Database-Manager");
+    const int maxRows = qMax(1, s.value("script/maxRows", 1000).toInt());
+
+    current = session->executeScript(sqls, maxRows, stopOnError);
+    if (current < 0) {
+        if (outError) *outError = "Ya hay una consulta en ejecución.";
+        return false;
+    }
+    return true;
+}
+
+void ScriptResultsWidget::cancel()
+{
+    if (isRunning()) session->cancel();
+}
+
+void ScriptResultsWidget::setStatus(int index, const QString& text, const QColor& color)
+{
+    QTableWidgetItem* it = list->item(index, ColStatus);
+    if (!it) return;
+    it->setText(text);
+    it->setForeground(color);
+}
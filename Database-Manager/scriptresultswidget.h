@@ -0,0 +1,45 @@
+#pragma once
+#include <QWidget>
+#include <QVector>
+#include <QHash>
+#include "SqlText.h"
+
+class QTabWidget;
+class QTableWidget;
+class QLabel;
+class QuerySession;
+class ResultModel;
+class QColor;
+class QueryStats;
+
+// Resultado de un script: una fila de estado por sentencia (tiempo, filas, error)
+// y una pestaña por cada result set. Usa la conexión de la consola (QuerySession).
+class ScriptResultsWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ScriptResultsWidget(QuerySession* session, QWidget* parent = nullptr);
+
+    // Asíncrono: el final llega por scriptFinished.
+    bool run(const QVector<SqlStatement>& statements, bool stopOnError, QString* outError = nullptr);
+    bool isRunning() const { return current >= 0; }
+    void cancel();
+    // Cada sentencia terminada se registra con origen "script".
+    void setStats(QueryStats* st) { stats = st; }
+
+signals:
+    void statementSucceeded(const QString& sql);
+    void scriptFinished(bool ok, const QString& message);
+
+private:
+    void setStatus(int index, const QString& text, const QColor& color);
+
+    QuerySession* session;
+    QueryStats* stats = nullptr;
+    int current = -1;
+    QVector<SqlStatement> statements;
+    QHash<int, ResultModel*> models;   // índice de sentencia -> resultado
+
+    QTabWidget* tabs;
+    QTableWidget* list;
+    QLabel* summary;
+};
@@ -0,0 +1,493 @@
+#include "SqlCompleter.h"
+#include "DbSession.h"
+#include "MetadataService.h"
+#include "SqlHighlighter.h"
+#include <QPlainTextEdit>
+#include <QCompleter>
+#include <QStandardItemModel>
+#include <QAbstractItemView>
+#include <QScrollBar>
+#include <QKeyEvent>
+#include <QCoreApplication>
+#include <QPointer>
+#include <QSettings>
+#include <memory>
+
+namespace {
+
+const QChar kSep(0x1F);
+const int kMaxItems = 200;
+
+bool isWordChar(QChar c) { return c.isLetterOrNumber() || c == '_' || c == '$'; }
+
+// Token de la sentencia: identificador (con sus partes a.b.c, sin comillas invertidas)
+// o un signo suelto. upper solo se llena para palabras sin comillas (posibles palabras clave).
+struct Token {
+    QStringList parts;
+    QString upper;
+    QChar punct;
+    bool word = false;
+};
+
+QVector<Token> tokenize(const QString& s)
+{
+    QVector<Token> out;
+    const int n = s.size();
+    int i = 0;
+    while (i < n) {
+        const QChar c = s[i];
+        if (c.isSpace()) { ++i; continue; }
+
+        if (c == '#' || (c == '-' && i + 1 < n && s[i + 1] == '-')) {
+            while (i < n && s[i] != '\n') ++i;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && s[i + 1] == '*') {
+            const int end = s.indexOf("*/", i + 2);
+            i = end < 0 ? n : end + 2;
+            continue;
+        }
+        if (c == '\'' || c == '"') {
+            ++i;
+            while (i < n && s[i] != c) i += (s[i] == '\\') ? 2 : 1;
+            ++i;
+            Token t;
+            t.punct = c;
+            out << t;
+            continue;
+        }
+
+        if (isWordChar(c) || c == '`') {
+            Token t;
+            t.word = true;
+            bool quoted = false;
+            for (;;) {
+                QString part;
+                if (i < n && s[i] == '`') {
+                    quoted = true;
+                    const int end = s.indexOf('`', i + 1);
+                    part = s.mid(i + 1, (end < 0 ? n : end) - i - 1);
+                    i = end < 0 ? n : end + 1;
+                } else {
+                    const int from = i;
+                    while (i < n && isWordChar(s[i])) ++i;
+                    part = s.mid(from, i - from);
+                }
+                t.parts << part;
+                if (i + 1 < n && s[i] == '.' && (isWordChar(s[i + 1]) || s[i + 1] == '`')) { ++i; continue; }
+                break;
+            }
+            if (!quoted && t.parts.size() == 1) t.upper = t.parts[0].toUpper();
+            out << t;
+            continue;
+        }
+
+        Token t;
+        t.punct = c;
+        out << t;
+        ++i;
+    }
+    return out;
+}
+
+bool isKeywordToken(const Token& t)
+{
+    return !t.upper.isEmpty() && SqlHighlighter::isKeyword(t.upper);
+}
+
+QString quoted(const QString& name)
+{
+    bool plain = !name.isEmpty() && !name[0].isDigit();
+    for (QChar c : name) plain = plain && isWordChar(c);
+    if (plain) return name;
+    QString s = name;
+    s.replace("`", "``");
+    return "`" + s + "`";
+}
+
+// Consulta de una lista en la caché de un MetadataService (name vacío salvo "columns").
+bool cachedList(MetadataService& meta, const QString& db, const QString& kind, const QString& name,
+                QStringList* out)
+{
+    QVariant c;
+    if (!meta.cached(db, kind, name, &c)) return false;
+    *out = c.toStringList();
+    return true;
+}
+
+// Tramo armado solo con la caché de meta; false si falta alguna lista.
+bool bucketFromCache(MetadataService& meta, const QString& bucket, QVector<CompletionIndex::Item>* items)
+{
+    const QStringList p = bucket.split(kSep);
+    auto add = [items](const QStringList& names, CompletionIndex::Kind kind, const QString& detail){
+        for (const auto& n : names) {
+            CompletionIndex::Item it;
+            it.text = n;
+            it.kind = kind;
+            it.detail = detail;
+            *items << it;
+        }
+    };
+
+    QStringList a, b, c, d;
+    if (bucket == CompletionIndex::databasesBucket()) {
+        if (!cachedList(meta, {}, "databases", {}, &a)) return false;
+        add(a, CompletionIndex::Database, "base de datos");
+    } else if (p.size() == 2 && p[0] == "obj") {
+        const QString& db = p[1];
+        if (!cachedList(meta, db, "tables", {}, &a) || !cachedList(meta, db, "views", {}, &b)
+            || !cachedList(meta, db, "functions", {}, &c) || !cachedList(meta, db, "procedures", {}, &d))
+            return false;
+        add(a, CompletionIndex::Table, "tabla de " + db);
+        add(b, CompletionIndex::View, "vista de " + db);
+        add(c, CompletionIndex::Function, "función de " + db);
+        add(d, CompletionIndex::Procedure, "procedimiento de " + db);
+    } else if (p.size() == 3 && p[0] == "col") {
+        if (!cachedList(meta, p[1], "columns", p[2], &a)) return false;
+        add(a, CompletionIndex::Column, QString("columna de %1.%2").arg(p[1], p[2]));
+    }
+    return true;
+}
+
+// Lee del servidor lo que necesita un tramo, a la caché de meta; corre en el hilo de carga.
+void fetchBucket(MetadataService& meta, const QString& bucket)
+{
+    const QStringList p = bucket.split(kSep);
+    if (bucket == CompletionIndex::databasesBucket()) meta.listDatabases();
+    else if (p.size() == 2 && p[0] == "obj") meta.loadSchema(p[1]);
+    else if (p.size() == 3 && p[0] == "col") meta.listColumns(p[1], p[2]);
+}
+
+} // namespace
+
+SqlCompleter::SqlCompleter(MetadataService* meta, const DbSession* s, QPlainTextEdit* editor)
+    : QObject(editor), meta(meta), s(s), editor(editor)
+{
+    // Se lee una vez: update() corre en cada tecla
+    minChars = qMax(1, QSettings("UNITEC", "Database-Manager").value("completion/minChars", 2).toInt());
+
+    QVector<CompletionIndex::Item> keywords;
+    for (const auto& k : SqlHighlighter::keywords()) {
+        CompletionIndex::Item it;
+        it.text = k;
+        it.kind = CompletionIndex::Keyword;
+        keywords << it;
+    }
+    index.setBucket(CompletionIndex::keywordsBucket(), keywords);
+
+    model = new QStandardItemModel(this);
+    completer = new QCompleter(this);
+    completer->setWidget(editor);
+    completer->setModel(model);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setMaxVisibleItems(12);
+
+    editor->installEventFilter(this);
+    // Después de QCompleter: este filtro ve primero las teclas de la lista
+    completer->popup()->installEventFilter(this);
+
+    connect(editor, &QPlainTextEdit::textChanged, this, [this](){
+        if (!typed) return;
+        typed = false;
+        update(forced && completer->popup()->isVisible());
+    });
+    connect(completer, QOverload<const QModelIndex&>::of(&QCompleter::activated), this,
+            [this](const QModelIndex& i){ insert(i.data(Qt::UserRole).toString()); });
+}
+
+bool SqlCompleter::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() != QEvent::KeyPress) return QObject::eventFilter(watched, event);
+    auto* ke = static_cast<QKeyEvent*>(event);
+    QAbstractItemView* popup = completer->popup();
+
+    if (watched == popup) {
+        switch (ke->key()) {
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+        case Qt::Key_Tab: {
+            const QModelIndex i = popup->currentIndex();
+            popup->hide();
+            if (i.isValid()) insert(i.data(Qt::UserRole).toString());
+            return true;
+        }
+        case Qt::Key_Escape:
+        case Qt::Key_Backtab:
+            popup->hide();
+            return true;
+        default:
+            // QCompleter la reenvía al editor sin pasar por su filtro
+            typed = !ke->text().isEmpty();
+            return false;
+        }
+    }
+
+    if (watched == editor) {
+        if (ke->key() == Qt::Key_Space && (ke->modifiers() & Qt::ControlModifier)) {
+            update(true);
+            return true;
+        }
+        typed = !ke->text().isEmpty() && !(ke->modifiers() & Qt::ControlModifier);
+    }
+    return false;
+}
+
+QVector<SqlCompleter::TableRef> SqlCompleter::tableRefs(const QString& statement) const
+{
+    const QString db = currentDb ? currentDb() : QString();
+    const QVector<Token> toks = tokenize(statement);
+    QVector<TableRef> refs;
+
+    for (int i = 0; i < toks.size(); ++i) {
+        const QString& kw = toks[i].upper;
+        if (kw != "FROM" && kw != "JOIN" && kw != "UPDATE" && kw != "INTO") continue;
+
+        int j = i + 1;
+        while (j < toks.size() && toks[j].word && !isKeywordToken(toks[j])) {
+            const QStringList& p = toks[j].parts;
+            TableRef r;
+            r.db = p.size() > 1 ? p[p.size() - 2] : db;
+            r.table = p.last();
+            ++j;
+            if (j < toks.size() && toks[j].upper == "AS") ++j;
+            if (j < toks.size() && toks[j].word && toks[j].parts.size() == 1 && !isKeywordToken(toks[j])) {
+                r.alias = toks[j].parts[0];
+                ++j;
+            }
+            refs << r;
+            // FROM a x, b y  /  UPDATE a, b
+            if ((kw == "FROM" || kw == "UPDATE") && j < toks.size() && toks[j].punct == ',') { ++j; continue; }
+            break;
+        }
+    }
+    return refs;
+}
+
+SqlCompleter::Context SqlCompleter::contextAtCursor()
+{
+    Context ctx;
+    const QString text = editor->toPlainText();
+    const int pos = editor->textCursor().position();
+
+    // Sentencia actual: entre los ; que rodean al cursor
+    const int start = text.lastIndexOf(';', pos - 1) + 1;
+    int end = text.indexOf(';', pos);
+    if (end < 0) end = text.size();
+
+    // Palabra bajo el cursor, con sus calificadores (db.tabla.col)
+    int w = pos;
+    while (w > start && (isWordChar(text[w - 1]) || text[w - 1] == '.' || text[w - 1] == '`')) --w;
+    const QString raw = text.mid(w, pos - w);
+    QStringList parts = raw.split('.');
+    for (auto& p : parts) p.remove('`');
+    ctx.prefix = parts.takeLast();
+    ctx.wordStart = w + raw.lastIndexOf('.') + 1;
+    ctx.qualified = !parts.isEmpty();
+
+    const QString db = currentDb ? currentDb() : QString();
+    const QVector<Token> before = tokenize(text.mid(start, w - start));
+    const Token last = before.isEmpty() ? Token() : before.last();
+
+    // Cláusula más cercana hacia atrás
+    static const QStringList clauses = {
+        "SELECT", "FROM", "JOIN", "UPDATE", "INTO", "TABLE", "USE", "CALL", "DESCRIBE", "WHERE",
+        "ON", "SET", "BY", "HAVING", "VALUES", "AND", "OR", "NOT", "WHEN", "THEN", "ELSE", "USING",
+    };
+    QString clause;
+    for (int i = before.size() - 1; i >= 0 && clause.isEmpty(); --i)
+        if (clauses.contains(before[i].upper)) clause = before[i].upper;
+
+    static const QStringList tableKeywords = { "FROM", "JOIN", "UPDATE", "INTO", "TABLE", "DESCRIBE" };
+    const bool tableContext = tableKeywords.contains(last.upper)
+                              || (last.punct == ',' && (clause == "FROM" || clause == "UPDATE"));
+    using K = CompletionIndex;
+
+    if (last.upper == "USE") {
+        ctx.buckets << K::databasesBucket();
+        ctx.kinds << K::Database;
+        return ctx;
+    }
+    if (last.upper == "CALL") {
+        const QString d = parts.isEmpty() ? db : parts.last();
+        if (!d.isEmpty()) ctx.buckets << K::objectsBucket(d);
+        ctx.kinds << K::Procedure;
+        return ctx;
+    }
+    if (tableContext) {
+        if (!parts.isEmpty()) {
+            ctx.buckets << K::objectsBucket(parts.last());
+        } else {
+            if (!db.isEmpty()) ctx.buckets << K::objectsBucket(db);
+            ctx.buckets << K::databasesBucket();
+        }
+        ctx.kinds << K::Table << K::View << K::Database;
+        return ctx;
+    }
+
+    // Columnas: las tablas del FROM de toda la sentencia, también lo que va tras el cursor
+    const QVector<TableRef> refs = tableRefs(text.mid(start, end - start));
+    if (parts.size() >= 2) {
+        ctx.buckets << K::columnsBucket(parts[parts.size() - 2], parts.last());
+        ctx.kinds << K::Column;
+        return ctx;
+    }
+    if (parts.size() == 1) {
+        const QString& q = parts[0];
+        for (const auto& r : refs) {
+            if (r.alias.compare(q, Qt::CaseInsensitive) == 0 || (r.alias.isEmpty() && r.table.compare(q, Qt::CaseInsensitive) == 0)) {
+                ctx.buckets << K::columnsBucket(r.db, r.table);
+                ctx.kinds << K::Column;
+                return ctx;
+            }
+        }
+        // No es un alias: tabla de la base actual, o bien una base (db.objeto)
+        if (!db.isEmpty()) ctx.buckets << K::columnsBucket(db, q);
+        ctx.buckets << K::objectsBucket(q);
+        return ctx;
+    }
+
+    for (const auto& r : refs) ctx.buckets << K::columnsBucket(r.db, r.table);
+    if (!db.isEmpty()) ctx.buckets << K::objectsBucket(db);
+    ctx.buckets << K::keywordsBucket();
+    return ctx;
+}
+
+void SqlCompleter::update(bool force)
+{
+    QAbstractItemView* popup = completer->popup();
+    forced = force;
+
+    const Context ctx = contextAtCursor();
+    if (!force && !ctx.qualified && ctx.prefix.size() < minChars) {
+        popup->hide();
+        return;
+    }
+
+    // Lo que falta se carga después; ahora se muestra lo que hay
+    // Lo que ya está en la caché de MetadataService entra sin ir al servidor
+    for (const auto& b : ctx.buckets) {
+        if (index.hasBucket(b) || pending.contains(b) || loading.contains(b)) continue;
+        QVector<CompletionIndex::Item> items;
+        if (bucketFromCache(*meta, b, &items)) index.setBucket(b, items);
+        else pending << b;
+    }
+    loadPending();
+    waiting = !pending.isEmpty() || !loading.isEmpty();
+
+    const auto items = index.complete(ctx.buckets, ctx.prefix, kMaxItems, ctx.kinds);
+    if (items.isEmpty()) {
+        popup->hide();
+        return;
+    }
+
+    model->clear();
+    for (const auto& it : items) {
+        auto* row = new QStandardItem(it.text);
+        row->setData(it.text, Qt::UserRole);
+        if (!it.detail.isEmpty()) row->setToolTip(it.detail);
+        row->setEditable(false);
+        model->appendRow(row);
+    }
+    wordStart = ctx.wordStart;
+
+    QRect r = editor->cursorRect();
+    r.setWidth(popup->sizeHintForColumn(0) + popup->verticalScrollBar()->sizeHint().width() + 8);
+    completer->complete(r);
+    popup->setCurrentIndex(model->index(0, 0));
+}
+
+void SqlCompleter::loadPending()
+{
+    if (pending.isEmpty() || !loading.isEmpty()) return;
+    loading = pending;
+    pending.clear();
+
+    // Todos los tramos que faltan en una conexión del pool, en un hilo de trabajo de la sesión
+    // (no termina: su conexión se reutiliza en la próxima carga). Lo leído pasa a la caché de
+    // MetadataService, con su TTL y sus invalidaciones.
+    const DbSession* session = s;
+    const QStringList buckets = loading;
+    const quint64 since = meta->generation();
+    const QPointer<SqlCompleter> self(this);
+    session->post([self, session, buckets, since](){
+        std::shared_ptr<MetadataService> read;
+        {
+            DbLease lease = session->acquire();
+            if (lease.isValid()) {
+                read = std::make_shared<MetadataService>(lease.connectionName());
+                read->setCacheTtl(3600);   // solo para que adopt() lo pase a la caché de la GUI
+                for (const auto& b : buckets) fetchBucket(*read, b);
+            }
+        }
+        QMetaObject::invokeMethod(qApp, [self, read, since](){
+            if (self) self->loaded(read, since);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SqlCompleter::loaded(const std::shared_ptr<MetadataService>& read, quint64 since)
+{
+    // Sin conexión, o algo se invalidó mientras tanto: no se guarda nada y se vuelve a pedir
+    // en la próxima tecla, no antes.
+    const QStringList buckets = loading;
+    loading.clear();
+    if (!read || since != meta->generation()) {
+        waiting = false;
+        pending.clear();
+        return;
+    }
+    meta->adopt(*read, since);
+    // Vacío también se guarda: una tabla que no existe no se vuelve a pedir en cada tecla
+    for (const auto& b : buckets) {
+        QVector<CompletionIndex::Item> items;
+        bucketFromCache(*read, b, &items);
+        index.setBucket(b, items);
+    }
+
+    if (!pending.isEmpty()) {
+        loadPending();
+        return;
+    }
+    // Todo cargado: actualizar la lista si se estaba esperando algo
+    if (waiting || completer->popup()->isVisible()) {
+        waiting = false;
+        if (editor->hasFocus()) update(forced);
+    }
+}
+
+void SqlCompleter::insert(const QString& text)
+{
+    if (text.isEmpty()) return;
+    QTextCursor c = editor->textCursor();
+    c.setPosition(qMin(wordStart, c.position()), QTextCursor::KeepAnchor);
+    c.insertText(quoted(text));
+    editor->setTextCursor(c);
+}
+
+void SqlCompleter::invalidate(const QString& db, const QString& kind, const QString& name)
+{
+    using K = CompletionIndex;
+    const QString obj = K::objectsBucket(QString());   // prefijo "obj<sep>"
+    const QString col = K::columnsBucket(QString(), QString()).chopped(1);
+
+    if (kind.isEmpty()) {
+        index.removeBucket(K::databasesBucket());
+        index.removeBuckets(obj);
+        index.removeBuckets(col);
+        return;
+    }
+    if (kind == "database") {
+        index.removeBucket(K::databasesBucket());
+        index.removeBucket(K::objectsBucket(name));
+        index.removeBuckets(col + name + kSep);
+        return;
+    }
+    if (kind == "table" || kind == "view" || kind == "function" || kind == "procedure") {
+        if (db.isEmpty()) index.removeBuckets(obj);
+        else index.removeBucket(K::objectsBucket(db));
+        if (kind == "table" || kind == "view") {
+            if (db.isEmpty()) index.removeBuckets(col);
+            else index.removeBucket(K::columnsBucket(db, name));
+        }
+    }
+}
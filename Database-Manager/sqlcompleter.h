@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include "CompletionIndex.h"
+
+class QPlainTextEdit;
+class QCompleter;
+class QStandardItemModel;
+class DbSession;
+class MetadataService;
+
+// Autocompletado de la consola según el contexto del cursor:
+//   FROM/JOIN/UPDATE/INTO/TABLE ->  tablas y vistas (db. -> las de esa base)
+//   USE -> bases;  CALL -> procedimientos
+//   resto -> columnas de las tablas del FROM de la sentencia (alias. -> las de esa tabla),
+//            funciones, tablas y palabras clave
+// Las sugerencias salen de CompletionIndex con lo que ya está cargado; lo que falta se toma
+// de la caché de MetadataService y, si tampoco está ahí, se pide en un hilo de trabajo de la
+// sesión después de mostrar la lista (y pasa a esa caché). La lista se actualiza al llegar.
+// Las columnas de una tabla solo se piden cuando la tabla aparece en el FROM. Ctrl+Espacio
+// abre la lista sin prefijo.
+class SqlCompleter : public QObject {
+    Q_OBJECT
+public:
+    SqlCompleter(MetadataService* meta, const DbSession* s, QPlainTextEdit* editor);
+
+    // Base para nombres sin calificar (la seleccionada en el árbol o el último USE).
+    void setDatabaseProvider(std::function<QString()> provider) { currentDb = std::move(provider); }
+
+    // Misma firma que MetadataService::setInvalidationHook.
+    void invalidate(const QString& db, const QString& kind, const QString& name);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    struct TableRef { QString db; QString table; QString alias; };
+    struct Context {
+        QStringList buckets;
+        QVector<CompletionIndex::Kind> kinds;
+        QString prefix;
+        int wordStart = 0;   // posición en el documento donde empieza el prefijo
+        bool qualified = false;
+    };
+
+    Context contextAtCursor();
+    QVector<TableRef> tableRefs(const QString& statement) const;
+    void update(bool force);
+    void loadPending();
+    void loaded(const std::shared_ptr<MetadataService>& read, quint64 since);
+    void insert(const QString& text);
+
+    MetadataService* meta;
+    const DbSession* s;
+    QPlainTextEdit* editor;
+    QCompleter* completer;
+    QStandardItemModel* model;
+    CompletionIndex index;
+    std::function<QString()> currentDb;
+    int minChars = 2;
+
+    QStringList pending;     // tramos por cargar
+    QStringList loading;     // tramos que está leyendo el hilo
+    bool typed = false;      // la última tecla escribió texto
+    bool forced = false;     // abierto con Ctrl+Espacio
+    bool waiting = false;    // la lista espera tramos pendientes
+    int wordStart = 0;
+};
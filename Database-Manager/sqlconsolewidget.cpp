@@ -1,61 +1,42 @@
 #include "SqlConsoleWidget.h"
+#include "SqlHighlighter.h"
+#include "SqlText.h"
 #include <QPlainTextEdit>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
-#include <QSyntaxHighlighter>
-#include <QTextCharFormat>
-#include <QRegularExpression>
-#include <QTextDocument>
 #include <QTextCursor>
-
-class SqlSyntaxHighlighter : public QSyntaxHighlighter {
-public:
-    explicit SqlSyntaxHighlighter(QTextDocument* parent)
-        : QSyntaxHighlighter(parent)
-    {
-        QTextCharFormat kw;
-        kw.setForeground(QColor("#569CD6"));
-        kw.setFontWeight(QFont::Bold);
-
-        const QStringList keywords = {
-            "select","from","where","insert","into","values","update","set","delete",
-            "create","table","view","drop","alter","database","show","describe","use",
-            "join","left","right","inner","outer","on","group","by","order","having",
-            "limit","as","distinct", "column","databases", "full"
-        };
-
-        for (const auto& k : keywords) {
-            rules.append({QRegularExpression("\\b" + k + "\\b", QRegularExpression::CaseInsensitiveOption), kw});
-        }
-    }
-
-protected:
-    void highlightBlock(const QString& text) override
-    {
-        for (const auto& r : rules) {
-            auto it = r.re.globalMatch(text);
-            while (it.hasNext()) {
-                auto m = it.next();
-                setFormat(m.capturedStart(), m.capturedLength(), r.fmt);
-            }
-        }
-    }
-
-private:
-    struct Rule { QRegularExpression re; QTextCharFormat fmt; };
-    QVector<Rule> rules;
-};
-
+#include <QTimer>
+#include <QShortcut>
+#include <QCheckBox>
+#include <QSettings>
 
 SqlConsoleWidget::SqlConsoleWidget(QWidget* p):QWidget(p){
     edit = new QPlainTextEdit;
     edit->setPlaceholderText("Escribe SQL aquí...");
 
-    new SqlSyntaxHighlighter(edit->document());
+    new SqlHighlighter(edit->document());
 
     btn = new QPushButton("Ejecutar");
+    btnCancel = new QPushButton("Cancelar");
+    btnCancel->setEnabled(false);
+    btnCancel->setToolTip("Cancelar consulta (Esc)");
+    btnExplain = new QPushButton("Explain");
+    btnExplain->setToolTip("Plan estimado de la sentencia bajo el cursor (no la ejecuta)");
+    btnAnalyze = new QPushButton("Analyze");
+    btnAnalyze->setToolTip("Ejecuta la sentencia bajo el cursor y muestra el plan con filas y tiempos reales");
+
+    chkContinue = new QCheckBox("Continuar tras errores");
+    chkContinue->setToolTip("En scripts de varias sentencias, ejecutar las siguientes aunque una falle");
+    {
+        QSettings st("UNITEC", "Database-Manager");
+        chkContinue->setChecked(st.value("script/continueOnError", false).toBool());
+    }
+    connect(chkContinue, &QCheckBox::toggled, this, [](bool on){
+        QSettings st("UNITEC", "Database-Manager");
+        st.setValue("script/continueOnError", on);
+    });
     status = new QLabel;
     status->setWordWrap(true);
     status->setTextInteractionFlags(Qt::TextSelectableByMouse);
@@ -64,6 +45,11 @@ SqlConsoleWidget::SqlConsoleWidget(QWidget* p):QWidget(p){
     auto* topLay = new QHBoxLayout(topBar);
     topLay->setContentsMargins(0,0,0,0);
     topLay->addWidget(btn);
+    topLay->addWidget(btnCancel);
+    topLay->addWidget(btnExplain);
+    topLay->addWidget(btnAnalyze);
+    topLay->addWidget(chkContinue);
+    topLay->addStretch(1);
 
     auto* l = new QVBoxLayout(this);
     l->addWidget(topBar);
@@ -78,15 +64,81 @@ SqlConsoleWidget::SqlConsoleWidget(QWidget* p):QWidget(p){
         }
         emit executeRequested(s);
     });
+
+    connect(btnCancel, &QPushButton::clicked, this, &SqlConsoleWidget::cancelRequested);
+
+    auto requestPlan = [this](bool analyze){
+        const QString s = statementAtCursor();
+        if (s.isEmpty()) {
+            setStatusError("SQL vacío.");
+            return;
+        }
+        emit explainRequested(s, analyze);
+    };
+    connect(btnExplain, &QPushButton::clicked, this, [requestPlan](){ requestPlan(false); });
+    connect(btnAnalyze, &QPushButton::clicked, this, [requestPlan](){ requestPlan(true); });
+
+    auto* esc = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    esc->setContext(Qt::WindowShortcut);
+    connect(esc, &QShortcut::activated, this, [this](){
+        if (btnCancel->isEnabled()) emit cancelRequested();
+    });
+
+    ticker = new QTimer(this);
+    ticker->setInterval(100);
+    connect(ticker, &QTimer::timeout, this, [this](){
+        elapsed = clock.elapsed();
+        status->setText(QString("Ejecutando... %1 s").arg(elapsed / 1000.0, 0, 'f', 1));
+    });
+}
+
+bool SqlConsoleWidget::continueOnError() const
+{
+    return chkContinue->isChecked();
 }
 
 QString SqlConsoleWidget::sql() const { return edit->toPlainText(); }
 
+QString SqlConsoleWidget::statementAtCursor() const
+{
+    const QTextCursor c = edit->textCursor();
+    QString s;
+    if (c.hasSelection()) {
+        s = c.selectedText().replace(QChar::ParagraphSeparator, '\n');
+    } else {
+        // La última sentencia que empieza en o antes de la línea del cursor
+        const auto statements = SqlText::splitStatements(edit->toPlainText());
+        const int line = c.blockNumber() + 1;
+        for (const auto& st : statements) {
+            if (st.line > line && !s.isEmpty()) break;
+            s = st.sql;
+        }
+    }
+    return SqlText::stripTrailingSemicolon(s.trimmed()).trimmed();
+}
+
 void SqlConsoleWidget::setSql(const QString& s){
     edit->setPlainText(s);
     edit->moveCursor(QTextCursor::End);
 }
 
+void SqlConsoleWidget::setRunning(bool running)
+{
+    btn->setEnabled(!running);
+    btnCancel->setEnabled(running);
+
+    if (running) {
+        clock.start();
+        elapsed = 0;
+        status->setText("Ejecutando...");
+        status->setStyleSheet("color: #D4D4D4;");
+        ticker->start();
+    } else {
+        ticker->stop();
+        elapsed = clock.elapsed();
+    }
+}
+
 void SqlConsoleWidget::setStatusOk(const QString& message){
     status->setText(message);
     status->setStyleSheet("color: #9CDCFE;");
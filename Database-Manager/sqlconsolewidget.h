@@ -1,9 +1,12 @@
 #pragma once
 #include <QWidget>
+#include <QElapsedTimer>
 
 class QPlainTextEdit;
 class QPushButton;
+class QCheckBox;
 class QLabel;
+class QTimer;
 
 class SqlConsoleWidget : public QWidget {
     Q_OBJECT
@@ -12,15 +15,35 @@ public:
 
     QString sql() const;
     void setSql(const QString& sql);
+    QPlainTextEdit* editor() const { return edit; }
 
     void setStatusOk(const QString& message);
     void setStatusError(const QString& message);
 
+    // Mientras corre una consulta: habilita Cancelar y muestra el tiempo transcurrido.
+    void setRunning(bool running);
+    qint64 elapsedMs() const { return elapsed; }
+
+    // Scripts de varias sentencias: seguir con la siguiente si una falla.
+    bool continueOnError() const;
+
+    // Texto seleccionado o, si no hay selección, la sentencia bajo el cursor.
+    QString statementAtCursor() const;
+
 signals:
     void executeRequested(const QString& sql);
+    void cancelRequested();
+    void explainRequested(const QString& sql, bool analyze);
 
 private:
     QPlainTextEdit* edit;
     QPushButton* btn;
+    QPushButton* btnCancel;
+    QPushButton* btnExplain;
+    QPushButton* btnAnalyze;
+    QCheckBox* chkContinue;
     QLabel* status;
+    QTimer* ticker;
+    QElapsedTimer clock;
+    qint64 elapsed = 0;
 };
@@ -0,0 +1,160 @@
+#include "SqlHighlighter.h"
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
+namespace {
+
+// Ordenada y en mayúsculas: se busca por bisección.
+constexpr std::string_view kKeywords[] = {
+    "ADD", "ALL", "ALTER", "AND", "AS", "ASC", "AUTO_INCREMENT", "BEGIN", "BETWEEN", "BY",
+    "CALL", "CASE", "CHANGE", "CHARSET", "COLLATE", "COLUMN", "COLUMNS", "CONSTRAINT", "CREATE",
+    "CROSS", "DATABASE", "DATABASES", "DECLARE", "DEFAULT", "DELETE", "DELIMITER", "DESC",
+    "DESCRIBE", "DISTINCT", "DO", "DROP", "EACH", "ELSE", "ELSEIF", "END", "ENGINE", "EXISTS",
+    "EXPLAIN", "FOR", "FOREIGN", "FROM", "FULL", "FUNCTION", "GRANT", "GROUP", "HAVING", "IF",
+    "IGNORE", "IN", "INDEX", "INNER", "INSERT", "INTERVAL", "INTO", "IS", "JOIN", "KEY", "KEYS",
+    "LEFT", "LIKE", "LIMIT", "MODIFY", "NOT", "NULL", "OFFSET", "ON", "OR", "ORDER", "OUTER",
+    "PRIMARY", "PROCEDURE", "REFERENCES", "RENAME", "REPLACE", "RETURN", "RETURNS", "REVOKE",
+    "RIGHT", "ROW", "SCHEMA", "SELECT", "SET", "SHOW", "STATUS", "TABLE", "TABLES", "THEN", "TO",
+    "TRIGGER", "TRUNCATE", "UNION", "UNIQUE", "UPDATE", "USE", "USING", "VALUES", "VIEW", "WHEN",
+    "WHERE", "WHILE", "WITH",
+};
+
+constexpr bool sortedKeywords()
+{
+    for (size_t i = 1; i < std::size(kKeywords); ++i)
+        if (!(kKeywords[i - 1] < kKeywords[i])) return false;
+    return true;
+}
+static_assert(sortedKeywords(), "kKeywords debe estar ordenada");
+
+constexpr size_t longestKeyword()
+{
+    size_t n = 0;
+    for (auto k : kKeywords) n = k.size() > n ? k.size() : n;
+    return n;
+}
+constexpr size_t kMaxKeyword = longestKeyword();
+
+// Estado al final de un bloque: dentro de qué construcción multilínea quedó el lexer.
+enum State { Normal = 0, InComment, InSingle, InDouble, InBacktick };
+
+bool isWordStart(QChar c) { return c.isLetter() || c == '_' || c == '$'; }
+bool isWordChar(QChar c)  { return c.isLetterOrNumber() || c == '_' || c == '$'; }
+
+} // namespace
+
+SqlHighlighter::SqlHighlighter(QTextDocument* parent)
+    : QSyntaxHighlighter(parent)
+{
+    keyword.setForeground(QColor("#569CD6"));
+    keyword.setFontWeight(QFont::Bold);
+    string.setForeground(QColor("#CE9178"));
+    number.setForeground(QColor("#B5CEA8"));
+    comment.setForeground(QColor("#6A9955"));
+    identifier.setForeground(QColor("#9CDCFE"));
+}
+
+bool SqlHighlighter::isKeyword(QStringView word)
+{
+    if (word.isEmpty() || size_t(word.size()) > kMaxKeyword) return false;
+
+    char buf[kMaxKeyword];
+    for (int i = 0; i < word.size(); ++i) {
+        const ushort u = word[i].unicode();
+        if (u > 0x7F) return false;
+        buf[i] = (u >= 'a' && u <= 'z') ? char(u - 32) : char(u);
+    }
+    const std::string_view w(buf, size_t(word.size()));
+    return std::binary_search(std::begin(kKeywords), std::end(kKeywords), w);
+}
+
+QStringList SqlHighlighter::keywords()
+{
+    QStringList out;
+    out.reserve(int(std::size(kKeywords)));
+    for (auto k : kKeywords) out << QString::fromLatin1(k.data(), int(k.size()));
+    return out;
+}
+
+void SqlHighlighter::highlightBlock(const QString& text)
+{
+    const int n = text.size();
+    int i = 0;
+    int state = previousBlockState() < 0 ? Normal : previousBlockState();
+
+    // Cierra una cadena/identificador que empezó en un bloque anterior (o en este, desde i).
+    auto closeQuote = [&](QChar q, int from) -> bool {
+        int j = i;
+        while (j < n) {
+            if (text[j] == '\\' && q != '`') { j += 2; continue; }
+            if (text[j] == q) {
+                if (j + 1 < n && text[j + 1] == q) { j += 2; continue; }
+                setFormat(from, j + 1 - from, q == '`' ? identifier : string);
+                i = j + 1;
+                return true;
+            }
+            ++j;
+        }
+        setFormat(from, n - from, q == '`' ? identifier : string);
+        i = n;
+        return false;
+    };
+
+    while (i < n) {
+        if (state == InComment) {
+            const int end = text.indexOf(QLatin1String("*/"), i);
+            const int stop = end < 0 ? n : end + 2;
+            setFormat(i, stop - i, comment);
+            i = stop;
+            if (end < 0) break;
+            state = Normal;
+            continue;
+        }
+        if (state == InSingle || state == InDouble || state == InBacktick) {
+            const QChar q = state == InSingle ? '\'' : state == InDouble ? '"' : '`';
+            if (!closeQuote(q, i)) break;
+            state = Normal;
+            continue;
+        }
+
+        const QChar c = text[i];
+        if (c.isSpace()) { ++i; continue; }
+
+        if ((c == '-' && i + 1 < n && text[i + 1] == '-') || c == '#') {
+            setFormat(i, n - i, comment);
+            i = n;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && text[i + 1] == '*') {
+            state = InComment;
+            setFormat(i, 2, comment);
+            i += 2;
+            continue;
+        }
+        if (c == '\'' || c == '"' || c == '`') {
+            const int from = i++;
+            if (!closeQuote(c, from)) {
+                state = c == '\'' ? InSingle : c == '"' ? InDouble : InBacktick;
+                break;
+            }
+            continue;
+        }
+        if (c.isDigit() || (c == '.' && i + 1 < n && text[i + 1].isDigit())) {
+            const int from = i;
+            while (i < n && (text[i].isLetterOrNumber() || text[i] == '.')) ++i;
+            setFormat(from, i - from, number);
+            continue;
+        }
+        if (isWordStart(c)) {
+            const int from = i;
+            while (i < n && isWordChar(text[i])) ++i;
+            if (isKeyword(QStringView(text).mid(from, i - from)))
+                setFormat(from, i - from, keyword);
+            continue;
+        }
+        ++i;
+    }
+
+    setCurrentBlockState(state);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <QSyntaxHighlighter>
+#include <QTextCharFormat>
+
+// Resaltado SQL en una sola pasada por bloque. Los comentarios /* */, las cadenas y los
+// identificadores `...` pueden ocupar varias líneas: el estado del lexer al final de cada
+// bloque se guarda con setCurrentBlockState y Qt solo repinta los bloques siguientes
+// cuando ese estado cambia.
+class SqlHighlighter : public QSyntaxHighlighter {
+public:
+    explicit SqlHighlighter(QTextDocument* parent);
+
+    static bool isKeyword(QStringView word);
+    static QStringList keywords();
+
+protected:
+    void highlightBlock(const QString& text) override;
+
+private:
+    QTextCharFormat keyword;
+    QTextCharFormat string;
+    QTextCharFormat number;
+    QTextCharFormat comment;
+    QTextCharFormat identifier;
+};
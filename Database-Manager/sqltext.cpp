@@ -0,0 +1,428 @@
+#include "SqlText.h"
+#include <QRegularExpression>
+
+QString SqlText::firstTokenUpper(QString s)
+{
+    s = s.trimmed();
+    if (s.isEmpty()) return {};
+
+    while (s.startsWith("--")) {
+        int nl = s.indexOf('\n');
+        if (nl < 0) return {};
+        s = s.mid(nl + 1).trimmed();
+    }
+
+    while (s.startsWith("/*")) {
+        int end = s.indexOf("*/");
+        if (end < 0) return {};
+        s = s.mid(end + 2).trimmed();
+    }
+
+    int i = 0;
+    while (i < s.size() && !s[i].isSpace() && s[i] != ';') i++;
+    return s.left(i).toUpper();
+}
+
+bool SqlText::isDbLevelDdl(const QString& sql)
+{
+    const QString t = firstTokenUpper(sql);
+    if (t == "CREATE" || t == "DROP" || t == "ALTER" || t == "RENAME") {
+        const QString u = sql.trimmed().toUpper();
+        return u.contains(" DATABASE ") || u.contains(" SCHEMA ");
+    }
+    return false;
+}
+
+bool SqlText::isTableLevelDdlOrDmlThatAffectsMetadata(const QString& sql)
+{
+    const QString t = firstTokenUpper(sql);
+    if (t == "CREATE" || t == "DROP" || t == "ALTER" || t == "RENAME" || t == "TRUNCATE")
+        return true;
+
+    return false;
+}
+
+QString SqlText::stripTrailingSemicolon(QString s)
+{
+    s = s.trimmed();
+    if (s.endsWith(';')) s.chop(1);
+    return s.trimmed();
+}
+
+QString SqlText::wrapWithDelimiter(const QString& ddl, const QString& delim)
+{
+    const QString body = stripTrailingSemicolon(ddl);
+    if (body.isEmpty()) return {};
+
+    QString out;
+    out += QString("DELIMITER %1\n").arg(delim);
+    out += body;
+    out += QString("%1\n").arg(delim);
+    out += "DELIMITER ;\n";
+    return out;
+}
+
+QString SqlText::fingerprint(const QString& sql)
+{
+    QString out;
+    out.reserve(sql.size());
+    const int n = sql.size();
+    bool space = false;
+    auto put = [&](QChar c){
+        if (space && !out.isEmpty()) out += ' ';
+        space = false;
+        out += c;
+    };
+
+    for (int i = 0; i < n; ) {
+        const QChar c = sql[i];
+        if (c.isSpace()) { space = true; ++i; continue; }
+
+        // Comentarios
+        if (c == '#' || (c == '-' && i + 1 < n && sql[i + 1] == '-'
+                         && (i + 2 == n || sql[i + 2].isSpace()))) {
+            while (i < n && sql[i] != '\n') ++i;
+            space = true;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && sql[i + 1] == '*') {
+            const int end = sql.indexOf("*/", i + 2);
+            i = end < 0 ? n : end + 2;
+            space = true;
+            continue;
+        }
+
+        // Cadenas: el contenido no cuenta
+        if (c == '\'' || c == '"') {
+            ++i;
+            while (i < n) {
+                if (sql[i] == '\\') { i += 2; continue; }
+                if (sql[i] == c) {
+                    if (i + 1 < n && sql[i + 1] == c) { i += 2; continue; }
+                    break;
+                }
+                ++i;
+            }
+            ++i;
+            put('?');
+            continue;
+        }
+
+        // Identificador entre comillas invertidas: se conserva
+        if (c == '`') {
+            const int end = sql.indexOf('`', i + 1);
+            const int stop = end < 0 ? n : end + 1;
+            put('`');
+            out += sql.mid(i + 1, stop - i - 1).toLower();
+            i = stop;
+            continue;
+        }
+
+        // Números sueltos (no parte de un identificador como t1)
+        const bool wordBefore = !out.isEmpty() && !space
+                                && (out.back().isLetterOrNumber() || out.back() == '_');
+        if (c.isDigit() && !wordBefore) {
+            while (i < n && (sql[i].isLetterOrNumber() || sql[i] == '.')) ++i;
+            put('?');
+            continue;
+        }
+
+        put(c.toLower());
+        ++i;
+    }
+
+    while (out.endsWith(';') || out.endsWith(' ')) out.chop(1);
+
+    static const QRegularExpression list(R"(\(\s*\?(\s*,\s*\?)+\s*\))");
+    out.replace(list, "(?+)");
+    return out;
+}
+
+static bool matchAt(const QString& s, int i, const QString& w)
+{
+    if (i + w.size() > s.size()) return false;
+    for (int k = 0; k < w.size(); ++k)
+        if (s[i + k].toUpper() != w[k].toUpper()) return false;
+    return true;
+}
+
+QVector<SqlStatement> SqlText::splitStatements(const QString& script)
+{
+    QVector<SqlStatement> out;
+    QString delim = ";";
+    const int n = script.size();
+    int i = 0;
+    int line = 1;
+    int start = 0;
+    int startLine = 1;
+    bool hasCode = false;   // el tramo actual tiene algo más que espacios y comentarios
+
+    auto beginCode = [&](){
+        if (hasCode) return;
+        hasCode = true;
+        start = i;
+        startLine = line;
+    };
+    auto flush = [&](int end){
+        if (hasCode) {
+            const QString sql = script.mid(start, end - start).trimmed();
+            if (!sql.isEmpty()) out << SqlStatement{sql, startLine};
+        }
+        hasCode = false;
+    };
+    auto skipTo = [&](int end){
+        for (; i < end; ++i)
+            if (script[i] == '\n') ++line;
+    };
+
+    while (i < n) {
+        const QChar c = script[i];
+        if (c == '\n') { ++line; ++i; continue; }
+        if (c.isSpace()) { ++i; continue; }
+
+        // DELIMITER sólo cuenta al comienzo de una sentencia y ocupa el resto de la línea
+        if (!hasCode && matchAt(script, i, "DELIMITER") && i + 9 < n && script[i + 9].isSpace()
+            && script[i + 9] != '\n') {
+            int eol = script.indexOf('\n', i);
+            if (eol < 0) eol = n;
+            const QString arg = script.mid(i + 9, eol - i - 9).trimmed();
+            const int sp = arg.indexOf(QRegularExpression("\\s"));
+            const QString d = sp < 0 ? arg : arg.left(sp);
+            if (!d.isEmpty()) delim = d;
+            i = eol;
+            continue;
+        }
+
+        // Comentarios: "-- " (con espacio, como MySQL), "#" y "/* */"; "/*!" y "/*+" son código
+        if ((c == '-' && i + 1 < n && script[i + 1] == '-' && (i + 2 >= n || script[i + 2].isSpace()))
+            || c == '#') {
+            int eol = script.indexOf('\n', i);
+            i = eol < 0 ? n : eol;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && script[i + 1] == '*') {
+            const bool code = i + 2 < n && (script[i + 2] == '!' || script[i + 2] == '+');
+            if (code) beginCode();
+            const int end = script.indexOf("*/", i + 2);
+            skipTo(end < 0 ? n : end + 2);
+            continue;
+        }
+
+        if (c == '\'' || c == '"' || c == '`') {
+            beginCode();
+            int j = i + 1;
+            while (j < n) {
+                if (script[j] == '\\' && c != '`') { j += 2; continue; }
+                if (script[j] == c) {
+                    if (j + 1 < n && script[j + 1] == c) { j += 2; continue; }   // comilla doblada
+                    break;
+                }
+                ++j;
+            }
+            skipTo(qMin(j + 1, n));
+            continue;
+        }
+
+        if (matchAt(script, i, delim)) {
+            flush(i);
+            i += delim.size();
+            continue;
+        }
+
+        beginCode();
+        ++i;
+    }
+    flush(n);
+    return out;
+}
+
+// Tokens de una sentencia: palabras, identificadores `...`, cadenas y signos sueltos.
+// Los comentarios se descartan. Los identificadores entre backticks conservan su texto tal cual.
+struct Tok {
+    QString text;
+    bool quoted = false;
+};
+
+static QVector<Tok> tokenize(const QString& s)
+{
+    QVector<Tok> out;
+    const int n = s.size();
+    int i = 0;
+    while (i < n) {
+        const QChar c = s[i];
+        if (c.isSpace()) { ++i; continue; }
+
+        if (c == '-' && i + 1 < n && s[i + 1] == '-') {
+            while (i < n && s[i] != '\n') ++i;
+            continue;
+        }
+        if (c == '#') {
+            while (i < n && s[i] != '\n') ++i;
+            continue;
+        }
+        if (c == '/' && i + 1 < n && s[i + 1] == '*') {
+            const int end = s.indexOf("*/", i + 2);
+            i = (end < 0) ? n : end + 2;
+            continue;
+        }
+
+        if (c == '`' || c == '\'' || c == '"') {
+            QString text;
+            ++i;
+            while (i < n) {
+                if (s[i] == c) {
+                    if (i + 1 < n && s[i + 1] == c) { text += c; i += 2; continue; }
+                    ++i;
+                    break;
+                }
+                if (s[i] == '\\' && c != '`' && i + 1 < n) { text += s[i + 1]; i += 2; continue; }
+                text += s[i++];
+            }
+            out.push_back({text, true});
+            continue;
+        }
+
+        if (c.isLetterOrNumber() || c == '_' || c == '$' || c == '@') {
+            const int start = i;
+            while (i < n && (s[i].isLetterOrNumber() || s[i] == '_' || s[i] == '$' || s[i] == '@')) ++i;
+            out.push_back({s.mid(start, i - start), false});
+            continue;
+        }
+
+        out.push_back({QString(c), false});
+        ++i;
+    }
+    return out;
+}
+
+static bool isWord(const QVector<Tok>& t, int i, const char* w)
+{
+    return i < t.size() && !t[i].quoted && t[i].text.compare(QLatin1String(w), Qt::CaseInsensitive) == 0;
+}
+
+// Lee un nombre [db.]obj a partir de t[i]; avanza i.
+static bool readName(const QVector<Tok>& t, int& i, QString* db, QString* name)
+{
+    if (i >= t.size()) return false;
+    QString first = t[i].text;
+    ++i;
+    if (i + 1 < t.size() && t[i].text == "." && !t[i].quoted) {
+        *db = first;
+        *name = t[i + 1].text;
+        i += 2;
+    } else {
+        db->clear();
+        *name = first;
+    }
+    return !name->isEmpty();
+}
+
+static void skipIfExists(const QVector<Tok>& t, int& i)
+{
+    if (isWord(t, i, "IF")) {
+        ++i;
+        if (isWord(t, i, "NOT")) ++i;
+        if (isWord(t, i, "EXISTS")) ++i;
+    }
+}
+
+static QString kindFor(const QVector<Tok>& t, int i)
+{
+    if (isWord(t, i, "TABLE")) return "table";
+    if (isWord(t, i, "VIEW")) return "view";
+    if (isWord(t, i, "FUNCTION")) return "function";
+    if (isWord(t, i, "PROCEDURE")) return "procedure";
+    if (isWord(t, i, "TRIGGER")) return "trigger";
+    if (isWord(t, i, "INDEX") || isWord(t, i, "KEY")) return "index";
+    if (isWord(t, i, "DATABASE") || isWord(t, i, "SCHEMA")) return "database";
+    return {};
+}
+
+QVector<DdlTarget> SqlText::ddlTargets(const QString& sql)
+{
+    QVector<DdlTarget> out;
+    const QVector<Tok> t = tokenize(sql);
+    if (t.isEmpty()) return out;
+
+    int i = 0;
+    const QString verb = t[0].text.toUpper();
+    ++i;
+
+    if (verb == "RENAME") {
+        // RENAME TABLE a TO b [, c TO d]: cambian ambos nombres.
+        if (!isWord(t, i, "TABLE") && !isWord(t, i, "TABLES")) return out;
+        ++i;
+        while (i < t.size()) {
+            DdlTarget from{"table", {}, {}, {}};
+            DdlTarget to{"table", {}, {}, {}};
+            if (!readName(t, i, &from.db, &from.name)) break;
+            if (isWord(t, i, "NOWAIT")) ++i;
+            else if (isWord(t, i, "WAIT")) i += 2;
+            if (!isWord(t, i, "TO")) break;
+            ++i;
+            if (!readName(t, i, &to.db, &to.name)) break;
+            out << from << to;
+            if (i < t.size() && t[i].text == ",") { ++i; continue; }
+            break;
+        }
+        return out;
+    }
+
+    if (verb == "TRUNCATE") {
+        if (isWord(t, i, "TABLE")) ++i;
+        DdlTarget d{"table", {}, {}, {}};
+        if (readName(t, i, &d.db, &d.name)) out << d;
+        return out;
+    }
+
+    if (verb != "CREATE" && verb != "DROP" && verb != "ALTER") return out;
+
+    // Modificadores entre el verbo y el tipo de objeto.
+    QString kind;
+    while (i < t.size()) {
+        kind = kindFor(t, i);
+        if (!kind.isEmpty()) break;
+        // OR REPLACE, DEFINER = user@host, SQL SECURITY, UNIQUE, TEMPORARY...
+        ++i;
+        if (i > 24) return out;   // no parece DDL de objeto
+    }
+    if (kind.isEmpty()) return out;
+    ++i;
+    skipIfExists(t, i);
+
+    if (kind == "index") {
+        // CREATE/DROP INDEX i ON [db.]t
+        DdlTarget d{"index", {}, {}, {}};
+        QString ignored;
+        if (!readName(t, i, &ignored, &d.name)) return out;
+        while (i < t.size() && !isWord(t, i, "ON")) ++i;
+        if (!isWord(t, i, "ON")) return out;
+        ++i;
+        if (!readName(t, i, &d.db, &d.table)) return out;
+        out << d;
+        return out;
+    }
+
+    // DROP TABLE a, b, c admite listas.
+    while (i < t.size()) {
+        DdlTarget d{kind, {}, {}, {}};
+        if (!readName(t, i, &d.db, &d.name)) break;
+        if (kind == "database") { d.db = d.name; }
+        out << d;
+        if (verb == "DROP" && i < t.size() && t[i].text == ",") { ++i; continue; }
+        break;
+    }
+
+    // CREATE TRIGGER tr ... ON [db.]t: el trigger pertenece a la base de la tabla.
+    if (kind == "trigger" && !out.isEmpty() && out.first().db.isEmpty() && verb == "CREATE") {
+        int j = i;
+        while (j < t.size() && !isWord(t, j, "ON")) ++j;
+        if (isWord(t, j, "ON")) {
+            ++j;
+            QString db, table;
+            if (readName(t, j, &db, &table)) out.first().db = db;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Objeto afectado por una sentencia DDL (para invalidar metadatos).
+struct DdlTarget {
+    QString kind;    // "database", "table", "view", "function", "procedure", "trigger", "index"
+    QString db;      // vacío si la sentencia no lo califica
+    QString name;
+    QString table;   // sólo para "index"
+};
+
+// Sentencia de un script, sin el delimitador final.
+struct SqlStatement {
+    QString sql;
+    int line = 1;    // línea (1..n) donde empieza dentro del script
+};
+
+// Utilidades de texto SQL sin conexión al servidor.
+class SqlText {
+public:
+    static QString firstTokenUpper(QString s);
+    static bool isDbLevelDdl(const QString& sql);
+    static bool isTableLevelDdlOrDmlThatAffectsMetadata(const QString& sql);
+
+    static QString stripTrailingSemicolon(QString s);
+    static QString wrapWithDelimiter(const QString& ddl, const QString& delim);
+
+    // Parte un script en sentencias como el cliente mysql: respeta cadenas, identificadores
+    // `...`, comentarios (--, #, /* */) y las líneas DELIMITER (las de wrapWithDelimiter).
+    // Los comentarios previos a una sentencia y los tramos vacíos se descartan.
+    static QVector<SqlStatement> splitStatements(const QString& script);
+
+    // Forma normalizada para agrupar repeticiones de la misma consulta: sin comentarios,
+    // en minúsculas, espacios colapsados, literales (cadenas y números) como ? y
+    // las listas IN (?, ?, ...) como (?+).
+    static QString fingerprint(const QString& sql);
+
+    // Objetos que toca una sentencia CREATE/ALTER/DROP/RENAME/TRUNCATE.
+    static QVector<DdlTarget> ddlTargets(const QString& sql);
+};
@@ -0,0 +1,216 @@
+#include "TableDataBrowser.h"
+#include "DbSession.h"
+#include "QueryWorker.h"
+#include "ResultTableWidget.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QSettings>
+
+TableDataBrowser::TableDataBrowser(const DbSession* s, const QString& db, const QString& table,
+                                   const QStringList& keyColumns, const QStringList& columns,
+                                   const QStringList& largeColumns, const QStringList& fractionalColumns,
+                                   QWidget* parent)
+    : QWidget(parent), db(db), tbl(table), keys(keyColumns), cols(columns), lobs(largeColumns)
+{
+    for (const auto& k : keys)
+        if (fractionalColumns.contains(k)) textKeys << k;
+
+    QSettings st("UNITEC", "Database-Manager");
+    previewChars = qMax(1, st.value("results/lobPreviewChars", 256).toInt());
+
+    session = new QuerySession(s, this);
+    results = new ResultTableWidget(session);
+    results->setCellSource(s, db, table, keys);
+
+    btnFirst = new QPushButton("Primera");
+    btnPrev  = new QPushButton("Anterior");
+    btnNext  = new QPushButton("Siguiente");
+
+    pageSize = new QSpinBox;
+    pageSize->setRange(10, 100000);
+    pageSize->setValue(200);
+    pageSize->setSuffix(" filas");
+
+    seek = new QLineEdit;
+    seek->setPlaceholderText(keys.isEmpty() ? QString() : "Ir a " + keys.first() + " >=");
+
+    pageInfo = new QLabel;
+
+    auto* bar = new QHBoxLayout;
+    bar->setContentsMargins(0,0,0,0);
+    bar->addWidget(btnFirst);
+    bar->addWidget(btnPrev);
+    bar->addWidget(btnNext);
+    bar->addWidget(pageSize);
+    bar->addWidget(seek, 1);
+    bar->addWidget(pageInfo);
+
+    auto* l = new QVBoxLayout(this);
+    l->addLayout(bar);
+    l->addWidget(results, 1);
+
+    connect(btnFirst, &QPushButton::clicked, this, &TableDataBrowser::firstPage);
+    connect(btnPrev, &QPushButton::clicked, this, &TableDataBrowser::previousPage);
+    connect(btnNext, &QPushButton::clicked, this, &TableDataBrowser::nextPage);
+    connect(seek, &QLineEdit::returnPressed, this, [this](){ seekTo(seek->text()); });
+    connect(results, &ResultTableWidget::queryFinished, this, &TableDataBrowser::onFinished);
+
+    if (keys.isEmpty()) {
+        // Sin llave no hay orden estable para buscar: sólo la primera página.
+        btnPrev->setEnabled(false);
+        btnNext->setEnabled(false);
+        seek->setEnabled(false);
+        pageInfo->setText("Sin llave primaria: sólo primera página");
+    }
+
+    firstPage();
+}
+
+void TableDataBrowser::setStats(QueryStats* st)
+{
+    results->setStats(st, "datos");
+}
+
+void TableDataBrowser::setProfileName(const QString& name)
+{
+    results->setProfileName(name);
+}
+
+void TableDataBrowser::firstPage()
+{
+    pageStarts.clear();
+    load({}, false);
+}
+
+void TableDataBrowser::nextPage()
+{
+    if (keys.isEmpty() || results->rowCount() == 0) return;
+    const Key last = lastKey();
+    if (last.isEmpty()) return;
+    pageStarts.push_back(current);
+    load(last, false);
+}
+
+void TableDataBrowser::previousPage()
+{
+    if (pageStarts.isEmpty()) return;
+    const Bound prev = pageStarts.takeLast();
+    load(prev.key, prev.inclusive);
+}
+
+void TableDataBrowser::seekTo(const QString& firstKeyValue)
+{
+    if (keys.isEmpty()) return;
+    pageStarts.clear();
+    if (firstKeyValue.trimmed().isEmpty()) {
+        load({}, false);
+        return;
+    }
+    load(Key{QVariant(firstKeyValue.trimmed())}, true);
+}
+
+void TableDataBrowser::load(const Key& after, bool inclusive)
+{
+    current.key = after;
+    current.inclusive = inclusive;
+
+    // La página entera llega en el primer tramo; una fila más que el LIMIT para que el worker
+    // vea el cursor agotado y lo cierre, en vez de dejarlo abierto y tener que abortarlo
+    // (KILL QUERY) al pedir la página siguiente.
+    results->setChunkSize(pageSize->value() + 1);
+
+    btnFirst->setEnabled(false);
+    btnPrev->setEnabled(false);
+    btnNext->setEnabled(false);
+
+    QString err;
+    if (!results->execute(pageSql(after, inclusive), &err))
+        pageInfo->setText(err);
+}
+
+QString TableDataBrowser::pageSql(const Key& after, bool inclusive) const
+{
+    QString sql = QString("SELECT %1 FROM %2.%3").arg(projection(), DbSession::q(db), DbSession::q(tbl));
+
+    // Calificadas con la tabla: un alias de la proyección (CAST(k AS CHAR) AS k) no debe
+    // sustituir a la columna en el ORDER BY
+    auto column = [this](const QString& k){ return DbSession::q(tbl) + "." + DbSession::q(k); };
+
+    if (!keys.isEmpty() && !after.isEmpty()) {
+        // (a,b) > (x,y) se expande a a > x OR (a = x AND b > y): MariaDB lo resuelve como rango del índice.
+        QStringList ors;
+        for (int i = 0; i < after.size() && i < keys.size(); ++i) {
+            QStringList ands;
+            for (int j = 0; j < i; ++j)
+                ands << QString("%1 = %2").arg(column(keys[j]), DbSession::literal(after[j]));
+            const bool last = (i == after.size() - 1);
+            const QString op = (last && inclusive) ? ">=" : ">";
+            ands << QString("%1 %2 %3").arg(column(keys[i]), op, DbSession::literal(after[i]));
+            ors << "(" + ands.join(" AND ") + ")";
+        }
+        sql += " WHERE " + ors.join(" OR ");
+    }
+
+    if (!keys.isEmpty()) {
+        QStringList order;
+        for (const auto& k : keys) order << column(k);
+        sql += " ORDER BY " + order.join(", ");
+    }
+
+    sql += QString(" LIMIT %1").arg(pageSize->value());
+    return sql;
+}
+
+QString TableDataBrowser::projection() const
+{
+    if ((lobs.isEmpty() && textKeys.isEmpty()) || cols.isEmpty()) return "*";
+
+    // Un documento de 10 MB viaja como sus primeros caracteres y su tamaño
+    QStringList out;
+    for (const auto& c : cols) {
+        const QString qc = DbSession::q(c);
+        if (textKeys.contains(c)) {
+            out << QString("CAST(%1 AS CHAR) AS %1").arg(qc);
+            continue;
+        }
+        if (!lobs.contains(c)) {
+            out << qc;
+            continue;
+        }
+        out << QString("LEFT(%1, %2) AS %1").arg(qc, QString::number(previewChars))
+            << QString("OCTET_LENGTH(%1) AS %2").arg(qc, DbSession::q(c + ResultBuffer::lengthSuffix()));
+    }
+    return out.join(", ");
+}
+
+TableDataBrowser::Key TableDataBrowser::lastKey() const
+{
+    Key k;
+    const int row = results->rowCount() - 1;
+    if (row < 0) return k;
+
+    for (const auto& col : keys) {
+        const int c = results->columnIndex(col);
+        if (c < 0) return {};
+        k << results->value(row, c);
+    }
+    return k;
+}
+
+void TableDataBrowser::onFinished(bool ok, const QString& message)
+{
+    btnFirst->setEnabled(true);
+    if (!ok) {
+        pageInfo->setText(message);
+        return;
+    }
+    if (keys.isEmpty()) return;
+
+    btnPrev->setEnabled(!pageStarts.isEmpty());
+    btnNext->setEnabled(results->rowCount() >= pageSize->value());
+    pageInfo->setText(QString("Página %1 · %2 filas").arg(pageStarts.size() + 1).arg(results->rowCount()));
+}
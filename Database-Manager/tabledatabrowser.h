@@ -0,0 +1,73 @@
+#pragma once
+#include <QWidget>
+#include <QVector>
+#include <QVariant>
+#include <QStringList>
+
+class DbSession;
+class QuerySession;
+class ResultTableWidget;
+class QPushButton;
+class QSpinBox;
+class QLineEdit;
+class QLabel;
+class QueryStats;
+
+// Navegador de datos de una tabla con paginación por llave (keyset/seek):
+// cada página es WHERE (pk) > (última vista) ORDER BY pk LIMIT n, sin OFFSET.
+class TableDataBrowser : public QWidget {
+    Q_OBJECT
+public:
+    // largeColumns (TEXT/BLOB/JSON) se piden como LEFT(col, n) más su OCTET_LENGTH();
+    // el valor completo lo carga el visor de celdas. columns da el orden de la proyección.
+    // Las llaves de fractionalColumns (DATETIME(6)...) se piden como texto para no perder
+    // los microsegundos en la condición de la página siguiente.
+    TableDataBrowser(const DbSession* s, const QString& db, const QString& table,
+                     const QStringList& keyColumns, const QStringList& columns = {},
+                     const QStringList& largeColumns = {}, const QStringList& fractionalColumns = {},
+                     QWidget* parent = nullptr);
+
+    QString database() const { return db; }
+    QString table() const { return tbl; }
+
+    void firstPage();
+    void nextPage();
+    void previousPage();
+    void seekTo(const QString& firstKeyValue);
+
+    // Las páginas se registran con origen "datos".
+    void setStats(QueryStats* st);
+    // Perfil que se anota en las instantáneas de las páginas.
+    void setProfileName(const QString& name);
+
+private:
+    using Key = QVector<QVariant>;
+    struct Bound { Key key; bool inclusive = false; };
+
+    void load(const Key& after, bool inclusive);
+    QString pageSql(const Key& after, bool inclusive) const;
+    QString projection() const;
+    Key lastKey() const;
+    void onFinished(bool ok, const QString& message);
+
+    QString db;
+    QString tbl;
+    QStringList keys;
+    QStringList cols;
+    QStringList lobs;
+    QStringList textKeys;   // llaves con fracción de segundo, como texto
+    int previewChars = 256;
+
+    QuerySession* session;
+    ResultTableWidget* results;
+
+    QVector<Bound> pageStarts;   // límite inferior de cada página visitada
+    Bound current;
+
+    QPushButton* btnFirst;
+    QPushButton* btnPrev;
+    QPushButton* btnNext;
+    QSpinBox* pageSize;
+    QLineEdit* seek;
+    QLabel* pageInfo;
+};
@@ -0,0 +1,46 @@
+// tst_completionindex: búsqueda por prefijo del autocompletado sobre cubos de metadatos.
+
+#include "CompletionIndex.h"
+
+#include <QtTest>
+
+class TestCompletionIndex : public QObject {
+    Q_OBJECT
+
+private slots:
+    void completionIndex();
+};
+
+void TestCompletionIndex::completionIndex()
+{
+    using Item = CompletionIndex::Item;
+    CompletionIndex idx;
+    const QString t1 = CompletionIndex::columnsBucket("d", "t1");
+    const QString t2 = CompletionIndex::columnsBucket("d", "t2");
+    const QString objs = CompletionIndex::objectsBucket("d");
+    idx.setBucket(t1, {Item{{}, "Id", CompletionIndex::Column, {}}, Item{{}, "nombre", CompletionIndex::Column, {}}});
+    idx.setBucket(t2, {Item{{}, "Id", CompletionIndex::Column, {}}, Item{{}, "importe", CompletionIndex::Column, {}}});
+    idx.setBucket(objs, {Item{{}, "items", CompletionIndex::Table, {}}, Item{{}, "ventas", CompletionIndex::Table, {}}});
+
+    // Sin distinguir mayúsculas, columnas primero y la misma columna de dos tablas una vez
+    auto r = idx.complete({t1, t2, objs}, "I", 10);
+    QCOMPARE(r.size(), 3);
+    QCOMPARE(r[0].text, QString("Id"));
+    QCOMPARE(r[1].text, QString("importe"));
+    QCOMPARE(r[2].text, QString("items"));
+    QCOMPARE(r[2].kind, CompletionIndex::Table);
+
+    r = idx.complete({t1, t2, objs}, "i", 10, {CompletionIndex::Table});
+    QCOMPARE(r.size(), 1);
+    QCOMPARE(r[0].text, QString("items"));
+
+    QCOMPARE(idx.complete({t1, t2, objs}, "i", 2).size(), 2);
+
+    idx.removeBuckets(CompletionIndex::columnsBucket("d", QString()));
+    QVERIFY(!idx.hasBucket(t1));
+    QVERIFY(!idx.hasBucket(t2));
+    QVERIFY(idx.hasBucket(objs));
+}
+
+QTEST_GUILESS_MAIN(TestCompletionIndex)
+#include "tst_completionindex.moc"
@@ -0,0 +1,159 @@
+// tst_resultbuffer: instantáneas de resultados (ida y vuelta, y archivos dañados).
+
+#include "ResultBuffer.h"
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <cstring>
+#include <limits>
+
+class TestResultBuffer : public QObject {
+    Q_OBJECT
+
+private slots:
+    void snapshotRoundTrip();
+    void snapshotRejectsDamage();
+    void snapshotClampsTextOffsets();
+    void pinnedByCopies();
+};
+
+static ResultBuffer sampleBuffer()
+{
+    const QVector<ColumnType> types{ColumnType::Int64, ColumnType::Double, ColumnType::Text, ColumnType::Bytes};
+    ResultBuffer buf;
+    buf.reset({"id", "importe", "nota", "datos"});
+    // Dos tramos y un recorte de 4 bytes: la instantánea los une y conserva el tamaño real
+    for (int part = 0; part < 2; ++part) {
+        ChunkBuilder b(types, 4);
+        for (int i = 0; i < 3; ++i) {
+            const int row = part * 3 + i;
+            b.addValue(0, qlonglong(row));
+            b.addValue(1, row == 1 ? QVariant() : QVariant(row * 1.5));
+            b.addValue(2, row == 4 ? QString("largo más de cuatro") : QString("n%1").arg(row));
+            b.addValue(3, QByteArray(1, char(row)));
+            b.endRow();
+        }
+        buf.append(b.take());
+    }
+    return buf;
+}
+
+void TestResultBuffer::snapshotRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("r.dmsnap");
+
+    const ResultBuffer src = sampleBuffer();
+    QString err;
+    QVERIFY2(src.save(path, QJsonObject{{"sql", "SELECT 1"}}, &err), qPrintable(err));
+
+    ResultBuffer out;
+    QJsonObject meta;
+    QVERIFY2(out.load(path, &meta, &err), qPrintable(err));
+    QCOMPARE(meta.value("sql").toString(), QString("SELECT 1"));
+    QCOMPARE(out.rowCount(), src.rowCount());
+    QCOMPARE(out.columnCount(), src.columnCount());
+    QCOMPARE(out.columnName(2), QString("nota"));
+    QVERIFY(out.columnType(1) == ColumnType::Double);
+    for (int r = 0; r < src.rowCount(); ++r)
+        for (int c = 0; c < src.columnCount(); ++c) {
+            QCOMPARE(out.isNull(r, c), src.isNull(r, c));
+            QCOMPARE(out.value(r, c), src.value(r, c));
+            QCOMPARE(out.fullLength(r, c), src.fullLength(r, c));
+        }
+    QVERIFY(out.isNull(1, 1));
+    QCOMPARE(out.value(4, 2).toString(), QString("larg"));
+    QCOMPARE(out.fullLength(4, 2), qint64(QString("largo más de cuatro").toUtf8().size()));
+    QCOMPARE(out.fullLength(3, 2), qint64(-1));
+}
+
+void TestResultBuffer::snapshotRejectsDamage()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("r.dmsnap");
+    QVERIFY(sampleBuffer().save(path, {}));
+
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    const QByteArray good = f.readAll();
+    f.close();
+
+    auto loads = [&](const QByteArray& bytes){
+        QFile w(path);
+        if (!w.open(QIODevice::WriteOnly | QIODevice::Truncate)) return true;
+        w.write(bytes);
+        w.close();
+        ResultBuffer out;
+        QJsonObject meta;
+        return out.load(path, &meta);
+    };
+
+    QVERIFY(loads(good));
+    QVERIFY(!loads(good.left(good.size() / 2)));   // truncada
+    QVERIFY(!loads(good.left(20)));
+    QByteArray magic = good;
+    magic[0] = 'X';
+    QVERIFY(!loads(magic));
+    // metaAt (byte 16) enorme: no debe desbordar la comprobación de límites
+    QByteArray huge = good;
+    const qint64 big = std::numeric_limits<qint64>::max() - 4;
+    std::memcpy(huge.data() + 16, &big, sizeof big);
+    QVERIFY(!loads(huge));
+}
+
+void TestResultBuffer::snapshotClampsTextOffsets()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("r.dmsnap");
+    QVERIFY(sampleBuffer().save(path, {}));
+
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadWrite));
+    QByteArray bytes = f.readAll();
+    // Cabecera: dirAt en el byte 32. Entrada del primer segmento: rows, at, len y luego
+    // 5 pares (at, len) por columna; la columna 2 es texto y su tercer par son los offsets.
+    qint64 dirAt, segAt, offsetsAt;
+    std::memcpy(&dirAt, bytes.constData() + 32, 8);
+    std::memcpy(&segAt, bytes.constData() + dirAt + 8, 8);
+    std::memcpy(&offsetsAt, bytes.constData() + dirAt + 24 + (2 * 5 + 2) * 16, 8);
+    // Fin de la fila 0 mucho más allá del arena: load no recorre offsets, la lectura los acota
+    const quint32 far = 0xFFFFFFF0u;
+    std::memcpy(bytes.data() + segAt + offsetsAt + 4, &far, 4);
+    QVERIFY(f.seek(0));
+    QCOMPARE(f.write(bytes), qint64(bytes.size()));
+    f.close();
+
+    ResultBuffer out;
+    QJsonObject meta;
+    QString err;
+    QVERIFY2(out.load(path, &meta, &err), qPrintable(err));
+    QCOMPARE(out.rowCount(), 6);
+    QVERIFY(out.value(0, 2).toString().size() <= 64);   // hasta el final del arena, no más
+    QCOMPARE(out.value(1, 2).toString(), QString());
+    QCOMPARE(out.value(5, 2).toString(), QString("n5"));
+}
+
+void TestResultBuffer::pinnedByCopies()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    ResultBuffer live = sampleBuffer();
+    const ResultBuffer copy = live;
+    QCOMPARE(live.pinnedBy({&copy}), qint64(0));
+
+    // El primer tramo pasa a disco aquí, pero la copia lo sigue teniendo en RAM
+    QVERIFY(live.spillOldest(1, dir.path()));
+    const qint64 first = copy.chunk(0).memoryUsage();
+    QCOMPARE(live.pinnedBy({&copy}), first);
+    QCOMPARE(live.pinnedBy({&copy, &copy}), first);
+
+    live.reset({"x"});
+    QCOMPARE(live.pinnedBy({&copy}), first + copy.chunk(1).memoryUsage());
+}
+
+QTEST_GUILESS_MAIN(TestResultBuffer)
+#include "tst_resultbuffer.moc"
@@ -0,0 +1,42 @@
+// tst_resultfilter: sintaxis de los filtros de la grilla de resultados.
+
+#include "ResultView.h"
+
+#include <QtTest>
+
+class TestResultFilter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void resultFilterParse();
+};
+
+void TestResultFilter::resultFilterParse()
+{
+    ResultFilter f;
+    QVERIFY(ResultFilter::parse(2, ">= 10", &f));
+    QCOMPARE(f.column, 2);
+    QCOMPARE(f.op, ResultFilter::GreaterEqual);
+    QCOMPARE(f.value, QString("10"));
+
+    QVERIFY(ResultFilter::parse(0, "<> x", &f));
+    QCOMPARE(f.op, ResultFilter::NotEqual);
+    QCOMPARE(f.value, QString("x"));
+
+    QVERIFY(ResultFilter::parse(0, "  abc ", &f));
+    QCOMPARE(f.op, ResultFilter::Contains);
+    QCOMPARE(f.value, QString("abc"));
+
+    QVERIFY(ResultFilter::parse(0, "null", &f));
+    QCOMPARE(f.op, ResultFilter::IsNull);
+    QVERIFY(ResultFilter::parse(0, "!NULL", &f));
+    QCOMPARE(f.op, ResultFilter::NotNull);
+
+    QString err;
+    QVERIFY(!ResultFilter::parse(0, "=", &f, &err));
+    QVERIFY(!err.isEmpty());
+    QVERIFY(!ResultFilter::parse(0, "   ", &f));
+}
+
+QTEST_GUILESS_MAIN(TestResultFilter)
+#include "tst_resultfilter.moc"
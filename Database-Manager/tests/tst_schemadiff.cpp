@@ -0,0 +1,50 @@
+// tst_schemadiff: análisis y normalización de SHOW CREATE para comparar esquemas.
+
+#include "SchemaDiff.h"
+
+#include <QtTest>
+
+class TestSchemaDiff : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parseTable();
+    void normalize();
+};
+
+void TestSchemaDiff::parseTable()
+{
+    const SchemaDiff::TableDef t = SchemaDiff::parseTable(
+        "CREATE TABLE `t` (\n"
+        "  `id` int(11) NOT NULL AUTO_INCREMENT,\n"
+        "  `b` varchar(20) DEFAULT NULL,\n"
+        "  `doc` text,\n"
+        "  PRIMARY KEY (`id`),\n"
+        "  KEY `ix_b` (`b`),\n"
+        "  FULLTEXT KEY `ft_doc` (`doc`),\n"
+        "  CONSTRAINT `fk_b` FOREIGN KEY (`b`) REFERENCES `o` (`b`),\n"
+        "  CONSTRAINT `ck_id` CHECK (`id` > 0)\n"
+        ") ENGINE=InnoDB AUTO_INCREMENT=42 DEFAULT CHARSET=utf8mb4");
+
+    QCOMPARE(t.columnOrder, QStringList({"id", "b", "doc"}));
+    QCOMPARE(t.columns.value("b"), QString("`b` varchar(20) DEFAULT NULL"));
+    QCOMPARE(t.indexOrder, QStringList({"PRIMARY", "ix_b", "ft_doc"}));
+    QCOMPARE(t.indexes.value("PRIMARY"), QString("PRIMARY KEY (`id`)"));
+    QCOMPARE(t.indexes.value("ft_doc"), QString("FULLTEXT KEY `ft_doc` (`doc`)"));
+    QVERIFY(t.foreignKeys.contains("fk_b"));
+    QVERIFY(t.checks.contains("ck_id"));
+    QCOMPARE(t.options, QString("ENGINE=InnoDB DEFAULT CHARSET=utf8mb4"));
+}
+
+void TestSchemaDiff::normalize()
+{
+    QCOMPARE(SchemaDiff::normalize("table", "CREATE TABLE `t` (\n  `id` int\n) ENGINE=InnoDB AUTO_INCREMENT=7;", "d"),
+             QString("CREATE TABLE `t` (\n  `id` int\n) ENGINE=InnoDB"));
+    QCOMPARE(SchemaDiff::normalize("view",
+                                   "CREATE ALGORITHM=UNDEFINED DEFINER=`root`@`localhost` SQL SECURITY DEFINER "
+                                   "VIEW `d`.`v` AS select `d`.`t`.`id` AS `id` from `d`.`t`", "d"),
+             QString("CREATE ALGORITHM=UNDEFINED SQL SECURITY DEFINER VIEW `v` AS select `t`.`id` AS `id` from `t`"));
+}
+
+QTEST_GUILESS_MAIN(TestSchemaDiff)
+#include "tst_schemadiff.moc"
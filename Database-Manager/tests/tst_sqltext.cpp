@@ -0,0 +1,76 @@
+// tst_sqltext: análisis de texto SQL sin servidor (partir scripts y objetos que toca un DDL).
+
+#include "SqlText.h"
+
+#include <QtTest>
+
+class TestSqlText : public QObject {
+    Q_OBJECT
+
+private slots:
+    void splitStatements();
+    void splitStatementsDelimiter();
+    void ddlTargets();
+};
+
+void TestSqlText::splitStatements()
+{
+    const auto st = SqlText::splitStatements("SELECT 1; SELECT 'a;b';\n-- nota;\n# otra;\nSELECT `x;y`");
+    QCOMPARE(st.size(), 3);
+    QCOMPARE(st[0].sql, QString("SELECT 1"));
+    QCOMPARE(st[1].sql, QString("SELECT 'a;b'"));
+    QCOMPARE(st[2].sql, QString("SELECT `x;y`"));
+    QCOMPARE(st[0].line, 1);
+    QCOMPARE(st[2].line, 4);
+
+    QVERIFY(SqlText::splitStatements("  ;\n-- solo un comentario\n").isEmpty());
+}
+
+void TestSqlText::splitStatementsDelimiter()
+{
+    const auto st = SqlText::splitStatements(
+        "DELIMITER $$\nCREATE PROCEDURE p() BEGIN SELECT 1; END$$\nDELIMITER ;\nSELECT 2;");
+    QCOMPARE(st.size(), 2);
+    QCOMPARE(st[0].sql, QString("CREATE PROCEDURE p() BEGIN SELECT 1; END"));
+    QCOMPARE(st[0].line, 2);
+    QCOMPARE(st[1].sql, QString("SELECT 2"));
+    QCOMPARE(st[1].line, 4);
+}
+
+void TestSqlText::ddlTargets()
+{
+    auto t = SqlText::ddlTargets("DROP TABLE IF EXISTS a, `db2`.`b`");
+    QCOMPARE(t.size(), 2);
+    QCOMPARE(t[0].kind, QString("table"));
+    QCOMPARE(t[0].db, QString());
+    QCOMPARE(t[0].name, QString("a"));
+    QCOMPARE(t[1].db, QString("db2"));
+    QCOMPARE(t[1].name, QString("b"));
+
+    t = SqlText::ddlTargets("RENAME TABLE a TO d.c");
+    QCOMPARE(t.size(), 2);
+    QCOMPARE(t[1].db, QString("d"));
+    QCOMPARE(t[1].name, QString("c"));
+
+    t = SqlText::ddlTargets("CREATE INDEX ix ON d.t (c)");
+    QCOMPARE(t.size(), 1);
+    QCOMPARE(t[0].kind, QString("index"));
+    QCOMPARE(t[0].name, QString("ix"));
+    QCOMPARE(t[0].db, QString("d"));
+    QCOMPARE(t[0].table, QString("t"));
+
+    t = SqlText::ddlTargets("CREATE OR REPLACE DEFINER=`u`@`h` VIEW v AS SELECT 1");
+    QCOMPARE(t.size(), 1);
+    QCOMPARE(t[0].kind, QString("view"));
+    QCOMPARE(t[0].name, QString("v"));
+
+    t = SqlText::ddlTargets("CREATE TRIGGER tr BEFORE INSERT ON d.t FOR EACH ROW SET @x = 1");
+    QCOMPARE(t.size(), 1);
+    QCOMPARE(t[0].kind, QString("trigger"));
+    QCOMPARE(t[0].db, QString("d"));
+
+    QVERIFY(SqlText::ddlTargets("SELECT * FROM t").isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestSqlText)
+#include "tst_sqltext.moc"
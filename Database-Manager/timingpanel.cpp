@@ -0,0 +1,108 @@
+#include "TimingPanel.h"
+#include "QueryStats.h"
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QSplitter>
+#include <QLabel>
+#include <QTimer>
+#include <QLocale>
+#include <algorithm>
+
+enum { ColSource, ColKind, ColSql, ColExec, ColFirst, ColFetch, ColRows, ColBytes, ColGui, ColTotal, ColCount };
+
+static QString ms(qint64 v)
+{
+    return v < 0 ? QString("-") : QString("%1 ms").arg(v);
+}
+
+static QString bytes(qint64 b)
+{
+    return QLocale().formattedDataSize(b, 1, QLocale::DataSizeTraditionalFormat);
+}
+
+static QTableWidget* makeTable(const QStringList& headers)
+{
+    auto* t = new QTableWidget(0, headers.size());
+    t->setHorizontalHeaderLabels(headers);
+    t->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    t->setSelectionBehavior(QAbstractItemView::SelectRows);
+    t->verticalHeader()->setVisible(false);
+    return t;
+}
+
+TimingPanel::TimingPanel(QueryStats* stats, QWidget* p)
+    : QWidget(p), stats(stats)
+{
+    history = makeTable({"Origen", "Tipo", "Sentencia", "Ejecutar", "1ª fila", "Fetch",
+                         "Filas", "Bytes", "Modelo/Render", "Total"});
+    history->horizontalHeader()->setSectionResizeMode(ColSql, QHeaderView::Stretch);
+
+    summary = makeTable({"Tipo", "Muestras", "p50", "p95"});
+    summary->horizontalHeader()->setStretchLastSection(true);
+
+    note = new QLabel("Total = ejecutar + fetch + modelo + render. Bytes: valores ya leídos, no tráfico de red.");
+    note->setWordWrap(true);
+
+    auto* split = new QSplitter(Qt::Vertical);
+    split->addWidget(history);
+    split->addWidget(summary);
+    split->setStretchFactor(0, 3);
+    split->setStretchFactor(1, 1);
+
+    auto* l = new QVBoxLayout(this);
+    l->setContentsMargins(0,0,0,0);
+    l->addWidget(note);
+    l->addWidget(split, 1);
+
+    throttle = new QTimer(this);
+    throttle->setSingleShot(true);
+    throttle->setInterval(250);
+    connect(throttle, &QTimer::timeout, this, &TimingPanel::refresh);
+    connect(stats, &QueryStats::changed, this, [this]{
+        if (!throttle->isActive()) throttle->start();
+    });
+
+    refresh();
+}
+
+void TimingPanel::refresh()
+{
+    // La más reciente arriba
+    const auto& h = stats->history();
+    history->setRowCount(h.size());
+    for (int i = 0; i < h.size(); ++i) {
+        const QueryTiming& t = h[h.size() - 1 - i];
+        QString sql = t.sql.simplified();
+        if (sql.size() > 120) sql = sql.left(117) + "...";
+
+        QString gui = QString("%1 / %2 ms").arg(t.modelMs).arg(t.renderMs);
+        QString total = t.done ? ms(t.activeMs()) : QString("en curso");
+        if (t.done && !t.ok) total += " (error)";
+
+        const QString cells[ColCount] = {
+            t.source, t.kind, sql, ms(t.executeMs), ms(t.firstRowMs), ms(t.fetchMs),
+            QString::number(t.rows), bytes(t.bytes), gui, total
+        };
+        for (int c = 0; c < ColCount; ++c) {
+            QTableWidgetItem* it = history->item(i, c);
+            if (!it) history->setItem(i, c, it = new QTableWidgetItem);
+            it->setText(cells[c]);
+        }
+        history->item(i, ColSql)->setToolTip(t.sql);
+    }
+
+    const auto p = stats->percentilesByKind();
+    QStringList kinds = p.keys();
+    std::sort(kinds.begin(), kinds.end());
+    summary->setRowCount(kinds.size());
+    for (int i = 0; i < kinds.size(); ++i) {
+        const auto& v = p.value(kinds[i]);
+        const QString cells[] = { kinds[i], QString::number(v.samples), ms(v.p50), ms(v.p95) };
+        for (int c = 0; c < 4; ++c) {
+            QTableWidgetItem* it = summary->item(i, c);
+            if (!it) summary->setItem(i, c, it = new QTableWidgetItem);
+            it->setText(cells[c]);
+        }
+    }
+}
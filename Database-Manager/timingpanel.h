@@ -0,0 +1,25 @@
+#pragma once
+#include <QWidget>
+
+class QueryStats;
+class QTableWidget;
+class QLabel;
+class QTimer;
+
+// Pestaña "Tiempos": desglose de las últimas ejecuciones (servidor, primera fila,
+// fetch, modelo y pintado) y p50/p95 por tipo de sentencia. Se redibuja como mucho
+// unas pocas veces por segundo aunque lleguen muchos tramos.
+class TimingPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit TimingPanel(QueryStats* stats, QWidget* parent = nullptr);
+
+private:
+    void refresh();
+
+    QueryStats* stats;
+    QTableWidget* history;
+    QTableWidget* summary;
+    QLabel* note;
+    QTimer* throttle;
+};